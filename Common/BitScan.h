@@ -21,6 +21,13 @@ inline uint32_t clz32(uint32_t value) {
 	return 31 ^ (uint32_t)index;
 }
 
+// Index of the lowest set bit.  Use this if you know the value is non-zero.
+inline uint32_t ctz32_nonzero(uint32_t value) {
+	DWORD index;
+	BitScanForward(&index, value);
+	return (uint32_t)index;
+}
+
 #else
 
 // Use this if you know the value is non-zero.
@@ -34,4 +41,9 @@ inline uint32_t clz32(uint32_t value) {
 	return __builtin_clz(value);
 }
 
+// Index of the lowest set bit.  Use this if you know the value is non-zero.
+inline uint32_t ctz32_nonzero(uint32_t value) {
+	return __builtin_ctz(value);
+}
+
 #endif
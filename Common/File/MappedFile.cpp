@@ -0,0 +1,129 @@
+#include "ppsspp_config.h"
+
+#include <cstdint>
+
+#ifdef _WIN32
+#include "Common/CommonWindows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Common/File/FileUtil.h"
+#include "Common/File/MappedFile.h"
+#include "Common/File/Path.h"
+#include "Common/Log.h"
+
+bool MappedFile::Open(const Path &filename) {
+	Close();
+	if (Map(filename)) {
+		mapped_ = true;
+		return true;
+	}
+
+	if (!File::ReadFileToString(false, filename, buffer_) || buffer_.empty()) {
+		buffer_.clear();
+		return false;
+	}
+	data_ = (const uint8_t *)buffer_.data();
+	size_ = buffer_.size();
+	return true;
+}
+
+#if defined(_WIN32) && !PPSSPP_PLATFORM(UWP)
+
+bool MappedFile::Map(const Path &filename) {
+	if (filename.Type() != PathType::NATIVE)
+		return false;
+
+	HANDLE file = CreateFileW(filename.ToWString().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size{};
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &size) && size.QuadPart != 0 && (uint64_t)size.QuadPart <= (uint64_t)SIZE_MAX)
+		mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	// The mapping keeps the file open.
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+
+	const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!view)
+		return false;
+
+	data_ = (const uint8_t *)view;
+	size_ = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (mapped_)
+		UnmapViewOfFile(data_);
+	else
+		buffer_.clear();
+	data_ = nullptr;
+	size_ = 0;
+	mapped_ = false;
+}
+
+#elif !defined(_WIN32)
+
+bool MappedFile::Map(const Path &filename) {
+	int fd = -1;
+	switch (filename.Type()) {
+	case PathType::NATIVE:
+		fd = open(filename.c_str(), O_RDONLY);
+		break;
+	case PathType::CONTENT_URI:
+		fd = File::OpenFD(filename, File::OPEN_READ);
+		break;
+	default:
+		break;
+	}
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	void *view = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0 && (uint64_t)st.st_size <= (uint64_t)SIZE_MAX)
+		view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping stays valid after closing.
+	close(fd);
+	if (view == MAP_FAILED)
+		return false;
+
+	data_ = (const uint8_t *)view;
+	size_ = (size_t)st.st_size;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (mapped_)
+		munmap((void *)data_, size_);
+	else
+		buffer_.clear();
+	data_ = nullptr;
+	size_ = 0;
+	mapped_ = false;
+}
+
+#else
+
+// UWP can only map files through StorageFile, so just read it.
+bool MappedFile::Map(const Path &filename) {
+	return false;
+}
+
+void MappedFile::Close() {
+	buffer_.clear();
+	data_ = nullptr;
+	size_ = 0;
+	mapped_ = false;
+}
+
+#endif
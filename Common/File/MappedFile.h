@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Path;
+
+// Read-only view of a whole file.  Where possible the file is memory mapped, so pages are only
+// read when touched and are shared between processes.  Otherwise, it's just read into memory.
+class MappedFile {
+public:
+	MappedFile() {}
+	~MappedFile() {
+		Close();
+	}
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator =(const MappedFile &) = delete;
+
+	// Fails for empty files, too.
+	bool Open(const Path &filename);
+	void Close();
+
+	bool IsOpen() const {
+		return data_ != nullptr;
+	}
+	bool IsMapped() const {
+		return mapped_;
+	}
+	const uint8_t *Data() const {
+		return data_;
+	}
+	size_t Size() const {
+		return size_;
+	}
+
+private:
+	bool Map(const Path &filename);
+
+	const uint8_t *data_ = nullptr;
+	size_t size_ = 0;
+	bool mapped_ = false;
+	// Only used when the file couldn't be mapped.
+	std::string buffer_;
+};
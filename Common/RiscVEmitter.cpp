@@ -628,7 +628,7 @@ void RiscVEmitter::FlushIcache() {
 
 void RiscVEmitter::FlushIcacheSection(const u8 *start, const u8 *end) {
 #if PPSSPP_ARCH(RISCV64)
-	__builtin___clear_cache(start, end);
+	__builtin___clear_cache((char *)start, (char *)end);
 #endif
 }
 
@@ -744,13 +744,14 @@ void RiscVEmitter::SetRegToImmediate(RiscVReg rd, uint64_t value, RiscVReg temp)
 	}
 
 	auto useUpper = [&](int64_t v, void (RiscVEmitter::*upperOp)(RiscVReg, s32), bool force = false) {
-		if (SignReduce64(v, 32) == v || force) {
-			int32_t lower = (int32_t)SignReduce64(svalue, 12);
-			int32_t upper = ((v - lower) >> 12) << 12;
+		// The lower part is sign extended, so the upper part may need to round up past 32 bits.
+		int32_t lower = (int32_t)SignReduce64(v, 12);
+		int64_t upper = ((v - lower) >> 12) << 12;
+		if (SignReduce64(upper, 32) == upper || force) {
 			_assert_msg_(force || upper + lower == v, "Upper + ADDI immediate math mistake?");
 
 			// Should be fused on some processors.
-			(this->*upperOp)(rd, upper);
+			(this->*upperOp)(rd, (s32)upper);
 			if (lower != 0)
 				ADDI(rd, rd, lower);
 			return true;
@@ -2100,4 +2101,14 @@ void RiscVEmitter::C_SDSP(RiscVReg rs2, u32 uimm9) {
 	Write16(EncodeCSS(Opcode16::C2, rs2, imm5_4_3_8_7_6, Funct3::C_SDSP));
 }
 
+void RiscVCodeBlock::PoisonMemory(int offset) {
+	u32 *ptr = (u32 *)(region + offset);
+	u32 *maxptr = (u32 *)(region + region_size - offset);
+	// If our memory isn't a multiple of u32 then this won't write the last remaining bytes with anything
+	// Less than optimal, but there would be nothing we could do but throw a runtime warning anyway.
+	// RISC-V: 0x00100073 = ebreak
+	while (ptr < maxptr)
+		*ptr++ = 0x00100073;
+}
+
 };
@@ -501,7 +501,7 @@ static int DefaultCpuCore() {
 }
 
 static bool DefaultCodeGen() {
-#if PPSSPP_ARCH(ARM) || PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+#if PPSSPP_ARCH(ARM) || PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(RISCV64)
 	return true;
 #else
 	return false;
@@ -632,6 +632,9 @@ static ConfigSetting cpuSettings[] = {
 	ConfigSetting("HideSlowWarnings", &g_Config.bHideSlowWarnings, false, true, false),
 	ConfigSetting("HideStateWarnings", &g_Config.bHideStateWarnings, false, true, false),
 	ConfigSetting("PreloadFunctions", &g_Config.bPreloadFunctions, false, true, true),
+	ConfigSetting("IRBlockCache", &g_Config.bIRBlockCache, false, false, false),  // Doesn't save. Ini-only.
+	ConfigSetting("JitBackgroundCompile", &g_Config.bJitBackgroundCompile, false, true, true),
+	ConfigSetting("FuncScanInBackground", &g_Config.bFuncScanInBackground, false, true, true),
 	ConfigSetting("JitDisableFlags", &g_Config.uJitDisableFlags, (uint32_t)0, true, true),
 	ReportedConfigSetting("CPUSpeed", &g_Config.iLockedCPUSpeed, 0, true, true),
 
@@ -1462,7 +1465,13 @@ void Config::Load(const char *iniFileName, const char *controllerIniFilename) {
 	}
 
 	// Override ppsspp.ini JIT value to prevent crashing
-	if (DefaultCpuCore() != (int)CPUCore::JIT && g_Config.iCpuCore == (int)CPUCore::JIT) {
+#if PPSSPP_ARCH(RISCV64)
+	// Only the IR jit has a native backend here.
+	const bool jitIRSupported = true;
+#else
+	const bool jitIRSupported = DefaultCpuCore() == (int)CPUCore::JIT;
+#endif
+	if ((DefaultCpuCore() != (int)CPUCore::JIT && g_Config.iCpuCore == (int)CPUCore::JIT) || (!jitIRSupported && g_Config.iCpuCore == (int)CPUCore::JIT_IR)) {
 		jitForcedOff = true;
 		g_Config.iCpuCore = (int)CPUCore::INTERPRETER;
 	}
@@ -119,6 +119,9 @@ struct Config {
 	bool bHideSlowWarnings;
 	bool bHideStateWarnings;
 	bool bPreloadFunctions;
+	bool bIRBlockCache;  // Hidden ini-only setting, useful for debugging IR compile times.
+	bool bJitBackgroundCompile;
+	bool bFuncScanInBackground;
 	uint32_t uJitDisableFlags;
 
 	bool bSeparateSASThread;
@@ -34,6 +34,7 @@ enum class CPUCore {
 	INTERPRETER = 0,
 	JIT = 1,
 	IR_JIT = 2,
+	JIT_IR = 3,
 };
 
 enum {
@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <atomic>
 #include <climits>
 #include <cstdio>
@@ -63,14 +64,56 @@ struct BaseEvent {
 
 typedef LinkedListItem<BaseEvent> Event;
 
-Event *first;
+// The main queue is a 4-ary min-heap, ordered by time and then by scheduling order, so that
+// events due at the same time still fire first come first served like the old sorted list.
+// The event data lives in slots that remember their heap index, which is what lets an
+// EventHandle find its event without searching.
+struct HeapEntry {
+	s64 time;
+	u32 order;
+	int slot;
+};
+
+struct EventSlot {
+	u64 userdata;
+	int type;
+	// -1 while the slot is free.
+	int heapIndex;
+	u32 generation;
+	int nextFree;
+};
+
+static const int HEAP_ARITY = 4;
+
+static std::vector<HeapEntry> eventHeap;
+static std::vector<EventSlot> eventSlots;
+static int firstFreeSlot = -1;
+static u32 nextEventOrder = 0;
+// Reused by the unschedule functions to avoid allocating.
+static std::vector<int> matchingSlots;
+
+// Events from other threads go through a bounded lock-free ring, so that the GE thread and
+// async I/O never wait on the CPU thread or each other.  Producers claim a cell by bumping
+// tsRingWritePos and then publish it through the cell's sequence, and MoveEvents on the CPU
+// thread is the only consumer.  Cancelled events just get their type set to -1.
+struct TsEventCell {
+	std::atomic<u32> sequence;
+	BaseEvent event;
+};
+
+static const u32 TS_RING_SIZE = 1024;
+static TsEventCell tsRing[TS_RING_SIZE];
+static std::atomic<u32> tsRingWritePos;
+static u32 tsRingReadPos;
+
+// If the ring fills up, events overflow into this list, which still needs the lock.  While
+// it's in use all threadsafe events go there, to keep them in order.
 Event *tsFirst;
 Event *tsLast;
+static std::atomic<u32> tsOverflowed;
 
-// event pools
-Event *eventPool = 0;
+// event pool
 Event *eventTsPool = 0;
-int allocatedTsEvents = 0;
 // Optimization to skip MoveEvents when possible.
 std::atomic<u32> hasTsEvents;
 
@@ -131,20 +174,8 @@ u64 GetGlobalTimeUs() {
 	return lastGlobalTimeUs + usSinceLast;
 }
 
-Event* GetNewEvent()
-{
-	if(!eventPool)
-		return new Event;
-
-	Event* ev = eventPool;
-	eventPool = ev->next;
-	return ev;
-}
-
 Event* GetNewTsEvent()
 {
-	allocatedTsEvents++;
-
 	if(!eventTsPool)
 		return new Event;
 
@@ -153,17 +184,145 @@ Event* GetNewTsEvent()
 	return ev;
 }
 
-void FreeEvent(Event* ev)
-{
-	ev->next = eventPool;
-	eventPool = ev;
-}
-
 void FreeTsEvent(Event* ev)
 {
 	ev->next = eventTsPool;
 	eventTsPool = ev;
-	allocatedTsEvents--;
+}
+
+static inline bool EventBefore(const HeapEntry &a, const HeapEntry &b) {
+	return a.time < b.time || (a.time == b.time && a.order < b.order);
+}
+
+static inline void PlaceHeapEntry(int i, const HeapEntry &entry) {
+	eventHeap[i] = entry;
+	eventSlots[entry.slot].heapIndex = i;
+}
+
+static void SiftUp(int i) {
+	const HeapEntry entry = eventHeap[i];
+	while (i > 0) {
+		int parent = (i - 1) / HEAP_ARITY;
+		if (!EventBefore(entry, eventHeap[parent]))
+			break;
+		PlaceHeapEntry(i, eventHeap[parent]);
+		i = parent;
+	}
+	PlaceHeapEntry(i, entry);
+}
+
+static void SiftDown(int i) {
+	const int n = (int)eventHeap.size();
+	const HeapEntry entry = eventHeap[i];
+	while (true) {
+		int child = i * HEAP_ARITY + 1;
+		if (child >= n)
+			break;
+		int best = child;
+		int end = std::min(child + HEAP_ARITY, n);
+		for (int c = child + 1; c < end; ++c) {
+			if (EventBefore(eventHeap[c], eventHeap[best]))
+				best = c;
+		}
+		if (!EventBefore(eventHeap[best], entry))
+			break;
+		PlaceHeapEntry(i, eventHeap[best]);
+		i = best;
+	}
+	PlaceHeapEntry(i, entry);
+}
+
+static int AllocEventSlot() {
+	if (firstFreeSlot == -1) {
+		eventSlots.push_back(EventSlot{ 0, 0, -1, 1, -1 });
+		return (int)eventSlots.size() - 1;
+	}
+	int slot = firstFreeSlot;
+	firstFreeSlot = eventSlots[slot].nextFree;
+	return slot;
+}
+
+static void FreeEventSlot(int slot) {
+	EventSlot &s = eventSlots[slot];
+	s.heapIndex = -1;
+	// Invalidates outstanding handles.  Zero is skipped so a valid handle is never 0.
+	if (++s.generation == 0)
+		s.generation = 1;
+	s.nextFree = firstFreeSlot;
+	firstFreeSlot = slot;
+}
+
+static std::vector<HeapEntry> SortedEvents();
+
+// Keeps the entries at 16 bytes.  Renumbering keeps the relative order, so the heap stays valid.
+static void RenumberEventOrder() {
+	std::vector<HeapEntry> sorted = SortedEvents();
+	for (u32 i = 0; i < (u32)sorted.size(); ++i)
+		eventHeap[eventSlots[sorted[i].slot].heapIndex].order = i;
+	nextEventOrder = (u32)sorted.size();
+}
+
+static EventHandle AddEventToQueue(s64 time, int event_type, u64 userdata) {
+	if (nextEventOrder == 0xFFFFFFFF)
+		RenumberEventOrder();
+
+	int slot = AllocEventSlot();
+	eventSlots[slot].userdata = userdata;
+	eventSlots[slot].type = event_type;
+	eventHeap.push_back(HeapEntry{ time, nextEventOrder++, slot });
+	SiftUp((int)eventHeap.size() - 1);
+	return ((u64)eventSlots[slot].generation << 32) | (u32)slot;
+}
+
+// Removes the entry at heap index i and frees its slot.
+static void RemoveHeapEntry(int i) {
+	FreeEventSlot(eventHeap[i].slot);
+	const HeapEntry last = eventHeap.back();
+	eventHeap.pop_back();
+	if (i == (int)eventHeap.size())
+		return;
+
+	PlaceHeapEntry(i, last);
+	if (i > 0 && EventBefore(last, eventHeap[(i - 1) / HEAP_ARITY]))
+		SiftUp(i);
+	else
+		SiftDown(i);
+}
+
+static int LookupHandle(EventHandle handle) {
+	u32 slot = (u32)handle;
+	if (slot >= eventSlots.size() || eventSlots[slot].generation != (u32)(handle >> 32))
+		return -1;
+	return eventSlots[slot].heapIndex;
+}
+
+// Removes every event in the main queue that pred matches.  Returns the cycles left until the
+// last of them would have fired, or 0 if none matched.
+template <typename Pred>
+static s64 RemoveMatchingEvents(Pred pred) {
+	matchingSlots.clear();
+	const HeapEntry *latest = nullptr;
+	for (const HeapEntry &entry : eventHeap) {
+		if (pred(eventSlots[entry.slot])) {
+			matchingSlots.push_back(entry.slot);
+			if (!latest || EventBefore(*latest, entry))
+				latest = &entry;
+		}
+	}
+	if (!latest)
+		return 0;
+
+	s64 result = latest->time - GetTicks();
+	for (int slot : matchingSlots)
+		RemoveHeapEntry(eventSlots[slot].heapIndex);
+	return result;
+}
+
+// The main queue in firing order, for save states and debugging.
+static std::vector<HeapEntry> SortedEvents() {
+	std::vector<HeapEntry> sorted = eventHeap;
+	std::sort(sorted.begin(), sorted.end(), &EventBefore);
+	return sorted;
 }
 
 int RegisterEvent(const char *name, TimedCallback callback) {
@@ -209,7 +368,7 @@ void RestoreRegisterEvent(int &event_type, const char *name, TimedCallback callb
 }
 
 void UnregisterAllEvents() {
-	_dbg_assert_msg_(first == nullptr, "Unregistering events with events pending - this isn't good.");
+	_dbg_assert_msg_(eventHeap.empty(), "Unregistering events with events pending - this isn't good.");
 	event_types.clear();
 	usedEventTypes.clear();
 	restoredEventTypes.clear();
@@ -224,6 +383,11 @@ void Init()
 	lastGlobalTimeTicks = 0;
 	lastGlobalTimeUs = 0;
 	hasTsEvents = 0;
+	for (u32 i = 0; i < TS_RING_SIZE; ++i)
+		tsRing[i].sequence.store(i, std::memory_order_relaxed);
+	tsRingWritePos = 0;
+	tsRingReadPos = 0;
+	tsOverflowed = 0;
 	mhzChangeCallbacks.clear();
 	CPU_HZ = initialHz;
 }
@@ -234,12 +398,9 @@ void Shutdown()
 	ClearPendingEvents();
 	UnregisterAllEvents();
 
-	while(eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
+	eventHeap.clear();
+	eventSlots.clear();
+	firstFreeSlot = -1;
 
 	std::lock_guard<std::mutex> lk(externalEventLock);
 	while(eventTsPool)
@@ -261,21 +422,83 @@ u64 GetIdleTicks()
 }
 
 
-// This is to be called when outside threads, such as the graphics thread, wants to
-// schedule things to be executed on the main thread.
-void ScheduleEvent_Threadsafe(s64 cyclesIntoFuture, int event_type, u64 userdata)
+static bool PushTsRingEvent(const BaseEvent &ev)
+{
+	u32 pos = tsRingWritePos.load(std::memory_order_relaxed);
+	TsEventCell *cell;
+	while (true) {
+		cell = &tsRing[pos & (TS_RING_SIZE - 1)];
+		u32 seq = cell->sequence.load(std::memory_order_acquire);
+		s32 diff = (s32)(seq - pos);
+		if (diff == 0) {
+			if (tsRingWritePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			// Full, MoveEvents hasn't caught up yet.
+			return false;
+		} else {
+			pos = tsRingWritePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->event = ev;
+	cell->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+// Calls func on each published event that MoveEvents hasn't taken yet.  CPU thread only.
+template <typename Func>
+static void ForEachTsRingEvent(Func func)
+{
+	for (u32 pos = tsRingReadPos; ; ++pos) {
+		TsEventCell &cell = tsRing[pos & (TS_RING_SIZE - 1)];
+		if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+			break;
+		func(cell.event);
+	}
+}
+
+// Takes published events off the ring, in order.  CPU thread only.
+template <typename Func>
+static void DrainTsRing(Func func)
+{
+	while (true) {
+		TsEventCell &cell = tsRing[tsRingReadPos & (TS_RING_SIZE - 1)];
+		if (cell.sequence.load(std::memory_order_acquire) != tsRingReadPos + 1)
+			break;
+		if (cell.event.type != -1)
+			func(cell.event);
+		cell.sequence.store(tsRingReadPos + TS_RING_SIZE, std::memory_order_release);
+		tsRingReadPos++;
+	}
+}
+
+// Must hold externalEventLock.
+static void AppendTsOverflowEvent(const BaseEvent &ev)
 {
-	std::lock_guard<std::mutex> lk(externalEventLock);
 	Event *ne = GetNewTsEvent();
-	ne->time = GetTicks() + cyclesIntoFuture;
-	ne->type = event_type;
+	ne->time = ev.time;
+	ne->type = ev.type;
 	ne->next = 0;
-	ne->userdata = userdata;
+	ne->userdata = ev.userdata;
 	if(!tsFirst)
 		tsFirst = ne;
 	if(tsLast)
 		tsLast->next = ne;
 	tsLast = ne;
+	tsOverflowed.store(1, std::memory_order_release);
+}
+
+// This is to be called when outside threads, such as the graphics thread, wants to
+// schedule things to be executed on the main thread.
+void ScheduleEvent_Threadsafe(s64 cyclesIntoFuture, int event_type, u64 userdata)
+{
+	BaseEvent ev{ (s64)GetTicks() + cyclesIntoFuture, userdata, event_type };
+	if (tsOverflowed.load(std::memory_order_acquire) || !PushTsRingEvent(ev))
+	{
+		std::lock_guard<std::mutex> lk(externalEventLock);
+		AppendTsOverflowEvent(ev);
+	}
 
 	hasTsEvents.store(1, std::memory_order::memory_order_release);
 }
@@ -295,92 +518,47 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata)
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
-}
-
-void AddEventToQueue(Event* ne)
-{
-	Event* prev = NULL;
-	Event** pNext = &first;
-	for(;;)
-	{
-		Event*& next = *pNext;
-		if(!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	for (const HeapEntry &entry : eventHeap)
+		FreeEventSlot(entry.slot);
+	eventHeap.clear();
 }
 
 // This must be run ONLY from within the cpu thread
 // cyclesIntoFuture may be VERY inaccurate if called from anything else
 // than Advance
-void ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata)
+EventHandle ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = GetTicks() + cyclesIntoFuture;
-	AddEventToQueue(ne);
+	return AddEventToQueue(GetTicks() + cyclesIntoFuture, event_type, userdata);
 }
 
 // Returns cycles left in timer.
 s64 UnscheduleEvent(int event_type, u64 userdata)
 {
-	s64 result = 0;
-	if (!first)
-		return result;
-	while(first)
-	{
-		if (first->type == event_type && first->userdata == userdata)
-		{
-			result = first->time - GetTicks();
-
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
-		return result;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type && ptr->userdata == userdata)
-		{
-			result = ptr->time - GetTicks();
-
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
-	}
+	return RemoveMatchingEvents([&](const EventSlot &s) {
+		return s.type == event_type && s.userdata == userdata;
+	});
+}
 
+s64 UnscheduleEventByHandle(EventHandle handle)
+{
+	int i = LookupHandle(handle);
+	if (i == -1)
+		return 0;
+	s64 result = eventHeap[i].time - GetTicks();
+	RemoveHeapEntry(i);
 	return result;
 }
 
 s64 UnscheduleThreadsafeEvent(int event_type, u64 userdata)
 {
 	s64 result = 0;
+	ForEachTsRingEvent([&](BaseEvent &ev) {
+		if (ev.type == event_type && ev.userdata == userdata) {
+			result = ev.time - GetTicks();
+			ev.type = -1;
+		}
+	});
+
 	std::lock_guard<std::mutex> lk(externalEventLock);
 	if (!tsFirst)
 		return result;
@@ -435,56 +613,32 @@ void RegisterMHzChangeCallback(MHzChangeCallback callback) {
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e) {
-		if (e->type == event_type)
+	for (const HeapEntry &entry : eventHeap) {
+		if (eventSlots[entry.slot].type == event_type)
 			return true;
-		e = e->next;
 	}
 	return false;
 }
 
+bool IsHandleScheduled(EventHandle handle)
+{
+	return LookupHandle(handle) != -1;
+}
+
 void RemoveEvent(int event_type)
 {
-	if (!first)
-		return;
-	while(first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
-		return;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
-	}
+	RemoveMatchingEvents([&](const EventSlot &s) {
+		return s.type == event_type;
+	});
 }
 
 void RemoveThreadsafeEvent(int event_type)
 {
+	ForEachTsRingEvent([&](BaseEvent &ev) {
+		if (ev.type == event_type)
+			ev.type = -1;
+	});
+
 	std::lock_guard<std::mutex> lk(externalEventLock);
 	if (!tsFirst)
 	{
@@ -537,21 +691,15 @@ void RemoveAllEvents(int event_type)
 //This raise only the events required while the fifo is processing data
 void ProcessFifoWaitEvents()
 {
-	while (first)
+	while (!eventHeap.empty() && eventHeap[0].time <= (s64)GetTicks())
 	{
-		if (first->time <= (s64)GetTicks())
-		{
-//			LOG(CPU, "[Scheduler] %s		 (%lld, %lld) ",
-//				first->name ? first->name : "?", (u64)GetTicks(), (u64)first->time);
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(GetTicks() - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		// Take it off the queue first, the callback may well schedule or unschedule events.
+		const s64 time = eventHeap[0].time;
+		const EventSlot &slot = eventSlots[eventHeap[0].slot];
+		const int type = slot.type;
+		const u64 userdata = slot.userdata;
+		RemoveHeapEntry(0);
+		event_types[type].callback(userdata, (int)(GetTicks() - time));
 	}
 }
 
@@ -559,25 +707,27 @@ void MoveEvents()
 {
 	hasTsEvents.store(0, std::memory_order::memory_order_release);
 
-	std::lock_guard<std::mutex> lk(externalEventLock);
 	// Move events from async queue into main queue
+	DrainTsRing([](const BaseEvent &ev) {
+		AddEventToQueue(ev.time, ev.type, ev.userdata);
+	});
+	if (!tsOverflowed.load(std::memory_order_acquire))
+		return;
+
+	std::lock_guard<std::mutex> lk(externalEventLock);
+	// Producers go back to the ring once we're done here, so take the rest of the ring first.
+	DrainTsRing([](const BaseEvent &ev) {
+		AddEventToQueue(ev.time, ev.type, ev.userdata);
+	});
+	tsOverflowed.store(0, std::memory_order_release);
 	while (tsFirst)
 	{
 		Event *next = tsFirst->next;
-		AddEventToQueue(tsFirst);
+		AddEventToQueue(tsFirst->time, tsFirst->type, tsFirst->userdata);
+		FreeTsEvent(tsFirst);
 		tsFirst = next;
 	}
 	tsLast = NULL;
-
-	// Move free events to threadsafe pool
-	while(allocatedTsEvents > 0 && eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		ev->next = eventTsPool;
-		eventTsPool = ev;
-		allocatedTsEvents--;
-	}
 }
 
 void ForceCheck()
@@ -604,7 +754,7 @@ void Advance() {
 		MoveEvents();
 	ProcessFifoWaitEvents();
 
-	if (!first) {
+	if (eventHeap.empty()) {
 		// This should never happen in PPSSPP.
 		// WARN_LOG_REPORT(TIME, "WARNING - no events in queue. Setting currentMIPS->downcount to 10000");
 		if (slicelength < 10000) {
@@ -613,7 +763,7 @@ void Advance() {
 		}
 	} else {
 		// Note that events can eat cycles as well.
-		int target = (int)(first->time - globalTimer);
+		int target = (int)(eventHeap[0].time - globalTimer);
 		if (target > MAX_SLICE_LENGTH)
 			target = MAX_SLICE_LENGTH;
 
@@ -624,10 +774,8 @@ void Advance() {
 }
 
 void LogPendingEvents() {
-	Event *ptr = first;
-	while (ptr) {
-		//INFO_LOG(CPU, "PENDING: Now: %lld Pending: %lld Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
+	for (const HeapEntry &entry : SortedEvents()) {
+		DEBUG_LOG(CPU, "PENDING: Now: %lld Pending: %lld Type: %d", (long long)globalTimer, (long long)entry.time, eventSlots[entry.slot].type);
 	}
 }
 
@@ -636,9 +784,9 @@ void Idle(int maxIdle) {
 	if (maxIdle != 0 && cyclesDown > maxIdle)
 		cyclesDown = maxIdle;
 
-	if (first && cyclesDown > 0) {
+	if (!eventHeap.empty() && cyclesDown > 0) {
 		int cyclesExecuted = slicelength - currentMIPS->downcount;
-		int cyclesNextEvent = (int) (first->time - globalTimer);
+		int cyclesNextEvent = (int) (eventHeap[0].time - globalTimer);
 
 		if (cyclesNextEvent < cyclesExecuted + cyclesDown)
 			cyclesDown = cyclesNextEvent - cyclesExecuted;
@@ -657,23 +805,21 @@ void Idle(int maxIdle) {
 }
 
 std::string GetScheduledEventsSummary() {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr) {
-		unsigned int t = ptr->type;
+	for (const HeapEntry &entry : SortedEvents()) {
+		const EventSlot &slot = eventSlots[entry.slot];
+		unsigned int t = slot.type;
 		if (t >= event_types.size()) {
 			_dbg_assert_msg_(false, "Invalid event type %d", t);
-			ptr = ptr->next;
 			continue;
 		}
 		const char *name = event_types[t].name;
 		if (!name)
 			name = "[unknown]";
 		char temp[512];
-		sprintf(temp, "%s : %i %08x%08x\n", name, (int)ptr->time, (u32)(ptr->userdata >> 32), (u32)(ptr->userdata));
+		sprintf(temp, "%s : %i %08x%08x\n", name, (int)entry.time, (u32)(slot.userdata >> 32), (u32)(slot.userdata));
 		text += temp;
-		ptr = ptr->next;
 	}
 	return text;
 }
@@ -693,6 +839,40 @@ void Event_DoStateOld(PointerWrap &p, BaseEvent *ev)
 	usedEventTypes.insert(ev->type);
 }
 
+// Uses the same format as DoLinkedList did back when the main queue was a sorted list, so
+// save states don't change.
+static void DoEventQueue(PointerWrap &p, void (*doEvent)(PointerWrap &, BaseEvent *)) {
+	if (p.mode == PointerWrap::MODE_READ) {
+		ClearPendingEvents();
+		while (true) {
+			u8 shouldExist = 0;
+			Do(p, shouldExist);
+			if (shouldExist != 1) {
+				if (shouldExist != 0) {
+					WARN_LOG(SAVESTATE, "Savestate failure: incorrect item marker %d", shouldExist);
+					p.SetError(p.ERROR_FAILURE);
+				}
+				break;
+			}
+			BaseEvent ev;
+			doEvent(p, &ev);
+			if (p.error == p.ERROR_FAILURE)
+				break;
+			AddEventToQueue(ev.time, ev.type, ev.userdata);
+		}
+		return;
+	}
+
+	for (const HeapEntry &entry : SortedEvents()) {
+		u8 shouldExist = 1;
+		Do(p, shouldExist);
+		BaseEvent ev{ entry.time, eventSlots[entry.slot].userdata, eventSlots[entry.slot].type };
+		doEvent(p, &ev);
+	}
+	u8 shouldExist = 0;
+	Do(p, shouldExist);
+}
+
 void DoState(PointerWrap &p) {
 	std::lock_guard<std::mutex> lk(externalEventLock);
 
@@ -718,13 +898,20 @@ void DoState(PointerWrap &p) {
 	usedEventTypes.clear();
 	restoredEventTypes.clear();
 
+	// The ring isn't saved directly, the list format is kept.
+	DrainTsRing([](const BaseEvent &ev) {
+		AppendTsOverflowEvent(ev);
+	});
+
 	if (s >= 3) {
-		DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoState>(p, first, (Event **) NULL);
+		DoEventQueue(p, &Event_DoState);
 		DoLinkedList<BaseEvent, GetNewTsEvent, FreeTsEvent, Event_DoState>(p, tsFirst, &tsLast);
 	} else {
-		DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoStateOld>(p, first, (Event **) NULL);
+		DoEventQueue(p, &Event_DoStateOld);
 		DoLinkedList<BaseEvent, GetNewTsEvent, FreeTsEvent, Event_DoStateOld>(p, tsFirst, &tsLast);
 	}
+	tsOverflowed = tsFirst != nullptr ? 1 : 0;
+	hasTsEvents = tsOverflowed.load();
 
 	Do(p, CPU_HZ);
 	Do(p, slicelength);
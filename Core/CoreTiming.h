@@ -77,6 +77,9 @@ namespace CoreTiming
 
 	typedef void (*MHzChangeCallback)();
 	typedef void (*TimedCallback)(u64 userdata, int cyclesLate);
+	// Identifies one scheduled event, so it can be unscheduled without searching the queue.
+	// Goes stale once the event fires or is removed.  Not kept in save states.
+	typedef u64 EventHandle;
 
 	u64 GetTicks();
 	u64 GetIdleTicks();
@@ -91,16 +94,20 @@ namespace CoreTiming
 
 	// userdata MAY NOT CONTAIN POINTERS. userdata might get written and reloaded from disk,
 	// when we implement state saves.
-	void ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata=0);
+	EventHandle ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata=0);
 	void ScheduleEvent_Threadsafe(s64 cyclesIntoFuture, int event_type, u64 userdata=0);
 	void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata=0);
 	s64 UnscheduleEvent(int event_type, u64 userdata);
+	// Returns cycles left, or 0 if the handle is stale.
+	s64 UnscheduleEventByHandle(EventHandle handle);
+	// Only call this from the CPU thread, same goes for RemoveThreadsafeEvent.
 	s64 UnscheduleThreadsafeEvent(int event_type, u64 userdata);
 
 	void RemoveEvent(int event_type);
 	void RemoveThreadsafeEvent(int event_type);
 	void RemoveAllEvents(int event_type);
 	bool IsScheduled(int event_type);
+	bool IsHandleScheduled(EventHandle handle);
 	void Advance();
 	void MoveEvents();
 	void ProcessFifoWaitEvents();
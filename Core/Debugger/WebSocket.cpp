@@ -56,6 +56,7 @@
 #include "Core/Debugger/WebSocket/GPUBufferSubscriber.h"
 #include "Core/Debugger/WebSocket/GPURecordSubscriber.h"
 #include "Core/Debugger/WebSocket/GPUStatsSubscriber.h"
+#include "Core/Debugger/WebSocket/HLEProfilerSubscriber.h"
 #include "Core/Debugger/WebSocket/HLESubscriber.h"
 #include "Core/Debugger/WebSocket/InputSubscriber.h"
 #include "Core/Debugger/WebSocket/MemoryInfoSubscriber.h"
@@ -73,6 +74,7 @@ static const std::vector<SubscriberInit> subscribers({
 	&WebSocketGPURecordInit,
 	&WebSocketGPUStatsInit,
 	&WebSocketHLEInit,
+	&WebSocketHLEProfilerInit,
 	&WebSocketInputInit,
 	&WebSocketMemoryInfoInit,
 	&WebSocketMemoryInit,
@@ -0,0 +1,116 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "Core/Debugger/WebSocket/HLEProfilerSubscriber.h"
+#include "Core/Debugger/WebSocket/WebSocketUtils.h"
+#include "Core/HLE/HLEProfiler.h"
+
+struct WebSocketHLEProfilerState : public DebuggerSubscriber {
+	~WebSocketHLEProfilerState() override;
+	void Start(DebuggerRequest &req);
+	void Stop(DebuggerRequest &req);
+	void Reset(DebuggerRequest &req);
+	void Get(DebuggerRequest &req);
+
+protected:
+	// Whether this connection has the profiler enabled.
+	bool enabled_ = false;
+};
+
+DebuggerSubscriber *WebSocketHLEProfilerInit(DebuggerEventHandlerMap &map) {
+	auto p = new WebSocketHLEProfilerState();
+	map["hle.profile.start"] = std::bind(&WebSocketHLEProfilerState::Start, p, std::placeholders::_1);
+	map["hle.profile.stop"] = std::bind(&WebSocketHLEProfilerState::Stop, p, std::placeholders::_1);
+	map["hle.profile.reset"] = std::bind(&WebSocketHLEProfilerState::Reset, p, std::placeholders::_1);
+	map["hle.profile.get"] = std::bind(&WebSocketHLEProfilerState::Get, p, std::placeholders::_1);
+
+	return p;
+}
+
+WebSocketHLEProfilerState::~WebSocketHLEProfilerState() {
+	if (enabled_)
+		HLEProfiler_Enable(false);
+}
+
+// Start profiling HLE calls (hle.profile.start)
+//
+// Parameters:
+//  - reset: optional boolean, pass true to clear previously collected stats first.
+//
+// Response (same event name) with no extra data.
+//
+// Note: this also enables debug stats, which makes the jit slightly slower.
+void WebSocketHLEProfilerState::Start(DebuggerRequest &req) {
+	bool reset = false;
+	if (!req.ParamBool("reset", &reset, DebuggerParamType::OPTIONAL))
+		return;
+
+	if (reset)
+		HLEProfiler_Reset();
+	if (!enabled_) {
+		HLEProfiler_Enable(true);
+		enabled_ = true;
+	}
+	req.Respond();
+}
+
+// Stop profiling HLE calls (hle.profile.stop)
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.
+//
+// Note: collected stats are kept until reset, and other connections may still be profiling.
+void WebSocketHLEProfilerState::Stop(DebuggerRequest &req) {
+	if (enabled_) {
+		HLEProfiler_Enable(false);
+		enabled_ = false;
+	}
+	req.Respond();
+}
+
+// Clear collected HLE call stats (hle.profile.reset)
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.
+void WebSocketHLEProfilerState::Reset(DebuggerRequest &req) {
+	HLEProfiler_Reset();
+	req.Respond();
+}
+
+// Get collected HLE call stats (hle.profile.get)
+//
+// No parameters.
+//
+// Response (same event name):
+//  - enabled: boolean, whether the profiler is currently collecting.
+//  - functions: array of objects sorted by total time, most first, each with properties:
+//     - module: string module name, e.g. 'ThreadManForUser'.
+//     - name: string function name.
+//     - nid: unsigned integer function id.
+//     - calls: unsigned integer number of calls.
+//     - totalUs: number of microseconds of host time spent in all calls.
+//     - averageUs: number of microseconds per call.
+//     - maxUs: number of microseconds spent in the slowest call.
+//     - histogram: array of unsigned integer call counts.  Index i counts calls taking less than
+//       2^i nanoseconds, and at least 2^(i-1).  Trailing zeros are omitted.
+void WebSocketHLEProfilerState::Get(DebuggerRequest &req) {
+	JsonWriter &json = req.Respond();
+	json.writeBool("enabled", HLEProfiler_IsEnabled());
+	HLEProfiler_WriteJson(json, "functions");
+}
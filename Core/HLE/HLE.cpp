@@ -34,6 +34,7 @@
 #include "Core/System.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSCodeUtils.h"
+#include "Core/HLE/HLEProfiler.h"
 #include "Core/HLE/HLETables.h"
 #include "Core/HLE/sceIo.h"
 #include "Core/HLE/sceAudio.h"
@@ -694,11 +695,54 @@ void *GetQuickSyscallFunc(MIPSOpcode op) {
 	// TODO: Do this with a flag?
 	if (op == idleOp)
 		return (void *)info->func;
-	if (info->flags != 0)
+	if ((info->flags & ~HLE_JIT_MASK) != 0)
 		return (void *)&CallSyscallWithFlags;
 	return (void *)&CallSyscallWithoutFlags;
 }
 
+const HLEFunction *GetInlineSyscallFuncPointer(MIPSOpcode op) {
+	if (coreCollectDebugStats)
+		return nullptr;
+
+	const HLEFunction *info = GetSyscallFuncPointer(op);
+	if (!info || !info->func || (info->flags & HLE_JIT_MASK) != HLE_JIT_INLINE)
+		return nullptr;
+	DEBUG_LOG(HLE, "Compiling inline syscall to %s", info->name);
+	return info;
+}
+
+static u32 InlineSyscallExitPC(u32 nextPC, SceUID threadID) {
+	// Anything the dispatcher would need to handle means we have to leave the block after all.
+	if (currentMIPS->pc != nextPC || __KernelGetCurThread() != threadID)
+		return currentMIPS->pc;
+	if (coreState != CORE_RUNNING || currentMIPS->downcount < 0)
+		return currentMIPS->pc;
+	return 0;
+}
+
+u32 CallInlineSyscall(const HLEFunction *info) {
+	const u32 nextPC = currentMIPS->pc;
+	const SceUID threadID = __KernelGetCurThread();
+
+	if ((info->flags & ~HLE_JIT_MASK) != 0)
+		CallSyscallWithFlags(info);
+	else
+		CallSyscallWithoutFlags(info);
+
+	return InlineSyscallExitPC(nextPC, threadID);
+}
+
+u32 CallInlineSyscallOp(MIPSOpcode op) {
+	// Stats and the profiler are only recorded by CallSyscall, and may be turned on after compiling.
+	if (coreCollectDebugStats || HLEProfiler_IsEnabled()) {
+		const u32 nextPC = currentMIPS->pc;
+		const SceUID threadID = __KernelGetCurThread();
+		CallSyscall(op);
+		return InlineSyscallExitPC(nextPC, threadID);
+	}
+	return CallInlineSyscall(GetSyscallFuncPointer(op));
+}
+
 static double hleSteppingTime = 0.0;
 void hleSetSteppingTime(double t) {
 	hleSteppingTime += t;
@@ -726,7 +770,7 @@ void CallSyscall(MIPSOpcode op)
 	if (info->func) {
 		if (op == idleOp)
 			info->func();
-		else if (info->flags != 0)
+		else if ((info->flags & ~HLE_JIT_MASK) != 0)
 			CallSyscallWithFlags(info);
 		else
 			CallSyscallWithoutFlags(info);
@@ -746,6 +790,7 @@ void CallSyscall(MIPSOpcode op)
 		_dbg_assert_msg_(total >= 0.0, "Time spent in syscall became negative");
 		hleSteppingTime = 0.0;
 		hleFlipTime = 0.0;
+		HLEProfiler_Record(modulenum, funcnum, moduleDB[modulenum].name, info, total);
 		updateSyscallStats(modulenum, funcnum, total);
 	}
 }
@@ -31,7 +31,10 @@ typedef void (* HLEFunc)();
 
 enum {
 	// The low 8 bits are a value, indicating special jit handling.
-	// Currently there are none.
+	HLE_JIT_MASK = 0xFF,
+	// Quick calls that rarely reschedule.  The jit calls these directly and keeps running the
+	// block afterward, unless the call changed threads or an event is due.
+	HLE_JIT_INLINE = 0x01,
 
 	// The remaining 24 bits are flags.
 	// Don't allow the call within an interrupt.  Not yet implemented.
@@ -156,6 +159,13 @@ void HLEReturnFromMipsCall();
 const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op);
 // For jit, takes arg: const HLEFunction *
 void *GetQuickSyscallFunc(MIPSOpcode op);
+// For jit, returns nullptr unless the syscall can be made without ending the block (see HLE_JIT_INLINE.)
+// The pc must already point after the syscall, and the syscall must not be in a delay slot.
+const HLEFunction *GetInlineSyscallFuncPointer(MIPSOpcode op);
+// Returns 0 if the block can continue, or else the pc to exit to, like after a regular syscall.
+u32 CallInlineSyscall(const HLEFunction *info);
+// Same, but falls back to CallSyscall when collecting stats or profiling.
+u32 CallInlineSyscallOp(MIPSOpcode op);
 
 void hleDoLogInternal(LogTypes::LOG_TYPE t, LogTypes::LOG_LEVELS level, u64 res, const char *file, int line, const char *reportTag, char retmask, const char *reason, const char *formatted_reason);
 
@@ -0,0 +1,137 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "Common/Data/Format/JSONWriter.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Core/HLE/HLE.h"
+#include "Core/HLE/HLEProfiler.h"
+#include "Core/System.h"
+
+static std::atomic<int> enableCount;
+static std::mutex statsLock;
+// Indexed by module, then function, like syscall numbers.  Entries with no calls are unused.
+static std::vector<std::vector<HLEProfilerFuncStats>> funcStats;
+
+void HLEProfiler_Enable(bool enable) {
+	if (enable) {
+		enableCount++;
+	} else {
+		enableCount--;
+	}
+	_assert_(enableCount >= 0);
+	Core_ForceDebugStats(enable);
+}
+
+bool HLEProfiler_IsEnabled() {
+	return enableCount > 0;
+}
+
+void HLEProfiler_Reset() {
+	std::lock_guard<std::mutex> guard(statsLock);
+	funcStats.clear();
+}
+
+static int HistogramBucket(double seconds) {
+	u64 ns = seconds > 0.0 ? (u64)(seconds * 1000000000.0) : 0;
+	int bucket = 0;
+	while (ns != 0 && bucket < HLE_PROFILER_BUCKETS - 1) {
+		ns >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+void HLEProfiler_Record(int moduleIndex, int funcIndex, const char *module, const HLEFunction *func, double seconds) {
+	if (enableCount <= 0)
+		return;
+
+	std::lock_guard<std::mutex> guard(statsLock);
+	if ((int)funcStats.size() <= moduleIndex)
+		funcStats.resize(moduleIndex + 1);
+	std::vector<HLEProfilerFuncStats> &moduleStats = funcStats[moduleIndex];
+	if ((int)moduleStats.size() <= funcIndex)
+		moduleStats.resize(funcIndex + 1);
+
+	HLEProfilerFuncStats &stats = moduleStats[funcIndex];
+	if (stats.calls == 0) {
+		stats.module = module;
+		stats.name = func->name;
+		stats.nid = func->ID;
+	}
+	if (stats.calls != 0xFFFFFFFF)
+		stats.calls++;
+	stats.totalTime += seconds;
+	stats.maxTime = std::max(stats.maxTime, seconds);
+	stats.histogram[HistogramBucket(seconds)]++;
+}
+
+std::vector<HLEProfilerFuncStats> HLEProfiler_GetStats() {
+	std::vector<HLEProfilerFuncStats> result;
+	{
+		std::lock_guard<std::mutex> guard(statsLock);
+		for (const auto &moduleStats : funcStats) {
+			for (const HLEProfilerFuncStats &stats : moduleStats) {
+				if (stats.calls != 0)
+					result.push_back(stats);
+			}
+		}
+	}
+
+	std::sort(result.begin(), result.end(), [](const HLEProfilerFuncStats &a, const HLEProfilerFuncStats &b) {
+		return a.totalTime > b.totalTime;
+	});
+	return result;
+}
+
+void HLEProfiler_WriteJson(json::JsonWriter &json, const char *name) {
+	json.pushArray(name);
+	for (const HLEProfilerFuncStats &stats : HLEProfiler_GetStats()) {
+		json.pushDict();
+		json.writeString("module", stats.module);
+		json.writeString("name", stats.name ? stats.name : "");
+		json.writeUint("nid", stats.nid);
+		json.writeUint("calls", stats.calls);
+		json.writeFloat("totalUs", stats.totalTime * 1000000.0);
+		json.writeFloat("averageUs", stats.totalTime * 1000000.0 / stats.calls);
+		json.writeFloat("maxUs", stats.maxTime * 1000000.0);
+
+		// Trailing empty buckets are left out.
+		int used = HLE_PROFILER_BUCKETS;
+		while (used > 0 && stats.histogram[used - 1] == 0)
+			used--;
+		json.pushArray("histogram");
+		for (int i = 0; i < used; ++i)
+			json.writeUint(stats.histogram[i]);
+		json.pop();
+		json.pop();
+	}
+	json.pop();
+}
+
+bool HLEProfiler_DumpJson(const Path &filename) {
+	json::JsonWriter json(json::JsonWriter::PRETTY);
+	json.begin();
+	HLEProfiler_WriteJson(json, "functions");
+	json.end();
+	return File::WriteStringToFile(true, json.str(), filename);
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <vector>
+#include "Common/CommonTypes.h"
+
+class Path;
+struct HLEFunction;
+namespace json {
+class JsonWriter;
+}
+
+// Counts calls and host time per HLE function, to find which sce* calls take up the most time in
+// a game.  Always compiled in, but only records while enabled.  Since the timing happens in
+// CallSyscall, enabling it also forces debug stats on so the jit doesn't call functions directly.
+//
+// Unlike the per frame kernelStats, this keeps adding up until reset, even across games.
+
+// Bucket i counts calls that took less than 2^i ns (and at least 2^(i-1).)  The last one is open.
+static const int HLE_PROFILER_BUCKETS = 32;
+
+struct HLEProfilerFuncStats {
+	const char *module;
+	const char *name;
+	u32 nid;
+	u32 calls;
+	double totalTime;
+	double maxTime;
+	u32 histogram[HLE_PROFILER_BUCKETS];
+};
+
+// Calls nest, like Core_ForceDebugStats.
+void HLEProfiler_Enable(bool enable);
+bool HLEProfiler_IsEnabled();
+void HLEProfiler_Reset();
+
+// Called by CallSyscall, with the time in seconds.
+void HLEProfiler_Record(int moduleIndex, int funcIndex, const char *module, const HLEFunction *func, double seconds);
+
+// Returns the functions called so far, most total time first.  Safe from any thread.
+std::vector<HLEProfilerFuncStats> HLEProfiler_GetStats();
+// Writes an array of functions, with times in microseconds.
+void HLEProfiler_WriteJson(json::JsonWriter &json, const char *name);
+bool HLEProfiler_DumpJson(const Path &filename);
@@ -22,6 +22,8 @@
 #include <algorithm>
 
 #include "Common/CommonTypes.h"
+#include "Core/CoreTiming.h"
+#include "Core/MemMap.h"
 #include "Core/HLE/sceKernelThread.h"
 
 namespace HLEKernel
@@ -310,4 +312,20 @@ inline void RemoveWaitingThread(std::vector<T> &waitingThreads, const SceUID thr
 	waitingThreads.erase(std::remove(waitingThreads.begin(), waitingThreads.end(), threadID), waitingThreads.end());
 }
 
+// Calls tryUnlock once for each waiting thread, in order, and removes those it returns true for.
+// Erasing as we go would move the rest of the list for each thread woken, so this compacts
+// the list in a single pass instead.  The order of the remaining threads is kept.
+template <typename T, class TryUnlockFunc>
+inline void RemoveWaitingThreadsIf(std::vector<T> &waitingThreads, TryUnlockFunc tryUnlock) {
+	size_t kept = 0;
+	for (size_t i = 0; i < waitingThreads.size(); ++i) {
+		if (tryUnlock(waitingThreads[i]))
+			continue;
+		if (kept != i)
+			waitingThreads[kept] = waitingThreads[i];
+		++kept;
+	}
+	waitingThreads.resize(kept);
+}
+
 };
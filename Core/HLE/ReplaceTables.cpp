@@ -17,11 +17,18 @@
 
 #include "ppsspp_config.h"
 #include <algorithm>
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <unordered_map>
 
+#include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
+#include "Common/Data/Format/JSONWriter.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Common/StringUtils.h"
 #include "Common/Log.h"
 #include "Common/Swap.h"
 #include "Core/Config.h"
@@ -435,6 +442,118 @@ static int Replace_strncmp() {
 	return 10 + bytes / 4;  // approximation
 }
 
+// Returns the offset of the first byte that differs, or bytes if they're all the same.
+static u32 FindFirstDifference(const u8 *a, const u8 *b, u32 bytes) {
+	u32 i = 0;
+#if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+	for (; i + 16 <= bytes; i += 16) {
+		__m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+		__m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+		u32 same = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+		if (same != 0xFFFF)
+			return i + LeastSignificantSetBit(~same);
+	}
+#else
+	for (; i + 8 <= bytes; i += 8) {
+		u64 va, vb;
+		memcpy(&va, a + i, 8);
+		memcpy(&vb, b + i, 8);
+		if (va != vb)
+			break;
+	}
+#endif
+	for (; i < bytes; ++i) {
+		if (a[i] != b[i])
+			return i;
+	}
+	return bytes;
+}
+
+// Like strlen, but won't run off the end of valid memory.
+static u32 BoundedStrlen(u32 ptr, u32 maxLen) {
+	u32 bytes = Memory::ValidSize(ptr, maxLen);
+	const char *src = (const char *)Memory::GetPointer(ptr);
+	if (!src || bytes == 0)
+		return 0;
+	const char *end = (const char *)memchr(src, 0, bytes);
+	return end ? (u32)(end - src) : bytes;
+}
+
+// Like newlib, returns the difference of the first mismatched bytes, not just the sign.
+static int Replace_memcmp() {
+	u32 aPtr = PARAM(0);
+	u32 bPtr = PARAM(1);
+	u32 bytes = PARAM(2);
+	bytes = std::min(Memory::ValidSize(aPtr, bytes), Memory::ValidSize(bPtr, bytes));
+	const u8 *a = Memory::GetPointer(aPtr);
+	const u8 *b = Memory::GetPointer(bPtr);
+	u32 offset = bytes;
+	if (a && b && bytes != 0) {
+		offset = FindFirstDifference(a, b, bytes);
+	}
+	if (offset < bytes) {
+		RETURN((int)a[offset] - (int)b[offset]);
+	} else {
+		RETURN(0);
+	}
+	return 10 + offset / 4;  // approximation
+}
+
+static int Replace_memchr() {
+	u32 srcPtr = PARAM(0);
+	u8 value = PARAM(1);
+	u32 bytes = Memory::ValidSize(srcPtr, PARAM(2));
+	const u8 *src = Memory::GetPointer(srcPtr);
+	const u8 *found = src && bytes != 0 ? (const u8 *)memchr(src, value, bytes) : nullptr;
+	if (found) {
+		RETURN(srcPtr + (u32)(found - src));
+		return 10 + (u32)(found - src) / 4;  // approximation
+	}
+	RETURN(0);
+	return 10 + bytes / 4;  // approximation
+}
+
+static int Replace_strchr() {
+	u32 srcPtr = PARAM(0);
+	char value = (char)PARAM(1);
+	u32 len = BoundedStrlen(srcPtr, 0xFFFFFFFF);
+	const char *src = (const char *)Memory::GetPointer(srcPtr);
+	if (value == 0) {
+		// The terminator counts as part of the string.
+		RETURN(src ? srcPtr + len : 0);
+	} else {
+		const char *found = src && len != 0 ? (const char *)memchr(src, value, len) : nullptr;
+		RETURN(found ? srcPtr + (u32)(found - src) : 0);
+	}
+	return 10 + len / 4;  // approximation
+}
+
+static int Replace_strrchr() {
+	u32 srcPtr = PARAM(0);
+	char value = (char)PARAM(1);
+	u32 len = BoundedStrlen(srcPtr, 0xFFFFFFFF);
+	const char *src = (const char *)Memory::GetPointer(srcPtr);
+	u32 result = 0;
+	if (src && value == 0) {
+		result = srcPtr + len;
+	} else if (src) {
+		for (u32 i = len; i > 0; --i) {
+			if (src[i - 1] == value) {
+				result = srcPtr + i - 1;
+				break;
+			}
+		}
+	}
+	RETURN(result);
+	return 10 + len / 2;  // approximation
+}
+
+static int Replace_strnlen() {
+	u32 len = BoundedStrlen(PARAM(0), PARAM(1));
+	RETURN(len);
+	return 7 + len * 4;  // approximation
+}
+
 static int Replace_fabsf() {
 	RETURNF(fabsf(PARAMF(0)));
 	return 4;
@@ -1370,6 +1489,36 @@ static int Hook_ZZT3_select_hack() {
 	return 0;
 }
 
+struct UnreplacedFuncKey {
+	u64 hash;
+	u32 size;
+	bool operator <(const UnreplacedFuncKey &other) const {
+		return hash < other.hash || (hash == other.hash && size < other.size);
+	}
+};
+
+static std::atomic<bool> unreplacedProfilerEnabled;
+static std::mutex unreplacedProfilerLock;
+// Kept by hash, so the same function adds up across games, modules, and reloads.
+static std::map<UnreplacedFuncKey, u32> unreplacedCalls;
+static std::unordered_map<u32, UnreplacedFuncKey> unreplacedHookAddresses;
+
+// Installed at the entry of hashed functions without a replacement.  Since it's a hook, this
+// also counts a loop that jumps back to the first instruction.
+static int Hook_unreplaced_profile() {
+	if (!unreplacedProfilerEnabled)
+		return 0;
+
+	std::lock_guard<std::mutex> guard(unreplacedProfilerLock);
+	auto it = unreplacedHookAddresses.find(currentMIPS->pc);
+	if (it != unreplacedHookAddresses.end()) {
+		u32 &calls = unreplacedCalls[it->second];
+		if (calls != 0xFFFFFFFF)
+			calls++;
+	}
+	return 0;
+}
+
 #define JITFUNC(f) (&MIPSComp::MIPSFrontendInterface::f)
 
 // Can either replace with C functions or functions emitted in Asm/ArmAsm.
@@ -1399,11 +1548,17 @@ static const ReplacementTableEntry entries[] = {
 	{ "memmove", &Replace_memmove, 0, 0 },
 	{ "memset", &Replace_memset, 0, 0 },
 	{ "memset_jak", &Replace_memset_jak, 0, 0 },
+	{ "memcmp", &Replace_memcmp, 0, 0 },
+	{ "bcmp", &Replace_memcmp, 0, 0 },
+	{ "memchr", &Replace_memchr, 0, 0 },
 	{ "strlen", &Replace_strlen, 0, REPFLAG_DISABLED },
 	{ "strcpy", &Replace_strcpy, 0, REPFLAG_DISABLED },
 	{ "strncpy", &Replace_strncpy, 0, REPFLAG_DISABLED },
 	{ "strcmp", &Replace_strcmp, 0, REPFLAG_DISABLED },
 	{ "strncmp", &Replace_strncmp, 0, REPFLAG_DISABLED },
+	{ "strchr", &Replace_strchr, 0, REPFLAG_DISABLED },
+	{ "strrchr", &Replace_strrchr, 0, REPFLAG_DISABLED },
+	{ "strnlen", &Replace_strnlen, 0, REPFLAG_DISABLED },
 	{ "fabsf", &Replace_fabsf, JITFUNC(Replace_fabsf), REPFLAG_ALLOWINLINE | REPFLAG_DISABLED },
 	{ "dl_write_matrix", &Replace_dl_write_matrix, 0, REPFLAG_DISABLED }, // &MIPSComp::Jit::Replace_dl_write_matrix, REPFLAG_DISABLED },
 	{ "dl_write_matrix_2", &Replace_dl_write_matrix, 0, REPFLAG_DISABLED },
@@ -1489,6 +1644,8 @@ static const ReplacementTableEntry entries[] = {
 	{ "gow_fps_hack", &Hook_gow_fps_hack, 0, REPFLAG_HOOKEXIT , 0 },
 	{ "gow_vortex_hack", &Hook_gow_vortex_hack, 0, REPFLAG_HOOKENTER, 0x60 },
 	{ "ZZT3_select_hack", &Hook_ZZT3_select_hack, 0, REPFLAG_HOOKENTER, 0xC4 },
+	// Not a real function name, written by ProfileUnreplacedFunction() instead.
+	{ "__unreplaced_profile", &Hook_unreplaced_profile, 0, REPFLAG_HOOKENTER, 0 },
 	{}
 };
 
@@ -1683,3 +1840,78 @@ bool CanReplaceJalTo(u32 dest, const ReplacementTableEntry **entry, u32 *funcSiz
 	}
 	return true;
 }
+
+void ProfileUnreplacedFunction(u32 address, u64 hash, int size) {
+	if (!unreplacedProfilerEnabled || !GetReplacementFuncIndexes(hash, size).empty())
+		return;
+
+	static int hookIndex = -1;
+	if (hookIndex == -1) {
+		for (int i = 0; i < (int)ARRAY_SIZE(entries); i++) {
+			if (entries[i].replaceFunc == &Hook_unreplaced_profile)
+				hookIndex = i;
+		}
+	}
+
+	// Some other hook might already be here (like a disabled replacement being debugged.)
+	const u32 prevInstr = Memory::Read_Instruction(address, false).encoding;
+	if (MIPS_IS_REPLACEMENT(prevInstr) && (int)(prevInstr & MIPS_EMUHACK_VALUE_MASK) != hookIndex)
+		return;
+
+	{
+		std::lock_guard<std::mutex> guard(unreplacedProfilerLock);
+		UnreplacedFuncKey key{ hash, (u32)size };
+		unreplacedHookAddresses[address] = key;
+		// Show up in the report even if never called.
+		unreplacedCalls.emplace(key, 0);
+	}
+	WriteReplaceInstruction(address, hookIndex);
+}
+
+void ReplacementProfiler_Enable(bool enable) {
+	unreplacedProfilerEnabled = enable;
+}
+
+bool ReplacementProfiler_IsEnabled() {
+	return unreplacedProfilerEnabled;
+}
+
+void ReplacementProfiler_Reset() {
+	std::lock_guard<std::mutex> guard(unreplacedProfilerLock);
+	for (auto &it : unreplacedCalls)
+		it.second = 0;
+}
+
+std::vector<UnreplacedFuncStats> ReplacementProfiler_GetStats() {
+	std::vector<UnreplacedFuncStats> result;
+	{
+		std::lock_guard<std::mutex> guard(unreplacedProfilerLock);
+		for (const auto &it : unreplacedCalls) {
+			result.push_back({ it.first.hash, it.first.size, it.second });
+		}
+	}
+
+	std::stable_sort(result.begin(), result.end(), [](const UnreplacedFuncStats &a, const UnreplacedFuncStats &b) {
+		return a.calls > b.calls;
+	});
+	return result;
+}
+
+bool ReplacementProfiler_DumpJson(const Path &filename) {
+	json::JsonWriter json(json::JsonWriter::PRETTY);
+	json.begin();
+	json.pushArray("functions");
+	for (const UnreplacedFuncStats &stats : ReplacementProfiler_GetStats()) {
+		const char *name = MIPSAnalyst::LookupHash(stats.hash, stats.size);
+		json.pushDict();
+		// Same format as knownfuncs.ini, to make it easy to add entries.
+		json.writeString("hash", StringFromFormat("%016llx", (unsigned long long)stats.hash));
+		json.writeUint("size", stats.size);
+		json.writeString("name", name ? name : "");
+		json.writeUint("calls", stats.calls);
+		json.pop();
+	}
+	json.pop();
+	json.end();
+	return File::WriteStringToFile(true, json.str(), filename);
+}
@@ -34,10 +34,13 @@
 #pragma once
 
 #include <map>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 
+class Path;
+
 typedef int (* ReplaceFunc)();
 
 enum {
@@ -75,3 +78,24 @@ bool CanReplaceJalTo(u32 dest, const ReplacementTableEntry **entry, u32 *funcSiz
 // For savestates.  If you call SaveAndClearReplacements(), you must call RestoreSavedReplacements().
 std::map<u32, u32> SaveAndClearReplacements();
 void RestoreSavedReplacements(const std::map<u32, u32> &saved);
+
+// Counts calls to hashed functions that have no enabled replacement, to find which are worth
+// adding next.  The counting hooks are written along with replacements, so enable this before
+// a game's functions are scanned.  Counts add up by hash until reset, even across games.
+struct UnreplacedFuncStats {
+	u64 hash;
+	u32 size;
+	u32 calls;
+};
+
+void ReplacementProfiler_Enable(bool enable);
+bool ReplacementProfiler_IsEnabled();
+void ReplacementProfiler_Reset();
+
+// Called for each hashed function after WriteReplaceInstructions(), does nothing unless enabled.
+void ProfileUnreplacedFunction(u32 address, u64 hash, int size);
+
+// Returns functions seen so far, most calls first.  Safe from any thread.
+std::vector<UnreplacedFuncStats> ReplacementProfiler_GetStats();
+// Names come from the hash map, and are empty for functions it doesn't know.
+bool ReplacementProfiler_DumpJson(const Path &filename);
@@ -556,6 +556,8 @@ struct KernelStats {
 		summedMsInSyscalls.clear();
 		summedSlowestSyscallTime = 0;
 		summedSlowestSyscallName = 0;
+		reschedules = 0;
+		threadSwitches = 0;
 	}
 
 	double msInSyscalls;
@@ -564,6 +566,9 @@ struct KernelStats {
 	std::map<KernelStatsSyscall, double> summedMsInSyscalls;
 	double summedSlowestSyscallTime;
 	const char *summedSlowestSyscallName;
+	// Thread reschedules (outside interrupts), and how many of them switched threads.
+	u32 reschedules;
+	u32 threadSwitches;
 };
 
 extern KernelStats kernelStats;
@@ -296,14 +296,9 @@ u32 sceKernelSetEventFlag(SceUID id, u32 bitsToSet) {
 
 		e->nef.currentPattern |= bitsToSet;
 
-		for (size_t i = 0; i < e->waitingThreads.size(); ++i) {
-			EventFlagTh *t = &e->waitingThreads[i];
-			if (__KernelUnlockEventFlagForThread(e, *t, error, 0, wokeThreads)) {
-				e->waitingThreads.erase(e->waitingThreads.begin() + i);
-				// Try the one that used to be in this place next.
-				--i;
-			}
-		}
+		HLEKernel::RemoveWaitingThreadsIf(e->waitingThreads, [&](EventFlagTh &t) {
+			return __KernelUnlockEventFlagForThread(e, t, error, 0, wokeThreads);
+		});
 
 		if (wokeThreads)
 			hleReSchedule("event flag set");
@@ -26,6 +26,7 @@
 #include "Common/Serialize/SerializeSet.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/HLE/HLE.h"
@@ -560,6 +561,7 @@ void __KernelModuleDoState(PointerWrap &p)
 	}
 
 	if (g_Config.bFuncReplacements) {
+		MIPSAnalyst::FinishBackgroundScans(true);
 		MIPSAnalyst::ReplaceFunctions();
 	}
 }
@@ -1391,6 +1393,8 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 
 		// If the ELF has debug symbols, don't add entries to the symbol table.
 		bool insertSymbols = scan && !reader.LoadSymbols();
+		// Inclusive ranges, scanned after the loop so they can be handed off together.
+		std::vector<std::pair<u32, u32>> scanRanges;
 		std::vector<SectionID> codeSections = reader.GetCodeSections();
 		for (SectionID id : codeSections) {
 			u32 start = reader.GetSectionAddr(id);
@@ -1408,7 +1412,7 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 				module->textEnd = end;
 
 			if (scan) {
-				insertSymbols = MIPSAnalyst::ScanForFunctions(start, end, insertSymbols);
+				scanRanges.push_back(std::make_pair(start, end));
 			}
 		}
 
@@ -1420,20 +1424,27 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 			if (Memory::IsValidRange(scanStart, scanEnd - scanStart)) {
 				// Skip the exports and imports sections, they're not code.
 				if (scanEnd >= std::min(modinfo->libent, modinfo->libstub)) {
-					insertSymbols = MIPSAnalyst::ScanForFunctions(scanStart, std::min(modinfo->libent, modinfo->libstub) - 4, insertSymbols);
+					scanRanges.push_back(std::make_pair(scanStart, std::min(modinfo->libent, modinfo->libstub) - 4));
 					scanStart = std::min(modinfo->libentend, modinfo->libstubend);
 				}
 				if (scanEnd >= std::max(modinfo->libent, modinfo->libstub)) {
-					insertSymbols = MIPSAnalyst::ScanForFunctions(scanStart, std::max(modinfo->libent, modinfo->libstub) - 4, insertSymbols);
+					scanRanges.push_back(std::make_pair(scanStart, std::max(modinfo->libent, modinfo->libstub) - 4));
 					scanStart = std::max(modinfo->libentend, modinfo->libstubend);
 				}
-				insertSymbols = MIPSAnalyst::ScanForFunctions(scanStart, scanEnd, insertSymbols);
+				scanRanges.push_back(std::make_pair(scanStart, scanEnd));
 			} else {
 				ERROR_LOG(LOADER, "Bad text scan range %08x-%08x", scanStart, scanEnd);
 			}
 		}
 
-		if (scan) {
+		if (scan && g_Config.bFuncScanInBackground) {
+			MIPSAnalyst::ScanForFunctionsInBackground(scanRanges, insertSymbols);
+		} else if (scan) {
+			double st = time_now_d();
+			for (const auto &range : scanRanges) {
+				insertSymbols = MIPSAnalyst::ScanForFunctions(range.first, range.second, insertSymbols);
+			}
+			INFO_LOG(LOADER, "Scanned %d ranges for functions in %0.2f ms", (int)scanRanges.size(), (time_now_d() - st) * 1000.0);
 			MIPSAnalyst::FinalizeScan(insertSymbols);
 		}
 	}
@@ -304,15 +304,10 @@ int sceKernelSignalSema(SceUID id, int signal)
 			std::stable_sort(s->waitingThreads.begin(), s->waitingThreads.end(), __KernelThreadSortPriority);
 
 		bool wokeThreads = false;
-retry:
-		for (auto iter = s->waitingThreads.begin(), end = s->waitingThreads.end(); iter != end; ++iter)
-		{
-			if (__KernelUnlockSemaForThread(s, *iter, error, 0, wokeThreads))
-			{
-				s->waitingThreads.erase(iter);
-				goto retry;
-			}
-		}
+		// The count only goes down while waking, so threads that couldn't unlock still can't.
+		HLEKernel::RemoveWaitingThreadsIf(s->waitingThreads, [&](SceUID threadID) {
+			return __KernelUnlockSemaForThread(s, threadID, error, 0, wokeThreads);
+		});
 
 		if (wokeThreads)
 			hleReSchedule("semaphore signaled");
@@ -339,12 +334,11 @@ void __KernelSemaTimeout(u64 userdata, int cycleslate)
 	PSPSemaphore *s = kernelObjects.Get<PSPSemaphore>(uid, error);
 	if (s && (s->ns.attr & PSP_SEMA_ATTR_PRIORITY) == PSP_SEMA_ATTR_FIFO) {
 		bool wokeThreads;
-		std::vector<SceUID>::iterator iter = s->waitingThreads.begin();
+		size_t woken = 0;
 		// Unlock every waiting thread until the first that must still wait.
-		while (iter != s->waitingThreads.end() && __KernelUnlockSemaForThread(s, *iter, error, 0, wokeThreads)) {
-			s->waitingThreads.erase(iter);
-			iter = s->waitingThreads.begin();
-		}
+		while (woken < s->waitingThreads.size() && __KernelUnlockSemaForThread(s, s->waitingThreads[woken], error, 0, wokeThreads))
+			++woken;
+		s->waitingThreads.erase(s->waitingThreads.begin(), s->waitingThreads.begin() + woken);
 	}
 }
 
@@ -1728,6 +1728,7 @@ static PSPThread *__KernelNextThread() {
 	// If the current thread is running, it's a valid candidate.
 	PSPThread *cur = __GetCurrentThread();
 	if (cur && cur->isRunning()) {
+		// This is the common case, and only checks the ready queue's bitmap when nothing changes.
 		bestThread = threadReadyQueue.pop_first_better(cur->nt.currentPriority);
 		if (bestThread != 0)
 			__KernelChangeReadyState(cur, currentThread, true);
@@ -1764,8 +1765,10 @@ void __KernelReSchedule(const char *reason)
 		return;
 	}
 
+	kernelStats.reschedules++;
 	PSPThread *nextThread = __KernelNextThread();
 	if (nextThread) {
+		kernelStats.threadSwitches++;
 		__KernelSwitchContext(nextThread, reason);
 	}
 	// Otherwise, no need to switch.
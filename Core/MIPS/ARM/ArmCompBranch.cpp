@@ -688,6 +688,26 @@ void ArmJit::Comp_Syscall(MIPSOpcode op)
 	gpr.SetRegImm(R0, op.encoding);
 	QuickCallFunction(R1, (void *)&CallSyscall);
 #else
+	// Quick calls don't need to end the block, unless they changed threads or similar.
+	const HLEFunction *inlineInfo = js.inDelaySlot ? nullptr : GetInlineSyscallFuncPointer(op);
+	if (inlineInfo)
+	{
+		gpr.SetRegImm(R0, (u32)(intptr_t)inlineInfo);
+		QuickCallFunction(R1, (const void *)&CallInlineSyscall);
+
+		// If 0, we can keep going.
+		CMPI2R(R0, 0, SCRATCHREG2);
+		FixupBranch skip = B_CC(CC_EQ);
+		ApplyRoundingMode();
+		RestoreDowncount();
+		WriteSyscallExit();
+		SetJumpTarget(skip);
+
+		ApplyRoundingMode();
+		RestoreDowncount();
+		return;
+	}
+
 	// Skip the CallSyscall where possible.
 	void *quickFunc = GetQuickSyscallFunc(op);
 	if (quickFunc)
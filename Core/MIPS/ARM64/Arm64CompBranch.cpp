@@ -704,6 +704,24 @@ void Arm64Jit::Comp_Syscall(MIPSOpcode op)
 	MOVI2R(W0, op.encoding);
 	QuickCallFunction(X1, (void *)&CallSyscall);
 #else
+	// Quick calls don't need to end the block, unless they changed threads or similar.
+	const HLEFunction *inlineInfo = js.inDelaySlot ? nullptr : GetInlineSyscallFuncPointer(op);
+	if (inlineInfo) {
+		MOVI2R(X0, (uintptr_t)inlineInfo);
+		QuickCallFunction(X1, (const void *)&CallInlineSyscall);
+
+		// If 0, we can keep going.
+		FixupBranch skip = CBZ(W0);
+		LoadStaticRegisters();
+		ApplyRoundingMode();
+		WriteSyscallExit();
+		SetJumpTarget(skip);
+
+		LoadStaticRegisters();
+		ApplyRoundingMode();
+		return;
+	}
+
 	// Skip the CallSyscall where possible.
 	void *quickFunc = GetQuickSyscallFunc(op);
 	if (quickFunc) {
@@ -54,6 +54,30 @@ using namespace MIPSAnalyst;
 namespace MIPSComp
 {
 
+// Writes the exit for when the branch isn't taken, or when forming a trace that usually goes that
+// way, the exit for when it's taken instead.  Returns true if compilation continues not taken.
+bool IRFrontend::WriteNotTakenExit(const BranchInfo &branchInfo, IRComparison cc, u32 targetAddr, u8 lhs, u8 rhs) {
+	u32 notTakenAddr = ResolveNotTakenTarget(branchInfo);
+	// Likely branches only run the delay slot when taken, so those can't be flipped.
+	bool canFlip = !branchInfo.likely && !branchInfo.delaySlotIsBranch;
+	if (canFlip && PredictBranch() == IRBranchHint::NOT_TAKEN && CanContinueBranch(notTakenAddr)) {
+		ir.Write(ComparisonToExit(Invert(cc)), ir.AddConstant(targetAddr), lhs, rhs);
+		AddContinuedBlock(notTakenAddr);
+		return true;
+	}
+
+	ir.Write(ComparisonToExit(cc), ir.AddConstant(notTakenAddr), lhs, rhs);
+	return false;
+}
+
+// When forming a trace that usually takes this branch, continues at the target.
+bool IRFrontend::ContinueTaken(const BranchInfo &branchInfo, u32 targetAddr) {
+	if (branchInfo.delaySlotIsBranch || PredictBranch() != IRBranchHint::TAKEN || !CanContinueBranch(targetAddr))
+		return false;
+	AddContinuedBlock(targetAddr);
+	return true;
+}
+
 void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	if (js.inDelaySlot) {
 		ERROR_LOG_REPORT(JIT, "Branch in RSRTComp delay slot at %08x in block starting at %08x", GetCompilerPC(), js.blockStart);
@@ -100,7 +124,8 @@ void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	js.downcountAmount = 0;
 
 	FlushAll();
-	ir.Write(ComparisonToExit(cc), ir.AddConstant(ResolveNotTakenTarget(branchInfo)), lhs, rhs);
+	if (WriteNotTakenExit(branchInfo, cc, targetAddr, lhs, rhs))
+		return;
 	// This makes the block "impure" :(
 	if (likely && !branchInfo.delaySlotIsBranch)
 		CompileDelaySlot();
@@ -114,6 +139,8 @@ void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	}
 
 	FlushAll();
+	if (ContinueTaken(branchInfo, targetAddr))
+		return;
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -151,7 +178,8 @@ void IRFrontend::BranchRSZeroComp(MIPSOpcode op, IRComparison cc, bool andLink,
 	js.downcountAmount = 0;
 
 	FlushAll();
-	ir.Write(ComparisonToExit(cc), ir.AddConstant(ResolveNotTakenTarget(branchInfo)), lhs);
+	if (WriteNotTakenExit(branchInfo, cc, targetAddr, lhs, 0))
+		return;
 	if (likely && !branchInfo.delaySlotIsBranch)
 		CompileDelaySlot();
 	if (branchInfo.delaySlotIsBranch) {
@@ -165,6 +193,8 @@ void IRFrontend::BranchRSZeroComp(MIPSOpcode op, IRComparison cc, bool andLink,
 
 	// Taken
 	FlushAll();
+	if (ContinueTaken(branchInfo, targetAddr))
+		return;
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -230,7 +260,8 @@ void IRFrontend::BranchFPFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 
 	FlushAll();
 	// Not taken
-	ir.Write(ComparisonToExit(cc), ir.AddConstant(ResolveNotTakenTarget(branchInfo)), IRTEMP_LHS, 0);
+	if (WriteNotTakenExit(branchInfo, cc, targetAddr, IRTEMP_LHS, 0))
+		return;
 	// Taken
 	if (likely && !branchInfo.delaySlotIsBranch)
 		CompileDelaySlot();
@@ -244,6 +275,8 @@ void IRFrontend::BranchFPFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 	}
 
 	FlushAll();
+	if (ContinueTaken(branchInfo, targetAddr))
+		return;
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -291,7 +324,8 @@ void IRFrontend::BranchVFPUFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 
 	ir.Write(IROp::AndConst, IRTEMP_LHS, IRTEMP_LHS, ir.AddConstant(1 << imm3));
 	FlushAll();
-	ir.Write(ComparisonToExit(cc), ir.AddConstant(ResolveNotTakenTarget(branchInfo)), IRTEMP_LHS, 0);
+	if (WriteNotTakenExit(branchInfo, cc, targetAddr, IRTEMP_LHS, 0))
+		return;
 
 	if (likely && !branchInfo.delaySlotIsBranch)
 		CompileDelaySlot();
@@ -306,6 +340,8 @@ void IRFrontend::BranchVFPUFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 
 	// Taken
 	FlushAll();
+	if (ContinueTaken(branchInfo, targetAddr))
+		return;
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -362,6 +398,10 @@ void IRFrontend::Comp_Jump(MIPSOpcode op) {
 	js.downcountAmount = 0;
 
 	FlushAll();
+	if (CanContinueBranch(targetAddr)) {
+		AddContinuedBlock(targetAddr);
+		return;
+	}
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -447,6 +487,13 @@ void IRFrontend::Comp_Syscall(MIPSOpcode op) {
 	FlushAll();
 
 	RestoreRoundingMode();
+	// Quick calls don't need to end the block, unless they changed threads or similar.
+	if (!js.inDelaySlot && GetInlineSyscallFuncPointer(op)) {
+		ir.Write(IROp::SyscallInline, 0, ir.AddConstant(op.encoding));
+		ApplyRoundingMode();
+		return;
+	}
+
 	ir.Write(IROp::Syscall, 0, ir.AddConstant(op.encoding));
 	ApplyRoundingMode();
 	ir.Write(IROp::ExitToPC);
@@ -1316,9 +1316,19 @@ namespace MIPSComp {
 				}
 				return;
 			} else {
-				// ABc - s consecutive, t not.
-				// Tekken uses this.
-				// logBlocks = 1;
+				// METHOD 3: ABc - s consecutive, t not.  Tekken uses this.
+				// Gather each column of t, so we can still use dots.  Same order of adds as below.
+				int t0 = IRVTEMP_PFX_T;
+				for (int j = 0; j < 4; j++) {
+					for (int i = 0; i < 4; i++) {
+						ir.Write(IROp::FMov, t0 + i, tregs[j * 4 + i]);
+					}
+					for (int i = 0; i < 4; i++) {
+						ir.Write(IROp::Vec4Dot, s0 + i, sregs[i * 4], t0);
+					}
+					ir.Write(IROp::Vec4Mov, dregs[j * 4], s0);
+				}
+				return;
 			}
 		}
 
@@ -1394,19 +1404,21 @@ namespace MIPSComp {
 			}
 			return;
 		} else if (msz == M_4x4 && IsConsecutive4(sregs)) {
-			// Consecutive, which is harder.
-			DISABLE;
+			// Consecutive, so each row is a dot with t.  Homogenous treats t[3] as 1, which is exact.
 			int s0 = IRVTEMP_0;
-			int s1 = IRVTEMP_PFX_S;
-			// Doesn't make complete sense to me why this works.... (because it doesn't.)
-			ir.Write(IROp::Vec4Scale, s0, sregs[0], tregs[0]);
-			for (int i = 1; i < 4; i++) {
-				if (!homogenous || (i != n - 1)) {
-					ir.Write(IROp::Vec4Scale, s1, sregs[i], tregs[i]);
-					ir.Write(IROp::Vec4Add, s0, s0, s1);
-				} else {
-					ir.Write(IROp::Vec4Add, s0, s0, sregs[i]);
+			int t0 = tregs[0];
+			if (homogenous || !IsConsecutive4(tregs)) {
+				t0 = IRVTEMP_PFX_T;
+				for (int i = 0; i < 3; i++) {
+					ir.Write(IROp::FMov, t0 + i, tregs[i]);
 				}
+				if (homogenous)
+					ir.Write(IROp::SetConstF, t0 + 3, ir.AddConstantFloat(1.0f));
+				else
+					ir.Write(IROp::FMov, t0 + 3, tregs[3]);
+			}
+			for (int i = 0; i < 4; i++) {
+				ir.Write(IROp::Vec4Dot, s0 + i, sregs[i * 4], t0);
 			}
 			if (IsConsecutive4(dregs)) {
 				ir.Write(IROp::Vec4Mov, dregs[0], s0);
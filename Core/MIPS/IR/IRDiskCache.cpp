@@ -0,0 +1,173 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Common/File/FileUtil.h"
+#include "Common/Log.h"
+#include "Common/TimeUtil.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/IR/IRDiskCache.h"
+#include "Core/MIPS/IR/IRJit.h"
+
+#define CACHE_HEADER_MAGIC 0x43425249
+// Bump this whenever IROp values, the meaning of their operands, or the state key change.
+#define CACHE_VERSION 3
+
+struct IRDiskCacheHeader {
+	u32 magic;
+	u32 version;
+	u32 instSize;
+	u32 numEntries;
+};
+
+struct IRDiskCacheEntryHeader {
+	u32 addr;
+	u32 mipsBytes;
+	u64 hash;
+	u64 stateKey;
+	u32 numInstructions;
+	u32 reserved;
+};
+
+// Same limit as IRBlock, which stores the count in a u16.
+static const u32 MAX_CACHED_INSTRUCTIONS = 0xFFFF;
+
+void IRDiskCache::Load(const Path &filename) {
+	File::IOFile f(filename, "rb");
+	if (!f.IsOpen())
+		return;
+
+	IRDiskCacheHeader header;
+	if (!f.ReadArray(&header, 1))
+		return;
+	if (header.magic != CACHE_HEADER_MAGIC || header.version != CACHE_VERSION || header.instSize != sizeof(IRInst))
+		return;
+
+	double st = time_now_d();
+	entries_.clear();
+	for (u32 i = 0; i < header.numEntries; ++i) {
+		IRDiskCacheEntryHeader entryHeader;
+		if (!f.ReadArray(&entryHeader, 1))
+			break;
+		if (entryHeader.numInstructions == 0 || entryHeader.numInstructions > MAX_CACHED_INSTRUCTIONS || (entryHeader.mipsBytes & 3) != 0) {
+			ERROR_LOG(JIT, "Corrupt IR block cache entry, ignoring the rest.");
+			break;
+		}
+
+		Entry entry;
+		entry.mipsBytes = entryHeader.mipsBytes;
+		entry.hash = entryHeader.hash;
+		entry.stateKey = entryHeader.stateKey;
+		entry.instructions.resize(entryHeader.numInstructions);
+		if (!f.ReadArray(&entry.instructions[0], entryHeader.numInstructions))
+			break;
+
+		// If any op is unknown, this is from another version and the whole file is suspect.
+		for (const IRInst &inst : entry.instructions) {
+			if (GetIRMeta(inst.op) == nullptr) {
+				ERROR_LOG(JIT, "Unknown op in IR block cache, discarding.");
+				entries_.clear();
+				return;
+			}
+		}
+		entries_[entryHeader.addr] = std::move(entry);
+	}
+	dirty_ = false;
+
+	NOTICE_LOG(JIT, "Loaded %d cached IR blocks in %0.2f milliseconds", (int)entries_.size(), (time_now_d() - st) * 1000.0);
+}
+
+void IRDiskCache::Save(const Path &filename) {
+	if (!dirty_ || entries_.empty())
+		return;
+
+	INFO_LOG(JIT, "Saving the IR block cache to '%s'", filename.c_str());
+	FILE *f = File::OpenCFile(filename, "wb");
+	if (!f) {
+		// Can't save, give up for now.
+		dirty_ = false;
+		return;
+	}
+
+	IRDiskCacheHeader header;
+	header.magic = CACHE_HEADER_MAGIC;
+	header.version = CACHE_VERSION;
+	header.instSize = sizeof(IRInst);
+	header.numEntries = (u32)entries_.size();
+	fwrite(&header, 1, sizeof(header), f);
+	for (const auto &iter : entries_) {
+		const Entry &entry = iter.second;
+		IRDiskCacheEntryHeader entryHeader;
+		entryHeader.addr = iter.first;
+		entryHeader.mipsBytes = entry.mipsBytes;
+		entryHeader.hash = entry.hash;
+		entryHeader.stateKey = entry.stateKey;
+		entryHeader.numInstructions = (u32)entry.instructions.size();
+		entryHeader.reserved = 0;
+		fwrite(&entryHeader, 1, sizeof(entryHeader), f);
+		fwrite(&entry.instructions[0], sizeof(IRInst), entry.instructions.size(), f);
+	}
+	fclose(f);
+	dirty_ = false;
+}
+
+void IRDiskCache::Clear() {
+	entries_.clear();
+	dirty_ = false;
+}
+
+bool IRDiskCache::Lookup(u32 addr, u64 stateKey, std::vector<IRInst> &instructions, u32 &mipsBytes) const {
+	auto iter = entries_.find(addr);
+	if (iter == entries_.end())
+		return false;
+
+	const Entry &entry = iter->second;
+	if (entry.stateKey != stateKey || !Memory::IsValidRange(addr, entry.mipsBytes))
+		return false;
+	if (MIPSComp::IRBlock::HashRange(addr, entry.mipsBytes) != entry.hash)
+		return false;
+
+	instructions = entry.instructions;
+	mipsBytes = entry.mipsBytes;
+	return true;
+}
+
+std::vector<u32> IRDiskCache::GetAddresses() const {
+	std::vector<u32> addresses;
+	addresses.reserve(entries_.size());
+	for (const auto &it : entries_) {
+		if (Memory::IsValidRange(it.first, it.second.mipsBytes))
+			addresses.push_back(it.first);
+	}
+	// Sorted, so blocks are loaded in roughly the order of the code.
+	std::sort(addresses.begin(), addresses.end());
+	return addresses;
+}
+
+void IRDiskCache::Add(u32 addr, u32 mipsBytes, u64 stateKey, const std::vector<IRInst> &instructions) {
+	if (instructions.empty() || instructions.size() > MAX_CACHED_INSTRUCTIONS)
+		return;
+
+	Entry &entry = entries_[addr];
+	entry.mipsBytes = mipsBytes;
+	entry.hash = MIPSComp::IRBlock::HashRange(addr, mipsBytes);
+	entry.stateKey = stateKey;
+	entry.instructions = instructions;
+	dirty_ = true;
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File/Path.h"
+#include "Core/MIPS/IR/IRInst.h"
+
+// Keeps the IR for compiled blocks across runs, one file per game.
+//
+// Entries are keyed by address, and only used if a hash of the MIPS code there still matches,
+// and the frontend is in the same state (see IRFrontend::GetCompileStateKey().)  This way,
+// stale entries are just replaced the next time that code is compiled.
+class IRDiskCache {
+public:
+	void Load(const Path &filename);
+	void Save(const Path &filename);
+	void Clear();
+
+	// Fills instructions and mipsBytes if the block at addr is cached and still valid.
+	bool Lookup(u32 addr, u64 stateKey, std::vector<IRInst> &instructions, u32 &mipsBytes) const;
+	void Add(u32 addr, u32 mipsBytes, u64 stateKey, const std::vector<IRInst> &instructions);
+
+	bool HasEntries() const {
+		return !entries_.empty();
+	}
+	// Only the valid range of each is checked, call Lookup() before using them.
+	std::vector<u32> GetAddresses() const;
+
+private:
+	struct Entry {
+		u32 mipsBytes;
+		u64 hash;
+		u64 stateKey;
+		std::vector<IRInst> instructions;
+	};
+
+	std::unordered_map<u32, Entry> entries_;
+	bool dirty_ = false;
+};
@@ -15,14 +15,18 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
+#include "Core/Config.h"
 #include "Core/Debugger/Breakpoints.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/Reporting.h"
 #include "Core/HLE/ReplaceTables.h"
 #include "Core/MemMap.h"
+#include "Core/System.h"
 #include "Core/MIPS/MIPSTables.h"
 #include "Core/MIPS/IR/IRFrontend.h"
 #include "Core/MIPS/IR/IRRegCache.h"
@@ -31,6 +35,10 @@
 
 namespace MIPSComp {
 
+// Limits for superblocks formed by DoTrace().
+static const int MAX_TRACE_INSTRUCTIONS = 300;
+static const u32 MAX_TRACE_BYTES = 0x1000;
+
 IRFrontend::IRFrontend(bool startDefaultPrefix) {
 	js.startDefaultPrefix = true;
 	js.hasSetRounding = false;
@@ -237,6 +245,10 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 	js.PrefixStart();
 	ir.Clear();
 
+	traceStarts_.clear();
+	traceStarts_.push_back(em_address);
+	traceEnd_ = em_address;
+
 	js.numInstructions = 0;
 	while (js.compiling) {
 		// Jit breakpoints are quite fast, so let's do them in release too.
@@ -254,7 +266,8 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 		ir.Clear();
 	}
 
-	mipsBytes = js.compilerPC - em_address;
+	// With a trace, this covers everything between the start and the furthest segment.
+	mipsBytes = std::max(js.compilerPC, traceEnd_) - em_address;
 
 	IRWriter simplified;
 	IRWriter *code = &ir;
@@ -265,11 +278,32 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 			&OptimizeFPMoves,
 			&PropagateConstants,
 			&PurgeTemps,
+			&RemoveDeadWrites,
+			&RemoveRedundantStores,
+			&CombineVec4Lanes,
 			// &ReorderLoadStore,
 			// &MergeLoadStore,
 			// &ThreeOpToTwoOp,
 		};
-		if (IRApplyPasses(passes, ARRAY_SIZE(passes), ir, simplified, opts))
+		// Traces are hot, so they're worth a few more.  Note that ReduceLoads still stops at the first exit.
+		static const IRPassFunc tracePasses[] = {
+			&ApplyMemoryValidation,
+			&RemoveLoadStoreLeftRight,
+			&OptimizeFPMoves,
+			&PropagateConstants,
+			&ReduceLoads,
+			&PurgeTemps,
+			&RemoveDeadWrites,
+			&RemoveRedundantStores,
+			&CombineVec4Lanes,
+		};
+		const IRPassFunc *passList = passes;
+		size_t passCount = ARRAY_SIZE(passes);
+		if (traceHints_) {
+			passList = tracePasses;
+			passCount = ARRAY_SIZE(tracePasses);
+		}
+		if (IRApplyPasses(passList, passCount, ir, simplified, opts, &passStats_))
 			logBlocks = 1;
 		code = &simplified;
 		//if (ir.GetInstructions().size() >= 24)
@@ -314,6 +348,65 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 		dontLogBlocks--;
 }
 
+u64 IRFrontend::GetCompileStateKey() const {
+	u64 key = (u64)opts.disableFlags << 8;
+	if (opts.unalignedLoadStore)
+		key |= 1;
+	if (js.hasSetRounding)
+		key |= 2;
+	if (js.startDefaultPrefix)
+		key |= 4;
+	// These change what gets emitted too, so the same block compiles differently.
+	if (g_Config.bFastMemory)
+		key |= 8;
+	if (PSP_CoreParameter().compat.flags().MoreAccurateVMMUL)
+		key |= 16;
+	// Syscalls aren't inlined while collecting stats.
+	if (coreCollectDebugStats)
+		key |= 32;
+	// Replaced functions compile to CallReplacement, but the hash only sees the original code.
+	if (g_Config.bFuncReplacements)
+		key |= 64;
+	return key;
+}
+
+bool IRFrontend::DoTrace(u32 em_address, const IRTraceHintFunc &hints, std::vector<IRInst> &instructions, u32 &mipsBytes) {
+	traceHints_ = &hints;
+	DoJit(em_address, instructions, mipsBytes, false);
+	traceHints_ = nullptr;
+	return js.lastContinuedPC != 0 && !instructions.empty();
+}
+
+IRBranchHint IRFrontend::PredictBranch() {
+	if (!traceHints_)
+		return IRBranchHint::UNKNOWN;
+	// The profile is per block, and each continued part started where a block would have.
+	return (*traceHints_)(js.lastContinuedPC != 0 ? js.lastContinuedPC : js.blockStart);
+}
+
+bool IRFrontend::CanContinueBranch(u32 targetAddr) {
+	if (!traceHints_ || js.numInstructions >= MAX_TRACE_INSTRUCTIONS)
+		return false;
+	// Only go forward, and not too far, so the block's range stays small.
+	if (targetAddr <= js.blockStart || targetAddr - js.blockStart >= MAX_TRACE_BYTES)
+		return false;
+	if (!Memory::IsValidAddress(targetAddr) || (targetAddr & 3) != 0)
+		return false;
+	// No unrolling, loops just exit back to the start of the trace.
+	return std::find(traceStarts_.begin(), traceStarts_.end(), targetAddr) == traceStarts_.end();
+}
+
+void IRFrontend::AddContinuedBlock(u32 dest) {
+	if (js.lastContinuedPC == 0)
+		js.initialBlockSize = js.numInstructions;
+	js.lastContinuedPC = dest;
+	traceStarts_.push_back(dest);
+	// The branch and its delay slot.
+	traceEnd_ = std::max(traceEnd_, GetCompilerPC() + 8);
+	// DoJit adds 4 after each op.
+	js.compilerPC = dest - 4;
+}
+
 void IRFrontend::Comp_RunBlock(MIPSOpcode op) {
 	// This shouldn't be necessary, the dispatcher should catch us before we get here.
 	ERROR_LOG(JIT, "Comp_RunBlock should never be reached!");
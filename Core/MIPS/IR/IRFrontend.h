@@ -1,13 +1,27 @@
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/JitCommon/JitState.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
 #include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRPassSimplify.h"
 
 namespace MIPSComp {
 
+// Which way the branch ending a block usually goes, from the exit profile.
+enum class IRBranchHint {
+	UNKNOWN,
+	TAKEN,
+	NOT_TAKEN,
+};
+
+// Looks up the hint for the block starting at the given address.
+typedef std::function<IRBranchHint(u32 blockStart)> IRTraceHintFunc;
+
 class IRFrontend : public MIPSFrontendInterface {
 public:
 	IRFrontend(bool startDefaultPrefix);
@@ -89,6 +103,12 @@ class IRFrontend : public MIPSFrontendInterface {
 	bool CheckRounding(u32 blockAddress);  // returns true if we need a do-over
 
 	void DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	// Like DoJit, but keeps compiling along the hot side of branches and jumps, forming a
+	// superblock with multiple exits.  Returns false if no branch was followed.
+	bool DoTrace(u32 em_address, const IRTraceHintFunc &hints, std::vector<IRInst> &instructions, u32 &mipsBytes);
+
+	// Anything besides the MIPS code itself that affects what DoJit() produces.
+	u64 GetCompileStateKey() const;
 
 	void EatPrefix() override {
 		js.EatPrefix();
@@ -98,6 +118,14 @@ class IRFrontend : public MIPSFrontendInterface {
 		opts = o;
 	}
 
+	// Accumulated over all blocks compiled since the last reset.
+	const IRPassStats &GetPassStats() const {
+		return passStats_;
+	}
+	void ResetPassStats() {
+		passStats_.clear();
+	}
+
 private:
 	void RestoreRoundingMode(bool force = false);
 	void ApplyRoundingMode(bool force = false);
@@ -111,6 +139,12 @@ class IRFrontend : public MIPSFrontendInterface {
 	void EatInstruction(MIPSOpcode op);
 	MIPSOpcode GetOffsetInstruction(int offset);
 
+	IRBranchHint PredictBranch();
+	bool CanContinueBranch(u32 targetAddr);
+	bool WriteNotTakenExit(const BranchInfo &branchInfo, IRComparison cc, u32 targetAddr, u8 lhs, u8 rhs);
+	bool ContinueTaken(const BranchInfo &branchInfo, u32 targetAddr);
+	void AddContinuedBlock(u32 dest);
+
 	void CheckBreakpoint(u32 addr);
 	void CheckMemoryBreakpoint(int rs, int offset);
 
@@ -137,6 +171,13 @@ class IRFrontend : public MIPSFrontendInterface {
 	IRWriter ir;
 	IROptions opts{};
 
+	// Only set while forming a trace, which also selects the trace passes.
+	const IRTraceHintFunc *traceHints_ = nullptr;
+	std::vector<u32> traceStarts_;
+	u32 traceEnd_ = 0;
+
+	IRPassStats passStats_;
+
 	int dontLogBlocks = 0;
 	int logBlocks = 0;
 };
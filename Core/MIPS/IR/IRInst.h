@@ -209,6 +209,7 @@ enum class IROp : u8 {
 	ExitToPC,  // Used after a syscall to give us a way to do things before returning.
 
 	Syscall,
+	SyscallInline,  // Exits like a syscall only when needed, see HLE_JIT_INLINE.
 	SetPC,  // hack to make syscall returns work
 	SetPCConst,  // hack to make replacement know PC
 	CallReplacement,
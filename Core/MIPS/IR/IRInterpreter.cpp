@@ -25,6 +25,7 @@
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/ReplaceTables.h"
 #include "Core/Host.h"
+#include "Core/MemFault.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSTables.h"
@@ -98,6 +99,9 @@ u32 RunValidateAddress(u32 pc, u32 addr, u32 isWrite) {
 	return 0;
 }
 
+// After a bad fastmem access with an exception, MemFault skips it and the block must stop there.
+#define IR_STOP_ON_FAULT() if (Memory::g_interpreterFaulted) return mips->pc
+
 // We cannot use NEON on ARM32 here until we make it a hard dependency. We can, however, on ARM64.
 u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 	const IRInst *end = inst + count;
@@ -188,18 +192,23 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 
 		case IROp::Load8:
 			mips->r[inst->dest] = Memory::ReadUnchecked_U8(mips->r[inst->src1] + inst->constant);
+			IR_STOP_ON_FAULT();
 			break;
 		case IROp::Load8Ext:
 			mips->r[inst->dest] = SignExtend8ToU32(Memory::ReadUnchecked_U8(mips->r[inst->src1] + inst->constant));
+			IR_STOP_ON_FAULT();
 			break;
 		case IROp::Load16:
 			mips->r[inst->dest] = Memory::ReadUnchecked_U16(mips->r[inst->src1] + inst->constant);
+			IR_STOP_ON_FAULT();
 			break;
 		case IROp::Load16Ext:
 			mips->r[inst->dest] = SignExtend16ToU32(Memory::ReadUnchecked_U16(mips->r[inst->src1] + inst->constant));
+			IR_STOP_ON_FAULT();
 			break;
 		case IROp::Load32:
 			mips->r[inst->dest] = Memory::ReadUnchecked_U32(mips->r[inst->src1] + inst->constant);
+			IR_STOP_ON_FAULT();
 			break;
 		case IROp::Load32Left:
 		{
@@ -208,6 +217,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			u32 mem = Memory::ReadUnchecked_U32(addr & 0xfffffffc);
 			u32 destMask = 0x00ffffff >> shift;
 			mips->r[inst->dest] = (mips->r[inst->dest] & destMask) | (mem << (24 - shift));
+			IR_STOP_ON_FAULT();
 			break;
 		}
 		case IROp::Load32Right:
@@ -217,20 +227,25 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			u32 mem = Memory::ReadUnchecked_U32(addr & 0xfffffffc);
 			u32 destMask = 0xffffff00 << (24 - shift);
 			mips->r[inst->dest] = (mips->r[inst->dest] & destMask) | (mem >> shift);
+			IR_STOP_ON_FAULT();
 			break;
 		}
 		case IROp::LoadFloat:
 			mips->f[inst->dest] = Memory::ReadUnchecked_Float(mips->r[inst->src1] + inst->constant);
+			IR_STOP_ON_FAULT();
 			break;
 
 		case IROp::Store8:
 			Memory::WriteUnchecked_U8(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
+			IR_STOP_ON_FAULT();
 			break;
 		case IROp::Store16:
 			Memory::WriteUnchecked_U16(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
+			IR_STOP_ON_FAULT();
 			break;
 		case IROp::Store32:
 			Memory::WriteUnchecked_U32(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
+			IR_STOP_ON_FAULT();
 			break;
 		case IROp::Store32Left:
 		{
@@ -240,6 +255,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			u32 memMask = 0xffffff00 << shift;
 			u32 result = (mips->r[inst->src3] >> (24 - shift)) | (mem & memMask);
 			Memory::WriteUnchecked_U32(result, addr & 0xfffffffc);
+			IR_STOP_ON_FAULT();
 			break;
 		}
 		case IROp::Store32Right:
@@ -250,10 +266,12 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			u32 memMask = 0x00ffffff >> (24 - shift);
 			u32 result = (mips->r[inst->src3] << shift) | (mem & memMask);
 			Memory::WriteUnchecked_U32(result, addr & 0xfffffffc);
+			IR_STOP_ON_FAULT();
 			break;
 		}
 		case IROp::StoreFloat:
 			Memory::WriteUnchecked_Float(mips->f[inst->src3], mips->r[inst->src1] + inst->constant);
+			IR_STOP_ON_FAULT();
 			break;
 
 		case IROp::LoadVec4:
@@ -265,6 +283,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = Memory::ReadUnchecked_Float(base + 4 * i);
 #endif
+			IR_STOP_ON_FAULT();
 			break;
 		}
 		case IROp::StoreVec4:
@@ -276,6 +295,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			for (int i = 0; i < 4; i++)
 				Memory::WriteUnchecked_Float(mips->f[inst->dest + i], base + 4 * i);
 #endif
+			IR_STOP_ON_FAULT();
 			break;
 		}
 
@@ -353,6 +373,8 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_div_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps(&mips->f[inst->src2])));
+#elif PPSSPP_ARCH(ARM64_NEON)
+			vst1q_f32(&mips->f[inst->dest], vdivq_f32(vld1q_f32(&mips->f[inst->src1]), vld1q_f32(&mips->f[inst->src2])));
 #else
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = mips->f[inst->src1 + i] / mips->f[inst->src2 + i];
@@ -364,6 +386,8 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_mul_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_set1_ps(mips->f[inst->src2])));
+#elif PPSSPP_ARCH(ARM64_NEON)
+			vst1q_f32(&mips->f[inst->dest], vmulq_n_f32(vld1q_f32(&mips->f[inst->src1]), mips->f[inst->src2]));
 #else
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = mips->f[inst->src1 + i] * mips->f[inst->src2];
@@ -556,10 +580,24 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 		// Not quickly implementable on all platforms, unfortunately.
 		case IROp::Vec4Dot:
 		{
+			// The multiplies can go wide, but the adds must stay in order to match the scalar ops.
+#if defined(_M_SSE)
+			__m128 mul = _mm_mul_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps(&mips->f[inst->src2]));
+			__m128 dot = _mm_add_ss(mul, _mm_shuffle_ps(mul, mul, _MM_SHUFFLE(1, 1, 1, 1)));
+			dot = _mm_add_ss(dot, _mm_shuffle_ps(mul, mul, _MM_SHUFFLE(2, 2, 2, 2)));
+			dot = _mm_add_ss(dot, _mm_shuffle_ps(mul, mul, _MM_SHUFFLE(3, 3, 3, 3)));
+			_mm_store_ss(&mips->f[inst->dest], dot);
+#elif PPSSPP_ARCH(ARM64_NEON)
+			float32x4_t mul = vmulq_f32(vld1q_f32(&mips->f[inst->src1]), vld1q_f32(&mips->f[inst->src2]));
+			float dot = vgetq_lane_f32(mul, 0) + vgetq_lane_f32(mul, 1);
+			dot += vgetq_lane_f32(mul, 2);
+			mips->f[inst->dest] = dot + vgetq_lane_f32(mul, 3);
+#else
 			float dot = mips->f[inst->src1] * mips->f[inst->src2];
 			for (int i = 1; i < 4; i++)
 				dot += mips->f[inst->src1 + i] * mips->f[inst->src2 + i];
 			mips->f[inst->dest] = dot;
+#endif
 			break;
 		}
 
@@ -972,18 +1010,38 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			// IROp::SetPC was (hopefully) executed before.
 		{
 			MIPSOpcode op(inst->constant);
-			CallSyscall(op);
+			{
+				Memory::MemFaultInterpreterCallScope callScope;
+				CallSyscall(op);
+			}
 			if (coreState != CORE_RUNNING)
 				CoreTiming::ForceCheck();
 			break;
 		}
 
+		case IROp::SyscallInline:
+		{
+			MIPSOpcode op(inst->constant);
+			u32 exitPC;
+			{
+				Memory::MemFaultInterpreterCallScope callScope;
+				exitPC = CallInlineSyscallOp(op);
+			}
+			if (exitPC != 0) {
+				if (coreState != CORE_RUNNING)
+					CoreTiming::ForceCheck();
+				return exitPC;
+			}
+			break;
+		}
+
 		case IROp::ExitToPC:
 			return mips->pc;
 
 		case IROp::Interpret:  // SLOW fallback. Can be made faster. Ideally should be removed but may be useful for debugging.
 		{
 			MIPSOpcode op(inst->constant);
+			Memory::MemFaultInterpreterCallScope callScope;
 			MIPSInterpret(op);
 			break;
 		}
@@ -992,6 +1050,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 		{
 			int funcIndex = inst->constant;
 			const ReplacementTableEntry *f = GetReplacementFunc(funcIndex);
+			Memory::MemFaultInterpreterCallScope callScope;
 			int cycles = f->replaceFunc();
 			mips->downcount -= cycles;
 			break;
@@ -1052,3 +1111,252 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 	Crash();
 	return 0;
 }
+
+#if defined(__GNUC__) || defined(__clang__)
+#define IR_THREADED_GOTO 1
+#else
+#define IR_THREADED_GOTO 0
+#endif
+
+// The ops with their own handler in IRInterpretThreaded().  Anything else uses the fallback.
+#define IR_THREADED_OPS(X) \
+	X(SetConst) X(SetConstF) X(Mov) X(Add) X(Sub) X(And) X(Or) X(Xor) \
+	X(AddConst) X(SubConst) X(AndConst) X(OrConst) X(XorConst) X(Neg) X(Not) \
+	X(Ext8to32) X(Ext16to32) X(ShlImm) X(ShrImm) X(SarImm) X(Shl) X(Shr) X(Sar) \
+	X(Slt) X(SltU) X(SltConst) X(SltUConst) X(MovZ) X(MovNZ) \
+	X(MtLo) X(MtHi) X(MfLo) X(MfHi) X(Mult) X(MultU) \
+	X(Load8) X(Load8Ext) X(Load16) X(Load16Ext) X(Load32) X(LoadFloat) \
+	X(Store8) X(Store16) X(Store32) X(StoreFloat) \
+	X(FAdd) X(FSub) X(FMul) X(FDiv) X(FMov) X(FAbs) X(FNeg) X(FMovFromGPR) X(FMovToGPR) \
+	X(Downcount) X(SetPC) X(SetPCConst) X(ExitToConst) X(ExitToReg) X(ExitToPC) \
+	X(ExitToConstIfEq) X(ExitToConstIfNeq) X(ExitToConstIfGtZ) X(ExitToConstIfGeZ) \
+	X(ExitToConstIfLtZ) X(ExitToConstIfLeZ)
+
+enum class IRThreadedOp : u16 {
+#define IR_THREADED_ENUM(name) name,
+	IR_THREADED_OPS(IR_THREADED_ENUM)
+#undef IR_THREADED_ENUM
+	Fallback,
+};
+
+static IRThreadedOp GetThreadedOp(IROp op) {
+	switch (op) {
+#define IR_THREADED_CASE(name) case IROp::name: return IRThreadedOp::name;
+	IR_THREADED_OPS(IR_THREADED_CASE)
+#undef IR_THREADED_CASE
+	default:
+		return IRThreadedOp::Fallback;
+	}
+}
+
+static const void *const *threadedHandlers = nullptr;
+
+static u32 *ThreadedOperand(MIPSState *mips, char type, u8 reg) {
+	if (type == 'G')
+		return &mips->r[reg];
+	if (type == 'F')
+		return &mips->fi[reg];
+	return nullptr;
+}
+
+void IRBuildThreaded(MIPSState *mips, const IRInst *inst, int count, std::vector<IRThreadedInst> &out) {
+#if IR_THREADED_GOTO
+	if (!threadedHandlers) {
+		// This just grabs the handler table.
+		IRInterpretThreaded(nullptr, nullptr);
+	}
+#endif
+
+	out.resize(count);
+	for (int i = 0; i < count; ++i) {
+		const IRMeta *m = GetIRMeta(inst[i].op);
+		IRThreadedInst &t = out[i];
+		IRThreadedOp op = GetThreadedOp(inst[i].op);
+		t.op = (u16)op;
+#if IR_THREADED_GOTO
+		t.handler = threadedHandlers[t.op];
+#else
+		t.handler = nullptr;
+#endif
+		// For stores, dest is src3, which works out the same.
+		t.dest = ThreadedOperand(mips, m->types[0], inst[i].dest);
+		t.src1 = m->types[0] != '\0' ? ThreadedOperand(mips, m->types[1], inst[i].src1) : nullptr;
+		t.src2 = m->types[0] != '\0' && m->types[1] != '\0' ? ThreadedOperand(mips, m->types[2], inst[i].src2) : nullptr;
+		// Shift immediates are in src2, put them with the other constants.
+		t.constant = m->types[0] != '\0' && m->types[1] != '\0' && m->types[2] == 'I' ? inst[i].src2 : inst[i].constant;
+		t.fallback[0] = inst[i];
+		t.fallback[1] = { IROp::ExitToConst, { 0 }, 0, 0, 0 };
+	}
+}
+
+#if IR_THREADED_GOTO
+#define IR_HANDLER(name) op_##name:
+#define IR_NEXT() { ++inst; goto *inst->handler; }
+// Like IR_NEXT(), but stops if MemFault skipped a bad access.  Picking the target instead of
+// branching keeps each handler's own indirect jump, which is what makes this fast.
+#define IR_NEXT_MEM() { ++inst; goto *(Memory::g_interpreterFaulted ? &&stop_after_fault : inst->handler); }
+#else
+#define IR_HANDLER(name) case IRThreadedOp::name:
+#define IR_NEXT() continue
+#define IR_NEXT_MEM() { IR_STOP_ON_FAULT(); continue; }
+#endif
+
+#define R(p) (*(p))
+#define F(p) (*(float *)(p))
+
+u32 IRInterpretThreaded(MIPSState *mips, const IRThreadedInst *inst) {
+#if IR_THREADED_GOTO
+#define IR_THREADED_LABEL(name) &&op_##name,
+	static const void *const handlers[] = {
+		IR_THREADED_OPS(IR_THREADED_LABEL)
+		&&op_Fallback,
+	};
+#undef IR_THREADED_LABEL
+	if (!inst) {
+		threadedHandlers = handlers;
+		return 0;
+	}
+	goto *inst->handler;
+#else
+	for (;; ++inst) {
+		switch ((IRThreadedOp)inst->op) {
+#endif
+
+	IR_HANDLER(SetConst) R(inst->dest) = inst->constant; IR_NEXT();
+	IR_HANDLER(SetConstF) R(inst->dest) = inst->constant; IR_NEXT();
+	IR_HANDLER(Mov) R(inst->dest) = R(inst->src1); IR_NEXT();
+	IR_HANDLER(Add) R(inst->dest) = R(inst->src1) + R(inst->src2); IR_NEXT();
+	IR_HANDLER(Sub) R(inst->dest) = R(inst->src1) - R(inst->src2); IR_NEXT();
+	IR_HANDLER(And) R(inst->dest) = R(inst->src1) & R(inst->src2); IR_NEXT();
+	IR_HANDLER(Or) R(inst->dest) = R(inst->src1) | R(inst->src2); IR_NEXT();
+	IR_HANDLER(Xor) R(inst->dest) = R(inst->src1) ^ R(inst->src2); IR_NEXT();
+	IR_HANDLER(AddConst) R(inst->dest) = R(inst->src1) + inst->constant; IR_NEXT();
+	IR_HANDLER(SubConst) R(inst->dest) = R(inst->src1) - inst->constant; IR_NEXT();
+	IR_HANDLER(AndConst) R(inst->dest) = R(inst->src1) & inst->constant; IR_NEXT();
+	IR_HANDLER(OrConst) R(inst->dest) = R(inst->src1) | inst->constant; IR_NEXT();
+	IR_HANDLER(XorConst) R(inst->dest) = R(inst->src1) ^ inst->constant; IR_NEXT();
+	IR_HANDLER(Neg) R(inst->dest) = -(s32)R(inst->src1); IR_NEXT();
+	IR_HANDLER(Not) R(inst->dest) = ~R(inst->src1); IR_NEXT();
+	IR_HANDLER(Ext8to32) R(inst->dest) = SignExtend8ToU32(R(inst->src1)); IR_NEXT();
+	IR_HANDLER(Ext16to32) R(inst->dest) = SignExtend16ToU32(R(inst->src1)); IR_NEXT();
+	IR_HANDLER(ShlImm) R(inst->dest) = R(inst->src1) << (int)inst->constant; IR_NEXT();
+	IR_HANDLER(ShrImm) R(inst->dest) = R(inst->src1) >> (int)inst->constant; IR_NEXT();
+	IR_HANDLER(SarImm) R(inst->dest) = (s32)R(inst->src1) >> (int)inst->constant; IR_NEXT();
+	IR_HANDLER(Shl) R(inst->dest) = R(inst->src1) << (R(inst->src2) & 31); IR_NEXT();
+	IR_HANDLER(Shr) R(inst->dest) = R(inst->src1) >> (R(inst->src2) & 31); IR_NEXT();
+	IR_HANDLER(Sar) R(inst->dest) = (s32)R(inst->src1) >> (R(inst->src2) & 31); IR_NEXT();
+	IR_HANDLER(Slt) R(inst->dest) = (s32)R(inst->src1) < (s32)R(inst->src2); IR_NEXT();
+	IR_HANDLER(SltU) R(inst->dest) = R(inst->src1) < R(inst->src2); IR_NEXT();
+	IR_HANDLER(SltConst) R(inst->dest) = (s32)R(inst->src1) < (s32)inst->constant; IR_NEXT();
+	IR_HANDLER(SltUConst) R(inst->dest) = R(inst->src1) < inst->constant; IR_NEXT();
+	IR_HANDLER(MovZ)
+		if (R(inst->src1) == 0)
+			R(inst->dest) = R(inst->src2);
+		IR_NEXT();
+	IR_HANDLER(MovNZ)
+		if (R(inst->src1) != 0)
+			R(inst->dest) = R(inst->src2);
+		IR_NEXT();
+
+	IR_HANDLER(MtLo) mips->lo = R(inst->src1); IR_NEXT();
+	IR_HANDLER(MtHi) mips->hi = R(inst->src1); IR_NEXT();
+	IR_HANDLER(MfLo) R(inst->dest) = mips->lo; IR_NEXT();
+	IR_HANDLER(MfHi) R(inst->dest) = mips->hi; IR_NEXT();
+	IR_HANDLER(Mult)
+	{
+		s64 result = (s64)(s32)R(inst->src1) * (s64)(s32)R(inst->src2);
+		memcpy(&mips->lo, &result, 8);
+		IR_NEXT();
+	}
+	IR_HANDLER(MultU)
+	{
+		u64 result = (u64)R(inst->src1) * (u64)R(inst->src2);
+		memcpy(&mips->lo, &result, 8);
+		IR_NEXT();
+	}
+
+	IR_HANDLER(Load8) R(inst->dest) = Memory::ReadUnchecked_U8(R(inst->src1) + inst->constant); IR_NEXT_MEM();
+	IR_HANDLER(Load8Ext) R(inst->dest) = SignExtend8ToU32(Memory::ReadUnchecked_U8(R(inst->src1) + inst->constant)); IR_NEXT_MEM();
+	IR_HANDLER(Load16) R(inst->dest) = Memory::ReadUnchecked_U16(R(inst->src1) + inst->constant); IR_NEXT_MEM();
+	IR_HANDLER(Load16Ext) R(inst->dest) = SignExtend16ToU32(Memory::ReadUnchecked_U16(R(inst->src1) + inst->constant)); IR_NEXT_MEM();
+	IR_HANDLER(Load32) R(inst->dest) = Memory::ReadUnchecked_U32(R(inst->src1) + inst->constant); IR_NEXT_MEM();
+	IR_HANDLER(LoadFloat) F(inst->dest) = Memory::ReadUnchecked_Float(R(inst->src1) + inst->constant); IR_NEXT_MEM();
+	IR_HANDLER(Store8) Memory::WriteUnchecked_U8(R(inst->dest), R(inst->src1) + inst->constant); IR_NEXT_MEM();
+	IR_HANDLER(Store16) Memory::WriteUnchecked_U16(R(inst->dest), R(inst->src1) + inst->constant); IR_NEXT_MEM();
+	IR_HANDLER(Store32) Memory::WriteUnchecked_U32(R(inst->dest), R(inst->src1) + inst->constant); IR_NEXT_MEM();
+	IR_HANDLER(StoreFloat) Memory::WriteUnchecked_Float(F(inst->dest), R(inst->src1) + inst->constant); IR_NEXT_MEM();
+
+	IR_HANDLER(FAdd) F(inst->dest) = F(inst->src1) + F(inst->src2); IR_NEXT();
+	IR_HANDLER(FSub) F(inst->dest) = F(inst->src1) - F(inst->src2); IR_NEXT();
+	IR_HANDLER(FMul)
+		if ((my_isinf(F(inst->src1)) && F(inst->src2) == 0.0f) || (my_isinf(F(inst->src2)) && F(inst->src1) == 0.0f)) {
+			R(inst->dest) = 0x7fc00000;
+		} else {
+			F(inst->dest) = F(inst->src1) * F(inst->src2);
+		}
+		IR_NEXT();
+	IR_HANDLER(FDiv) F(inst->dest) = F(inst->src1) / F(inst->src2); IR_NEXT();
+	IR_HANDLER(FMov) F(inst->dest) = F(inst->src1); IR_NEXT();
+	IR_HANDLER(FAbs) F(inst->dest) = fabsf(F(inst->src1)); IR_NEXT();
+	IR_HANDLER(FNeg) F(inst->dest) = -F(inst->src1); IR_NEXT();
+	// These are just bit copies now that both sides are u32 pointers.
+	IR_HANDLER(FMovFromGPR) R(inst->dest) = R(inst->src1); IR_NEXT();
+	IR_HANDLER(FMovToGPR) R(inst->dest) = R(inst->src1); IR_NEXT();
+
+	IR_HANDLER(Downcount) mips->downcount -= inst->constant; IR_NEXT();
+	IR_HANDLER(SetPC) mips->pc = R(inst->src1); IR_NEXT();
+	IR_HANDLER(SetPCConst) mips->pc = inst->constant; IR_NEXT();
+	IR_HANDLER(ExitToConst) return inst->constant;
+	IR_HANDLER(ExitToReg) return R(inst->src1);
+	IR_HANDLER(ExitToPC) return mips->pc;
+	IR_HANDLER(ExitToConstIfEq)
+		if (R(inst->src1) == R(inst->src2))
+			return inst->constant;
+		IR_NEXT();
+	IR_HANDLER(ExitToConstIfNeq)
+		if (R(inst->src1) != R(inst->src2))
+			return inst->constant;
+		IR_NEXT();
+	IR_HANDLER(ExitToConstIfGtZ)
+		if ((s32)R(inst->src1) > 0)
+			return inst->constant;
+		IR_NEXT();
+	IR_HANDLER(ExitToConstIfGeZ)
+		if ((s32)R(inst->src1) >= 0)
+			return inst->constant;
+		IR_NEXT();
+	IR_HANDLER(ExitToConstIfLtZ)
+		if ((s32)R(inst->src1) < 0)
+			return inst->constant;
+		IR_NEXT();
+	IR_HANDLER(ExitToConstIfLeZ)
+		if ((s32)R(inst->src1) <= 0)
+			return inst->constant;
+		IR_NEXT();
+
+#if IR_THREADED_GOTO
+stop_after_fault:
+	return mips->pc;
+#endif
+
+	IR_HANDLER(Fallback)
+	{
+		// Runs just this instruction, the ExitToConst after it returns 0.
+		u32 exitPC = IRInterpret(mips, inst->fallback, 2);
+		if (exitPC != 0)
+			return exitPC;
+		IR_NEXT();
+	}
+
+#if !IR_THREADED_GOTO
+		}
+	}
+#endif
+}
+
+#undef R
+#undef F
+#undef IR_HANDLER
+#undef IR_NEXT
+#undef IR_NEXT_MEM
+#undef IR_STOP_ON_FAULT
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <vector>
+
 #include "Common/CommonTypes.h"
+#include "Core/MIPS/IR/IRInst.h"
 
 class MIPSState;
-struct IRInst;
 
 inline static u32 ReverseBits32(u32 v) {
 	// http://graphics.stanford.edu/~seander/bithacks.html#ReverseParallel
@@ -21,3 +23,23 @@ inline static u32 ReverseBits32(u32 v) {
 }
 
 u32 IRInterpret(MIPSState *ms, const IRInst *inst, int count);
+
+// Pre-decoded ("direct threaded") form of an IR block.  The register operands are resolved to
+// pointers into one specific MIPSState, and where the compiler supports computed goto, the op is
+// resolved to the address of its handler, so dispatch is a single indirect jump.
+// Ops without a handler of their own run through IRInterpret() one at a time.
+struct IRThreadedInst {
+	const void *handler;
+	u32 *dest;
+	const u32 *src1;
+	const u32 *src2;
+	u32 constant;
+	// Handler index, used when computed goto isn't available.
+	u16 op;
+	// The original instruction followed by ExitToConst 0, for the fallback.
+	IRInst fallback[2];
+};
+
+// The result is only valid for the same MIPSState, and the block must end with an exit.
+void IRBuildThreaded(MIPSState *ms, const IRInst *inst, int count, std::vector<IRThreadedInst> &out);
+u32 IRInterpretThreaded(MIPSState *ms, const IRThreadedInst *inst);
@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <set>
 
 #include "ext/xxhash.h"
@@ -22,12 +23,16 @@
 
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
+#include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
 
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/Debugger/Breakpoints.h"
+#include "Core/ELF/ParamSFO.h"
 #include "Core/HLE/sceKernelMemory.h"
+#include "Core/MemFault.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSCodeUtils.h"
@@ -39,6 +44,7 @@
 #include "Core/MIPS/IR/IRInterpreter.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/Reporting.h"
+#include "Core/System.h"
 
 namespace MIPSComp {
 
@@ -51,9 +57,19 @@ IRJit::IRJit(MIPSState *mipsState) : frontend_(mipsState->HasDefaultPrefix()), m
 	opts.disableFlags = g_Config.uJitDisableFlags;
 	opts.unalignedLoadStore = (opts.disableFlags & (uint32_t)JitDisable::LSU_UNALIGNED) == 0;
 	frontend_.SetOptions(opts);
+	blocks_.SetPassStats(&frontend_.GetPassStats());
+
+	std::string discID = g_paramSFO.GetDiscID();
+	if (g_Config.bIRBlockCache && !discID.empty()) {
+		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+		diskCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".irblockcache");
+		diskCache_.Load(diskCachePath_);
+	}
 }
 
 IRJit::~IRJit() {
+	if (diskCachePath_.Valid())
+		diskCache_.Save(diskCachePath_);
 }
 
 void IRJit::DoState(PointerWrap &p) {
@@ -66,6 +82,7 @@ void IRJit::UpdateFCR31() {
 void IRJit::ClearCache() {
 	INFO_LOG(JIT, "IRJit: Clearing the cache!");
 	blocks_.Clear();
+	frontend_.ResetPassStats();
 }
 
 void IRJit::InvalidateCacheAt(u32 em_address, int length) {
@@ -75,7 +92,7 @@ void IRJit::InvalidateCacheAt(u32 em_address, int length) {
 void IRJit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
 
-	if (g_Config.bPreloadFunctions) {
+	if (g_Config.bPreloadFunctions || diskCache_.HasEntries()) {
 		// Look to see if we've preloaded this block.
 		int block_num = blocks_.FindPreloadBlock(em_address);
 		if (block_num != -1) {
@@ -105,14 +122,42 @@ void IRJit::Compile(u32 em_address) {
 	}
 }
 
+// Blocks that depend on debugger state or change the frontend's state can't be reused later.
+static bool CanDiskCacheBlock(const std::vector<IRInst> &instructions) {
+	for (const IRInst &inst : instructions) {
+		switch (inst.op) {
+		case IROp::Breakpoint:
+		case IROp::MemoryCheck:
+		case IROp::UpdateRoundingMode:
+			return false;
+		default:
+			break;
+		}
+	}
+	return !instructions.empty();
+}
+
 bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload) {
-	frontend_.DoJit(em_address, instructions, mipsBytes, preload);
+	bool useDiskCache = diskCachePath_.Valid() && !CBreakPoints::HasMemChecks();
+	u64 stateKey = frontend_.GetCompileStateKey();
+	bool cached = useDiskCache && diskCache_.Lookup(em_address, stateKey, instructions, mipsBytes);
+	if (cached && CBreakPoints::RangeContainsBreakPoint(em_address, mipsBytes))
+		cached = false;
+	if (!cached) {
+		frontend_.DoJit(em_address, instructions, mipsBytes, preload);
+		if (useDiskCache && CanDiskCacheBlock(instructions))
+			diskCache_.Add(em_address, mipsBytes, stateKey, instructions);
+	}
 	if (instructions.empty()) {
 		_dbg_assert_(preload);
 		// We return true when preloading so it doesn't abort.
 		return preload;
 	}
 
+	return AddBlock(em_address, instructions, mipsBytes, preload);
+}
+
+bool IRJit::AddBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, bool preload) {
 	int block_num = blocks_.AllocateBlock(em_address);
 	if ((block_num & ~MIPS_EMUHACK_VALUE_MASK) != 0) {
 		// Out of block numbers.  Caller will handle.
@@ -122,6 +167,10 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 	IRBlock *b = blocks_.GetBlock(block_num);
 	b->SetInstructions(instructions);
 	b->SetOriginalSize(mipsBytes);
+	if (!CompileTargetBlock(b, block_num, preload)) {
+		// Out of native code space.  Caller will handle.
+		return false;
+	}
 	if (preload) {
 		// Hash, then only update page stats, don't link yet.
 		b->UpdateHash();
@@ -135,6 +184,80 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 	return true;
 }
 
+void IRJit::CompileTrace(int block_num) {
+	IRBlock *b = blocks_.GetBlock(block_num);
+	if (!b || b->IsTrace() || !b->IsValid() || b->GetBranchHint() == IRBranchHint::UNKNOWN)
+		return;
+
+	u32 em_address, size;
+	b->GetRange(em_address, size);
+
+	IRTraceHintFunc hints = [&](u32 blockStart) {
+		const IRBlock *hintBlock = blocks_.GetBlock(blocks_.GetBlockNumberFromStartAddress(blockStart));
+		return hintBlock ? hintBlock->GetBranchHint() : IRBranchHint::UNKNOWN;
+	};
+
+	std::vector<IRInst> instructions;
+	u32 mipsBytes;
+	if (!frontend_.DoTrace(em_address, hints, instructions, mipsBytes)) {
+		// Nothing worth following, keep the regular block.
+		return;
+	}
+
+	int trace_num = blocks_.AllocateBlock(em_address);
+	if ((trace_num & ~MIPS_EMUHACK_VALUE_MASK) != 0) {
+		ERROR_LOG(JIT, "Ran out of block numbers, clearing cache");
+		ClearCache();
+		return;
+	}
+
+	IRBlock *trace = blocks_.GetBlock(trace_num);
+	trace->SetInstructions(instructions);
+	trace->SetOriginalSize(mipsBytes);
+	trace->SetTrace(true);
+	if (!CompileTargetBlock(trace, trace_num, false)) {
+		ClearCache();
+		return;
+	}
+
+	// The trace takes over the address, other blocks still exit to it as usual.
+	blocks_.InvalidateBlock(block_num);
+	blocks_.FinalizeBlock(trace_num);
+}
+
+bool IRJit::CompileTargetBlock(IRBlock *block, int block_num, bool preload) {
+	// No native code, but we can still skip decoding each instruction at runtime.
+	block->BuildThreaded(mips_);
+	return true;
+}
+
+void IRJit::PreloadCachedBlocks() {
+	PROFILE_THIS_SCOPE("jitc");
+
+	if (!diskCachePath_.Valid() || CBreakPoints::HasMemChecks())
+		return;
+
+	u64 stateKey = frontend_.GetCompileStateKey();
+	for (u32 em_address : diskCache_.GetAddresses()) {
+		// Like CompileFunction(), a real block may already be here.
+		if (MIPS_IS_RUNBLOCK(Memory::ReadUnchecked_U32(em_address)))
+			continue;
+
+		std::vector<IRInst> instructions;
+		u32 mipsBytes;
+		if (!diskCache_.Lookup(em_address, stateKey, instructions, mipsBytes))
+			continue;
+		if (CBreakPoints::RangeContainsBreakPoint(em_address, mipsBytes))
+			continue;
+
+		if (!AddBlock(em_address, instructions, mipsBytes, true)) {
+			// The rest will be compiled as they're run.
+			ERROR_LOG(JIT, "Ran out of block numbers while preloading cached blocks");
+			return;
+		}
+	}
+}
+
 void IRJit::CompileFunction(u32 start_address, u32 length) {
 	PROFILE_THIS_SCOPE("jitc");
 
@@ -221,23 +344,59 @@ void IRJit::RunLoopUntil(u64 globalticks) {
 		if (coreState != 0) {
 			break;
 		}
+
+		// The block we just ran, and the one its exit is linked to (if any.)
+		int prevBlock = -1;
+		int linkedBlock = -1;
 		while (mips_->downcount >= 0) {
-			u32 inst = Memory::ReadUnchecked_U32(mips_->pc);
-			u32 opcode = inst & 0xFF000000;
-			if (opcode == MIPS_EMUHACK_OPCODE) {
-				u32 data = inst & 0xFFFFFF;
-				IRBlock *block = blocks_.GetBlock(data);
-				u32 startPC = mips_->pc;
-				mips_->pc = IRInterpret(mips_, block->GetInstructions(), block->GetNumInstructions());
-				if (!Memory::IsValidAddress(mips_->pc) || (mips_->pc & 3) != 0) {
-					Core_ExecException(mips_->pc, startPC, ExecExceptionType::JUMP);
-					break;
+			int block_num = linkedBlock;
+			if (block_num == -1) {
+				u32 inst = Memory::ReadUnchecked_U32(mips_->pc);
+				u32 opcode = inst & 0xFF000000;
+				if (opcode != MIPS_EMUHACK_OPCODE) {
+					// RestoreRoundingMode(true);
+					Compile(mips_->pc);
+					// ApplyRoundingMode(true);
+					prevBlock = -1;
+					continue;
 				}
-			} else {
-				// RestoreRoundingMode(true);
-				Compile(mips_->pc);
-				// ApplyRoundingMode(true);
+				block_num = inst & 0xFFFFFF;
+				if (prevBlock != -1)
+					blocks_.LinkBlockExit(prevBlock, mips_->pc, block_num);
+			}
+
+			IRBlock *block = blocks_.GetBlock(block_num);
+			u32 startPC = mips_->pc;
+			const IRThreadedInst *threaded = block->GetThreadedInstructions();
+			{
+				// Lets faults from fastmem accesses in the block be handled like jit ones.
+				Memory::MemFaultInterpreterScope faultScope;
+				if (threaded)
+					mips_->pc = IRInterpretThreaded(mips_, threaded);
+				else
+					mips_->pc = IRInterpret(mips_, block->GetInstructions(), block->GetNumInstructions());
+			}
+			if (Memory::g_interpreterFaulted) {
+				// The block stopped at a bad access, and the exception was already raised.
+				Memory::g_interpreterFaulted = false;
+				break;
 			}
+			if (!Memory::IsValidAddress(mips_->pc) || (mips_->pc & 3) != 0) {
+				Core_ExecException(mips_->pc, startPC, ExecExceptionType::JUMP);
+				break;
+			}
+
+			// The block may have cleared the cache (for example, in a syscall.)
+			block = blocks_.GetBlock(block_num);
+			if (!block || block->RecordExit(mips_->pc)) {
+				if (block)
+					CompileTrace(block_num);
+				prevBlock = -1;
+				linkedBlock = -1;
+				continue;
+			}
+			prevBlock = block_num;
+			linkedBlock = block->GetLinkedBlock(mips_->pc);
 		}
 	}
 
@@ -268,6 +427,23 @@ void IRBlockCache::Clear() {
 	}
 	blocks_.clear();
 	byPage_.clear();
+	linkedFrom_.clear();
+}
+
+void IRBlockCache::InvalidateBlock(int i) {
+	// Anything linked here needs to go back through the emuhack op to find its replacement.
+	auto iter = linkedFrom_.find(i);
+	if (iter != linkedFrom_.end()) {
+		for (int from : iter->second)
+			blocks_[from].UnlinkExitsTo(i);
+		linkedFrom_.erase(iter);
+	}
+	blocks_[i].Destroy(i);
+}
+
+void IRBlockCache::LinkBlockExit(int from, u32 exitPC, int to) {
+	if (blocks_[to].IsValid() && blocks_[from].LinkExit(exitPC, to))
+		linkedFrom_[to].push_back(from);
 }
 
 void IRBlockCache::InvalidateICache(u32 address, u32 length) {
@@ -283,7 +459,7 @@ void IRBlockCache::InvalidateICache(u32 address, u32 length) {
 		for (int i : blocksInPage) {
 			if (blocks_[i].OverlapsRange(address, length)) {
 				// Not removing from the page, hopefully doesn't build up with small recompiles.
-				blocks_[i].Destroy(i);
+				InvalidateBlock(i);
 			}
 		}
 	}
@@ -413,6 +589,8 @@ void IRBlockCache::ComputeStats(BlockCacheStats &bcStats) const {
 	bcStats.minBloat = minBloat;
 	bcStats.maxBloat = maxBloat;
 	bcStats.avgBloat = totalBloat / (double)blocks_.size();
+	if (passStats_)
+		bcStats.passRemoved = *passStats_;
 }
 
 int IRBlockCache::GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly) const {
@@ -437,6 +615,66 @@ int IRBlockCache::GetBlockNumberFromStartAddress(u32 em_address, bool realBlocks
 	return best;
 }
 
+void IRBlock::FindExitLinks() {
+	links_.clear();
+	for (int i = 0; i < numInstructions_; ++i) {
+		switch (instr_[i].op) {
+		case IROp::ExitToConst:
+		case IROp::ExitToConstIfEq:
+		case IROp::ExitToConstIfNeq:
+		case IROp::ExitToConstIfGtZ:
+		case IROp::ExitToConstIfGeZ:
+		case IROp::ExitToConstIfLtZ:
+		case IROp::ExitToConstIfLeZ:
+		case IROp::ExitToConstIfFpTrue:
+		case IROp::ExitToConstIfFpFalse:
+		{
+			u32 target = instr_[i].constant;
+			auto matches = [&](const IRBlockLink &link) { return link.target == target; };
+			if (std::none_of(links_.begin(), links_.end(), matches))
+				links_.push_back({ target, -1 });
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+}
+
+bool IRBlock::LinkExit(u32 exitPC, int block) {
+	for (IRBlockLink &link : links_) {
+		if (link.target == exitPC) {
+			// Already linked, don't track it twice.
+			if (link.block == block)
+				return false;
+			link.block = block;
+			return true;
+		}
+	}
+	return false;
+}
+
+void IRBlock::UnlinkExitsTo(int block) {
+	for (IRBlockLink &link : links_) {
+		if (link.block == block)
+			link.block = -1;
+	}
+}
+
+IRBranchHint IRBlock::GetBranchHint() const {
+	// A trace's last exit isn't from the branch ending its first block.
+	if (isTrace_ || lastExitTarget_ == 0 || runCount_ < TRACE_MIN_RUNS)
+		return IRBranchHint::UNKNOWN;
+
+	// Only follow branches that almost always go the same way.
+	if (lastExitCount_ * 10 >= runCount_ * 9)
+		return IRBranchHint::TAKEN;
+	if (lastExitCount_ * 10 <= runCount_)
+		return IRBranchHint::NOT_TAKEN;
+	return IRBranchHint::UNKNOWN;
+}
+
 bool IRBlock::HasOriginalFirstOp() const {
 	return Memory::ReadUnchecked_U32(origAddr_) == origFirstOpcode_.encoding;
 }
@@ -473,22 +711,29 @@ void IRBlock::Destroy(int number) {
 
 u64 IRBlock::CalculateHash() const {
 	if (origAddr_) {
-		// This is unfortunate.  In case of emuhacks, we have to make a copy.
-		std::vector<u32> buffer;
-		buffer.resize(origSize_ / 4);
-		size_t pos = 0;
-		for (u32 off = 0; off < origSize_; off += 4) {
-			// Let's actually hash the replacement, if any.
-			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(origAddr_ + off, false);
-			buffer[pos++] = instr.encoding;
-		}
-
-		return XXH3_64bits(&buffer[0], origSize_);
+		return HashRange(origAddr_, origSize_);
 	}
 
 	return 0;
 }
 
+u64 IRBlock::HashRange(u32 addr, u32 size) {
+	if (size == 0)
+		return 0;
+
+	// This is unfortunate.  In case of emuhacks, we have to make a copy.
+	std::vector<u32> buffer;
+	buffer.resize(size / 4);
+	size_t pos = 0;
+	for (u32 off = 0; off < size; off += 4) {
+		// Let's actually hash the replacement, if any.
+		MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr + off, false);
+		buffer[pos++] = instr.encoding;
+	}
+
+	return XXH3_64bits(&buffer[0], size);
+}
+
 bool IRBlock::OverlapsRange(u32 addr, u32 size) const {
 	addr &= 0x3FFFFFFF;
 	u32 origAddr = origAddr_ & 0x3FFFFFFF;
@@ -26,7 +26,9 @@
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/IR/IRRegCache.h"
 #include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRDiskCache.h"
 #include "Core/MIPS/IR/IRFrontend.h"
+#include "Core/MIPS/IR/IRInterpreter.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
 
 #ifndef offsetof
@@ -35,6 +37,12 @@
 
 namespace MIPSComp {
 
+// A static exit from an IR block, and the block it leads to once resolved.
+struct IRBlockLink {
+	u32 target;
+	int block;
+};
+
 // TODO : Use arena allocators. For now let's just malloc.
 class IRBlock {
 public:
@@ -47,6 +55,13 @@ class IRBlock {
 		origSize_ = b.origSize_;
 		origFirstOpcode_ = b.origFirstOpcode_;
 		hash_ = b.hash_;
+		targetOffset_ = b.targetOffset_;
+		threaded_ = std::move(b.threaded_);
+		lastExitTarget_ = b.lastExitTarget_;
+		runCount_ = b.runCount_;
+		lastExitCount_ = b.lastExitCount_;
+		isTrace_ = b.isTrace_;
+		links_ = std::move(b.links_);
 		b.instr_ = nullptr;
 	}
 
@@ -60,9 +75,17 @@ class IRBlock {
 		if (!inst.empty()) {
 			memcpy(instr_, &inst[0], sizeof(IRInst) * inst.size());
 		}
+		// Blocks ending in a branch exit to the taken target last.
+		lastExitTarget_ = !inst.empty() && inst.back().op == IROp::ExitToConst ? inst.back().constant : 0;
+		FindExitLinks();
 	}
 
 	const IRInst *GetInstructions() const { return instr_; }
+	// Pre-decoded for IRInterpretThreaded(), or nullptr if not built.
+	const IRThreadedInst *GetThreadedInstructions() const { return threaded_.empty() ? nullptr : &threaded_[0]; }
+	void BuildThreaded(MIPSState *mips) {
+		IRBuildThreaded(mips, instr_, numInstructions_, threaded_);
+	}
 	int GetNumInstructions() const { return numInstructions_; }
 	MIPSOpcode GetOriginalFirstOp() const { return origFirstOpcode_; }
 	bool HasOriginalFirstOp() const;
@@ -78,32 +101,87 @@ class IRBlock {
 		return origAddr_ && hash_ == CalculateHash();
 	}
 	bool OverlapsRange(u32 addr, u32 size) const;
+	// Hash of the MIPS code in a range, as used by UpdateHash().
+	static u64 HashRange(u32 addr, u32 size);
 
 	void GetRange(u32 &start, u32 &size) const {
 		start = origAddr_;
 		size = origSize_;
 	}
 
+	// Offset into the native code space when a backend has compiled this block, or -1.
+	int GetTargetOffset() const { return targetOffset_; }
+	void SetTargetOffset(int offset) {
+		targetOffset_ = offset;
+	}
+
+	// Exit profile for trace formation.  Returns true when the block has just become hot.
+	bool RecordExit(u32 exitPC) {
+		if (runCount_ >= TRACE_HOT_RUNS)
+			return false;
+		if (exitPC == lastExitTarget_)
+			lastExitCount_++;
+		return ++runCount_ == TRACE_HOT_RUNS;
+	}
+	IRBranchHint GetBranchHint() const;
+
+	// Block number this exits to directly, or -1 if not linked (or not a static exit.)
+	int GetLinkedBlock(u32 exitPC) const {
+		for (const IRBlockLink &link : links_) {
+			if (link.target == exitPC)
+				return link.block;
+		}
+		return -1;
+	}
+	bool LinkExit(u32 exitPC, int block);
+	void UnlinkExitsTo(int block);
+
+	bool IsTrace() const { return isTrace_; }
+	void SetTrace(bool trace) {
+		isTrace_ = trace;
+	}
+
 	void Finalize(int number);
 	void Destroy(int number);
 
+	enum {
+		// Runs before we consider forming a trace starting at this block.
+		TRACE_HOT_RUNS = 1000,
+		// Runs before a block's profile is used as a hint when passing through it.
+		TRACE_MIN_RUNS = 50,
+	};
+
 private:
 	u64 CalculateHash() const;
+	void FindExitLinks();
 
 	IRInst *instr_;
 	u16 numInstructions_;
 	u32 origAddr_;
 	u32 origSize_;
 	u64 hash_ = 0;
+	int targetOffset_ = -1;
+	std::vector<IRThreadedInst> threaded_;
+	u32 lastExitTarget_ = 0;
+	u32 runCount_ = 0;
+	u32 lastExitCount_ = 0;
+	bool isTrace_ = false;
+	std::vector<IRBlockLink> links_;
 	MIPSOpcode origFirstOpcode_ = MIPSOpcode(0x68FFFFFF);
 };
 
 class IRBlockCache : public JitBlockCacheDebugInterface {
 public:
 	IRBlockCache() {}
+	// Included in ComputeStats(), if set.
+	void SetPassStats(const IRPassStats *stats) {
+		passStats_ = stats;
+	}
 	void Clear();
 	void InvalidateICache(u32 address, u32 length);
 	void FinalizeBlock(int i, bool preload = false);
+	void InvalidateBlock(int i);
+	void LinkBlockExit(int from, u32 exitPC, int to);
 	int GetNumBlocks() const override { return (int)blocks_.size(); }
 	int AllocateBlock(int emAddr) {
 		blocks_.push_back(IRBlock(emAddr));
@@ -131,6 +209,18 @@ class IRBlockCache : public JitBlockCacheDebugInterface {
 
 	std::vector<IRBlock> blocks_;
 	std::unordered_map<u32, std::vector<int>> byPage_;
+	// Which blocks link to each block, so they can be unlinked when it's invalidated.
+	std::unordered_map<int, std::vector<int>> linkedFrom_;
+	const IRPassStats *passStats_ = nullptr;
+};
+
+// Implemented by the backends that turn IR blocks into native code.
+class IRToNativeInterface {
+public:
+	virtual ~IRToNativeInterface() {}
+
+	// Returns the entry point of the generated code.
+	virtual const u8 *ConvertIRToNative(const IRInst *instructions, int count) = 0;
 };
 
 class IRJit : public JitInterface {
@@ -146,6 +236,7 @@ class IRJit : public JitInterface {
 
 	void Compile(u32 em_address) override;	// Compiles a block at current MIPS PC
 	void CompileFunction(u32 start_address, u32 length) override;
+	void PreloadCachedBlocks() override;
 
 	bool DescribeCodePtr(const u8 *ptr, std::string &name) override;
 	// Not using a regular block cache.
@@ -170,14 +261,23 @@ class IRJit : public JitInterface {
 	void LinkBlock(u8 *exitPoint, const u8 *checkedEntry) override;
 	void UnlinkBlock(u8 *checkedEntry, u32 originalAddress) override;
 
-private:
+protected:
 	bool CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	bool AddBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, bool preload);
+	void CompileTrace(int block_num);
 	bool ReplaceJalTo(u32 dest);
 
+	// Hook for backends that lower IR blocks to native code. Return false if out of space,
+	// in which case the whole cache is cleared and the block compiled again.
+	// By default, this prepares the block for IRInterpretThreaded().
+	virtual bool CompileTargetBlock(IRBlock *block, int block_num, bool preload);
+
 	JitOptions jo;
 
 	IRFrontend frontend_;
 	IRBlockCache blocks_;
+	IRDiskCache diskCache_;
+	Path diskCachePath_;
 
 	MIPSState *mips_;
 
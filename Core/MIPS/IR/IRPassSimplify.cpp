@@ -84,9 +84,41 @@ IROp ShiftToShiftImm(IROp op) {
 	}
 }
 
-bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWriter &out, const IROptions &opts) {
+const char *IRPassName(IRPassFunc pass) {
+	static const struct {
+		IRPassFunc pass;
+		const char *name;
+	} names[] = {
+		{ &RemoveLoadStoreLeftRight, "RemoveLoadStoreLeftRight" },
+		{ &PropagateConstants, "PropagateConstants" },
+		{ &PurgeTemps, "PurgeTemps" },
+		{ &ReduceLoads, "ReduceLoads" },
+		{ &ThreeOpToTwoOp, "ThreeOpToTwoOp" },
+		{ &OptimizeFPMoves, "OptimizeFPMoves" },
+		{ &ReorderLoadStore, "ReorderLoadStore" },
+		{ &MergeLoadStore, "MergeLoadStore" },
+		{ &RemoveDeadWrites, "RemoveDeadWrites" },
+		{ &RemoveRedundantStores, "RemoveRedundantStores" },
+		{ &CombineVec4Lanes, "CombineVec4Lanes" },
+		{ &ApplyMemoryValidation, "ApplyMemoryValidation" },
+	};
+	for (const auto &entry : names) {
+		if (entry.pass == pass)
+			return entry.name;
+	}
+	return "Unknown";
+}
+
+static bool ApplyPass(IRPassFunc pass, const IRWriter &in, IRWriter &out, const IROptions &opts, IRPassStats *stats) {
+	bool logBlocks = pass(in, out, opts);
+	if (stats)
+		(*stats)[IRPassName(pass)] += (int)in.GetInstructions().size() - (int)out.GetInstructions().size();
+	return logBlocks;
+}
+
+bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWriter &out, const IROptions &opts, IRPassStats *stats) {
 	if (c == 1) {
-		return passes[0](in, out, opts);
+		return ApplyPass(passes[0], in, out, opts, stats);
 	}
 
 	bool logBlocks = false;
@@ -95,7 +127,7 @@ bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWri
 	const IRWriter *nextIn = &in;
 	IRWriter *nextOut = &temp[1];
 	for (size_t i = 0; i < c - 1; ++i) {
-		if (passes[i](*nextIn, *nextOut, opts)) {
+		if (ApplyPass(passes[i], *nextIn, *nextOut, opts, stats)) {
 			logBlocks = true;
 		}
 
@@ -103,7 +135,7 @@ bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWri
 		nextIn = &temp[0];
 	}
 
-	if (passes[c - 1](*nextIn, out, opts)) {
+	if (ApplyPass(passes[c - 1], *nextIn, out, opts, stats)) {
 		logBlocks = true;
 	}
 
@@ -734,6 +766,7 @@ bool PropagateConstants(const IRWriter &in, IRWriter &out, const IROptions &opts
 		case IROp::CallReplacement:
 		case IROp::Break:
 		case IROp::Syscall:
+		case IROp::SyscallInline:
 		case IROp::Interpret:
 		case IROp::ExitToConst:
 		case IROp::ExitToReg:
@@ -773,7 +806,7 @@ bool IRReadsFromGPR(const IRInst &inst, int reg, bool directly = false) {
 		return true;
 	}
 	if (!directly) {
-		if (inst.op == IROp::Interpret || inst.op == IROp::CallReplacement || inst.op == IROp::Syscall || inst.op == IROp::Break)
+		if (inst.op == IROp::Interpret || inst.op == IROp::CallReplacement || inst.op == IROp::Syscall || inst.op == IROp::SyscallInline || inst.op == IROp::Break)
 			return true;
 		if (inst.op == IROp::Breakpoint || inst.op == IROp::MemoryCheck)
 			return true;
@@ -1496,3 +1529,360 @@ bool ApplyMemoryValidation(const IRWriter &in, IRWriter &out, const IROptions &o
 	}
 	return logBlocks;
 }
+
+static IROp Vec4OpForLaneOp(IROp op) {
+	switch (op) {
+	case IROp::FAdd: return IROp::Vec4Add;
+	case IROp::FSub: return IROp::Vec4Sub;
+	// Not FMul: it gives the PSP's NaN for inf * 0, which Vec4Mul/Vec4Scale don't.
+	case IROp::FDiv: return IROp::Vec4Div;
+	case IROp::FMov: return IROp::Vec4Mov;
+	case IROp::FNeg: return IROp::Vec4Neg;
+	case IROp::FAbs: return IROp::Vec4Abs;
+	default: return IROp::Nop;
+	}
+}
+
+static inline bool IsVec4Base(u8 reg) {
+	// Vec4 ops use aligned loads, and must stay within v[] or the vfpu temps.
+	// In between are t[] and vfpuCtrl, which must not be combined with anything.
+	if ((reg & 3) != 0)
+		return false;
+	return (reg >= 32 && reg + 4 <= 32 + 128) || reg == IRVTEMP_0;
+}
+
+// Checks if insts[0..3] do the same FP op on each lane of aligned vectors, so a Vec4 op can do it.
+// Returns the Vec4 op, or Nop if they can't be combined.
+static IROp MatchVec4Lanes(const IRInst *insts) {
+	IROp vecOp = Vec4OpForLaneOp(insts[0].op);
+	if (vecOp == IROp::Nop)
+		return IROp::Nop;
+	const IRInst &first = insts[0];
+	bool binary = GetIRMeta(first.op)->types[2] != '\0';
+	if (!IsVec4Base(first.dest) || !IsVec4Base(first.src1))
+		return IROp::Nop;
+	if (binary && !IsVec4Base(first.src2))
+		return IROp::Nop;
+
+	for (int i = 1; i < 4; ++i) {
+		const IRInst &inst = insts[i];
+		if (inst.op != first.op || inst.dest != first.dest + i || inst.src1 != first.src1 + i)
+			return IROp::Nop;
+		if (binary && inst.src2 != first.src2 + i)
+			return IROp::Nop;
+	}
+
+	// Since all the bases are aligned, lanes can't otherwise read what another lane writes.
+	return vecOp;
+}
+
+bool CombineVec4Lanes(const IRWriter &in, IRWriter &out, const IROptions &opts) {
+	CONDITIONAL_DISABLE;
+
+	const std::vector<IRInst> &insts = in.GetInstructions();
+	bool logBlocks = false;
+	for (int i = 0; i < (int)insts.size(); ++i) {
+		IROp vecOp = i + 3 < (int)insts.size() ? MatchVec4Lanes(&insts[i]) : IROp::Nop;
+		if (vecOp == IROp::Nop) {
+			out.Write(insts[i]);
+			continue;
+		}
+
+		IRInst inst = insts[i];
+		inst.op = vecOp;
+		out.Write(inst);
+		i += 3;
+	}
+	return logBlocks;
+}
+
+// IR GPRs and FPRs are both offsets into MIPSState, FPRs starting at f[0], so this maps both into
+// one space to catch aliasing.
+static const int DEAD_SLOTS = 256 + 32;
+
+static inline int FPRSlot(u8 reg) {
+	return reg + 32;
+}
+
+static inline bool IsTrackedSlot(int slot) {
+	// Everything from vfpuCtrl on (except vt[]) may be read implicitly, so is always live.
+	return slot < IRREG_VFPU_CTRL_BASE || (slot >= FPRSlot(IRVTEMP_PFX_S) && slot < FPRSlot(IRVTEMP_0 + 4));
+}
+
+// Ops that only write their dest (fully), and only read their listed operands.
+static bool IsPureWrite(IROp op) {
+	switch (op) {
+	case IROp::SetConst:
+	case IROp::SetConstF:
+	case IROp::Mov:
+	case IROp::Add:
+	case IROp::Sub:
+	case IROp::Neg:
+	case IROp::Not:
+	case IROp::And:
+	case IROp::Or:
+	case IROp::Xor:
+	case IROp::AddConst:
+	case IROp::SubConst:
+	case IROp::AndConst:
+	case IROp::OrConst:
+	case IROp::XorConst:
+	case IROp::Shl:
+	case IROp::Shr:
+	case IROp::Sar:
+	case IROp::Ror:
+	case IROp::ShlImm:
+	case IROp::ShrImm:
+	case IROp::SarImm:
+	case IROp::RorImm:
+	case IROp::Slt:
+	case IROp::SltConst:
+	case IROp::SltU:
+	case IROp::SltUConst:
+	case IROp::Clz:
+	case IROp::Max:
+	case IROp::Min:
+	case IROp::BSwap16:
+	case IROp::BSwap32:
+	case IROp::Ext8to32:
+	case IROp::Ext16to32:
+	case IROp::ReverseBits:
+	case IROp::FAdd:
+	case IROp::FSub:
+	case IROp::FMul:
+	case IROp::FDiv:
+	case IROp::FMin:
+	case IROp::FMax:
+	case IROp::FMov:
+	case IROp::FSqrt:
+	case IROp::FSin:
+	case IROp::FCos:
+	case IROp::FRSqrt:
+	case IROp::FRecip:
+	case IROp::FAsin:
+	case IROp::FNeg:
+	case IROp::FSign:
+	case IROp::FAbs:
+	case IROp::FRound:
+	case IROp::FTrunc:
+	case IROp::FCeil:
+	case IROp::FFloor:
+	case IROp::FCvtWS:
+	case IROp::FCvtSW:
+	case IROp::FSat0_1:
+	case IROp::FSatMinus1_1:
+	case IROp::FMovFromGPR:
+	case IROp::FMovToGPR:
+	case IROp::Vec4Init:
+	case IROp::Vec4Shuffle:
+	case IROp::Vec4Mov:
+	case IROp::Vec4Add:
+	case IROp::Vec4Sub:
+	case IROp::Vec4Mul:
+	case IROp::Vec4Div:
+	case IROp::Vec4Scale:
+	case IROp::Vec4Dot:
+	case IROp::Vec4Neg:
+	case IROp::Vec4Abs:
+	case IROp::Vec2Unpack16To31:
+	case IROp::Vec2Unpack16To32:
+	case IROp::Vec4Unpack8To32:
+	case IROp::Vec4DuplicateUpperBitsAndShift1:
+	case IROp::Vec4ClampToZero:
+	case IROp::Vec2ClampToZero:
+	case IROp::Vec4Pack32To8:
+	case IROp::Vec4Pack31To8:
+	case IROp::Vec2Pack32To16:
+	case IROp::Vec2Pack31To16:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Ops with side effects that still always overwrite their dest.
+static bool AlwaysWritesDest(IROp op) {
+	switch (op) {
+	case IROp::Load8:
+	case IROp::Load8Ext:
+	case IROp::Load16:
+	case IROp::Load16Ext:
+	case IROp::Load32:
+	case IROp::LoadFloat:
+	case IROp::LoadVec4:
+	case IROp::MfLo:
+	case IROp::MfHi:
+	case IROp::FpCondToReg:
+	case IROp::VfpuCtrlToReg:
+		return true;
+	default:
+		return IsPureWrite(op);
+	}
+}
+
+// Anything that may read any register, including leaving the block.
+static bool IsLivenessBarrier(const IRInst &inst) {
+	if ((GetIRMeta(inst.op)->flags & IRFLAG_EXIT) != 0)
+		return true;
+	return inst.op == IROp::Interpret || inst.op == IROp::CallReplacement;
+}
+
+static int AddSlots(char type, u8 reg, int *slots) {
+	switch (type) {
+	case 'G':
+		slots[0] = reg;
+		return 1;
+	case 'F':
+		slots[0] = FPRSlot(reg);
+		return 1;
+	case '2':
+	case 'V':
+		for (int i = 0; i < (type == 'V' ? 4 : 2); ++i)
+			slots[i] = FPRSlot(reg) + i;
+		return type == 'V' ? 4 : 2;
+	default:
+		return 0;
+	}
+}
+
+bool RemoveDeadWrites(const IRWriter &in, IRWriter &out, const IROptions &opts) {
+	CONDITIONAL_DISABLE;
+
+	const std::vector<IRInst> &insts = in.GetInstructions();
+	std::vector<bool> keep(insts.size(), true);
+	bool live[DEAD_SLOTS];
+	std::fill(live, live + DEAD_SLOTS, true);
+
+	for (int i = (int)insts.size() - 1; i >= 0; --i) {
+		const IRInst &inst = insts[i];
+		if (IsLivenessBarrier(inst)) {
+			std::fill(live, live + DEAD_SLOTS, true);
+			continue;
+		}
+
+		const IRMeta *m = GetIRMeta(inst.op);
+		int writes[4], reads[12];
+		int numWrites = 0, numReads = 0;
+		if ((m->flags & IRFLAG_SRC3) != 0) {
+			numReads += AddSlots(m->types[0], inst.src3, reads);
+		} else {
+			numWrites = AddSlots(m->types[0], inst.dest, writes);
+			if ((m->flags & IRFLAG_SRC3DST) != 0)
+				numReads += AddSlots(m->types[0], inst.dest, reads);
+		}
+		if (m->types[0] != '\0' && m->types[1] != '\0') {
+			numReads += AddSlots(m->types[1], inst.src1, reads + numReads);
+			if (m->types[2] != '\0')
+				numReads += AddSlots(m->types[2], inst.src2, reads + numReads);
+		}
+
+		if (numWrites != 0 && IsPureWrite(inst.op) && (m->flags & IRFLAG_SRC3DST) == 0) {
+			bool dead = true;
+			for (int j = 0; j < numWrites; ++j) {
+				if (!IsTrackedSlot(writes[j]) || live[writes[j]])
+					dead = false;
+			}
+			if (dead) {
+				keep[i] = false;
+				continue;
+			}
+		}
+
+		if (AlwaysWritesDest(inst.op) && (m->flags & IRFLAG_SRC3DST) == 0) {
+			for (int j = 0; j < numWrites; ++j)
+				live[writes[j]] = false;
+		}
+		for (int j = 0; j < numReads; ++j)
+			live[reads[j]] = true;
+	}
+
+	for (size_t i = 0; i < insts.size(); ++i) {
+		if (keep[i])
+			out.Write(insts[i]);
+	}
+	return false;
+}
+
+static int StoreSize(IROp op) {
+	switch (op) {
+	case IROp::Store8: return 1;
+	case IROp::Store16: return 2;
+	case IROp::Store32: return 4;
+	case IROp::StoreFloat: return 4;
+	case IROp::StoreVec4: return 16;
+	default: return 0;
+	}
+}
+
+static bool IsLoad(IROp op) {
+	switch (op) {
+	case IROp::Load8:
+	case IROp::Load8Ext:
+	case IROp::Load16:
+	case IROp::Load16Ext:
+	case IROp::Load32:
+	case IROp::Load32Left:
+	case IROp::Load32Right:
+	case IROp::LoadFloat:
+	case IROp::LoadVec4:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool RemoveRedundantStores(const IRWriter &in, IRWriter &out, const IROptions &opts) {
+	CONDITIONAL_DISABLE;
+
+	struct LaterStore {
+		u8 base;
+		// Offsets are signed, and shouldn't wrap when adding the size.
+		s64 offset;
+		int size;
+	};
+
+	// Walking backwards, these are the stores that will overwrite memory before anything reads it.
+	const std::vector<IRInst> &insts = in.GetInstructions();
+	std::vector<bool> keep(insts.size(), true);
+	std::vector<LaterStore> later;
+
+	for (int i = (int)insts.size() - 1; i >= 0; --i) {
+		const IRInst &inst = insts[i];
+		int size = StoreSize(inst.op);
+		if (size != 0) {
+			const s64 offset = (s64)(s32)inst.constant;
+			bool covered = false;
+			for (const LaterStore &store : later) {
+				if (store.base == inst.src1 && store.offset <= offset && offset + size <= store.offset + store.size)
+					covered = true;
+			}
+			if (covered) {
+				keep[i] = false;
+			} else {
+				later.push_back({ inst.src1, offset, size });
+			}
+			continue;
+		}
+
+		if (IsLoad(inst.op) || IsLivenessBarrier(inst)) {
+			// Loads, and anything that might load.
+			later.clear();
+			continue;
+		}
+
+		const IRMeta *m = GetIRMeta(inst.op);
+
+		// Earlier code sees a different base register value.
+		if (m->types[0] == 'G' && (m->flags & IRFLAG_SRC3) == 0) {
+			later.erase(std::remove_if(later.begin(), later.end(), [&](const LaterStore &store) {
+				return store.base == inst.dest;
+			}), later.end());
+		}
+	}
+
+	for (size_t i = 0; i < insts.size(); ++i) {
+		if (keep[i])
+			out.Write(insts[i]);
+	}
+	return false;
+}
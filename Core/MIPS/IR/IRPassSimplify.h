@@ -1,9 +1,17 @@
 #pragma once
 
+#include <map>
+#include <string>
+
 #include "Core/MIPS/IR/IRInst.h"
 
 typedef bool (*IRPassFunc)(const IRWriter &in, IRWriter &out, const IROptions &opts);
-bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWriter &out, const IROptions &opts);
+
+// Instructions removed by each pass, by name.  Negative for passes that add instructions.
+typedef std::map<std::string, int> IRPassStats;
+
+bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWriter &out, const IROptions &opts, IRPassStats *stats = nullptr);
+const char *IRPassName(IRPassFunc pass);
 
 // Block optimizer passes of varying usefulness.
 bool RemoveLoadStoreLeftRight(const IRWriter &in, IRWriter &out, const IROptions &opts);
@@ -14,4 +22,7 @@ bool ThreeOpToTwoOp(const IRWriter &in, IRWriter &out, const IROptions &opts);
 bool OptimizeFPMoves(const IRWriter &in, IRWriter &out, const IROptions &opts);
 bool ReorderLoadStore(const IRWriter &in, IRWriter &out, const IROptions &opts);
 bool MergeLoadStore(const IRWriter &in, IRWriter &out, const IROptions &opts);
+bool RemoveDeadWrites(const IRWriter &in, IRWriter &out, const IROptions &opts);
+bool RemoveRedundantStores(const IRWriter &in, IRWriter &out, const IROptions &opts);
+bool CombineVec4Lanes(const IRWriter &in, IRWriter &out, const IROptions &opts);
 bool ApplyMemoryValidation(const IRWriter &in, IRWriter &out, const IROptions &opts);
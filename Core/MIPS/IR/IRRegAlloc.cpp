@@ -0,0 +1,304 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/Log.h"
+#include "Core/MIPS/IR/IRRegAlloc.h"
+
+// The IR register numbers are offsets into MIPSState, so GPRs and FPRs overlap past the normal
+// registers (the GPR temps are in t[], and both can reach vfpuCtrl.)  We only allocate the
+// ranges that can't alias, everything else is always accessed in memory.
+bool IRRegAllocator::IsAllocatableGPR(int r) {
+	return r < IRREG_VFPU_CTRL_BASE;
+}
+
+bool IRRegAllocator::IsAllocatableFPR(int r) {
+	// f[], v[], and the vfpu temps in vt[].
+	return r < 32 + 128 || (r >= IRVTEMP_PFX_S && r < IRVTEMP_0 + 4);
+}
+
+static bool IsBuiltinBarrier(const IRInst &inst) {
+	switch (inst.op) {
+	case IROp::Interpret:
+	case IROp::CallReplacement:
+	case IROp::Syscall:
+	case IROp::SyscallInline:
+	case IROp::Break:
+	case IROp::Breakpoint:
+	case IROp::MemoryCheck:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static inline bool IsBarrier(const IRInst &inst, const IRRegAllocConfig &config) {
+	return IsBuiltinBarrier(inst) || (config.isBarrier && config.isBarrier(inst));
+}
+
+static inline bool IsSync(const IRInst &inst) {
+	return (GetIRMeta(inst.op)->flags & IRFLAG_EXIT) != 0;
+}
+
+namespace {
+
+struct Access {
+	u8 reg;
+	bool fpr;
+	bool read;
+	bool write;
+};
+
+}
+
+// Gathers the allocatable registers an instruction touches (through its operands only.)
+static int GetAccesses(const IRInst &inst, const bool *excludedFPRs, Access accesses[3]) {
+	const IRMeta *m = GetIRMeta(inst.op);
+	int n = 0;
+	auto add = [&](char type, u8 reg, bool read, bool write) {
+		if (type == 'G' && IRRegAllocator::IsAllocatableGPR(reg)) {
+			accesses[n++] = { reg, false, read, write };
+		} else if (type == 'F' && IRRegAllocator::IsAllocatableFPR(reg) && !excludedFPRs[reg]) {
+			accesses[n++] = { reg, true, read, write };
+		}
+	};
+
+	if ((m->flags & IRFLAG_SRC3) != 0)
+		add(m->types[0], inst.src3, true, false);
+	else if ((m->flags & IRFLAG_SRC3DST) != 0)
+		add(m->types[0], inst.dest, true, true);
+	else if (m->types[0] != '\0')
+		add(m->types[0], inst.dest, false, true);
+	if (m->types[0] != '\0' && m->types[1] != '\0') {
+		add(m->types[1], inst.src1, true, false);
+		if (m->types[2] != '\0')
+			add(m->types[2], inst.src2, true, false);
+	}
+
+	// Merge duplicates, like a read and write of the same register.
+	for (int i = 1; i < n; ++i) {
+		for (int j = 0; j < i; ++j) {
+			if (accesses[j].reg == accesses[i].reg && accesses[j].fpr == accesses[i].fpr) {
+				accesses[j].read = accesses[j].read || accesses[i].read;
+				accesses[j].write = accesses[j].write || accesses[i].write;
+				accesses[i] = accesses[--n];
+				--i;
+				break;
+			}
+		}
+	}
+	return n;
+}
+
+static void ExcludeVectorFPRs(const IRInst *insts, int count, bool *excludedFPRs) {
+	for (int i = 0; i < count; ++i) {
+		const IRMeta *m = GetIRMeta(insts[i].op);
+		const u8 regs[3] = { insts[i].dest, insts[i].src1, insts[i].src2 };
+		for (int slot = 0; slot < 3 && m->types[slot] != '\0'; ++slot) {
+			int size = m->types[slot] == 'V' ? 4 : (m->types[slot] == '2' ? 2 : 0);
+			for (int j = 0; j < size && regs[slot] + j < 256; ++j)
+				excludedFPRs[regs[slot] + j] = true;
+		}
+	}
+}
+
+void IRRegAllocator::BuildIntervals(const IRInst *insts, int count, const IRRegAllocConfig &config) {
+	bool excludedFPRs[256]{};
+	ExcludeVectorFPRs(insts, count, excludedFPRs);
+
+	int open[2][256];
+	memset(open, -1, sizeof(open));
+
+	for (int i = 0; i < count; ++i) {
+		if (IsBarrier(insts[i], config)) {
+			// Nothing stays mapped across a barrier, and its own operands use memory.
+			memset(open, -1, sizeof(open));
+			continue;
+		}
+
+		Access accesses[3];
+		int n = GetAccesses(insts[i], excludedFPRs, accesses);
+		for (int j = 0; j < n; ++j) {
+			const Access &a = accesses[j];
+			int &index = open[a.fpr ? 1 : 0][a.reg];
+			if (index == -1) {
+				index = (int)intervals_.size();
+				intervals_.push_back({ i, i, a.reg, a.fpr, a.read, NO_REG });
+			} else {
+				intervals_[index].end = i;
+			}
+		}
+	}
+}
+
+void IRRegAllocator::ScanClass(bool fpr, int numRegs) {
+	// Classic linear scan: intervals are already ordered by start.
+	std::vector<int> active;
+	std::vector<bool> freeRegs(numRegs, true);
+
+	for (int index = 0; index < (int)intervals_.size(); ++index) {
+		Interval &cur = intervals_[index];
+		if (cur.fpr != fpr)
+			continue;
+
+		// Expire anything that ended before this starts.
+		for (size_t j = 0; j < active.size(); ) {
+			const Interval &a = intervals_[active[j]];
+			if (a.end < cur.start) {
+				freeRegs[a.hostReg] = true;
+				active.erase(active.begin() + j);
+			} else {
+				++j;
+			}
+		}
+
+		int reg = NO_REG;
+		for (int r = 0; r < numRegs; ++r) {
+			if (freeRegs[r]) {
+				reg = r;
+				break;
+			}
+		}
+
+		if (reg == NO_REG && !active.empty()) {
+			// Steal from whichever lives longest, if that's longer than this one.
+			auto furthest = std::max_element(active.begin(), active.end(), [&](int a, int b) {
+				return intervals_[a].end < intervals_[b].end;
+			});
+			Interval &victim = intervals_[*furthest];
+			if (victim.end > cur.end) {
+				reg = victim.hostReg;
+				victim.hostReg = NO_REG;
+				active.erase(furthest);
+			}
+		}
+
+		if (reg != NO_REG) {
+			cur.hostReg = (s8)reg;
+			freeRegs[reg] = false;
+			active.push_back(index);
+		}
+	}
+}
+
+void IRRegAllocator::BuildActions(const IRInst *insts, int count, const IRRegAllocConfig &config) {
+	bool excludedFPRs[256]{};
+	ExcludeVectorFPRs(insts, count, excludedFPRs);
+
+	std::vector<int> live;
+	std::vector<bool> dirty(intervals_.size(), false);
+	s8 hostFor[2][256];
+	memset(hostFor, NO_REG, sizeof(hostFor));
+
+	size_t nextStart = 0;
+	for (int i = 0; i <= count; ++i) {
+		actionStart_[i] = (int)actions_.size();
+		bool sync = i == count || IsSync(insts[i]);
+
+		// First, write back anything that ended, and at exits, anything that's dirty.
+		for (size_t j = 0; j < live.size(); ) {
+			Interval &interval = intervals_[live[j]];
+			bool ended = interval.end < i;
+			if ((ended || sync) && dirty[live[j]]) {
+				actions_.push_back({ IRRegAllocActionType::STORE, interval.fpr, interval.irReg, (u8)interval.hostReg });
+				dirty[live[j]] = false;
+				stats_.stores++;
+			}
+			if (ended) {
+				hostFor[interval.fpr ? 1 : 0][interval.irReg] = NO_REG;
+				live.erase(live.begin() + j);
+			} else {
+				++j;
+			}
+		}
+
+		// Then load anything starting here that needs its old value.
+		while (nextStart < intervals_.size() && intervals_[nextStart].start == i) {
+			const Interval &interval = intervals_[nextStart];
+			if (interval.hostReg != NO_REG) {
+				if (interval.loadFirst) {
+					actions_.push_back({ IRRegAllocActionType::LOAD, interval.fpr, interval.irReg, (u8)interval.hostReg });
+					stats_.loads++;
+				}
+				hostFor[interval.fpr ? 1 : 0][interval.irReg] = interval.hostReg;
+				live.push_back((int)nextStart);
+			}
+			nextStart++;
+		}
+
+		if (i == count)
+			break;
+
+		const IRInst &inst = insts[i];
+		Operands &ops = operands_[i];
+		ops = { NO_REG, NO_REG, NO_REG };
+		if (IsBarrier(inst, config))
+			continue;
+
+		const IRMeta *m = GetIRMeta(inst.op);
+		auto lookup = [&](char type, u8 reg) -> s8 {
+			if (type == 'G' && IsAllocatableGPR(reg))
+				return hostFor[0][reg];
+			if (type == 'F' && IsAllocatableFPR(reg) && !excludedFPRs[reg])
+				return hostFor[1][reg];
+			return NO_REG;
+		};
+		if (m->types[0] != '\0') {
+			ops.dest = lookup(m->types[0], inst.dest);
+			if (m->types[1] != '\0') {
+				ops.src1 = lookup(m->types[1], inst.src1);
+				if (m->types[2] != '\0')
+					ops.src2 = lookup(m->types[2], inst.src2);
+			}
+		}
+
+		// Track what needs storing later.
+		if (ops.dest != NO_REG && (m->flags & IRFLAG_SRC3) == 0) {
+			for (int index : live) {
+				const Interval &interval = intervals_[index];
+				if (interval.hostReg == ops.dest && interval.fpr == (m->types[0] == 'F'))
+					dirty[index] = true;
+			}
+		}
+	}
+
+	_dbg_assert_(live.empty());
+}
+
+void IRRegAllocator::Allocate(const IRInst *insts, int count, const IRRegAllocConfig &config) {
+	intervals_.clear();
+	actions_.clear();
+	operands_.resize(count);
+	actionStart_.resize(count + 2);
+	stats_ = {};
+
+	BuildIntervals(insts, count, config);
+	ScanClass(false, config.numGPRs);
+	ScanClass(true, config.numFPRs);
+	BuildActions(insts, count, config);
+	// ActionsEnd(count) needs one more.
+	actionStart_[count + 1] = (int)actions_.size();
+
+	stats_.intervals = (int)intervals_.size();
+	for (const Interval &interval : intervals_) {
+		if (interval.hostReg != NO_REG)
+			stats_.allocated++;
+	}
+	stats_.spilled = stats_.intervals - stats_.allocated;
+}
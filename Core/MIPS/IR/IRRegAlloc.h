@@ -0,0 +1,116 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/MIPS/IR/IRInst.h"
+
+// Linear scan register allocation over an IR block, for IR->native backends.
+//
+// Unlike IRRegCache (which only tracks constants while building IR), this looks at a finished
+// block and decides which IR registers should live in host registers, and where they need to be
+// loaded from and stored back to MIPSState.  Host registers are plain indices; each backend maps
+// them onto its own register set.
+//
+// The block is split into regions at barriers (instructions that may read or write any register,
+// like Interpret or anything the backend calls out for.)  Values never stay in host registers
+// across a barrier, and dirty values are stored before any exit, so MIPSState is always up to
+// date when leaving the block.
+
+enum class IRRegAllocActionType : u8 {
+	// Store the host register back to MIPSState.
+	STORE,
+	// Load the host register from MIPSState.
+	LOAD,
+};
+
+struct IRRegAllocAction {
+	IRRegAllocActionType type;
+	bool fpr;
+	u8 irReg;
+	u8 hostReg;
+};
+
+struct IRRegAllocConfig {
+	int numGPRs = 0;
+	int numFPRs = 0;
+	// Optional. Return true for instructions the backend can't run with mapped registers.
+	bool (*isBarrier)(const IRInst &inst) = nullptr;
+};
+
+struct IRRegAllocStats {
+	int intervals;
+	int allocated;
+	int spilled;
+	int loads;
+	int stores;
+};
+
+class IRRegAllocator {
+public:
+	enum {
+		NO_REG = -1,
+	};
+
+	void Allocate(const IRInst *insts, int count, const IRRegAllocConfig &config);
+
+	// Host register for each operand of instruction i, or NO_REG to use MIPSState directly.
+	// Dest covers src3 too, for the instructions that use it.
+	int DestReg(int i) const { return operands_[i].dest; }
+	int Src1Reg(int i) const { return operands_[i].src1; }
+	int Src2Reg(int i) const { return operands_[i].src2; }
+
+	// Loads and stores to perform (in order) before instruction i.  Stores always come first.
+	// Also valid for i == count, for anything that needs to happen after the last instruction.
+	const IRRegAllocAction *ActionsBegin(int i) const { return actions_.data() + actionStart_[i]; }
+	const IRRegAllocAction *ActionsEnd(int i) const { return actions_.data() + actionStart_[i + 1]; }
+
+	const IRRegAllocStats &GetStats() const { return stats_; }
+
+	static bool IsAllocatableGPR(int r);
+	static bool IsAllocatableFPR(int r);
+
+private:
+	struct Operands {
+		s8 dest;
+		s8 src1;
+		s8 src2;
+	};
+
+	struct Interval {
+		int start;
+		int end;
+		u8 irReg;
+		bool fpr;
+		// Whether the first access reads the old value.
+		bool loadFirst;
+		s8 hostReg;
+	};
+
+	void BuildIntervals(const IRInst *insts, int count, const IRRegAllocConfig &config);
+	void ScanClass(bool fpr, int numRegs);
+	void BuildActions(const IRInst *insts, int count, const IRRegAllocConfig &config);
+
+	std::vector<Interval> intervals_;
+	std::vector<Operands> operands_;
+	std::vector<IRRegAllocAction> actions_;
+	std::vector<int> actionStart_;
+	IRRegAllocStats stats_{};
+};
@@ -44,6 +44,8 @@ struct BlockCacheStats {
 	float maxBloat;
 	u32 maxBloatBlock;
 	std::map<float, u32> bloatMap;
+	// Instructions removed by each optimization pass, for IR based jits.
+	std::map<std::string, int> passRemoved;
 };
 
 enum class DestroyType {
@@ -42,8 +42,12 @@
 #include "../ARM64/Arm64Jit.h"
 #elif PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
 #include "../x86/Jit.h"
+#include "../x86/X64IRJit.h"
 #elif PPSSPP_ARCH(MIPS)
 #include "../MIPS/MipsJit.h"
+#elif PPSSPP_ARCH(RISCV64)
+#include "../RiscV/RiscVIRJit.h"
+#include "../fake/FakeJit.h"
 #else
 #include "../fake/FakeJit.h"
 #endif
@@ -110,6 +114,16 @@ namespace MIPSComp {
 #endif
 	}
 
+	JitInterface *CreateIRNativeJit(MIPSState *mipsState) {
+#if PPSSPP_ARCH(AMD64)
+		return new MIPSComp::X64IRJit(mipsState);
+#elif PPSSPP_ARCH(RISCV64)
+		return new MIPSComp::RiscVIRJit(mipsState);
+#else
+		return new MIPSComp::IRJit(mipsState);
+#endif
+	}
+
 }
 #if PPSSPP_PLATFORM(WINDOWS) && !defined(__LIBRETRO__)
 #define DISASM_ALL 1
@@ -135,6 +135,8 @@ namespace MIPSComp {
 		virtual void RunLoopUntil(u64 globalticks) = 0;
 		virtual void Compile(u32 em_address) = 0;
 		virtual void CompileFunction(u32 start_address, u32 length) { }
+		// Loads any still valid blocks from a disk cache, without compiling anything new.
+		virtual void PreloadCachedBlocks() { }
 		virtual void ClearCache() = 0;
 		virtual void UpdateFCR31() = 0;
 		virtual MIPSOpcode GetOriginalOp(MIPSOpcode op) = 0;
@@ -176,4 +178,6 @@ namespace MIPSComp {
 	void DoDummyJitState(PointerWrap &p);
 
 	JitInterface *CreateNativeJit(MIPSState *mipsState);
+	// Compiles through IR, then to native code where a backend exists (otherwise interprets the IR.)
+	JitInterface *CreateIRNativeJit(MIPSState *mipsState);
 }
@@ -16,7 +16,10 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+#include <algorithm>
+#include <condition_variable>
 #include <map>
+#include <memory>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -25,8 +28,12 @@
 #include "ext/cityhash/city.h"
 #include "ext/xxhash.h"
 
+#include "Common/File/DirListing.h"
 #include "Common/File/FileUtil.h"
+#include "Common/File/MappedFile.h"
 #include "Common/Log.h"
+#include "Common/Swap.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/MemMap.h"
@@ -47,9 +54,8 @@ typedef std::vector<MIPSAnalyst::AnalyzedFunction> FunctionsVector;
 static FunctionsVector functions;
 std::recursive_mutex functions_lock;
 
-// One function can appear in multiple copies in memory, and they will all have 
-// the same hash and should all be replaced if possible.
-static std::unordered_multimap<u64, MIPSAnalyst::AnalyzedFunction *> hashToFunction;
+// Functions before this index have already been hashed.  Scans only add to the end.
+static size_t hashedFunctions = 0;
 
 struct HashMapFunc {
 	char name[64];
@@ -76,9 +82,68 @@ namespace std {
 }
 
 static std::unordered_set<HashMapFunc> hashMap;
+static bool builtinHashMapLoaded = false;
+// Set when hashMap has entries that haven't been stored yet.
+static bool hashMapDirty = false;
 
 static Path hashmapFileName;
 
+// knownfuncs.bin is a sorted copy of knownfuncs.ini, which is mapped instead of parsed and
+// inserted into hashMap.  It's regenerated whenever the ini is newer.
+struct HashMapFileHeader {
+	char magic[4];
+	u32_le version;
+	u32_le count;
+	u32_le namesSize;
+};
+
+struct HashMapFileEntry {
+	u64_le hash;
+	u32_le size;
+	u32_le nameOffset;
+};
+
+static const char HASHMAP_FILE_MAGIC[4] = { 'P', 'F', 'H', 'M' };
+static const u32 HASHMAP_FILE_VERSION = 1;
+
+static MappedFile hashMapFile;
+static Path hashMapFilePath;
+static uint64_t hashMapFileModified = 0;
+static const HashMapFileEntry *hashMapFileEntries = nullptr;
+static u32 hashMapFileCount = 0;
+static const char *hashMapFileNames = nullptr;
+static u32 hashMapFileNamesSize = 0;
+
+// A copy of the code being scanned on a worker thread, since the emu thread may jit or
+// replace it meanwhile.
+struct ScanSnapshot {
+	u32 start;
+	std::vector<u32> words;
+};
+
+static thread_local const ScanSnapshot *scanSnapshot = nullptr;
+
+struct BackgroundScanRange {
+	u32 start;
+	u32 end;
+	ScanSnapshot snapshot;
+	FunctionsVector functions;
+	// As returned by ScanForFunctions() for this range.
+	bool insertSymbols;
+};
+
+struct BackgroundScan {
+	std::vector<BackgroundScanRange> ranges;
+	bool insertSymbols;
+	double scanTime = 0.0;
+	bool done = false;
+};
+
+static std::mutex backgroundScansLock;
+static std::condition_variable backgroundScansCond;
+// In module load order, since later scans may depend on the symbols of earlier ones.
+static std::vector<std::shared_ptr<BackgroundScan>> backgroundScans;
+
 #define MIPSTABLE_IMM_MASK 0xFC000000
 
 // Similar to HashMapFunc but has a char pointer for the name for efficiency.
@@ -756,24 +821,30 @@ namespace MIPSAnalyst {
 	}
 	
 	void Reset() {
+		{
+			// The scans read memory outside their copies, so they must finish before shutdown.
+			std::unique_lock<std::mutex> guard(backgroundScansLock);
+			for (const auto &scan : backgroundScans) {
+				backgroundScansCond.wait(guard, [&] { return scan->done; });
+			}
+			backgroundScans.clear();
+		}
+
 		std::lock_guard<std::recursive_mutex> guard(functions_lock);
 		functions.clear();
-		hashToFunction.clear();
+		hashedFunctions = 0;
 	}
 
-	void UpdateHashToFunctionMap() {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
-		hashToFunction.clear();
-		// Really need to detect C++11 features with better defines.
-#if !PPSSPP_PLATFORM(IOS)
-		hashToFunction.reserve(functions.size());
-#endif
-		for (auto iter = functions.begin(); iter != functions.end(); iter++) {
-			AnalyzedFunction &f = *iter;
-			if (f.hasHash && f.size > 16) {
-				hashToFunction.insert(std::make_pair(f.hash, &f));
-			}
+	static MIPSOpcode ReadScanInstruction(u32 addr) {
+		const ScanSnapshot *snapshot = scanSnapshot;
+		if (!snapshot) {
+			return Memory::Read_Instruction(addr, true);
+		}
+		if (addr >= snapshot->start && (addr - snapshot->start) / 4 < snapshot->words.size()) {
+			return MIPSOpcode(snapshot->words[(addr - snapshot->start) / 4]);
 		}
+		// Looking up jit blocks isn't safe off the emu thread, so this may see emuhacks.
+		return MIPSOpcode(Memory::IsValidAddress(addr) ? Memory::ReadUnchecked_U32(addr) : 0);
 	}
 
 	enum RegisterUsage {
@@ -883,11 +954,10 @@ namespace MIPSAnalyst {
 		return DetermineRegisterUsage(reg, addr, instrs) == USAGE_CLOBBERED;
 	}
 
-	void HashFunctions() {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+	static void HashFunctionRange(FunctionsVector::iterator begin, FunctionsVector::iterator end) {
 		std::vector<u32> buffer;
 
-		for (auto iter = functions.begin(), end = functions.end(); iter != end; iter++) {
+		for (auto iter = begin; iter != end; iter++) {
 			AnalyzedFunction &f = *iter;
 			if (!Memory::IsValidRange(f.start, f.end - f.start + 4)) {
 				continue;
@@ -898,7 +968,7 @@ namespace MIPSAnalyst {
 			size_t pos = 0;
 			for (u32 addr = f.start; addr <= f.end; addr += 4) {
 				u32 validbits = 0xFFFFFFFF;
-				MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr, true);
+				MIPSOpcode instr = ReadScanInstruction(addr);
 				if (MIPS_IS_EMUHACK(instr)) {
 					f.hasHash = false;
 					goto skip;
@@ -919,6 +989,14 @@ namespace MIPSAnalyst {
 		}
 	}
 
+	static void HashFunctions() {
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+		if (hashedFunctions < functions.size()) {
+			HashFunctionRange(functions.begin() + hashedFunctions, functions.end());
+		}
+		hashedFunctions = functions.size();
+	}
+
 	void PrecompileFunction(u32 startAddr, u32 length) {
 		// Direct calls to this ignore the bPreloadFunctions flag, since it's just for stubs.
 		std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
@@ -929,12 +1007,16 @@ namespace MIPSAnalyst {
 
 	void PrecompileFunctions() {
 		if (!g_Config.bPreloadFunctions) {
+			// Loading a warm block cache is still cheap, but don't compile anything new.
+			std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+			if (MIPSComp::jit) {
+				MIPSComp::jit->PreloadCachedBlocks();
+			}
 			return;
 		}
+		FinishBackgroundScans(true);
 		std::lock_guard<std::recursive_mutex> guard(functions_lock);
 
-		// TODO: Load from cache file if available instead.
-
 		double st = time_now_d();
 		for (auto iter = functions.begin(), end = functions.end(); iter != end; iter++) {
 			const AnalyzedFunction &f = *iter;
@@ -990,10 +1072,10 @@ namespace MIPSAnalyst {
 
 		const u32 scanEnd = fromAddr + Memory::ValidSize(fromAddr, MAX_AHEAD_SCAN);
 		for (u32 ahead = fromAddr; ahead < scanEnd; ahead += 4) {
-			MIPSOpcode aheadOp = Memory::Read_Instruction(ahead, true);
+			MIPSOpcode aheadOp = ReadScanInstruction(ahead);
 			u32 target = GetBranchTargetNoRA(ahead, aheadOp);
 			if (target == INVALIDTARGET && ((aheadOp & 0xFC000000) == 0x08000000)) {
-				target = GetJumpTarget(ahead);
+				target = GetJumpTarget(ahead, aheadOp);
 			}
 
 			if (target != INVALIDTARGET) {
@@ -1014,10 +1096,10 @@ namespace MIPSAnalyst {
 
 		if (closestJumpbackAddr != INVALIDTARGET && furthestJumpbackAddr == INVALIDTARGET) {
 			for (u32 behind = closestJumpbackTarget; behind < fromAddr; behind += 4) {
-				MIPSOpcode behindOp = Memory::Read_Instruction(behind, true);
+				MIPSOpcode behindOp = ReadScanInstruction(behind);
 				u32 target = GetBranchTargetNoRA(behind, behindOp);
 				if (target == INVALIDTARGET && ((behindOp & 0xFC000000) == 0x08000000)) {
-					target = GetJumpTarget(behind);
+					target = GetJumpTarget(behind, behindOp);
 				}
 
 				if (target != INVALIDTARGET) {
@@ -1031,11 +1113,8 @@ namespace MIPSAnalyst {
 		return furthestJumpbackAddr;
 	}
 
-	bool ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
-
-		FunctionsVector new_functions;
-
+	// Only reads memory and the symbol map, so this is safe on a worker with a snapshot.
+	static bool ScanRange(FunctionsVector &new_functions, u32 startAddr, u32 endAddr, bool insertSymbols) {
 		AnalyzedFunction currentFunction = {startAddr};
 
 		u32 furthestBranch = 0;
@@ -1046,7 +1125,7 @@ namespace MIPSAnalyst {
 
 		u32 addr;
 		for (addr = startAddr; addr <= endAddr; addr += 4) {
-			MIPSOpcode op = Memory::Read_Instruction(addr, true);
+			MIPSOpcode op = ReadScanInstruction(addr);
 			u32 target = GetBranchTargetNoRA(addr, op);
 			if (target != INVALIDTARGET) {
 				isStraightLeaf = false;
@@ -1055,7 +1134,7 @@ namespace MIPSAnalyst {
 				}
 			// j X
 			} else if ((op & 0xFC000000) == 0x08000000) {
-				u32 sureTarget = GetJumpTarget(addr);
+				u32 sureTarget = GetJumpTarget(addr, op);
 				// Check for a tail call.  Might not even have a jr ra.
 				if (sureTarget != INVALIDTARGET && sureTarget < currentFunction.start) {
 					if (furthestBranch > addr) {
@@ -1069,7 +1148,7 @@ namespace MIPSAnalyst {
 					// If it's a nearby forward jump, and not a stackless leaf, assume not a tail call.
 					if (sureTarget <= addr + MAX_JUMP_FORWARD && decreasedSp) {
 						// But let's check the delay slot.
-						MIPSOpcode op = Memory::Read_Instruction(addr + 4, true);
+						MIPSOpcode op = ReadScanInstruction(addr + 4);
 						// addiu sp, sp, +X
 						if ((op & 0xFFFF8000) != 0x27BD0000) {
 							furthestBranch = sureTarget;
@@ -1117,10 +1196,10 @@ namespace MIPSAnalyst {
 
 			if (looking) {
 				if (addr >= furthestBranch) {
-					u32 sureTarget = GetSureBranchTarget(addr);
+					u32 sureTarget = GetSureBranchTarget(addr, op);
 					// Regular j only, jals are to new funcs.
 					if (sureTarget == INVALIDTARGET && ((op & 0xFC000000) == 0x08000000)) {
-						sureTarget = GetJumpTarget(addr);
+						sureTarget = GetJumpTarget(addr, op);
 					}
 
 					if (sureTarget != INVALIDTARGET && sureTarget < addr) {
@@ -1176,6 +1255,12 @@ namespace MIPSAnalyst {
 
 		for (auto iter = new_functions.begin(); iter != new_functions.end(); iter++) {
 			iter->size = iter->end - iter->start + 4;
+		}
+		return insertSymbols;
+	}
+
+	static void AddScannedFunctions(const FunctionsVector &new_functions, bool insertSymbols) {
+		for (auto iter = new_functions.begin(); iter != new_functions.end(); iter++) {
 			if (insertSymbols && !iter->foundInSymbolMap) {
 				char temp[256];
 				g_symbolMap->AddFunction(DefaultFunctionName(temp, iter->start), iter->start, iter->end - iter->start + 4);
@@ -1184,12 +1269,20 @@ namespace MIPSAnalyst {
 
 		// Concatenate the new functions to the end of the old ones.
 		functions.insert(functions.end(), new_functions.begin(), new_functions.end());
-		return insertSymbols;
 	}
 
-	void FinalizeScan(bool insertSymbols) {
-		HashFunctions();
+	bool ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
 
+		FunctionsVector new_functions;
+		insertSymbols = ScanRange(new_functions, startAddr, endAddr, insertSymbols);
+		AddScannedFunctions(new_functions, insertSymbols);
+		return insertSymbols;
+	}
+
+	// The part of FinalizeScan() after hashing.  Returns the time spent on the hash map.
+	static double ApplyScan(bool insertSymbols) {
+		double st = time_now_d();
 		Path hashMapFilename = GetSysDirectory(DIRECTORY_SYSTEM) / "knownfuncs.ini";
 		if (g_Config.bFuncHashMap || g_Config.bFuncReplacements) {
 			LoadBuiltinHashMap();
@@ -1200,9 +1293,119 @@ namespace MIPSAnalyst {
 			if (insertSymbols) {
 				ApplyHashMap();
 			}
-			if (g_Config.bFuncReplacements) {
-				ReplaceFunctions();
+		}
+		double hashMapTime = time_now_d() - st;
+
+		if (g_Config.bFuncReplacements) {
+			ReplaceFunctions();
+		}
+		return hashMapTime;
+	}
+
+	void FinalizeScan(bool insertSymbols) {
+		double st = time_now_d();
+		HashFunctions();
+		double hashTime = time_now_d() - st;
+		double hashMapTime = ApplyScan(insertSymbols);
+		double et = time_now_d();
+
+		INFO_LOG(LOADER, "Finalized function scan in %0.2f ms (hashing %0.2f ms, hash map %0.2f ms, replacing %0.2f ms)", (et - st) * 1000.0, hashTime * 1000.0, hashMapTime * 1000.0, (et - st - hashTime - hashMapTime) * 1000.0);
+	}
+
+	class FunctionScanTask : public Task {
+	public:
+		FunctionScanTask(std::shared_ptr<BackgroundScan> scan) : scan_(scan) {
+		}
+
+		TaskType Type() const override {
+			return TaskType::CPU_COMPUTE;
+		}
+
+		void Run() override {
+			double st = time_now_d();
+			bool insertSymbols = scan_->insertSymbols;
+			for (BackgroundScanRange &range : scan_->ranges) {
+				scanSnapshot = &range.snapshot;
+				insertSymbols = ScanRange(range.functions, range.start, range.end, insertSymbols);
+				range.insertSymbols = insertSymbols;
+				HashFunctionRange(range.functions.begin(), range.functions.end());
+				scanSnapshot = nullptr;
+			}
+			scan_->insertSymbols = insertSymbols;
+			scan_->scanTime = time_now_d() - st;
+
+			std::lock_guard<std::mutex> guard(backgroundScansLock);
+			scan_->done = true;
+			backgroundScansCond.notify_all();
+		}
+
+	private:
+		std::shared_ptr<BackgroundScan> scan_;
+	};
+
+	void ScanForFunctionsInBackground(const std::vector<std::pair<u32, u32>> &ranges, bool insertSymbols) {
+		double st = time_now_d();
+		auto scan = std::make_shared<BackgroundScan>();
+		scan->insertSymbols = insertSymbols;
+		for (const auto &range : ranges) {
+			BackgroundScanRange scanRange{ range.first, range.second };
+			// Include what ScanAheadForJumpback() is likely to look at past the end.
+			u32 size = range.second < range.first ? 0 : Memory::ValidSize(range.first, range.second - range.first + 4 + 0x1000);
+			scanRange.snapshot.start = range.first;
+			scanRange.snapshot.words.resize(size / 4);
+			if (size != 0) {
+				memcpy(scanRange.snapshot.words.data(), Memory::GetPointer(range.first), size & ~3);
+			}
+			scan->ranges.push_back(std::move(scanRange));
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(backgroundScansLock);
+			backgroundScans.push_back(scan);
+		}
+
+		FunctionScanTask *task = new FunctionScanTask(scan);
+		if (g_threadManager.IsInitialized()) {
+			g_threadManager.EnqueueTask(task);
+		} else {
+			task->Run();
+			task->Release();
+		}
+		INFO_LOG(LOADER, "Copied %d ranges for function scan in %0.2f ms", (int)ranges.size(), (time_now_d() - st) * 1000.0);
+	}
+
+	void FinishBackgroundScans(bool wait) {
+		while (true) {
+			std::shared_ptr<BackgroundScan> scan;
+			{
+				std::unique_lock<std::mutex> guard(backgroundScansLock);
+				if (backgroundScans.empty())
+					return;
+				scan = backgroundScans.front();
+				if (!scan->done && !wait)
+					return;
+				backgroundScansCond.wait(guard, [&] { return scan->done; });
+				backgroundScans.erase(backgroundScans.begin());
+			}
+
+			double st = time_now_d();
+			int count = 0;
+			{
+				std::lock_guard<std::recursive_mutex> guard(functions_lock);
+				HashFunctions();
+				for (const BackgroundScanRange &range : scan->ranges) {
+					AddScannedFunctions(range.functions, range.insertSymbols);
+					count += (int)range.functions.size();
+				}
+				hashedFunctions = functions.size();
+				ApplyScan(scan->insertSymbols);
+			}
+
+			// Anything the game already ran from these ranges may have just been replaced.
+			for (const BackgroundScanRange &range : scan->ranges) {
+				currentMIPS->InvalidateICache(range.start, range.end - range.start + 4);
 			}
+			NOTICE_LOG(LOADER, "Scanned %d functions in the background in %0.2f ms, applied in %0.2f ms", count, scan->scanTime * 1000.0, (time_now_d() - st) * 1000.0);
 		}
 	}
 
@@ -1219,7 +1422,9 @@ namespace MIPSAnalyst {
 					strncpy(hfun.name, name, 64);
 					hfun.name[63] = 0;
 					hfun.size = size;
-					hashMap.insert(hfun);
+					hfun.hardcoded = false;
+					if (hashMap.insert(hfun).second)
+						hashMapDirty = true;
 					return;
 				} else if (!iter->hasHash || size == 0) {
 					ERROR_LOG(HLE, "%s: %08x %08x : match but no hash (%i) or no size", name, startAddr, size, iter->hasHash);
@@ -1240,7 +1445,9 @@ namespace MIPSAnalyst {
 	}
 
 	void ForgetFunctions(u32 startAddr, u32 endAddr) {
+		FinishBackgroundScans(true);
 		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+		HashFunctions();
 
 		// It makes sense to forget functions as modules are unloaded but it breaks
 		// the easy way of saving a hashmap by unloading and loading a game. I added
@@ -1248,7 +1455,6 @@ namespace MIPSAnalyst {
 
 		// Most of the time, functions from the same module will be contiguous in functions.
 		FunctionsVector::iterator prevMatch = functions.end();
-		size_t originalSize = functions.size();
 		for (auto iter = functions.begin(); iter != functions.end(); ++iter) {
 			const bool hadPrevMatch = prevMatch != functions.end();
 			const bool match = iter->start >= startAddr && iter->start <= endAddr;
@@ -1268,19 +1474,18 @@ namespace MIPSAnalyst {
 		}
 
 		RestoreReplacedInstructions(startAddr, endAddr);
-
-		if (functions.empty()) {
-			hashToFunction.clear();
-		} else if (originalSize != functions.size()) {
-			UpdateHashToFunctionMap();
-		}
+		hashedFunctions = functions.size();
 	}
 
 	void ReplaceFunctions() {
 		std::lock_guard<std::recursive_mutex> guard(functions_lock);
 
 		for (size_t i = 0; i < functions.size(); i++) {
-			WriteReplaceInstructions(functions[i].start, functions[i].hash, functions[i].size);
+			const AnalyzedFunction &f = functions[i];
+			WriteReplaceInstructions(f.start, f.hash, f.size);
+			// Like the hash map, tiny functions aren't worth counting.
+			if (f.hasHash && f.size > 16)
+				ProfileUnreplacedFunction(f.start, f.hash, f.size);
 		}
 	}
 
@@ -1301,8 +1506,20 @@ namespace MIPSAnalyst {
 
 			HashMapFunc mf = { "", f.hash, f.size };
 			strncpy(mf.name, name.c_str(), sizeof(mf.name) - 1);
-			hashMap.insert(mf);
+			if (hashMap.insert(mf).second)
+				hashMapDirty = true;
+		}
+	}
+
+	static const char *LookupHashMapFile(u64 hash, u32 funcsize) {
+		const HashMapFileEntry *end = hashMapFileEntries + hashMapFileCount;
+		const HashMapFileEntry *it = std::lower_bound(hashMapFileEntries, end, std::make_pair(hash, funcsize), [](const HashMapFileEntry &e, const std::pair<u64, u32> &key) {
+			return e.hash < key.first || (e.hash == key.first && e.size < key.second);
+		});
+		if (it != end && it->hash == hash && it->size == funcsize && it->nameOffset < hashMapFileNamesSize) {
+			return hashMapFileNames + it->nameOffset;
 		}
+		return nullptr;
 	}
 
 	const char *LookupHash(u64 hash, u32 funcsize) {
@@ -1311,7 +1528,93 @@ namespace MIPSAnalyst {
 		if (it != hashMap.end()) {
 			return it->name;
 		}
-		return 0;
+		return LookupHashMapFile(hash, funcsize);
+	}
+
+	static void CloseHashMapFile() {
+		hashMapFile.Close();
+		hashMapFilePath = Path();
+		hashMapFileEntries = nullptr;
+		hashMapFileCount = 0;
+		hashMapFileNames = nullptr;
+		hashMapFileNamesSize = 0;
+	}
+
+	static bool OpenHashMapFile(const Path &filename, uint64_t modified) {
+		CloseHashMapFile();
+		if (!hashMapFile.Open(filename)) {
+			return false;
+		}
+
+		const u8 *data = hashMapFile.Data();
+		const size_t size = hashMapFile.Size();
+		const HashMapFileHeader *header = (const HashMapFileHeader *)data;
+		const size_t entriesOffset = sizeof(HashMapFileHeader);
+		bool valid = size >= entriesOffset && memcmp(header->magic, HASHMAP_FILE_MAGIC, sizeof(header->magic)) == 0 && header->version == HASHMAP_FILE_VERSION;
+		// Names must be terminated, so any offset inside them is a valid string.
+		valid = valid && header->namesSize != 0 && (u64)size == entriesOffset + (u64)header->count * sizeof(HashMapFileEntry) + header->namesSize;
+		valid = valid && data[size - 1] == 0;
+		if (!valid) {
+			WARN_LOG(LOADER, "Ignoring invalid hash map: %s", filename.c_str());
+			CloseHashMapFile();
+			return false;
+		}
+
+		hashMapFilePath = filename;
+		hashMapFileModified = modified;
+		hashMapFileEntries = (const HashMapFileEntry *)(data + entriesOffset);
+		hashMapFileCount = header->count;
+		hashMapFileNames = (const char *)(data + size - header->namesSize);
+		hashMapFileNamesSize = header->namesSize;
+		INFO_LOG(LOADER, "Mapped hash map with %d funcs: %s", hashMapFileCount, filename.c_str());
+		return true;
+	}
+
+	static bool WriteHashMapFile(const Path &filename, const std::vector<const HashMapFunc *> &sorted) {
+		HashMapFileHeader header{};
+		memcpy(header.magic, HASHMAP_FILE_MAGIC, sizeof(header.magic));
+		header.version = HASHMAP_FILE_VERSION;
+		header.count = (u32)sorted.size();
+
+		std::vector<HashMapFileEntry> entries;
+		std::string names;
+		entries.reserve(sorted.size());
+		for (const HashMapFunc *mf : sorted) {
+			HashMapFileEntry entry;
+			entry.hash = mf->hash;
+			entry.size = mf->size;
+			entry.nameOffset = (u32)names.size();
+			entries.push_back(entry);
+			names.append(mf->name, strnlen(mf->name, sizeof(mf->name)));
+			names.push_back('\0');
+		}
+		// Always at least one terminator, even when empty.
+		names.push_back('\0');
+		header.namesSize = (u32)names.size();
+
+		// Write a new file and swap it in, so anything mapping the old one keeps working.
+		Path tempFilename = filename.WithExtraExtension(".tmp");
+		FILE *file = File::OpenCFile(tempFilename, "wb");
+		if (!file) {
+			return false;
+		}
+		bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+		success = success && (entries.empty() || fwrite(entries.data(), sizeof(HashMapFileEntry) * entries.size(), 1, file) == 1);
+		success = success && fwrite(names.data(), names.size(), 1, file) == 1;
+		fclose(file);
+
+		if (success) {
+			// On Windows, the old one can't be replaced while it's mapped.
+			if (hashMapFilePath == filename) {
+				CloseHashMapFile();
+			}
+			File::Delete(filename);
+			success = File::Rename(tempFilename, filename);
+		}
+		if (!success) {
+			File::Delete(tempFilename);
+		}
+		return success;
 	}
 
 	void SetHashMapFilename(const std::string& filename) {
@@ -1326,55 +1629,102 @@ namespace MIPSAnalyst {
 			filename = hashmapFileName;
 
 		UpdateHashMap();
-		if (hashMap.empty()) {
+		// Nothing new since it was loaded or last stored.
+		if (!hashMapDirty && filename == hashmapFileName) {
 			return;
 		}
 
+		// The mapped entries are stored again along with the new ones.
+		std::vector<HashMapFunc> mappedFuncs;
+		mappedFuncs.reserve(hashMapFileCount);
+		for (u32 i = 0; i < hashMapFileCount; ++i) {
+			const HashMapFileEntry &entry = hashMapFileEntries[i];
+			HashMapFunc mf = { "", entry.hash, entry.size, false };
+			if (hashMap.find(mf) != hashMap.end() || entry.nameOffset >= hashMapFileNamesSize) {
+				continue;
+			}
+			strncpy(mf.name, hashMapFileNames + entry.nameOffset, sizeof(mf.name) - 1);
+			mappedFuncs.push_back(mf);
+		}
+
+		std::vector<const HashMapFunc *> sorted;
+		for (auto it = hashMap.begin(), end = hashMap.end(); it != end; ++it) {
+			if (!it->hardcoded) {
+				sorted.push_back(&*it);
+			}
+		}
+		for (const HashMapFunc &mf : mappedFuncs) {
+			sorted.push_back(&mf);
+		}
+		if (sorted.empty()) {
+			return;
+		}
+		std::sort(sorted.begin(), sorted.end(), [](const HashMapFunc *a, const HashMapFunc *b) {
+			return *a < *b;
+		});
+
 		FILE *file = File::OpenCFile(filename, "wt");
 		if (!file) {
 			WARN_LOG(LOADER, "Could not store hash map: %s", filename.c_str());
 			return;
 		}
 
-		for (auto it = hashMap.begin(), end = hashMap.end(); it != end; ++it) {
-			const HashMapFunc &mf = *it;
-			if (!mf.hardcoded) {
-				if (fprintf(file, "%016llx:%d = %s\n", mf.hash, mf.size, mf.name) <= 0) {
-					WARN_LOG(LOADER, "Could not store hash map: %s", filename.c_str());
-					break;
-				}
+		for (const HashMapFunc *mf : sorted) {
+			if (fprintf(file, "%016llx:%d = %s\n", mf->hash, mf->size, mf->name) <= 0) {
+				WARN_LOG(LOADER, "Could not store hash map: %s", filename.c_str());
+				break;
 			}
 		}
 		fclose(file);
+
+		const Path binFilename = filename.WithReplacedExtension(".bin");
+		const bool wasOpen = hashMapFilePath == binFilename;
+		if (binFilename == filename || !WriteHashMapFile(binFilename, sorted)) {
+			WARN_LOG(LOADER, "Could not store binary hash map: %s", binFilename.c_str());
+		} else if (wasOpen || filename == hashmapFileName) {
+			// Everything's in the new file now, including what was mapped before.
+			File::FileInfo binInfo;
+			if (File::GetFileInfo(binFilename, &binInfo)) {
+				OpenHashMapFile(binFilename, binInfo.mtime);
+			}
+		}
+		if (filename == hashmapFileName) {
+			hashMapDirty = false;
+		}
 	}
 
 	void ApplyHashMap() {
-		UpdateHashToFunctionMap();
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
 
-		for (auto mf = hashMap.begin(), end = hashMap.end(); mf != end; ++mf) {
-			auto range = hashToFunction.equal_range(mf->hash);
-			if (range.first == range.second) {
+		// Each lookup is a hash or binary search, so this is cheaper than going through the map.
+		for (auto iter = functions.begin(), end = functions.end(); iter != end; ++iter) {
+			AnalyzedFunction &f = *iter;
+			if (!f.hasHash || f.size <= 16) {
+				continue;
+			}
+			const char *name = LookupHash(f.hash, f.size);
+			if (!name) {
 				continue;
 			}
 
 			// Yay, found a function.
-			for (auto iter = range.first; iter != range.second; ++iter) {
-				AnalyzedFunction &f = *iter->second;
-				if (f.hash == mf->hash && f.size == mf->size) {
-					strncpy(f.name, mf->name, sizeof(mf->name) - 1);
-
-					std::string existingLabel = g_symbolMap->GetLabelString(f.start);
-					char defaultLabel[256];
-					// If it was renamed, keep it.  Only change the name if it's still the default.
-					if (existingLabel.empty() || existingLabel == DefaultFunctionName(defaultLabel, f.start)) {
-						g_symbolMap->SetLabelName(mf->name, f.start);
-					}
-				}
+			strncpy(f.name, name, sizeof(f.name) - 1);
+
+			std::string existingLabel = g_symbolMap->GetLabelString(f.start);
+			char defaultLabel[256];
+			// If it was renamed, keep it.  Only change the name if it's still the default.
+			if (existingLabel.empty() || existingLabel == DefaultFunctionName(defaultLabel, f.start)) {
+				g_symbolMap->SetLabelName(name, f.start);
 			}
 		}
 	}
 
 	void LoadBuiltinHashMap() {
+		if (builtinHashMapLoaded) {
+			return;
+		}
+		builtinHashMapLoaded = true;
+
 		HashMapFunc mf;
 		for (size_t i = 0; i < ARRAY_SIZE(hardcodedHashes); i++) {
 			mf.hash = hardcodedHashes[i].hash;
@@ -1387,12 +1737,27 @@ namespace MIPSAnalyst {
 	}
 
 	void LoadHashMap(const Path &filename) {
+		// Use the binary version if it's up to date, which is much quicker than parsing.
+		const Path binFilename = filename.WithReplacedExtension(".bin");
+		File::FileInfo iniInfo, binInfo;
+		const bool haveIni = File::GetFileInfo(filename, &iniInfo) && iniInfo.exists;
+		const bool haveBin = binFilename != filename && File::GetFileInfo(binFilename, &binInfo) && binInfo.exists;
+		if (haveBin && (!haveIni || binInfo.mtime >= iniInfo.mtime)) {
+			bool alreadyOpen = hashMapFile.IsOpen() && hashMapFilePath == binFilename && hashMapFileModified == binInfo.mtime;
+			if (alreadyOpen || OpenHashMapFile(binFilename, binInfo.mtime)) {
+				hashmapFileName = filename;
+				return;
+			}
+		}
+
 		FILE *file = File::OpenCFile(filename, "rt");
 		if (!file) {
 			WARN_LOG(LOADER, "Could not load hash map: %s", filename.c_str());
 			return;
 		}
 		hashmapFileName = filename;
+		// The binary version is stale, so write a new one on the next store.
+		hashMapDirty = true;
 
 		while (!feof(file)) {
 			HashMapFunc mf = { "" };
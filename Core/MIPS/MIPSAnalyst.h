@@ -18,6 +18,7 @@
 #pragma once
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -109,6 +110,12 @@ namespace MIPSAnalyst
 	// Returns new insertSymbols value for FinalizeScan().
 	bool ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols);
 	void FinalizeScan(bool insertSymbols);
+	// Like ScanForFunctions() on each inclusive range and then FinalizeScan(), except the scan
+	// runs on a copy of the code on a worker thread, and FinishBackgroundScans() applies it.
+	void ScanForFunctionsInBackground(const std::vector<std::pair<u32, u32>> &ranges, bool insertSymbols);
+	// Adds and replaces the functions from finished scans, in load order.  Call on the emu thread
+	// between timeslices.  With wait, also waits for scans that are still running.
+	void FinishBackgroundScans(bool wait);
 	void ForgetFunctions(u32 startAddr, u32 endAddr);
 	void PrecompileFunctions();
 	void PrecompileFunction(u32 startAddr, u32 length);
@@ -34,6 +34,10 @@ namespace MIPSCodeUtils
 
 	u32 GetJumpTarget(u32 addr) {
 		MIPSOpcode op = Memory::Read_Instruction(addr, true);
+		return GetJumpTarget(addr, op);
+	}
+
+	u32 GetJumpTarget(u32 addr, MIPSOpcode op) {
 		if (op != 0) {
 			MIPSInfo info = MIPSGetInfo(op);
 			if ((info & IS_JUMP) && (info & IN_IMM26))
@@ -77,6 +81,10 @@ namespace MIPSCodeUtils
 
 	u32 GetSureBranchTarget(u32 addr) {
 		MIPSOpcode op = Memory::Read_Instruction(addr, true);
+		return GetSureBranchTarget(addr, op);
+	}
+
+	u32 GetSureBranchTarget(u32 addr, MIPSOpcode op) {
 		if (op != 0) {
 			MIPSInfo info = MIPSGetInfo(op);
 			if ((info & IS_CONDBRANCH) && !(info & (IN_FPUFLAG | IS_VFPU))) {
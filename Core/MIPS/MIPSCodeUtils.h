@@ -77,7 +77,9 @@ namespace MIPSCodeUtils
 	u32 GetBranchTargetNoRA(u32 addr);
 	u32 GetBranchTargetNoRA(u32 addr, MIPSOpcode op);
 	u32 GetJumpTarget(u32 addr);
+	u32 GetJumpTarget(u32 addr, MIPSOpcode op);
 	u32 GetSureBranchTarget(u32 addr);
+	u32 GetSureBranchTarget(u32 addr, MIPSOpcode op);
 	bool IsVFPUBranch(MIPSOpcode op);
 	bool IsBranch(MIPSOpcode op);
 }
@@ -0,0 +1,1061 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(RISCV64)
+
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#include "Common/CommonFuncs.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/IR/IRInterpreter.h"
+#include "Core/MIPS/RiscV/IRToRiscV.h"
+
+namespace MIPSComp {
+
+using namespace RiscVGen;
+using namespace RiscVJitConstants;
+
+// Converts IR blocks directly to RISC-V, one instruction at a time.
+// GPRs that IRRegAllocator maps stay in host registers, everything else lives in MIPSState and is
+// loaded and stored around each op.  MIPSState is small enough that every IR register is within
+// reach of a 12-bit displacement from CTXREG.
+
+static_assert(sizeof(IRInst) == 8, "IRInst is passed to the fallback in a register");
+static_assert(offsetof(MIPSState, hi) == offsetof(MIPSState, lo) + 4, "lo and hi are accessed as one 64-bit value");
+static_assert((offsetof(MIPSState, lo) & 7) == 0, "lo and hi are accessed as one 64-bit value");
+static_assert(sizeof(MIPSState) < 2048, "MIPSState is accessed with 12-bit displacements");
+
+// All callee saved, since the fallback calls into C++.
+static const RiscVReg allocGPRs[] = { X18, X19, X20, X21, X22, X23, X24, X25, X26, X27 };
+
+// ra, s0-s11, and padding to keep the stack 16-byte aligned.
+static const int ENTER_STACK_SIZE = 14 * 8;
+
+static const float vec4InitValues[8][4] = {
+	{ 0.0f, 0.0f, 0.0f, 0.0f },
+	{ 1.0f, 1.0f, 1.0f, 1.0f },
+	{ -1.0f, -1.0f, -1.0f, -1.0f },
+	{ 1.0f, 0.0f, 0.0f, 0.0f },
+	{ 0.0f, 1.0f, 0.0f, 0.0f },
+	{ 0.0f, 0.0f, 1.0f, 0.0f },
+	{ 0.0f, 0.0f, 0.0f, 1.0f },
+};
+
+static inline s32 IRGPR(int r) {
+	return r * 4;
+}
+
+static inline s32 IRFPR(int r) {
+	return (s32)offsetof(MIPSState, f[0]) + r * 4;
+}
+
+typedef FixupBranch (RiscVEmitter::*BranchFunc)(RiscVReg, RiscVReg);
+
+static inline bool FitsSImm12(s64 v) {
+	return v >= -2048 && v < 2048;
+}
+
+// Runs a single instruction through the IR interpreter.
+// Returns 0 to continue, or the PC to exit to.
+static u32 RunIRFallback(MIPSState *mips, u64 encoded) {
+	IRInst inst[2];
+	memcpy(&inst[0], &encoded, sizeof(IRInst));
+	inst[1] = { IROp::ExitToConst, { 0 }, 0, 0, 0 };
+	return IRInterpret(mips, inst, 2);
+}
+
+// Ops handled by CompGeneric(), which must see every register in MIPSState.
+static bool NeedsFallback(const IRInst &inst) {
+	switch (inst.op) {
+	case IROp::SetConst:
+	case IROp::SetConstF:
+	case IROp::Mov:
+	case IROp::Add:
+	case IROp::Sub:
+	case IROp::And:
+	case IROp::Or:
+	case IROp::Xor:
+	case IROp::AddConst:
+	case IROp::SubConst:
+	case IROp::AndConst:
+	case IROp::OrConst:
+	case IROp::XorConst:
+	case IROp::Neg:
+	case IROp::Not:
+	case IROp::Ext8to32:
+	case IROp::Ext16to32:
+	case IROp::ShlImm:
+	case IROp::ShrImm:
+	case IROp::SarImm:
+	case IROp::RorImm:
+	case IROp::Shl:
+	case IROp::Shr:
+	case IROp::Sar:
+	case IROp::Ror:
+	case IROp::Slt:
+	case IROp::SltU:
+	case IROp::SltConst:
+	case IROp::SltUConst:
+	case IROp::MovZ:
+	case IROp::MovNZ:
+	case IROp::Max:
+	case IROp::Min:
+	case IROp::MtLo:
+	case IROp::MtHi:
+	case IROp::MfLo:
+	case IROp::MfHi:
+	case IROp::Mult:
+	case IROp::MultU:
+	case IROp::Madd:
+	case IROp::MaddU:
+	case IROp::Msub:
+	case IROp::MsubU:
+	case IROp::Load8:
+	case IROp::Load8Ext:
+	case IROp::Load16:
+	case IROp::Load16Ext:
+	case IROp::Load32:
+	case IROp::LoadFloat:
+	case IROp::LoadVec4:
+	case IROp::Store8:
+	case IROp::Store16:
+	case IROp::Store32:
+	case IROp::StoreFloat:
+	case IROp::StoreVec4:
+	// FMul only falls back for NANs, and doesn't touch GPRs.
+	case IROp::FAdd:
+	case IROp::FSub:
+	case IROp::FMul:
+	case IROp::FDiv:
+	case IROp::FMov:
+	case IROp::FAbs:
+	case IROp::FNeg:
+	case IROp::FSqrt:
+	case IROp::FCvtSW:
+	case IROp::FMovFromGPR:
+	case IROp::FMovToGPR:
+	case IROp::Vec4Init:
+	case IROp::Vec4Shuffle:
+	case IROp::Vec4Mov:
+	case IROp::Vec4Add:
+	case IROp::Vec4Sub:
+	case IROp::Vec4Mul:
+	case IROp::Vec4Div:
+	case IROp::Vec4Scale:
+	case IROp::Vec4Neg:
+	case IROp::Vec4Abs:
+	case IROp::Vec4ClampToZero:
+	case IROp::Vec4Dot:
+	case IROp::FpCondToReg:
+	case IROp::VfpuCtrlToReg:
+	case IROp::ZeroFpCond:
+	case IROp::SetCtrlVFPU:
+	case IROp::SetCtrlVFPUReg:
+	case IROp::SetCtrlVFPUFReg:
+	case IROp::ExitToConst:
+	case IROp::ExitToReg:
+	case IROp::ExitToPC:
+	case IROp::ExitToConstIfEq:
+	case IROp::ExitToConstIfNeq:
+	case IROp::ExitToConstIfGtZ:
+	case IROp::ExitToConstIfGeZ:
+	case IROp::ExitToConstIfLtZ:
+	case IROp::ExitToConstIfLeZ:
+	case IROp::Downcount:
+	case IROp::SetPC:
+	case IROp::SetPCConst:
+	case IROp::ApplyRoundingMode:
+	case IROp::RestoreRoundingMode:
+	case IROp::UpdateRoundingMode:
+		return false;
+
+	default:
+		return true;
+	}
+}
+
+IRToRiscV::EnterBlockFunc IRToRiscV::GenerateFixedCode() {
+	_assert_(code_ != nullptr);
+
+	// u32 enterBlock(MIPSState *mips, const u8 *block)
+	EnterBlockFunc enterBlock = (EnterBlockFunc)code_->AlignCode16();
+	code_->ADDI(R_SP, R_SP, -ENTER_STACK_SIZE);
+	code_->SD(R_RA, R_SP, 0);
+	code_->SD(X8, R_SP, 8);
+	code_->SD(X9, R_SP, 16);
+	for (int i = 0; i < (int)ARRAY_SIZE(allocGPRs); ++i)
+		code_->SD(allocGPRs[i], R_SP, 24 + i * 8);
+	code_->MV(CTXREG, X10);
+	code_->LI(MEMBASEREG, (uintptr_t)&Memory::base, SCRATCH1);
+	code_->LD(MEMBASEREG, MEMBASEREG, 0);
+	code_->JR(X11);
+
+	// Blocks jump here with the next PC in A0.
+	exitStub_ = code_->AlignCode16();
+	code_->LD(R_RA, R_SP, 0);
+	code_->LD(X8, R_SP, 8);
+	code_->LD(X9, R_SP, 16);
+	for (int i = 0; i < (int)ARRAY_SIZE(allocGPRs); ++i)
+		code_->LD(allocGPRs[i], R_SP, 24 + i * 8);
+	code_->ADDI(R_SP, R_SP, ENTER_STACK_SIZE);
+	code_->RET();
+
+	return enterBlock;
+}
+
+RiscVReg IRToRiscV::SrcGPR1(const IRInst &inst, RiscVReg scratch) {
+	int reg = regAlloc_.Src1Reg(curInst_);
+	if (reg != IRRegAllocator::NO_REG)
+		return allocGPRs[reg];
+	if (inst.src1 == MIPS_REG_ZERO)
+		return R_ZERO;
+	code_->LW(scratch, CTXREG, IRGPR(inst.src1));
+	return scratch;
+}
+
+RiscVReg IRToRiscV::SrcGPR2(const IRInst &inst, RiscVReg scratch) {
+	int reg = regAlloc_.Src2Reg(curInst_);
+	if (reg != IRRegAllocator::NO_REG)
+		return allocGPRs[reg];
+	if (inst.src2 == MIPS_REG_ZERO)
+		return R_ZERO;
+	code_->LW(scratch, CTXREG, IRGPR(inst.src2));
+	return scratch;
+}
+
+RiscVReg IRToRiscV::DestGPR(RiscVReg scratch) const {
+	int reg = regAlloc_.DestReg(curInst_);
+	return reg == IRRegAllocator::NO_REG ? scratch : allocGPRs[reg];
+}
+
+void IRToRiscV::FinishDestGPR(const IRInst &inst, RiscVReg reg) {
+	if (regAlloc_.DestReg(curInst_) == IRRegAllocator::NO_REG)
+		code_->SW(reg, CTXREG, IRGPR(inst.dest));
+}
+
+void IRToRiscV::EmitRegActions(int i) {
+	for (auto action = regAlloc_.ActionsBegin(i); action != regAlloc_.ActionsEnd(i); ++action) {
+		_dbg_assert_(!action->fpr);
+		if (action->type == IRRegAllocActionType::STORE)
+			code_->SW(allocGPRs[action->hostReg], CTXREG, IRGPR(action->irReg));
+		else
+			code_->LW(allocGPRs[action->hostReg], CTXREG, IRGPR(action->irReg));
+	}
+}
+
+void IRToRiscV::EmitExit(RiscVReg pc) {
+	if (pc != X10)
+		code_->MV(X10, pc);
+	if (code_->JInRange(exitStub_)) {
+		code_->J(exitStub_);
+	} else {
+		code_->LI(SCRATCH1, (uintptr_t)exitStub_, SCRATCH2);
+		code_->JR(SCRATCH1);
+	}
+}
+
+void IRToRiscV::EmitExitConst(u32 pc) {
+	// Like all 32-bit values in RV64, return values are sign extended.
+	code_->LI(X10, (s32)pc);
+	EmitExit(X10);
+}
+
+void IRToRiscV::EmitAddress(const IRInst &inst, RiscVReg dest) {
+	if (inst.src1 == MIPS_REG_ZERO && regAlloc_.Src1Reg(curInst_) == IRRegAllocator::NO_REG) {
+		code_->LI(dest, (u32)inst.constant);
+	} else {
+		RiscVReg base = SrcGPR1(inst, dest);
+		if (FitsSImm12((s32)inst.constant)) {
+			code_->ADDIW(dest, base, (s32)inst.constant);
+		} else {
+			code_->LI(SCRATCH4, (s32)inst.constant);
+			code_->ADDW(dest, base, SCRATCH4);
+		}
+		// Addresses are 32-bit unsigned, so zero extend.
+		code_->SLLI(dest, dest, 32);
+		code_->SRLI(dest, dest, 32);
+	}
+#ifdef MASKED_PSP_MEMORY
+	code_->LI(SCRATCH4, Memory::MEMVIEW32_MASK);
+	code_->AND(dest, dest, SCRATCH4);
+#endif
+	code_->ADD(dest, dest, MEMBASEREG);
+}
+
+void IRToRiscV::CompGeneric(const IRInst &inst) {
+	u64 encoded;
+	memcpy(&encoded, &inst, sizeof(encoded));
+
+	code_->MV(X10, CTXREG);
+	code_->LI(X11, encoded, SCRATCH1);
+	const void *func = (const void *)&RunIRFallback;
+	if (code_->JInRange(func)) {
+		code_->JAL(R_RA, func);
+	} else {
+		code_->LI(SCRATCH1, (uintptr_t)func, SCRATCH2);
+		code_->JALR(R_RA, SCRATCH1, 0);
+	}
+
+	if ((GetIRMeta(inst.op)->flags & IRFLAG_EXIT) != 0) {
+		FixupBranch skip = code_->BEQ(X10, R_ZERO);
+		EmitExit(X10);
+		code_->SetJumpTarget(skip);
+	}
+}
+
+void IRToRiscV::CompExitIf(const IRInst &inst) {
+	// Branch over the exit when the condition fails.
+	BranchFunc skipIf = nullptr;
+	RiscVReg lhs = SrcGPR1(inst, SCRATCH1);
+	RiscVReg rhs = R_ZERO;
+	switch (inst.op) {
+	case IROp::ExitToConstIfEq:
+	case IROp::ExitToConstIfNeq:
+		rhs = SrcGPR2(inst, SCRATCH2);
+		if (inst.op == IROp::ExitToConstIfEq)
+			skipIf = &RiscVEmitter::BNE;
+		else
+			skipIf = &RiscVEmitter::BEQ;
+		break;
+	case IROp::ExitToConstIfGtZ:
+		// Skip if 0 >= lhs.
+		std::swap(lhs, rhs);
+		skipIf = &RiscVEmitter::BGE;
+		break;
+	case IROp::ExitToConstIfGeZ: skipIf = &RiscVEmitter::BLT; break;
+	case IROp::ExitToConstIfLtZ: skipIf = &RiscVEmitter::BGE; break;
+	case IROp::ExitToConstIfLeZ:
+		// Skip if 0 < lhs.
+		std::swap(lhs, rhs);
+		skipIf = &RiscVEmitter::BLT;
+		break;
+	default:
+		_assert_(false);
+		return;
+	}
+
+	FixupBranch skip = (code_->*skipIf)(lhs, rhs);
+	EmitExitConst(inst.constant);
+	code_->SetJumpTarget(skip);
+}
+
+void IRToRiscV::CompLoadStore(const IRInst &inst) {
+	EmitAddress(inst, SCRATCH1);
+
+	// For stores, the value is in src3, which the allocator tracks as dest.
+	RiscVReg value = R_ZERO;
+	if (inst.op >= IROp::Store8 && inst.op <= IROp::Store32) {
+		int reg = regAlloc_.DestReg(curInst_);
+		if (reg != IRRegAllocator::NO_REG) {
+			value = allocGPRs[reg];
+		} else if (inst.src3 != MIPS_REG_ZERO) {
+			code_->LW(SCRATCH2, CTXREG, IRGPR(inst.src3));
+			value = SCRATCH2;
+		}
+	}
+
+	switch (inst.op) {
+	case IROp::Load8:
+	case IROp::Load8Ext:
+	case IROp::Load16:
+	case IROp::Load16Ext:
+	case IROp::Load32:
+	{
+		RiscVReg dest = DestGPR(SCRATCH2);
+		switch (inst.op) {
+		case IROp::Load8: code_->LBU(dest, SCRATCH1, 0); break;
+		case IROp::Load8Ext: code_->LB(dest, SCRATCH1, 0); break;
+		case IROp::Load16: code_->LHU(dest, SCRATCH1, 0); break;
+		case IROp::Load16Ext: code_->LH(dest, SCRATCH1, 0); break;
+		case IROp::Load32: code_->LW(dest, SCRATCH1, 0); break;
+		default: break;
+		}
+		FinishDestGPR(inst, dest);
+		break;
+	}
+	case IROp::LoadFloat:
+		code_->LW(SCRATCH2, SCRATCH1, 0);
+		code_->SW(SCRATCH2, CTXREG, IRFPR(inst.dest));
+		break;
+	case IROp::LoadVec4:
+		for (int i = 0; i < 4; ++i) {
+			code_->LW(SCRATCH2, SCRATCH1, i * 4);
+			code_->SW(SCRATCH2, CTXREG, IRFPR(inst.dest + i));
+		}
+		break;
+
+	case IROp::Store8:
+		code_->SB(value, SCRATCH1, 0);
+		break;
+	case IROp::Store16:
+		code_->SH(value, SCRATCH1, 0);
+		break;
+	case IROp::Store32:
+		code_->SW(value, SCRATCH1, 0);
+		break;
+	case IROp::StoreFloat:
+		code_->LW(SCRATCH2, CTXREG, IRFPR(inst.src3));
+		code_->SW(SCRATCH2, SCRATCH1, 0);
+		break;
+	case IROp::StoreVec4:
+		for (int i = 0; i < 4; ++i) {
+			code_->LW(SCRATCH2, CTXREG, IRFPR(inst.src3 + i));
+			code_->SW(SCRATCH2, SCRATCH1, i * 4);
+		}
+		break;
+
+	default:
+		_assert_(false);
+		break;
+	}
+}
+
+void IRToRiscV::CompFPU(const IRInst &inst) {
+	switch (inst.op) {
+	case IROp::FAdd:
+	case IROp::FSub:
+	case IROp::FDiv:
+		code_->FLW(F0, CTXREG, IRFPR(inst.src1));
+		code_->FLW(F1, CTXREG, IRFPR(inst.src2));
+		switch (inst.op) {
+		case IROp::FAdd: code_->FADD(32, F0, F0, F1); break;
+		case IROp::FSub: code_->FSUB(32, F0, F0, F1); break;
+		case IROp::FDiv: code_->FDIV(32, F0, F0, F1); break;
+		default: break;
+		}
+		code_->FSW(F0, CTXREG, IRFPR(inst.dest));
+		break;
+
+	case IROp::FMul:
+	{
+		code_->FLW(F0, CTXREG, IRFPR(inst.src1));
+		code_->FLW(F1, CTXREG, IRFPR(inst.src2));
+		code_->FMUL(32, F0, F0, F1);
+		// NAN results need the PSP's specific NAN (inf * 0), let the interpreter sort those out.
+		code_->FEQ(32, SCRATCH1, F0, F0);
+		FixupBranch slow = code_->BEQ(SCRATCH1, R_ZERO);
+		code_->FSW(F0, CTXREG, IRFPR(inst.dest));
+		FixupBranch done = code_->J();
+		code_->SetJumpTarget(slow);
+		CompGeneric(inst);
+		code_->SetJumpTarget(done);
+		break;
+	}
+
+	case IROp::FSqrt:
+		code_->FLW(F0, CTXREG, IRFPR(inst.src1));
+		code_->FSQRT(32, F0, F0);
+		code_->FSW(F0, CTXREG, IRFPR(inst.dest));
+		break;
+
+	case IROp::FMov:
+		code_->LW(SCRATCH1, CTXREG, IRFPR(inst.src1));
+		code_->SW(SCRATCH1, CTXREG, IRFPR(inst.dest));
+		break;
+	case IROp::FAbs:
+	case IROp::FNeg:
+		// Sign injection only touches the sign bit, even for NANs.
+		code_->FLW(F0, CTXREG, IRFPR(inst.src1));
+		if (inst.op == IROp::FAbs)
+			code_->FABS(32, F0, F0);
+		else
+			code_->FNEG(32, F0, F0);
+		code_->FSW(F0, CTXREG, IRFPR(inst.dest));
+		break;
+
+	case IROp::FCvtSW:
+		code_->LW(SCRATCH1, CTXREG, IRFPR(inst.src1));
+		code_->FCVT(FConv::S, FConv::W, F0, SCRATCH1);
+		code_->FSW(F0, CTXREG, IRFPR(inst.dest));
+		break;
+
+	case IROp::FMovFromGPR:
+		code_->SW(SrcGPR1(inst, SCRATCH1), CTXREG, IRFPR(inst.dest));
+		break;
+	case IROp::FMovToGPR:
+	{
+		RiscVReg dest = DestGPR(SCRATCH1);
+		code_->LW(dest, CTXREG, IRFPR(inst.src1));
+		FinishDestGPR(inst, dest);
+		break;
+	}
+
+	default:
+		CompGeneric(inst);
+		break;
+	}
+}
+
+void IRToRiscV::CompVec4(const IRInst &inst) {
+	// No vector extension assumed, so these are done a lane at a time.  All lanes are read before
+	// any are written, since dest may overlap the sources.
+	static const RiscVReg lanes[4] = { SCRATCH1, SCRATCH2, SCRATCH3, SCRATCH4 };
+
+	switch (inst.op) {
+	case IROp::Vec4Init:
+		for (int i = 0; i < 4; ++i) {
+			u32 bits;
+			memcpy(&bits, &vec4InitValues[inst.src1][i], sizeof(bits));
+			if (bits == 0) {
+				code_->SW(R_ZERO, CTXREG, IRFPR(inst.dest + i));
+			} else {
+				code_->LI(SCRATCH1, (s32)bits);
+				code_->SW(SCRATCH1, CTXREG, IRFPR(inst.dest + i));
+			}
+		}
+		break;
+
+	case IROp::Vec4Shuffle:
+		for (int i = 0; i < 4; ++i)
+			code_->LW(lanes[i], CTXREG, IRFPR(inst.src1 + ((inst.src2 >> (i * 2)) & 3)));
+		for (int i = 0; i < 4; ++i)
+			code_->SW(lanes[i], CTXREG, IRFPR(inst.dest + i));
+		break;
+
+	case IROp::Vec4Mov:
+		// Vec4 regs are always 16-byte aligned in MIPSState.
+		code_->LD(SCRATCH1, CTXREG, IRFPR(inst.src1));
+		code_->LD(SCRATCH2, CTXREG, IRFPR(inst.src1 + 2));
+		code_->SD(SCRATCH1, CTXREG, IRFPR(inst.dest));
+		code_->SD(SCRATCH2, CTXREG, IRFPR(inst.dest + 2));
+		break;
+
+	case IROp::Vec4Add:
+	case IROp::Vec4Sub:
+	case IROp::Vec4Mul:
+	case IROp::Vec4Div:
+		for (int i = 0; i < 4; ++i) {
+			RiscVReg lhs = (RiscVReg)(F0 + i), rhs = (RiscVReg)(F4 + i);
+			code_->FLW(lhs, CTXREG, IRFPR(inst.src1 + i));
+			code_->FLW(rhs, CTXREG, IRFPR(inst.src2 + i));
+			switch (inst.op) {
+			case IROp::Vec4Add: code_->FADD(32, lhs, lhs, rhs); break;
+			case IROp::Vec4Sub: code_->FSUB(32, lhs, lhs, rhs); break;
+			case IROp::Vec4Mul: code_->FMUL(32, lhs, lhs, rhs); break;
+			case IROp::Vec4Div: code_->FDIV(32, lhs, lhs, rhs); break;
+			default: break;
+			}
+		}
+		for (int i = 0; i < 4; ++i)
+			code_->FSW((RiscVReg)(F0 + i), CTXREG, IRFPR(inst.dest + i));
+		break;
+
+	case IROp::Vec4Scale:
+		code_->FLW(F4, CTXREG, IRFPR(inst.src2));
+		for (int i = 0; i < 4; ++i) {
+			code_->FLW((RiscVReg)(F0 + i), CTXREG, IRFPR(inst.src1 + i));
+			code_->FMUL(32, (RiscVReg)(F0 + i), (RiscVReg)(F0 + i), F4);
+		}
+		for (int i = 0; i < 4; ++i)
+			code_->FSW((RiscVReg)(F0 + i), CTXREG, IRFPR(inst.dest + i));
+		break;
+
+	case IROp::Vec4Neg:
+	case IROp::Vec4Abs:
+		for (int i = 0; i < 4; ++i) {
+			code_->FLW((RiscVReg)(F0 + i), CTXREG, IRFPR(inst.src1 + i));
+			if (inst.op == IROp::Vec4Neg)
+				code_->FNEG(32, (RiscVReg)(F0 + i), (RiscVReg)(F0 + i));
+			else
+				code_->FABS(32, (RiscVReg)(F0 + i), (RiscVReg)(F0 + i));
+		}
+		for (int i = 0; i < 4; ++i)
+			code_->FSW((RiscVReg)(F0 + i), CTXREG, IRFPR(inst.dest + i));
+		break;
+
+	case IROp::Vec4ClampToZero:
+		// Expand the sign bit into a mask, and use it to zero negative values.
+		for (int i = 0; i < 4; ++i) {
+			code_->LW(lanes[i], CTXREG, IRFPR(inst.src1 + i));
+			code_->SRAIW(SCRATCH5, lanes[i], 31);
+			code_->NOT(SCRATCH5, SCRATCH5);
+			code_->AND(lanes[i], lanes[i], SCRATCH5);
+		}
+		for (int i = 0; i < 4; ++i)
+			code_->SW(lanes[i], CTXREG, IRFPR(inst.dest + i));
+		break;
+
+	case IROp::Vec4Dot:
+		// Add in the same order as the interpreter, and never fuse the multiplies.
+		for (int i = 0; i < 4; ++i) {
+			code_->FLW((RiscVReg)(F0 + i), CTXREG, IRFPR(inst.src1 + i));
+			code_->FLW((RiscVReg)(F4 + i), CTXREG, IRFPR(inst.src2 + i));
+		}
+		code_->FMUL(32, F0, F0, F4);
+		for (int i = 1; i < 4; ++i) {
+			code_->FMUL(32, (RiscVReg)(F0 + i), (RiscVReg)(F0 + i), (RiscVReg)(F4 + i));
+			code_->FADD(32, F0, F0, (RiscVReg)(F0 + i));
+		}
+		code_->FSW(F0, CTXREG, IRFPR(inst.dest));
+		break;
+
+	default:
+		CompGeneric(inst);
+		break;
+	}
+}
+
+// This requires that the block ends in an exit, as the IR interpreter does.
+const u8 *IRToRiscV::ConvertIRToNative(const IRInst *instructions, int count) {
+	_assert_(code_ != nullptr && exitStub_ != nullptr);
+	const u8 *start = code_->AlignCode16();
+
+	IRRegAllocConfig config;
+	config.numGPRs = (int)ARRAY_SIZE(allocGPRs);
+	config.isBarrier = &NeedsFallback;
+	regAlloc_.Allocate(instructions, count, config);
+
+	for (int i = 0; i < count; i++) {
+		const IRInst &inst = instructions[i];
+		curInst_ = i;
+		EmitRegActions(i);
+		switch (inst.op) {
+		case IROp::Nop:
+			_assert_(false);
+			break;
+
+		case IROp::SetConst:
+		{
+			RiscVReg dest = DestGPR(SCRATCH1);
+			if (inst.constant == 0 && dest == SCRATCH1) {
+				code_->SW(R_ZERO, CTXREG, IRGPR(inst.dest));
+				break;
+			}
+			code_->LI(dest, (s32)inst.constant);
+			FinishDestGPR(inst, dest);
+			break;
+		}
+		case IROp::SetConstF:
+			if (inst.constant == 0) {
+				code_->SW(R_ZERO, CTXREG, IRFPR(inst.dest));
+			} else {
+				code_->LI(SCRATCH1, (s32)inst.constant);
+				code_->SW(SCRATCH1, CTXREG, IRFPR(inst.dest));
+			}
+			break;
+
+		case IROp::Mov:
+			if (inst.dest != inst.src1) {
+				RiscVReg src = SrcGPR1(inst, SCRATCH1);
+				RiscVReg dest = DestGPR(src);
+				if (dest != src)
+					code_->MV(dest, src);
+				FinishDestGPR(inst, dest);
+			}
+			break;
+
+		case IROp::Add:
+		case IROp::Sub:
+		case IROp::And:
+		case IROp::Or:
+		case IROp::Xor:
+		{
+			RiscVReg lhs = SrcGPR1(inst, SCRATCH1);
+			RiscVReg rhs = SrcGPR2(inst, SCRATCH2);
+			RiscVReg dest = DestGPR(SCRATCH1);
+			switch (inst.op) {
+			case IROp::Add: code_->ADDW(dest, lhs, rhs); break;
+			case IROp::Sub: code_->SUBW(dest, lhs, rhs); break;
+			case IROp::And: code_->AND(dest, lhs, rhs); break;
+			case IROp::Or: code_->OR(dest, lhs, rhs); break;
+			case IROp::Xor: code_->XOR(dest, lhs, rhs); break;
+			default: break;
+			}
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::AddConst:
+		case IROp::SubConst:
+		{
+			RiscVReg src = SrcGPR1(inst, SCRATCH1);
+			RiscVReg dest = DestGPR(SCRATCH1);
+			s64 imm = inst.op == IROp::SubConst ? -(s64)(s32)inst.constant : (s64)(s32)inst.constant;
+			if (FitsSImm12(imm)) {
+				code_->ADDIW(dest, src, (s32)imm);
+			} else {
+				code_->LI(SCRATCH2, (s32)inst.constant);
+				if (inst.op == IROp::AddConst)
+					code_->ADDW(dest, src, SCRATCH2);
+				else
+					code_->SUBW(dest, src, SCRATCH2);
+			}
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::AndConst:
+		case IROp::OrConst:
+		case IROp::XorConst:
+		{
+			// Both sides are sign extended, so the 64-bit ops keep the result sign extended.
+			RiscVReg src = SrcGPR1(inst, SCRATCH1);
+			RiscVReg dest = DestGPR(SCRATCH1);
+			s32 imm = (s32)inst.constant;
+			if (FitsSImm12(imm)) {
+				switch (inst.op) {
+				case IROp::AndConst: code_->ANDI(dest, src, imm); break;
+				case IROp::OrConst: code_->ORI(dest, src, imm); break;
+				case IROp::XorConst: code_->XORI(dest, src, imm); break;
+				default: break;
+				}
+			} else {
+				code_->LI(SCRATCH2, imm);
+				switch (inst.op) {
+				case IROp::AndConst: code_->AND(dest, src, SCRATCH2); break;
+				case IROp::OrConst: code_->OR(dest, src, SCRATCH2); break;
+				case IROp::XorConst: code_->XOR(dest, src, SCRATCH2); break;
+				default: break;
+				}
+			}
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::Neg:
+		case IROp::Not:
+		{
+			RiscVReg src = SrcGPR1(inst, SCRATCH1);
+			RiscVReg dest = DestGPR(SCRATCH1);
+			if (inst.op == IROp::Neg)
+				code_->NEGW(dest, src);
+			else
+				code_->NOT(dest, src);
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::Ext8to32:
+		case IROp::Ext16to32:
+		{
+			int shift = inst.op == IROp::Ext8to32 ? 56 : 48;
+			RiscVReg src = SrcGPR1(inst, SCRATCH1);
+			RiscVReg dest = DestGPR(SCRATCH1);
+			code_->SLLI(dest, src, shift);
+			code_->SRAI(dest, dest, shift);
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::ShlImm:
+		case IROp::ShrImm:
+		case IROp::SarImm:
+		case IROp::RorImm:
+		{
+			RiscVReg src = SrcGPR1(inst, SCRATCH1);
+			RiscVReg dest = DestGPR(SCRATCH1);
+			u32 shift = inst.src2 & 31;
+			// The emitter rejects zero shift amounts, and values are already sign extended.
+			if (shift == 0) {
+				code_->MV(dest, src);
+				FinishDestGPR(inst, dest);
+				break;
+			}
+			switch (inst.op) {
+			case IROp::ShlImm: code_->SLLIW(dest, src, shift); break;
+			case IROp::ShrImm: code_->SRLIW(dest, src, shift); break;
+			case IROp::SarImm: code_->SRAIW(dest, src, shift); break;
+			case IROp::RorImm:
+				code_->SRLIW(SCRATCH2, src, shift);
+				code_->SLLIW(SCRATCH3, src, 32 - shift);
+				code_->OR(dest, SCRATCH2, SCRATCH3);
+				break;
+			default: break;
+			}
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::Shl:
+		case IROp::Shr:
+		case IROp::Sar:
+		case IROp::Ror:
+		{
+			// The W shifts only use the low 5 bits of the amount, just like the interpreter.
+			RiscVReg lhs = SrcGPR1(inst, SCRATCH1);
+			RiscVReg rhs = SrcGPR2(inst, SCRATCH2);
+			RiscVReg dest = DestGPR(SCRATCH1);
+			switch (inst.op) {
+			case IROp::Shl: code_->SLLW(dest, lhs, rhs); break;
+			case IROp::Shr: code_->SRLW(dest, lhs, rhs); break;
+			case IROp::Sar: code_->SRAW(dest, lhs, rhs); break;
+			case IROp::Ror:
+				code_->SRLW(SCRATCH3, lhs, rhs);
+				code_->NEGW(SCRATCH4, rhs);
+				code_->SLLW(SCRATCH4, lhs, SCRATCH4);
+				code_->OR(dest, SCRATCH3, SCRATCH4);
+				break;
+			default: break;
+			}
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::Slt:
+		case IROp::SltU:
+		{
+			// With both sides sign extended, the 64-bit unsigned compare still works.
+			RiscVReg lhs = SrcGPR1(inst, SCRATCH1);
+			RiscVReg rhs = SrcGPR2(inst, SCRATCH2);
+			RiscVReg dest = DestGPR(SCRATCH1);
+			if (inst.op == IROp::Slt)
+				code_->SLT(dest, lhs, rhs);
+			else
+				code_->SLTU(dest, lhs, rhs);
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::SltConst:
+		case IROp::SltUConst:
+		{
+			RiscVReg src = SrcGPR1(inst, SCRATCH1);
+			RiscVReg dest = DestGPR(SCRATCH1);
+			s32 imm = (s32)inst.constant;
+			if (FitsSImm12(imm)) {
+				if (inst.op == IROp::SltConst)
+					code_->SLTI(dest, src, imm);
+				else
+					code_->SLTIU(dest, src, imm);
+			} else {
+				code_->LI(SCRATCH2, imm);
+				if (inst.op == IROp::SltConst)
+					code_->SLT(dest, src, SCRATCH2);
+				else
+					code_->SLTU(dest, src, SCRATCH2);
+			}
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::MovZ:
+		case IROp::MovNZ:
+		{
+			RiscVReg cond = SrcGPR1(inst, SCRATCH1);
+			BranchFunc skipIf = &RiscVEmitter::BEQ;
+			if (inst.op == IROp::MovZ)
+				skipIf = &RiscVEmitter::BNE;
+			FixupBranch skip = (code_->*skipIf)(cond, R_ZERO);
+			RiscVReg src = SrcGPR2(inst, SCRATCH2);
+			RiscVReg dest = DestGPR(src);
+			if (dest != src)
+				code_->MV(dest, src);
+			FinishDestGPR(inst, dest);
+			code_->SetJumpTarget(skip);
+			break;
+		}
+
+		case IROp::Max:
+		case IROp::Min:
+		{
+			RiscVReg lhs = SrcGPR1(inst, SCRATCH1);
+			RiscVReg rhs = SrcGPR2(inst, SCRATCH2);
+			// Dest may be either source, so pick in a scratch reg.
+			code_->MV(SCRATCH3, lhs);
+			// Keep lhs if it's already the larger (or smaller) one.
+			FixupBranch skip = code_->BLT(inst.op == IROp::Max ? rhs : lhs, inst.op == IROp::Max ? lhs : rhs);
+			code_->MV(SCRATCH3, rhs);
+			code_->SetJumpTarget(skip);
+			RiscVReg dest = DestGPR(SCRATCH3);
+			if (dest != SCRATCH3)
+				code_->MV(dest, SCRATCH3);
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::MtLo:
+		case IROp::MtHi:
+			code_->SW(SrcGPR1(inst, SCRATCH1), CTXREG, inst.op == IROp::MtLo ? offsetof(MIPSState, lo) : offsetof(MIPSState, hi));
+			break;
+		case IROp::MfLo:
+		case IROp::MfHi:
+		{
+			RiscVReg dest = DestGPR(SCRATCH1);
+			code_->LW(dest, CTXREG, inst.op == IROp::MfLo ? offsetof(MIPSState, lo) : offsetof(MIPSState, hi));
+			FinishDestGPR(inst, dest);
+			break;
+		}
+
+		case IROp::Mult:
+		case IROp::MultU:
+		case IROp::Madd:
+		case IROp::MaddU:
+		case IROp::Msub:
+		case IROp::MsubU:
+		{
+			// lo and hi are adjacent, so we can treat them as one 64-bit value.
+			RiscVReg lhs = SrcGPR1(inst, SCRATCH1);
+			RiscVReg rhs = SrcGPR2(inst, SCRATCH2);
+			if (inst.op == IROp::Mult || inst.op == IROp::Madd || inst.op == IROp::Msub) {
+				// Already sign extended, so a 64-bit multiply gives the full product.
+				code_->MUL(SCRATCH3, lhs, rhs);
+			} else {
+				// Shifted up, the high half of the 128-bit product is the unsigned 64-bit product.
+				code_->SLLI(SCRATCH3, lhs, 32);
+				code_->SLLI(SCRATCH4, rhs, 32);
+				code_->MULHU(SCRATCH3, SCRATCH3, SCRATCH4);
+			}
+			if (inst.op != IROp::Mult && inst.op != IROp::MultU) {
+				code_->LD(SCRATCH4, CTXREG, offsetof(MIPSState, lo));
+				if (inst.op == IROp::Madd || inst.op == IROp::MaddU)
+					code_->ADD(SCRATCH3, SCRATCH4, SCRATCH3);
+				else
+					code_->SUB(SCRATCH3, SCRATCH4, SCRATCH3);
+			}
+			code_->SD(SCRATCH3, CTXREG, offsetof(MIPSState, lo));
+			break;
+		}
+
+		case IROp::Load8:
+		case IROp::Load8Ext:
+		case IROp::Load16:
+		case IROp::Load16Ext:
+		case IROp::Load32:
+		case IROp::LoadFloat:
+		case IROp::LoadVec4:
+		case IROp::Store8:
+		case IROp::Store16:
+		case IROp::Store32:
+		case IROp::StoreFloat:
+		case IROp::StoreVec4:
+			CompLoadStore(inst);
+			break;
+
+		case IROp::FAdd:
+		case IROp::FSub:
+		case IROp::FMul:
+		case IROp::FDiv:
+		case IROp::FMov:
+		case IROp::FAbs:
+		case IROp::FNeg:
+		case IROp::FSqrt:
+		case IROp::FCvtSW:
+		case IROp::FMovFromGPR:
+		case IROp::FMovToGPR:
+			CompFPU(inst);
+			break;
+
+		case IROp::Vec4Init:
+		case IROp::Vec4Shuffle:
+		case IROp::Vec4Mov:
+		case IROp::Vec4Add:
+		case IROp::Vec4Sub:
+		case IROp::Vec4Mul:
+		case IROp::Vec4Div:
+		case IROp::Vec4Scale:
+		case IROp::Vec4Neg:
+		case IROp::Vec4Abs:
+		case IROp::Vec4ClampToZero:
+		case IROp::Vec4Dot:
+			CompVec4(inst);
+			break;
+
+		case IROp::FpCondToReg:
+		case IROp::VfpuCtrlToReg:
+		{
+			RiscVReg dest = DestGPR(SCRATCH1);
+			if (inst.op == IROp::FpCondToReg)
+				code_->LW(dest, CTXREG, offsetof(MIPSState, fpcond));
+			else
+				code_->LW(dest, CTXREG, offsetof(MIPSState, vfpuCtrl) + inst.src1 * 4);
+			FinishDestGPR(inst, dest);
+			break;
+		}
+		case IROp::ZeroFpCond:
+			code_->SW(R_ZERO, CTXREG, offsetof(MIPSState, fpcond));
+			break;
+
+		case IROp::SetCtrlVFPU:
+			if (inst.constant == 0) {
+				code_->SW(R_ZERO, CTXREG, offsetof(MIPSState, vfpuCtrl) + inst.dest * 4);
+			} else {
+				code_->LI(SCRATCH1, (s32)inst.constant);
+				code_->SW(SCRATCH1, CTXREG, offsetof(MIPSState, vfpuCtrl) + inst.dest * 4);
+			}
+			break;
+		case IROp::SetCtrlVFPUReg:
+			code_->SW(SrcGPR1(inst, SCRATCH1), CTXREG, offsetof(MIPSState, vfpuCtrl) + inst.dest * 4);
+			break;
+		case IROp::SetCtrlVFPUFReg:
+			code_->LW(SCRATCH1, CTXREG, IRFPR(inst.src1));
+			code_->SW(SCRATCH1, CTXREG, offsetof(MIPSState, vfpuCtrl) + inst.dest * 4);
+			break;
+
+		case IROp::ExitToConst:
+			EmitExitConst(inst.constant);
+			break;
+		case IROp::ExitToReg:
+			EmitExit(SrcGPR1(inst, SCRATCH1));
+			break;
+		case IROp::ExitToPC:
+			code_->LW(X10, CTXREG, offsetof(MIPSState, pc));
+			EmitExit(X10);
+			break;
+		case IROp::ExitToConstIfEq:
+		case IROp::ExitToConstIfNeq:
+		case IROp::ExitToConstIfGtZ:
+		case IROp::ExitToConstIfGeZ:
+		case IROp::ExitToConstIfLtZ:
+		case IROp::ExitToConstIfLeZ:
+			CompExitIf(inst);
+			break;
+
+		case IROp::Downcount:
+			code_->LW(SCRATCH1, CTXREG, offsetof(MIPSState, downcount));
+			if (FitsSImm12(-(s64)(s32)inst.constant)) {
+				code_->ADDIW(SCRATCH1, SCRATCH1, -(s32)inst.constant);
+			} else {
+				code_->LI(SCRATCH2, (s32)inst.constant);
+				code_->SUBW(SCRATCH1, SCRATCH1, SCRATCH2);
+			}
+			code_->SW(SCRATCH1, CTXREG, offsetof(MIPSState, downcount));
+			break;
+		case IROp::SetPC:
+			code_->SW(SrcGPR1(inst, SCRATCH1), CTXREG, offsetof(MIPSState, pc));
+			break;
+		case IROp::SetPCConst:
+			code_->LI(SCRATCH1, (s32)inst.constant);
+			code_->SW(SCRATCH1, CTXREG, offsetof(MIPSState, pc));
+			break;
+
+		case IROp::ApplyRoundingMode:
+		case IROp::RestoreRoundingMode:
+		case IROp::UpdateRoundingMode:
+			// Not implemented by the interpreter either.
+			break;
+
+		default:
+			// Syscalls, replacements, debugging ops, and the less common ALU/FPU/VFPU ops.
+			CompGeneric(inst);
+			break;
+		}
+	}
+
+	// If we got here, the block was badly constructed.
+	EmitRegActions(count);
+	code_->EBREAK();
+	code_->FlushIcache();
+	return start;
+}
+
+}  // namespace
+
+#endif // PPSSPP_ARCH(RISCV64)
@@ -0,0 +1,86 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include "Common/RiscVEmitter.h"
+#include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/IR/IRRegAlloc.h"
+
+struct MIPSState;
+
+namespace RiscVJitConstants {
+	const RiscVGen::RiscVReg CTXREG = RiscVGen::X8;
+	const RiscVGen::RiscVReg MEMBASEREG = RiscVGen::X9;
+
+	// Caller saved, all clobbered freely within an op.
+	const RiscVGen::RiscVReg SCRATCH1 = RiscVGen::X5;
+	const RiscVGen::RiscVReg SCRATCH2 = RiscVGen::X6;
+	const RiscVGen::RiscVReg SCRATCH3 = RiscVGen::X7;
+	const RiscVGen::RiscVReg SCRATCH4 = RiscVGen::X28;
+	const RiscVGen::RiscVReg SCRATCH5 = RiscVGen::X29;
+}
+
+namespace MIPSComp {
+
+// Lowers IR blocks to RV64GC. Like IRToX86, ops without a native implementation call into the
+// IR interpreter for just that instruction, so every block can be converted.
+//
+// The code expects CTXREG to point at the MIPSState and MEMBASEREG at Memory::base, and leaves
+// through the exit stub with the next PC in A0.  GPRs chosen by IRRegAllocator live in callee
+// saved registers within each block, always sign extended from 32 bits as RV64 prefers.
+class IRToRiscV : public IRToNativeInterface {
+public:
+	typedef u32 (*EnterBlockFunc)(MIPSState *mips, const u8 *block);
+
+	void SetCodeBlock(RiscVGen::RiscVCodeBlock *code) { code_ = code; }
+	// Emits the entry and exit stubs at the current code pointer.  Must be called before converting.
+	EnterBlockFunc GenerateFixedCode();
+	const u8 *GetExitStub() const { return exitStub_; }
+
+	const u8 *ConvertIRToNative(const IRInst *instructions, int count) override;
+
+	const IRRegAllocStats &GetRegAllocStats() const { return regAlloc_.GetStats(); }
+
+private:
+	void CompGeneric(const IRInst &inst);
+	void CompExitIf(const IRInst &inst);
+	void CompLoadStore(const IRInst &inst);
+	void CompFPU(const IRInst &inst);
+	void CompVec4(const IRInst &inst);
+
+	void EmitAddress(const IRInst &inst, RiscVGen::RiscVReg dest);
+	void EmitExit(RiscVGen::RiscVReg pc);
+	void EmitExitConst(u32 pc);
+	void EmitRegActions(int i);
+
+	// The host register holding each GPR operand of the current instruction.  Operands that
+	// aren't mapped are loaded into (or for dest, should be computed in) the scratch register.
+	RiscVGen::RiscVReg SrcGPR1(const IRInst &inst, RiscVGen::RiscVReg scratch);
+	RiscVGen::RiscVReg SrcGPR2(const IRInst &inst, RiscVGen::RiscVReg scratch);
+	RiscVGen::RiscVReg DestGPR(RiscVGen::RiscVReg scratch) const;
+	// Stores the dest back to MIPSState, if it wasn't mapped.
+	void FinishDestGPR(const IRInst &inst, RiscVGen::RiscVReg reg);
+
+	RiscVGen::RiscVCodeBlock *code_ = nullptr;
+	const u8 *exitStub_ = nullptr;
+	IRRegAllocator regAlloc_;
+	int curInst_ = 0;
+};
+
+}  // namespace
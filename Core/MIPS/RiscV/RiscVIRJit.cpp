@@ -0,0 +1,174 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(RISCV64)
+
+#include <cstddef>
+
+#include "Common/Profiler/Profiler.h"
+#include "Common/Log.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/Debugger/SymbolMap.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/IR/IRInterpreter.h"
+#include "Core/MIPS/RiscV/RiscVIRJit.h"
+
+namespace MIPSComp {
+
+using namespace RiscVGen;
+using namespace RiscVJitConstants;
+
+// Rough upper bound of generated code per IR instruction. Vec4 ops done a lane at a time are the largest.
+static const size_t MAX_BYTES_PER_IRINST = 128;
+
+RiscVIRJit::RiscVIRJit(MIPSState *mipsState) : IRJit(mipsState) {
+	AllocCodeSpace(1024 * 1024 * 16);
+	GenerateFixedCode();
+}
+
+void RiscVIRJit::GenerateFixedCode() {
+	BeginWrite();
+
+	converter_.SetCodeBlock(this);
+	enterBlock_ = converter_.GenerateFixedCode();
+
+	// Entered from the exception handler, with the block's registers intact.
+	crashHandler_ = AlignCode16();
+	LI(SCRATCH1, (uintptr_t)&coreState, SCRATCH2);
+	LI(SCRATCH2, CORE_RUNTIME_ERROR);
+	SW(SCRATCH2, SCRATCH1, 0);
+	LI(SCRATCH1, (uintptr_t)&CoreTiming::ForceCheck, SCRATCH2);
+	JALR(R_RA, SCRATCH1, 0);
+	LW(X10, CTXREG, offsetof(MIPSState, pc));
+	LI(SCRATCH1, (uintptr_t)converter_.GetExitStub(), SCRATCH2);
+	JR(SCRATCH1);
+
+	// Let's spare the pre-generated code from unprotect-reprotect.
+	jitStartOffset_ = (int)GetOffset(AlignCodePage());
+	FlushIcache();
+	EndWrite();
+}
+
+void RiscVIRJit::ClearCache() {
+	IRJit::ClearCache();
+	ClearCodeSpace(jitStartOffset_);
+	FlushIcacheSection(region + jitStartOffset_, region + region_size);
+}
+
+bool RiscVIRJit::CompileTargetBlock(IRBlock *block, int block_num, bool preload) {
+	int count = block->GetNumInstructions();
+	const size_t maxSize = count * MAX_BYTES_PER_IRINST + 16;
+	if (GetSpaceLeft() < maxSize)
+		return false;
+
+	BeginWrite(maxSize);
+	const u8 *start = converter_.ConvertIRToNative(block->GetInstructions(), count);
+	EndWrite();
+	_dbg_assert_msg_((size_t)(GetCodePtr() - start) <= maxSize, "Native code for IR block overflowed estimate");
+
+	block->SetTargetOffset((int)GetOffset(start));
+	return true;
+}
+
+void RiscVIRJit::RunLoopUntil(u64 globalticks) {
+	PROFILE_THIS_SCOPE("jit");
+
+	const u8 *base = GetBasePtr();
+	while (true) {
+		CoreTiming::Advance();
+		if (coreState != 0) {
+			break;
+		}
+		while (mips_->downcount >= 0) {
+			u32 inst = Memory::ReadUnchecked_U32(mips_->pc);
+			u32 opcode = inst & 0xFF000000;
+			if (opcode == MIPS_EMUHACK_OPCODE) {
+				u32 data = inst & 0xFFFFFF;
+				IRBlock *block = blocks_.GetBlock(data);
+				u32 startPC = mips_->pc;
+				int offset = block->GetTargetOffset();
+				if (offset != -1)
+					mips_->pc = enterBlock_(mips_, base + offset);
+				else
+					mips_->pc = IRInterpret(mips_, block->GetInstructions(), block->GetNumInstructions());
+				if (!Memory::IsValidAddress(mips_->pc) || (mips_->pc & 3) != 0) {
+					Core_ExecException(mips_->pc, startPC, ExecExceptionType::JUMP);
+					break;
+				}
+			} else {
+				Compile(mips_->pc);
+			}
+		}
+	}
+}
+
+bool RiscVIRJit::DescribeCodePtr(const u8 *ptr, std::string &name) {
+	if (!IsInSpace(ptr))
+		return false;
+
+	if (ptr == (const u8 *)enterBlock_) {
+		name = "enterBlock";
+		return true;
+	} else if (ptr == converter_.GetExitStub()) {
+		name = "exitStub";
+		return true;
+	} else if (ptr == crashHandler_) {
+		name = "crashHandler";
+		return true;
+	}
+
+	int offset = (int)GetOffset(ptr);
+	if (offset < jitStartOffset_) {
+		name = "PreGenCode";
+		return true;
+	}
+
+	// Find the block that starts closest before this pointer.
+	int bestNum = -1;
+	int bestOffset = -1;
+	for (int i = 0; i < blocks_.GetNumBlocks(); ++i) {
+		int blockOffset = blocks_.GetBlock(i)->GetTargetOffset();
+		if (blockOffset <= offset && blockOffset > bestOffset) {
+			bestOffset = blockOffset;
+			bestNum = i;
+		}
+	}
+
+	u32 start = 0, size = 0;
+	if (bestNum != -1)
+		blocks_.GetBlock(bestNum)->GetRange(start, size);
+	if (start == 0) {
+		name = "UnknownOrDeletedBlock";
+		return true;
+	}
+
+	char temp[1024];
+	const std::string label = g_symbolMap ? g_symbolMap->GetDescription(start) : "";
+	if (!label.empty())
+		snprintf(temp, sizeof(temp), "%08x_%s", start, label.c_str());
+	else
+		snprintf(temp, sizeof(temp), "%08x", start);
+	name = temp;
+	return true;
+}
+
+}  // namespace MIPSComp
+
+#endif
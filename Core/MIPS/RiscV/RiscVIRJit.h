@@ -0,0 +1,64 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include "ppsspp_config.h"
+
+#if PPSSPP_ARCH(RISCV64)
+
+#include <string>
+
+#include "Common/RiscVEmitter.h"
+#include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/RiscV/IRToRiscV.h"
+
+namespace MIPSComp {
+
+// Uses the IR frontend, optimization passes and block cache, but runs the blocks as RISC-V code
+// instead of interpreting them.  There's no other jit on RISC-V, so this is what JIT_IR gets.
+class RiscVIRJit : public IRJit, public RiscVGen::RiscVCodeBlock {
+public:
+	RiscVIRJit(MIPSState *mipsState);
+
+	void RunLoopUntil(u64 globalticks) override;
+
+	void ClearCache() override;
+
+	bool CodeInRange(const u8 *ptr) const override {
+		return IsInSpace(ptr);
+	}
+	bool DescribeCodePtr(const u8 *ptr, std::string &name) override;
+
+	const u8 *GetCrashHandler() const override { return crashHandler_; }
+
+protected:
+	bool CompileTargetBlock(IRBlock *block, int block_num, bool preload) override;
+
+private:
+	void GenerateFixedCode();
+
+	IRToRiscV converter_;
+
+	IRToRiscV::EnterBlockFunc enterBlock_ = nullptr;
+	const u8 *crashHandler_ = nullptr;
+	int jitStartOffset_ = 0;
+};
+
+}  // namespace MIPSComp
+
+#endif
@@ -833,6 +833,22 @@ void Jit::Comp_Syscall(MIPSOpcode op)
 	// When profiling, we can't skip CallSyscall, since it times syscalls.
 	ABI_CallFunctionC(&CallSyscall, op.encoding);
 #else
+	// Quick calls don't need to end the block, unless they changed threads or similar.
+	const HLEFunction *inlineInfo = js.inDelaySlot ? nullptr : GetInlineSyscallFuncPointer(op);
+	if (inlineInfo) {
+		ABI_CallFunctionP((const void *)&CallInlineSyscall, (void *)inlineInfo);
+
+		// If 0, we can keep going.
+		TEST(32, R(EAX), R(EAX));
+		FixupBranch skip = J_CC(CC_Z, true);
+		ApplyRoundingMode();
+		WriteSyscallExit();
+		SetJumpTarget(skip);
+
+		ApplyRoundingMode();
+		return;
+	}
+
 	// Skip the CallSyscall where possible.
 	void *quickFunc = GetQuickSyscallFunc(op);
 	if (quickFunc)
@@ -1,299 +1,822 @@
 #include "ppsspp_config.h"
-#if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+#if PPSSPP_ARCH(AMD64)
 
+#include <cstddef>
+#include <cstring>
+
+#include "Common/ABI.h"
+#include "Common/CommonFuncs.h"
+#include "Common/CPUDetect.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/IR/IRInterpreter.h"
 #include "Core/MIPS/x86/IRToX86.h"
+#include "Core/MIPS/x86/RegCache.h"
 
 namespace MIPSComp {
 
-// Initial attempt at converting IR directly to x86.
-// This is intended to be an easy way to benefit from the IR with the current infrastructure.
-// Later tries may go across multiple blocks and a different representation.
+using namespace Gen;
+using namespace X64JitConstants;
+
+// Converts IR blocks directly to x86-64, one instruction at a time.
+// GPRs that IRRegAllocator maps stay in host registers, everything else lives in MIPSState and is
+// loaded and stored around each op, using EAX, ECX, EDX, XMM0 and XMM1 as scratch.  CTXREG points
+// at f[0] like in the MIPS->x86 jit, so that both the GPR and FPR ranges can be reached with short
+// displacements.
+
+static_assert(sizeof(IRInst) == 8, "IRInst is passed to the fallback in a register");
+
+alignas(16) static const float vec4InitValues[8][4] = {
+	{ 0.0f, 0.0f, 0.0f, 0.0f },
+	{ 1.0f, 1.0f, 1.0f, 1.0f },
+	{ -1.0f, -1.0f, -1.0f, -1.0f },
+	{ 1.0f, 0.0f, 0.0f, 0.0f },
+	{ 0.0f, 1.0f, 0.0f, 0.0f },
+	{ 0.0f, 0.0f, 1.0f, 0.0f },
+	{ 0.0f, 0.0f, 0.0f, 1.0f },
+};
 
-struct GPRMapping {
-	Gen::OpArg dest;
-	Gen::OpArg src1;
-	Gen::OpArg src2;
+alignas(16) static const u32 signBits[4] = {
+	0x80000000, 0x80000000, 0x80000000, 0x80000000,
 };
 
-struct FPRMapping {
-	Gen::OpArg dest;
-	Gen::OpArg src1;
-	Gen::OpArg src2;
+alignas(16) static const u32 noSignMask[4] = {
+	0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF,
 };
 
+static inline OpArg IRGPR(int r) {
+	return MDisp(CTXREG, r * 4 - (int)offsetof(MIPSState, f[0]));
+}
 
-class GreedyRegallocGPR {
-public:
-	GPRMapping Map(IRInst inst, const IRMeta &meta);
+static inline OpArg IRFPR(int r) {
+	return MDisp(CTXREG, r * 4);
+}
 
-private:
-	
-};
+static inline OpArg MemAtEAX() {
+	return MComplex(MEMBASEREG, RAX, SCALE_1, 0);
+}
 
+// All callee saved, since the fallback calls into C++.
+static const X64Reg allocGPRs[] = { RBP, R12, R13, R15 };
 
-GPRMapping GreedyRegallocGPR::Map(IRInst inst, const IRMeta &meta) {
-	GPRMapping mapping;
-	if (meta.types[0] == 'G') {
+// Runs a single instruction through the IR interpreter.
+// Returns 0 to continue, or the PC to exit to.
+static u32 RunIRFallback(MIPSState *mips, u64 encoded) {
+	IRInst inst[2];
+	memcpy(&inst[0], &encoded, sizeof(IRInst));
+	inst[1] = { IROp::ExitToConst, { 0 }, 0, 0, 0 };
+	return IRInterpret(mips, inst, 2);
+}
 
+// Ops handled by CompGeneric(), which must see every register in MIPSState.
+static bool NeedsFallback(const IRInst &inst) {
+	switch (inst.op) {
+	case IROp::SetConst:
+	case IROp::SetConstF:
+	case IROp::Mov:
+	case IROp::Add:
+	case IROp::Sub:
+	case IROp::And:
+	case IROp::Or:
+	case IROp::Xor:
+	case IROp::AddConst:
+	case IROp::SubConst:
+	case IROp::AndConst:
+	case IROp::OrConst:
+	case IROp::XorConst:
+	case IROp::Neg:
+	case IROp::Not:
+	case IROp::Ext8to32:
+	case IROp::Ext16to32:
+	case IROp::ShlImm:
+	case IROp::ShrImm:
+	case IROp::SarImm:
+	case IROp::RorImm:
+	case IROp::Shl:
+	case IROp::Shr:
+	case IROp::Sar:
+	case IROp::Ror:
+	case IROp::Slt:
+	case IROp::SltU:
+	case IROp::SltConst:
+	case IROp::SltUConst:
+	case IROp::Clz:
+	case IROp::MovZ:
+	case IROp::MovNZ:
+	case IROp::Max:
+	case IROp::Min:
+	case IROp::BSwap16:
+	case IROp::BSwap32:
+	case IROp::MtLo:
+	case IROp::MtHi:
+	case IROp::MfLo:
+	case IROp::MfHi:
+	case IROp::Mult:
+	case IROp::MultU:
+	case IROp::Madd:
+	case IROp::MaddU:
+	case IROp::Msub:
+	case IROp::MsubU:
+	case IROp::Load8:
+	case IROp::Load8Ext:
+	case IROp::Load16:
+	case IROp::Load16Ext:
+	case IROp::Load32:
+	case IROp::LoadFloat:
+	case IROp::LoadVec4:
+	case IROp::Store8:
+	case IROp::Store16:
+	case IROp::Store32:
+	case IROp::StoreFloat:
+	case IROp::StoreVec4:
+	// FMul only falls back for NANs, and doesn't touch GPRs.
+	case IROp::FAdd:
+	case IROp::FSub:
+	case IROp::FMul:
+	case IROp::FDiv:
+	case IROp::FMin:
+	case IROp::FMax:
+	case IROp::FMov:
+	case IROp::FAbs:
+	case IROp::FNeg:
+	case IROp::FSqrt:
+	case IROp::FCvtSW:
+	case IROp::FMovFromGPR:
+	case IROp::FMovToGPR:
+	case IROp::Vec4Init:
+	case IROp::Vec4Shuffle:
+	case IROp::Vec4Mov:
+	case IROp::Vec4Add:
+	case IROp::Vec4Sub:
+	case IROp::Vec4Mul:
+	case IROp::Vec4Div:
+	case IROp::Vec4Scale:
+	case IROp::Vec4Neg:
+	case IROp::Vec4Abs:
+	case IROp::Vec4ClampToZero:
+	case IROp::Vec4Dot:
+	case IROp::FpCondToReg:
+	case IROp::VfpuCtrlToReg:
+	case IROp::ZeroFpCond:
+	case IROp::SetCtrlVFPU:
+	case IROp::SetCtrlVFPUReg:
+	case IROp::SetCtrlVFPUFReg:
+	case IROp::ExitToConst:
+	case IROp::ExitToReg:
+	case IROp::ExitToPC:
+	case IROp::ExitToConstIfEq:
+	case IROp::ExitToConstIfNeq:
+	case IROp::ExitToConstIfGtZ:
+	case IROp::ExitToConstIfGeZ:
+	case IROp::ExitToConstIfLtZ:
+	case IROp::ExitToConstIfLeZ:
+	case IROp::Downcount:
+	case IROp::SetPC:
+	case IROp::SetPCConst:
+	case IROp::ApplyRoundingMode:
+	case IROp::RestoreRoundingMode:
+	case IROp::UpdateRoundingMode:
+		return false;
+
+	default:
+		return true;
 	}
-	// etc..
-	return mapping;
 }
 
-// Every 4 registers can also be mapped into an SSE register.
-// When changing from single to vec4 mapping, we'll just flush, for now.
-class GreedyRegallocFPR {
-public:
-	FPRMapping Map(IRInst inst, const IRMeta &meta);
-};
+OpArg IRToX86::DestGPR(const IRInst &inst) const {
+	int reg = regAlloc_.DestReg(curInst_);
+	return reg == IRRegAllocator::NO_REG ? IRGPR(inst.dest) : R(allocGPRs[reg]);
+}
+
+OpArg IRToX86::SrcGPR1(const IRInst &inst) const {
+	int reg = regAlloc_.Src1Reg(curInst_);
+	return reg == IRRegAllocator::NO_REG ? IRGPR(inst.src1) : R(allocGPRs[reg]);
+}
 
-FPRMapping GreedyRegallocFPR::Map(IRInst inst, const IRMeta &meta) {
-	FPRMapping mapping;
+OpArg IRToX86::SrcGPR2(const IRInst &inst) const {
+	int reg = regAlloc_.Src2Reg(curInst_);
+	return reg == IRRegAllocator::NO_REG ? IRGPR(inst.src2) : R(allocGPRs[reg]);
+}
 
-	return mapping;
+void IRToX86::EmitRegActions(int i) {
+	for (auto action = regAlloc_.ActionsBegin(i); action != regAlloc_.ActionsEnd(i); ++action) {
+		_dbg_assert_(!action->fpr);
+		if (action->type == IRRegAllocActionType::STORE)
+			code_->MOV(32, IRGPR(action->irReg), R(allocGPRs[action->hostReg]));
+		else
+			code_->MOV(32, R(allocGPRs[action->hostReg]), IRGPR(action->irReg));
+	}
 }
 
+void IRToX86::EmitExit(OpArg pc) {
+	if (!pc.IsSimpleReg(EAX))
+		code_->MOV(32, R(EAX), pc);
+	code_->JMP(exitStub_, true);
+}
 
-// This requires that ThreeOpToTwoOp has been run as the last pass.
-void IRToX86::ConvertIRToNative(const IRInst *instructions, int count, const u32 *constants) {
-	// Set up regcaches
-	using namespace Gen;
+void IRToX86::EmitAddress(const IRInst &inst) {
+	if (inst.src1 == MIPS_REG_ZERO) {
+		code_->MOV(32, R(EAX), Imm32(inst.constant));
+	} else {
+		code_->MOV(32, R(EAX), SrcGPR1(inst));
+		if (inst.constant != 0)
+			code_->ADD(32, R(EAX), Imm32(inst.constant));
+	}
+#ifdef MASKED_PSP_MEMORY
+	code_->AND(32, R(EAX), Imm32(Memory::MEMVIEW32_MASK));
+#endif
+}
 
-	GreedyRegallocGPR gprAlloc;
-	GreedyRegallocFPR fprAlloc;
+void IRToX86::CompGeneric(const IRInst &inst) {
+	u64 encoded;
+	memcpy(&encoded, &inst, sizeof(encoded));
 
-	// Loop through all the instructions, emitting code as we go.
-	// Note that we do need to implement them all - fallbacks are not permitted.
-	for (int i = 0; i < count; i++) {
-		const IRInst *inst = &instructions[i];
-		const IRMeta &meta = *GetIRMeta(inst->op);
-		GPRMapping gpr = gprAlloc.Map(*inst, meta);
-		FPRMapping fpr = fprAlloc.Map(*inst, meta);
+	code_->LEA(64, ABI_PARAM1, MDisp(CTXREG, -(int)offsetof(MIPSState, f[0])));
+	code_->MOV(64, R(ABI_PARAM2), Imm64(encoded));
+	code_->ABI_CallFunction((const void *)&RunIRFallback);
+
+	if ((GetIRMeta(inst.op)->flags & IRFLAG_EXIT) != 0) {
+		code_->TEST(32, R(EAX), R(EAX));
+		FixupBranch skip = code_->J_CC(CC_Z);
+		EmitExit(R(EAX));
+		code_->SetJumpTarget(skip);
+	}
+}
+
+void IRToX86::CompExitIf(const IRInst &inst) {
+	CCFlags skipCond;
+	switch (inst.op) {
+	case IROp::ExitToConstIfEq:
+	case IROp::ExitToConstIfNeq:
+		code_->MOV(32, R(EAX), SrcGPR1(inst));
+		code_->CMP(32, R(EAX), SrcGPR2(inst));
+		skipCond = inst.op == IROp::ExitToConstIfEq ? CC_NE : CC_E;
+		break;
+	case IROp::ExitToConstIfGtZ: skipCond = CC_LE; break;
+	case IROp::ExitToConstIfGeZ: skipCond = CC_L; break;
+	case IROp::ExitToConstIfLtZ: skipCond = CC_GE; break;
+	case IROp::ExitToConstIfLeZ: skipCond = CC_G; break;
+	default:
+		_assert_(false);
+		return;
+	}
+
+	if (inst.op != IROp::ExitToConstIfEq && inst.op != IROp::ExitToConstIfNeq)
+		code_->CMP(32, SrcGPR1(inst), Imm8(0));
+	FixupBranch skip = code_->J_CC(skipCond);
+	EmitExit(Imm32(inst.constant));
+	code_->SetJumpTarget(skip);
+}
+
+void IRToX86::CompLoadStore(const IRInst &inst) {
+	if (inst.op >= IROp::Store8 && inst.op <= IROp::StoreVec4) {
+		// Grab the value first, EmitAddress() clobbers EAX.
+		if (inst.op == IROp::StoreVec4)
+			code_->MOVUPS(XMM0, IRFPR(inst.src3));
+		else if (inst.op == IROp::StoreFloat)
+			code_->MOV(32, R(ECX), IRFPR(inst.src3));
+		else
+			code_->MOV(32, R(ECX), DestGPR(inst));
+	}
+
+	EmitAddress(inst);
+
+	switch (inst.op) {
+	case IROp::Load8:
+		code_->MOVZX(32, 8, EDX, MemAtEAX());
+		code_->MOV(32, DestGPR(inst), R(EDX));
+		break;
+	case IROp::Load8Ext:
+		code_->MOVSX(32, 8, EDX, MemAtEAX());
+		code_->MOV(32, DestGPR(inst), R(EDX));
+		break;
+	case IROp::Load16:
+		code_->MOVZX(32, 16, EDX, MemAtEAX());
+		code_->MOV(32, DestGPR(inst), R(EDX));
+		break;
+	case IROp::Load16Ext:
+		code_->MOVSX(32, 16, EDX, MemAtEAX());
+		code_->MOV(32, DestGPR(inst), R(EDX));
+		break;
+	case IROp::Load32:
+		code_->MOV(32, R(EDX), MemAtEAX());
+		code_->MOV(32, DestGPR(inst), R(EDX));
+		break;
+	case IROp::LoadFloat:
+		code_->MOV(32, R(EDX), MemAtEAX());
+		code_->MOV(32, IRFPR(inst.dest), R(EDX));
+		break;
+	case IROp::LoadVec4:
+		code_->MOVUPS(XMM0, MemAtEAX());
+		code_->MOVUPS(IRFPR(inst.dest), XMM0);
+		break;
+
+	case IROp::Store8:
+		code_->MOV(8, MemAtEAX(), R(ECX));
+		break;
+	case IROp::Store16:
+		code_->MOV(16, MemAtEAX(), R(ECX));
+		break;
+	case IROp::Store32:
+	case IROp::StoreFloat:
+		code_->MOV(32, MemAtEAX(), R(ECX));
+		break;
+	case IROp::StoreVec4:
+		code_->MOVUPS(MemAtEAX(), XMM0);
+		break;
+
+	default:
+		_assert_(false);
+		break;
+	}
+}
+
+void IRToX86::CompFPU(const IRInst &inst) {
+	switch (inst.op) {
+	case IROp::FAdd:
+	case IROp::FSub:
+	case IROp::FDiv:
+		code_->MOVSS(XMM0, IRFPR(inst.src1));
+		switch (inst.op) {
+		case IROp::FAdd: code_->ADDSS(XMM0, IRFPR(inst.src2)); break;
+		case IROp::FSub: code_->SUBSS(XMM0, IRFPR(inst.src2)); break;
+		case IROp::FDiv: code_->DIVSS(XMM0, IRFPR(inst.src2)); break;
+		default: break;
+		}
+		code_->MOVSS(IRFPR(inst.dest), XMM0);
+		break;
+
+	case IROp::FMul:
+	{
+		code_->MOVSS(XMM0, IRFPR(inst.src1));
+		code_->MULSS(XMM0, IRFPR(inst.src2));
+		// NAN results need the PSP's specific NAN (inf * 0), let the interpreter sort those out.
+		code_->UCOMISS(XMM0, R(XMM0));
+		FixupBranch slow = code_->J_CC(CC_P, true);
+		code_->MOVSS(IRFPR(inst.dest), XMM0);
+		FixupBranch done = code_->J(true);
+		code_->SetJumpTarget(slow);
+		CompGeneric(inst);
+		code_->SetJumpTarget(done);
+		break;
+	}
+
+	case IROp::FMin:
+	case IROp::FMax:
+		// Operands swapped to match std::min/std::max on equal and unordered inputs.
+		code_->MOVSS(XMM0, IRFPR(inst.src2));
+		if (inst.op == IROp::FMin)
+			code_->MINSS(XMM0, IRFPR(inst.src1));
+		else
+			code_->MAXSS(XMM0, IRFPR(inst.src1));
+		code_->MOVSS(IRFPR(inst.dest), XMM0);
+		break;
+
+	case IROp::FSqrt:
+		code_->SQRTSS(XMM0, IRFPR(inst.src1));
+		code_->MOVSS(IRFPR(inst.dest), XMM0);
+		break;
+
+	case IROp::FMov:
+		code_->MOV(32, R(EAX), IRFPR(inst.src1));
+		code_->MOV(32, IRFPR(inst.dest), R(EAX));
+		break;
+	case IROp::FAbs:
+		code_->MOV(32, R(EAX), IRFPR(inst.src1));
+		code_->AND(32, R(EAX), Imm32(0x7FFFFFFF));
+		code_->MOV(32, IRFPR(inst.dest), R(EAX));
+		break;
+	case IROp::FNeg:
+		code_->MOV(32, R(EAX), IRFPR(inst.src1));
+		code_->XOR(32, R(EAX), Imm32(0x80000000));
+		code_->MOV(32, IRFPR(inst.dest), R(EAX));
+		break;
+
+	case IROp::FCvtSW:
+		code_->CVTSI2SS(XMM0, IRFPR(inst.src1));
+		code_->MOVSS(IRFPR(inst.dest), XMM0);
+		break;
+
+	case IROp::FMovFromGPR:
+		code_->MOV(32, R(EAX), SrcGPR1(inst));
+		code_->MOV(32, IRFPR(inst.dest), R(EAX));
+		break;
+	case IROp::FMovToGPR:
+		code_->MOV(32, R(EAX), IRFPR(inst.src1));
+		code_->MOV(32, DestGPR(inst), R(EAX));
+		break;
+
+	default:
+		CompGeneric(inst);
+		break;
+	}
+}
+
+void IRToX86::CompVec4(const IRInst &inst) {
+	switch (inst.op) {
+	case IROp::Vec4Init:
+		code_->MOV(64, R(RAX), ImmPtr(vec4InitValues[inst.src1]));
+		code_->MOVAPS(XMM0, MatR(RAX));
+		break;
+	case IROp::Vec4Shuffle:
+		code_->MOVUPS(XMM0, IRFPR(inst.src1));
+		code_->SHUFPS(XMM0, R(XMM0), inst.src2);
+		break;
+	case IROp::Vec4Mov:
+		code_->MOVUPS(XMM0, IRFPR(inst.src1));
+		break;
+
+	case IROp::Vec4Add:
+	case IROp::Vec4Sub:
+	case IROp::Vec4Mul:
+	case IROp::Vec4Div:
+		code_->MOVUPS(XMM0, IRFPR(inst.src1));
+		code_->MOVUPS(XMM1, IRFPR(inst.src2));
+		switch (inst.op) {
+		case IROp::Vec4Add: code_->ADDPS(XMM0, R(XMM1)); break;
+		case IROp::Vec4Sub: code_->SUBPS(XMM0, R(XMM1)); break;
+		case IROp::Vec4Mul: code_->MULPS(XMM0, R(XMM1)); break;
+		case IROp::Vec4Div: code_->DIVPS(XMM0, R(XMM1)); break;
+		default: break;
+		}
+		break;
+
+	case IROp::Vec4Scale:
+		code_->MOVSS(XMM1, IRFPR(inst.src2));
+		code_->SHUFPS(XMM1, R(XMM1), 0);
+		code_->MOVUPS(XMM0, IRFPR(inst.src1));
+		code_->MULPS(XMM0, R(XMM1));
+		break;
+
+	case IROp::Vec4Neg:
+	case IROp::Vec4Abs:
+		code_->MOV(64, R(RAX), ImmPtr(inst.op == IROp::Vec4Neg ? signBits : noSignMask));
+		code_->MOVUPS(XMM0, IRFPR(inst.src1));
+		if (inst.op == IROp::Vec4Neg)
+			code_->XORPS(XMM0, MatR(RAX));
+		else
+			code_->ANDPS(XMM0, MatR(RAX));
+		break;
+
+	case IROp::Vec4ClampToZero:
+		// Expand the sign bit, and use andnot to zero negative values.
+		code_->MOVUPS(XMM0, IRFPR(inst.src1));
+		code_->MOVAPS(XMM1, R(XMM0));
+		code_->PSRAD(XMM1, 31);
+		code_->PANDN(XMM1, R(XMM0));
+		code_->MOVAPS(XMM0, R(XMM1));
+		break;
+
+	case IROp::Vec4Dot:
+		// Add in the same order as the interpreter, lane by lane.
+		code_->MOVUPS(XMM0, IRFPR(inst.src1));
+		code_->MOVUPS(XMM1, IRFPR(inst.src2));
+		code_->MULPS(XMM0, R(XMM1));
+		for (u8 lane = 1; lane < 4; ++lane) {
+			code_->MOVAPS(XMM1, R(XMM0));
+			code_->SHUFPS(XMM1, R(XMM1), lane * 0x55);
+			code_->ADDSS(XMM0, R(XMM1));
+		}
+		code_->MOVSS(IRFPR(inst.dest), XMM0);
+		return;
+
+	default:
+		CompGeneric(inst);
+		return;
+	}
+
+	code_->MOVUPS(IRFPR(inst.dest), XMM0);
+}
+
+// This requires that the block ends in an exit, as the IR interpreter does.
+const u8 *IRToX86::ConvertIRToNative(const IRInst *instructions, int count) {
+	_assert_(code_ != nullptr && exitStub_ != nullptr);
+	const u8 *start = code_->AlignCode16();
+
+	IRRegAllocConfig config;
+	config.numGPRs = (int)ARRAY_SIZE(allocGPRs);
+	config.isBarrier = &NeedsFallback;
+	regAlloc_.Allocate(instructions, count, config);
 
-		bool symmetric = false;
-		switch (inst->op) {
+	for (int i = 0; i < count; i++) {
+		const IRInst &inst = instructions[i];
+		curInst_ = i;
+		EmitRegActions(i);
+		switch (inst.op) {
 		case IROp::Nop:
 			_assert_(false);
 			break;
 
-			// Output-only
 		case IROp::SetConst:
-			code_->MOV(32, gpr.dest, Imm32(constants[inst->src1]));
+			code_->MOV(32, DestGPR(inst), Imm32(inst.constant));
 			break;
 		case IROp::SetConstF:
-			code_->MOV(32, gpr.dest, Imm32(constants[inst->src1]));
+			code_->MOV(32, IRFPR(inst.dest), Imm32(inst.constant));
 			break;
 
-			// Add gets to be special cased because we have LEA.
-		case IROp::Add:
-			if (gpr.dest.IsSimpleReg() && gpr.src1.IsSimpleReg() && gpr.src2.IsSimpleReg()) {
-				code_->LEA(32, gpr.dest.GetSimpleReg(), MRegSum(gpr.src1.GetSimpleReg(), gpr.src2.GetSimpleReg()));
-				break;
+		case IROp::Mov:
+			if (inst.dest != inst.src1) {
+				code_->MOV(32, R(EAX), SrcGPR1(inst));
+				code_->MOV(32, DestGPR(inst), R(EAX));
 			}
-			// Else fall through.
-			// 3-op arithmetic that directly corresponds to x86
-			// (often 2-op in practice if src1 == dst). x86 only does 2-op though so some of these will need splitting.
+			break;
+
+		case IROp::Add:
 		case IROp::Sub:
 		case IROp::And:
 		case IROp::Or:
 		case IROp::Xor:
-			if (inst->src1 != inst->dest) {
-				code_->MOV(32, gpr.dest, gpr.src1);
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			switch (inst.op) {
+			case IROp::Add: code_->ADD(32, R(EAX), SrcGPR2(inst)); break;
+			case IROp::Sub: code_->SUB(32, R(EAX), SrcGPR2(inst)); break;
+			case IROp::And: code_->AND(32, R(EAX), SrcGPR2(inst)); break;
+			case IROp::Or: code_->OR(32, R(EAX), SrcGPR2(inst)); break;
+			case IROp::Xor: code_->XOR(32, R(EAX), SrcGPR2(inst)); break;
+			default: break;
+			}
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
+
+		case IROp::AddConst:
+		case IROp::SubConst:
+		case IROp::AndConst:
+		case IROp::OrConst:
+		case IROp::XorConst:
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			switch (inst.op) {
+			case IROp::AddConst: code_->ADD(32, R(EAX), Imm32(inst.constant)); break;
+			case IROp::SubConst: code_->SUB(32, R(EAX), Imm32(inst.constant)); break;
+			case IROp::AndConst: code_->AND(32, R(EAX), Imm32(inst.constant)); break;
+			case IROp::OrConst: code_->OR(32, R(EAX), Imm32(inst.constant)); break;
+			case IROp::XorConst: code_->XOR(32, R(EAX), Imm32(inst.constant)); break;
+			default: break;
 			}
-			// Emit directly
-			switch (inst->op) {
-			case IROp::Add: code_->ADD(32, gpr.dest, gpr.src2); break;
-			case IROp::Sub: code_->SUB(32, gpr.dest, gpr.src2); break;
-			case IROp::And: code_->AND(32, gpr.dest, gpr.src2); break;
-			case IROp::Or: code_->OR(32, gpr.dest, gpr.src2); break;
-			case IROp::Xor: code_->XOR(32, gpr.dest, gpr.src2); break;
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
+
+		case IROp::Neg:
+		case IROp::Not:
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			if (inst.op == IROp::Neg)
+				code_->NEG(32, R(EAX));
+			else
+				code_->NOT(32, R(EAX));
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
+
+		case IROp::Ext8to32:
+			code_->MOVSX(32, 8, EAX, SrcGPR1(inst));
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
+		case IROp::Ext16to32:
+			code_->MOVSX(32, 16, EAX, SrcGPR1(inst));
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
+
+		case IROp::ShlImm:
+		case IROp::ShrImm:
+		case IROp::SarImm:
+		case IROp::RorImm:
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			if (inst.src2 != 0) {
+				switch (inst.op) {
+				case IROp::ShlImm: code_->SHL(32, R(EAX), Imm8(inst.src2)); break;
+				case IROp::ShrImm: code_->SHR(32, R(EAX), Imm8(inst.src2)); break;
+				case IROp::SarImm: code_->SAR(32, R(EAX), Imm8(inst.src2)); break;
+				case IROp::RorImm: code_->ROR(32, R(EAX), Imm8(inst.src2)); break;
+				default: break;
+				}
 			}
+			code_->MOV(32, DestGPR(inst), R(EAX));
 			break;
 
-			// Variable shifts.
 		case IROp::Shl:
 		case IROp::Shr:
 		case IROp::Sar:
 		case IROp::Ror:
+			// x86 masks the shift amount by 31, just like the interpreter does.
+			code_->MOV(32, R(ECX), SrcGPR2(inst));
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			switch (inst.op) {
+			case IROp::Shl: code_->SHL(32, R(EAX), R(CL)); break;
+			case IROp::Shr: code_->SHR(32, R(EAX), R(CL)); break;
+			case IROp::Sar: code_->SAR(32, R(EAX), R(CL)); break;
+			case IROp::Ror: code_->ROR(32, R(EAX), R(CL)); break;
+			default: break;
+			}
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
 
 		case IROp::Slt:
 		case IROp::SltU:
-		case IROp::MovZ:
-		case IROp::MovNZ:
-		case IROp::Max:
-		case IROp::Min:
-			break;
-
-			// 2-op arithmetic with constant
-		case IROp::AddConst:
-		case IROp::SubConst:
-		case IROp::AndConst:
-		case IROp::OrConst:
-		case IROp::XorConst:
 		case IROp::SltConst:
 		case IROp::SltUConst:
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			code_->XOR(32, R(ECX), R(ECX));
+			if (inst.op == IROp::Slt || inst.op == IROp::SltU)
+				code_->CMP(32, R(EAX), SrcGPR2(inst));
+			else
+				code_->CMP(32, R(EAX), Imm32(inst.constant));
+			code_->SETcc(inst.op == IROp::Slt || inst.op == IROp::SltConst ? CC_L : CC_B, R(ECX));
+			code_->MOV(32, DestGPR(inst), R(ECX));
+			break;
 
-			// 2-op arithmetic with immediate
-		case IROp::ShlImm:
-		case IROp::ShrImm:
-		case IROp::SarImm:
-		case IROp::RorImm:
+		case IROp::Clz:
+			if (cpu_info.bLZCNT) {
+				code_->LZCNT(32, EAX, SrcGPR1(inst));
+			} else {
+				// BSR leaves ZF set for zero, in which case we want 63 ^ 31 = 32.
+				code_->MOV(32, R(ECX), Imm32(63));
+				code_->BSR(32, EAX, SrcGPR1(inst));
+				code_->CMOVcc(32, EAX, R(ECX), CC_Z);
+				code_->XOR(32, R(EAX), Imm8(31));
+			}
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
 
-			// 2-op arithmetic
-		case IROp::Mov:
-			code_->MOV(32, gpr.dest, gpr.src1);
+		case IROp::MovZ:
+		case IROp::MovNZ:
+			code_->MOV(32, R(EAX), DestGPR(inst));
+			code_->CMP(32, SrcGPR1(inst), Imm8(0));
+			code_->CMOVcc(32, EAX, SrcGPR2(inst), inst.op == IROp::MovZ ? CC_E : CC_NE);
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
+
+		case IROp::Max:
+		case IROp::Min:
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			code_->CMP(32, R(EAX), SrcGPR2(inst));
+			code_->CMOVcc(32, EAX, SrcGPR2(inst), inst.op == IROp::Max ? CC_L : CC_G);
+			code_->MOV(32, DestGPR(inst), R(EAX));
 			break;
 
-		case IROp::Neg:
-		case IROp::Not:
-		case IROp::Ext8to32:
-		case IROp::Ext16to32:
-		case IROp::ReverseBits:
 		case IROp::BSwap16:
 		case IROp::BSwap32:
-		case IROp::Clz:
-			if (inst->dest != inst->src1) {
-				code_->NEG(32, gpr.dest); break;
-			}
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			code_->BSWAP(32, EAX);
+			if (inst.op == IROp::BSwap16)
+				code_->ROR(32, R(EAX), Imm8(16));
+			code_->MOV(32, DestGPR(inst), R(EAX));
 			break;
-				// Multiplier control
+
 		case IROp::MtLo:
 		case IROp::MtHi:
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			code_->MOV(32, inst.op == IROp::MtLo ? MIPSSTATE_VAR(lo) : MIPSSTATE_VAR(hi), R(EAX));
+			break;
 		case IROp::MfLo:
 		case IROp::MfHi:
+			code_->MOV(32, R(EAX), inst.op == IROp::MfLo ? MIPSSTATE_VAR(lo) : MIPSSTATE_VAR(hi));
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
+
 		case IROp::Mult:
 		case IROp::MultU:
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			if (inst.op == IROp::Mult)
+				code_->IMUL(32, SrcGPR2(inst));
+			else
+				code_->MUL(32, SrcGPR2(inst));
+			code_->MOV(32, MIPSSTATE_VAR(lo), R(EAX));
+			code_->MOV(32, MIPSSTATE_VAR(hi), R(EDX));
+			break;
+
 		case IROp::Madd:
 		case IROp::MaddU:
 		case IROp::Msub:
 		case IROp::MsubU:
-		case IROp::Div:
-		case IROp::DivU:
+			// lo and hi are adjacent, so we can treat them as one 64-bit value.
+			// The low 64 bits of the product are the same signed or unsigned, only the extension differs.
+			if (inst.op == IROp::Madd || inst.op == IROp::Msub) {
+				code_->MOVSX(64, 32, RAX, SrcGPR1(inst));
+				code_->MOVSX(64, 32, RDX, SrcGPR2(inst));
+			} else {
+				code_->MOV(32, R(EAX), SrcGPR1(inst));
+				code_->MOV(32, R(EDX), SrcGPR2(inst));
+			}
+			code_->IMUL(64, RAX, R(RDX));
+			if (inst.op == IROp::Madd || inst.op == IROp::MaddU)
+				code_->ADD(64, MIPSSTATE_VAR(lo), R(RAX));
+			else
+				code_->SUB(64, MIPSSTATE_VAR(lo), R(RAX));
+			break;
 
-			// Memory access
 		case IROp::Load8:
 		case IROp::Load8Ext:
 		case IROp::Load16:
 		case IROp::Load16Ext:
 		case IROp::Load32:
 		case IROp::LoadFloat:
+		case IROp::LoadVec4:
 		case IROp::Store8:
 		case IROp::Store16:
 		case IROp::Store32:
 		case IROp::StoreFloat:
-		case IROp::LoadVec4:
 		case IROp::StoreVec4:
-
-			// Output-only SIMD functions
-		case IROp::Vec4Init:
-		case IROp::Vec4Shuffle:
-
-			// 2-op SIMD functions
-		case IROp::Vec4Mov:
-			code_->MOVAPS(fpr.dest.GetSimpleReg(), fpr.src1);
-			break;
-		case IROp::Vec4Neg:
-		case IROp::Vec4Abs:
-			break;
-		case IROp::Vec4ClampToZero:
-			code_->PXOR(XMM0, R(XMM0));
-			code_->PMAXSW(XMM0, fpr.src1);
-			code_->MOVAPD(fpr.dest, XMM0);
+			CompLoadStore(inst);
 			break;
-		case IROp::Vec4DuplicateUpperBitsAndShift1:
-		case IROp::Vec2ClampToZero:
-
-			// 3-op SIMD functions
-		case IROp::Vec4Add:
-		case IROp::Vec4Sub:
-		case IROp::Vec4Mul:
-		case IROp::Vec4Div:
 
-		case IROp::Vec4Scale:
-		case IROp::Vec4Dot:
-
-			// Pack-unpack
-		case IROp::Vec2Unpack16To31:
-		case IROp::Vec2Unpack16To32:
-		case IROp::Vec4Unpack8To32:
-		case IROp::Vec2Pack32To16:
-		case IROp::Vec2Pack31To16:
-		case IROp::Vec4Pack32To8:
-		case IROp::Vec4Pack31To8:
-
-		case IROp::FCmpVfpuBit:
-		case IROp::FCmpVfpuAggregate:
-		case IROp::FCmovVfpuCC:
-
-			// Trancendental functions (non-simd)
-		case IROp::FSin:
-		case IROp::FCos:
-		case IROp::FRSqrt:
-		case IROp::FRecip:
-		case IROp::FAsin:
-
-			// 3-Op FP
 		case IROp::FAdd:
 		case IROp::FSub:
 		case IROp::FMul:
 		case IROp::FDiv:
 		case IROp::FMin:
 		case IROp::FMax:
-
-			// 2-Op FP
 		case IROp::FMov:
 		case IROp::FAbs:
-		case IROp::FSqrt:
 		case IROp::FNeg:
-		case IROp::FSat0_1:
-		case IROp::FSatMinus1_1:
-		case IROp::FSign:
-		case IROp::FCeil:
-		case IROp::FFloor:
-		case IROp::FCmp:
+		case IROp::FSqrt:
 		case IROp::FCvtSW:
-		case IROp::FCvtWS:
-		case IROp::FRound:
-		case IROp::FTrunc:
-
-			// Cross moves
 		case IROp::FMovFromGPR:
 		case IROp::FMovToGPR:
+			CompFPU(inst);
+			break;
+
+		case IROp::Vec4Init:
+		case IROp::Vec4Shuffle:
+		case IROp::Vec4Mov:
+		case IROp::Vec4Add:
+		case IROp::Vec4Sub:
+		case IROp::Vec4Mul:
+		case IROp::Vec4Div:
+		case IROp::Vec4Scale:
+		case IROp::Vec4Neg:
+		case IROp::Vec4Abs:
+		case IROp::Vec4ClampToZero:
+		case IROp::Vec4Dot:
+			CompVec4(inst);
+			break;
+
 		case IROp::FpCondToReg:
+			code_->MOV(32, R(EAX), MIPSSTATE_VAR(fpcond));
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
 		case IROp::VfpuCtrlToReg:
+			code_->MOV(32, R(EAX), MIPSSTATE_VAR_ELEM32(vfpuCtrl[0], inst.src1));
+			code_->MOV(32, DestGPR(inst), R(EAX));
+			break;
+		case IROp::ZeroFpCond:
+			code_->MOV(32, MIPSSTATE_VAR(fpcond), Imm32(0));
+			break;
 
-			// VFPU flag/control
 		case IROp::SetCtrlVFPU:
+			code_->MOV(32, MIPSSTATE_VAR_ELEM32(vfpuCtrl[0], inst.dest), Imm32(inst.constant));
+			break;
 		case IROp::SetCtrlVFPUReg:
 		case IROp::SetCtrlVFPUFReg:
-		case IROp::ZeroFpCond:
+			code_->MOV(32, R(EAX), inst.op == IROp::SetCtrlVFPUReg ? SrcGPR1(inst) : IRFPR(inst.src1));
+			code_->MOV(32, MIPSSTATE_VAR_ELEM32(vfpuCtrl[0], inst.dest), R(EAX));
+			break;
 
-			// Block Exits
 		case IROp::ExitToConst:
+			EmitExit(Imm32(inst.constant));
+			break;
 		case IROp::ExitToReg:
+			EmitExit(SrcGPR1(inst));
+			break;
+		case IROp::ExitToPC:
+			EmitExit(MIPSSTATE_VAR(pc));
+			break;
 		case IROp::ExitToConstIfEq:
 		case IROp::ExitToConstIfNeq:
 		case IROp::ExitToConstIfGtZ:
 		case IROp::ExitToConstIfGeZ:
 		case IROp::ExitToConstIfLtZ:
 		case IROp::ExitToConstIfLeZ:
-		case IROp::ExitToPC:
+			CompExitIf(inst);
+			break;
 
-			// Utilities
 		case IROp::Downcount:
+			code_->SUB(32, MIPSSTATE_VAR(downcount), Imm32(inst.constant));
+			break;
 		case IROp::SetPC:
+			code_->MOV(32, R(EAX), SrcGPR1(inst));
+			code_->MOV(32, MIPSSTATE_VAR(pc), R(EAX));
+			break;
 		case IROp::SetPCConst:
-		case IROp::Syscall:
-		case IROp::Interpret:  // SLOW fallback. Can be made faster.
-		case IROp::CallReplacement:
-		case IROp::Break:
+			code_->MOV(32, MIPSSTATE_VAR(pc), Imm32(inst.constant));
+			break;
+
+		case IROp::ApplyRoundingMode:
+		case IROp::RestoreRoundingMode:
+		case IROp::UpdateRoundingMode:
+			// Not implemented by the interpreter either.
+			break;
+
 		default:
+			// Syscalls, replacements, debugging ops, and the less common ALU/FPU/VFPU ops.
+			CompGeneric(inst);
 			break;
-			}
 		}
 	}
 
+	// If we got here, the block was badly constructed.
+	EmitRegActions(count);
+	code_->INT3();
+	return start;
+}
 
 }  // namespace
 
-#endif // PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+#endif // PPSSPP_ARCH(AMD64)
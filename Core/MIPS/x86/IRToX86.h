@@ -1,23 +1,46 @@
+#pragma once
+
 #include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/IR/IRRegAlloc.h"
 #include "Common/x64Emitter.h"
 
 namespace MIPSComp {
 
-class IRToNativeInterface {
-public:
-	virtual ~IRToNativeInterface() {}
-
-	virtual void ConvertIRToNative(const IRInst *instructions, int count, const u32 *constants) = 0;
-};
-
-
+// Lowers IR blocks to x86-64. Ops without a native implementation call into the IR interpreter
+// for just that instruction, so every block can be converted.
+//
+// The code expects CTXREG to point at mips->f[0] and MEMBASEREG at Memory::base, and leaves
+// through the exit stub with the next PC in EAX.  GPRs are kept in callee saved registers
+// within each block, as chosen by IRRegAllocator, so the entry code must preserve them.
 class IRToX86 : public IRToNativeInterface {
 public:
 	void SetCodeBlock(Gen::XCodeBlock *code) { code_ = code; }
-	virtual void ConvertIRToNative(const IRInst *instructions, int count, const u32 *constants) override;
+	void SetExitStub(const u8 *exitStub) { exitStub_ = exitStub; }
+	const u8 *ConvertIRToNative(const IRInst *instructions, int count) override;
+
+	const IRRegAllocStats &GetRegAllocStats() const { return regAlloc_.GetStats(); }
 
 private:
-	Gen::XCodeBlock *code_;
+	void CompGeneric(const IRInst &inst);
+	void CompExitIf(const IRInst &inst);
+	void CompLoadStore(const IRInst &inst);
+	void CompFPU(const IRInst &inst);
+	void CompVec4(const IRInst &inst);
+
+	void EmitAddress(const IRInst &inst);
+	void EmitExit(Gen::OpArg pc);
+	void EmitRegActions(int i);
+
+	// The register or MIPSState location of each GPR operand of the current instruction.
+	Gen::OpArg DestGPR(const IRInst &inst) const;
+	Gen::OpArg SrcGPR1(const IRInst &inst) const;
+	Gen::OpArg SrcGPR2(const IRInst &inst) const;
+
+	Gen::XCodeBlock *code_ = nullptr;
+	const u8 *exitStub_ = nullptr;
+	IRRegAllocator regAlloc_;
+	int curInst_ = 0;
 };
 
 }  // namespace
@@ -0,0 +1,285 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#include <cstddef>
+
+#include "Common/Profiler/Profiler.h"
+#include "Common/Log.h"
+#include "Common/ABI.h"
+#include "Common/MemoryUtil.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Core/Config.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/Debugger/SymbolMap.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/x86/RegCache.h"
+#include "Core/MIPS/x86/X64IRJit.h"
+
+namespace MIPSComp {
+
+using namespace Gen;
+using namespace X64JitConstants;
+
+// Rough upper bound of generated code per IR instruction. Interpreter fallbacks are the largest.
+static const size_t MAX_BYTES_PER_IRINST = 64;
+
+class X64IRCompileTask : public Task {
+public:
+	X64IRCompileTask(X64IRJit *jit, int block_num, std::vector<IRInst> &&instructions, u32 generation)
+		: jit_(jit), block_num_(block_num), instructions_(std::move(instructions)), generation_(generation) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	void Run() override {
+		jit_->CompileInBackground(block_num_, instructions_, generation_);
+	}
+
+private:
+	X64IRJit *jit_;
+	int block_num_;
+	// A copy, so the block can be invalidated meanwhile.
+	std::vector<IRInst> instructions_;
+	u32 generation_;
+};
+
+X64IRJit::X64IRJit(MIPSState *mipsState) : IRJit(mipsState) {
+	AllocCodeSpace(1024 * 1024 * 16);
+	GenerateFixedCode();
+
+	converter_.SetCodeBlock(this);
+	converter_.SetExitStub(exitStub_);
+
+	// Writing code while other blocks run needs the space to be writable and executable at once.
+	backgroundCompile_ = g_Config.bJitBackgroundCompile && !PlatformIsWXExclusive() && g_threadManager.IsInitialized();
+}
+
+X64IRJit::~X64IRJit() {
+	// Tasks still in the queue hold a pointer to us, and may be writing code.
+	std::unique_lock<std::mutex> guard(compileLock_);
+	generation_++;
+	pendingCond_.wait(guard, [&] { return pendingTasks_ == 0; });
+}
+
+void X64IRJit::GenerateFixedCode() {
+	BeginWrite();
+
+	// u32 enterBlock(MIPSState *mips, const u8 *block)
+	enterBlock_ = (EnterBlockFunc)AlignCode16();
+	ABI_PushAllCalleeSavedRegsAndAdjustStack();
+	LEA(64, CTXREG, MDisp(ABI_PARAM1, (int)offsetof(MIPSState, f[0])));
+	MOV(64, R(MEMBASEREG), ImmPtr(&Memory::base));
+	MOV(64, R(MEMBASEREG), MatR(MEMBASEREG));
+	JMPptr(R(ABI_PARAM2));
+
+	// Blocks jump here with the next PC in EAX.
+	exitStub_ = AlignCode16();
+	ABI_PopAllCalleeSavedRegsAndAdjustStack();
+	RET();
+
+	crashHandler_ = AlignCode16();
+	MOV(PTRBITS, R(RAX), ImmPtr((const void *)&coreState));
+	MOV(32, MatR(RAX), Imm32(CORE_RUNTIME_ERROR));
+	ABI_CallFunction(&CoreTiming::ForceCheck);
+	MOV(32, R(EAX), MIPSSTATE_VAR(pc));
+	JMP(exitStub_, true);
+
+	// Let's spare the pre-generated code from unprotect-reprotect.
+	jitStartOffset_ = (int)GetOffset(AlignCodePage());
+	EndWrite();
+}
+
+void X64IRJit::ClearCache() {
+	IRJit::ClearCache();
+
+	std::lock_guard<std::mutex> guard(compileLock_);
+	generation_++;
+	outOfSpace_ = false;
+	results_.clear();
+	hasResults_ = false;
+	ClearCodeSpace(jitStartOffset_);
+}
+
+int X64IRJit::EmitBlock(const IRInst *instructions, int count) {
+	const size_t maxSize = count * MAX_BYTES_PER_IRINST + 16;
+	if (GetSpaceLeft() < maxSize)
+		return -1;
+
+	BeginWrite(maxSize);
+	const u8 *start = converter_.ConvertIRToNative(instructions, count);
+	EndWrite();
+	_dbg_assert_msg_((size_t)(GetCodePtr() - start) <= maxSize, "Native code for IR block overflowed estimate");
+
+	return (int)GetOffset(start);
+}
+
+bool X64IRJit::CompileTargetBlock(IRBlock *block, int block_num, bool preload) {
+	if (backgroundCompile_) {
+		// Prepare to interpret it until the native code is ready.
+		IRJit::CompileTargetBlock(block, block_num, preload);
+
+		const IRInst *instructions = block->GetInstructions();
+		std::vector<IRInst> copy(instructions, instructions + block->GetNumInstructions());
+		u32 generation;
+		{
+			std::lock_guard<std::mutex> guard(compileLock_);
+			pendingTasks_++;
+			generation = generation_;
+		}
+		g_threadManager.EnqueueTask(new X64IRCompileTask(this, block_num, std::move(copy), generation));
+		return true;
+	}
+
+	int offset = EmitBlock(block->GetInstructions(), block->GetNumInstructions());
+	if (offset == -1)
+		return false;
+	block->SetTargetOffset(offset);
+	return true;
+}
+
+void X64IRJit::CompileInBackground(int block_num, const std::vector<IRInst> &instructions, u32 generation) {
+	std::lock_guard<std::mutex> guard(compileLock_);
+	if (generation == generation_ && !outOfSpace_) {
+		int offset = EmitBlock(instructions.data(), (int)instructions.size());
+		if (offset == -1)
+			outOfSpace_ = true;
+		else
+			results_.push_back({ block_num, offset });
+		hasResults_ = true;
+	}
+
+	pendingTasks_--;
+	pendingCond_.notify_all();
+}
+
+void X64IRJit::InstallBackgroundBlocks() {
+	// Don't wait on a worker in the middle of a block, we'll just try again next timeslice.
+	std::unique_lock<std::mutex> guard(compileLock_, std::try_to_lock);
+	if (!guard.owns_lock())
+		return;
+
+	for (const BackgroundResult &result : results_) {
+		IRBlock *block = blocks_.GetBlock(result.block_num);
+		if (block && block->IsValid())
+			block->SetTargetOffset(result.offset);
+	}
+	results_.clear();
+	hasResults_ = false;
+
+	if (outOfSpace_) {
+		guard.unlock();
+		// Blocks go back to being interpreted until they're compiled again.
+		ClearCache();
+	}
+}
+
+void X64IRJit::RunLoopUntil(u64 globalticks) {
+	PROFILE_THIS_SCOPE("jit");
+
+	const u8 *base = GetBasePtr();
+	while (true) {
+		CoreTiming::Advance();
+		if (coreState != 0) {
+			break;
+		}
+		if (hasResults_)
+			InstallBackgroundBlocks();
+		while (mips_->downcount >= 0) {
+			u32 inst = Memory::ReadUnchecked_U32(mips_->pc);
+			u32 opcode = inst & 0xFF000000;
+			if (opcode == MIPS_EMUHACK_OPCODE) {
+				u32 data = inst & 0xFFFFFF;
+				IRBlock *block = blocks_.GetBlock(data);
+				u32 startPC = mips_->pc;
+				int offset = block->GetTargetOffset();
+				if (offset != -1)
+					mips_->pc = enterBlock_(mips_, base + offset);
+				else if (block->GetThreadedInstructions())
+					mips_->pc = IRInterpretThreaded(mips_, block->GetThreadedInstructions());
+				else
+					mips_->pc = IRInterpret(mips_, block->GetInstructions(), block->GetNumInstructions());
+				if (!Memory::IsValidAddress(mips_->pc) || (mips_->pc & 3) != 0) {
+					Core_ExecException(mips_->pc, startPC, ExecExceptionType::JUMP);
+					break;
+				}
+			} else {
+				Compile(mips_->pc);
+			}
+		}
+	}
+}
+
+bool X64IRJit::DescribeCodePtr(const u8 *ptr, std::string &name) {
+	if (!IsInSpace(ptr))
+		return false;
+
+	if (ptr == (const u8 *)enterBlock_) {
+		name = "enterBlock";
+		return true;
+	} else if (ptr == exitStub_) {
+		name = "exitStub";
+		return true;
+	} else if (ptr == crashHandler_) {
+		name = "crashHandler";
+		return true;
+	}
+
+	int offset = (int)GetOffset(ptr);
+	if (offset < jitStartOffset_) {
+		name = "PreGenCode";
+		return true;
+	}
+
+	// Find the block that starts closest before this pointer.
+	int bestNum = -1;
+	int bestOffset = -1;
+	for (int i = 0; i < blocks_.GetNumBlocks(); ++i) {
+		int blockOffset = blocks_.GetBlock(i)->GetTargetOffset();
+		if (blockOffset <= offset && blockOffset > bestOffset) {
+			bestOffset = blockOffset;
+			bestNum = i;
+		}
+	}
+
+	u32 start = 0, size = 0;
+	if (bestNum != -1)
+		blocks_.GetBlock(bestNum)->GetRange(start, size);
+	if (start == 0) {
+		name = "UnknownOrDeletedBlock";
+		return true;
+	}
+
+	char temp[1024];
+	const std::string label = g_symbolMap ? g_symbolMap->GetDescription(start) : "";
+	if (!label.empty())
+		snprintf(temp, sizeof(temp), "%08x_%s", start, label.c_str());
+	else
+		snprintf(temp, sizeof(temp), "%08x", start);
+	name = temp;
+	return true;
+}
+
+}  // namespace MIPSComp
+
+#endif
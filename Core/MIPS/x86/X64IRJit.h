@@ -0,0 +1,97 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include "ppsspp_config.h"
+
+#if PPSSPP_ARCH(AMD64)
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/x64Emitter.h"
+#include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/x86/IRToX86.h"
+
+namespace MIPSComp {
+
+// Uses the IR frontend, optimization passes and block cache, but runs the blocks as x86-64 code
+// instead of interpreting them.
+//
+// With JitBackgroundCompile, new blocks are interpreted at first while a worker thread generates
+// their x86 code, which the emu thread then installs between timeslices.
+class X64IRJit : public IRJit, public Gen::XCodeBlock {
+public:
+	X64IRJit(MIPSState *mipsState);
+	~X64IRJit();
+
+	void RunLoopUntil(u64 globalticks) override;
+
+	void ClearCache() override;
+
+	bool CodeInRange(const u8 *ptr) const override {
+		return IsInSpace(ptr);
+	}
+	bool DescribeCodePtr(const u8 *ptr, std::string &name) override;
+
+	const u8 *GetCrashHandler() const override { return crashHandler_; }
+
+protected:
+	bool CompileTargetBlock(IRBlock *block, int block_num, bool preload) override;
+
+private:
+	friend class X64IRCompileTask;
+
+	struct BackgroundResult {
+		int block_num;
+		int offset;
+	};
+
+	void GenerateFixedCode();
+	// Returns the offset of the new code, or -1 if out of space.
+	int EmitBlock(const IRInst *instructions, int count);
+	void CompileInBackground(int block_num, const std::vector<IRInst> &instructions, u32 generation);
+	void InstallBackgroundBlocks();
+
+	typedef u32 (*EnterBlockFunc)(MIPSState *mips, const u8 *block);
+
+	IRToX86 converter_;
+
+	EnterBlockFunc enterBlock_ = nullptr;
+	const u8 *exitStub_ = nullptr;
+	const u8 *crashHandler_ = nullptr;
+	int jitStartOffset_ = 0;
+
+	bool backgroundCompile_ = false;
+	// Protects the code space and everything below while background compiles are possible.
+	std::mutex compileLock_;
+	std::condition_variable pendingCond_;
+	int pendingTasks_ = 0;
+	// Bumped on each clear, so queued tasks for the old blocks are skipped.
+	u32 generation_ = 0;
+	bool outOfSpace_ = false;
+	std::vector<BackgroundResult> results_;
+	std::atomic<bool> hasResults_{};
+};
+
+}  // namespace MIPSComp
+
+#endif
@@ -35,6 +35,7 @@
 #include "Common/Log.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
+#include "Core/CoreTiming.h"
 #include "Core/MemFault.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
@@ -47,6 +48,9 @@ MemoryExceptionType g_lastMemoryExceptionType;
 
 std::unordered_set<const uint8_t *> g_ignoredAddresses;
 
+thread_local bool g_inInterpreterBlock = false;
+volatile bool g_interpreterFaulted = false;
+
 void MemFault_Init() {
 	g_numReportedBadAccesses = 0;
 	g_lastCrashAddress = nullptr;
@@ -98,7 +102,9 @@ bool HandleFault(uintptr_t hostAddress, void *ctx) {
 
 	// TODO: Check that codePtr is within the current JIT space.
 	bool inJitSpace = MIPSComp::jit && MIPSComp::jit->CodeInRange(codePtr);
-	if (!inJitSpace) {
+	// The IR interpreter's loads and stores are regular compiled code, so we rely on it telling us.
+	bool inInterpreter = !inJitSpace && g_inInterpreterBlock;
+	if (!inJitSpace && !inInterpreter) {
 		// This is a crash in non-jitted code. Not something we want to handle here, ignore.
 		return false;
 	}
@@ -171,6 +177,12 @@ bool HandleFault(uintptr_t hostAddress, void *ctx) {
 		infoString += disassembly + "\n";
 	}
 
+	if (inInterpreter && !success) {
+		// There's no crash handler to jump to, and we can't tell how to skip the instruction.
+		ERROR_LOG(MEMMAP, "Bad memory access in interpreter, could not analyze: %08x (%p)", guestAddress, (void *)hostAddress);
+		return false;
+	}
+
 	if (isAtDispatch) {
 		u32 targetAddr = currentMIPS->pc;  // bad approximation
 		// TODO: Do the other archs and platforms.
@@ -206,6 +218,15 @@ bool HandleFault(uintptr_t hostAddress, void *ctx) {
 		if (g_numReportedBadAccesses < 100) {
 			ERROR_LOG(MEMMAP, "Bad memory access detected and ignored: %08x (%p)", guestAddress, (void *)hostAddress);
 		}
+	} else if (inInterpreter) {
+		// The interpreter has no crash handler, so skip the access and have it stop the block.
+		// Stepping is enabled by the exception, and the downcount makes the loop notice.
+		Core_MemoryExceptionInfo(guestAddress, currentMIPS->pc, type, infoString);
+		g_lastCrashAddress = codePtr;
+		context->CTX_PC += info.instructionSize;
+		g_interpreterFaulted = true;
+		CoreTiming::ForceCheck();
+		ERROR_LOG(MEMMAP, "Bad memory access detected in interpreter! %08x (%p) Stopping emulation. Info:\n%s", guestAddress, (void *)hostAddress, infoString.c_str());
 	} else {
 		// Either bIgnoreBadMemAccess is off, or we failed recovery analysis.
 		uint32_t approximatePC = currentMIPS->pc;
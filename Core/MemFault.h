@@ -14,6 +14,37 @@ void MemFault_Init();
 bool MemFault_MayBeResumable();
 void MemFault_IgnoreLastCrash();
 
+// With fastmem, the IR interpreter reads and writes through base without any checks, just like
+// jitted code.  It marks the time it spends running blocks, so that HandleFault can skip bad
+// accesses in its (non-jit) code too.  Only the emu thread ever sets this.
+extern thread_local bool g_inInterpreterBlock;
+// Set by HandleFault when it skipped a bad access that raised an exception.  The interpreter
+// checks this after each access and stops the block, since there's no crash handler to jump to.
+extern volatile bool g_interpreterFaulted;
+
+struct MemFaultInterpreterScope {
+	MemFaultInterpreterScope() {
+		g_inInterpreterBlock = true;
+	}
+	~MemFaultInterpreterScope() {
+		g_inInterpreterBlock = false;
+	}
+};
+
+// Syscalls, replacements and the like called from a block aren't its own accesses, and faults
+// in them are real crashes.
+struct MemFaultInterpreterCallScope {
+	MemFaultInterpreterCallScope() : wasInBlock_(g_inInterpreterBlock) {
+		g_inInterpreterBlock = false;
+	}
+	~MemFaultInterpreterCallScope() {
+		g_inInterpreterBlock = wasInBlock_;
+	}
+
+private:
+	bool wasInBlock_;
+};
+
 // Called by exception handlers. We simply filter out accesses to PSP RAM and otherwise
 // just leave it as-is.
 bool HandleFault(uintptr_t hostAddress, void *context);
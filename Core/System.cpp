@@ -578,6 +578,8 @@ void PSP_RunLoopUntil(u64 globalticks) {
 		return;
 	}
 
+	// Between timeslices, it's safe to replace functions the game may have already run.
+	MIPSAnalyst::FinishBackgroundScans(false);
 	mipsr4k.RunLoopUntil(globalticks);
 	gpu->CleanupBeforeUI();
 }
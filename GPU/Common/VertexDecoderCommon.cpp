@@ -1269,7 +1269,12 @@ void VertexDecoder::SetVertexType(u32 fmt, const VertexDecoderOptions &options,
 
 	// Attempt to JIT as well. But only do that if the main CPU JIT is enabled, in order to aid
 	// debugging attempts - if the main JIT doesn't work, this one won't do any better, probably.
-	if (jitCache && g_Config.bVertexDecoderJit && g_Config.iCpuCore == (int)CPUCore::JIT) {
+	// On RISC-V, the IR jit is the only one there is.
+	bool cpuJit = g_Config.iCpuCore == (int)CPUCore::JIT;
+#if PPSSPP_ARCH(RISCV64)
+	cpuJit = cpuJit || g_Config.iCpuCore == (int)CPUCore::JIT_IR;
+#endif
+	if (jitCache && g_Config.bVertexDecoderJit && cpuJit) {
 		jitted_ = jitCache->Compile(*this, &jittedSize_);
 		if (!jitted_) {
 			WARN_LOG(G3D, "Vertex decoder JIT failed! fmt = %08x (%s)", fmt_, GetString(SHADER_STRING_SHORT_DESC).c_str());
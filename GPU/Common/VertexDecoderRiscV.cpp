@@ -0,0 +1,558 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(RISCV64)
+
+#include <cstddef>
+
+#include "Common/Log.h"
+#include "Common/RiscVEmitter.h"
+#include "Core/Config.h"
+#include "GPU/GPUState.h"
+#include "GPU/Common/VertexDecoderCommon.h"
+
+static const float by128 = 1.0f / 128.0f;
+static const float by32768 = 1.0f / 32768.0f;
+static const float const65535 = 65535.0f;
+
+using namespace RiscVGen;
+
+// Only caller saved registers are used, so nothing needs to be pushed.
+static const RiscVReg srcReg = X10;
+static const RiscVReg dstReg = X11;
+static const RiscVReg counterReg = X12;
+
+static const RiscVReg tempReg1 = X5;
+static const RiscVReg tempReg2 = X6;
+static const RiscVReg tempReg3 = X7;
+static const RiscVReg scratchReg = X28;
+
+// Stays non-zero while every color so far had full alpha.
+static const RiscVReg fullAlphaReg = X13;
+static const RiscVReg boundsMinUReg = X14;
+static const RiscVReg boundsMaxUReg = X15;
+static const RiscVReg boundsMinVReg = X16;
+static const RiscVReg boundsMaxVReg = X17;
+
+static const RiscVReg fpScratchReg1 = F0;
+static const RiscVReg fpScratchReg2 = F1;
+static const RiscVReg fpScratchReg3 = F2;
+
+static const RiscVReg fpUScaleReg = F10;
+static const RiscVReg fpVScaleReg = F11;
+static const RiscVReg fpUOffsetReg = F12;
+static const RiscVReg fpVOffsetReg = F13;
+static const RiscVReg fpBy128Reg = F14;
+static const RiscVReg fpBy32768Reg = F15;
+static const RiscVReg fpZeroReg = F16;
+static const RiscVReg fp65535Reg = F17;
+
+// There's no vector extension use here yet, so skinning and morph steps use the C versions.
+static const JitLookup jitLookup[] = {
+	{&VertexDecoder::Step_WeightsU8, &VertexDecoderJitCache::Jit_WeightsU8},
+	{&VertexDecoder::Step_WeightsU16, &VertexDecoderJitCache::Jit_WeightsU16},
+	{&VertexDecoder::Step_WeightsFloat, &VertexDecoderJitCache::Jit_WeightsFloat},
+
+	{&VertexDecoder::Step_TcFloat, &VertexDecoderJitCache::Jit_TcFloat},
+	{&VertexDecoder::Step_TcU8ToFloat, &VertexDecoderJitCache::Jit_TcU8ToFloat},
+	{&VertexDecoder::Step_TcU16ToFloat, &VertexDecoderJitCache::Jit_TcU16ToFloat},
+
+	{&VertexDecoder::Step_TcU8Prescale, &VertexDecoderJitCache::Jit_TcU8Prescale},
+	{&VertexDecoder::Step_TcU16Prescale, &VertexDecoderJitCache::Jit_TcU16Prescale},
+	{&VertexDecoder::Step_TcFloatPrescale, &VertexDecoderJitCache::Jit_TcFloatPrescale},
+
+	{&VertexDecoder::Step_TcFloatThrough, &VertexDecoderJitCache::Jit_TcFloatThrough},
+	{&VertexDecoder::Step_TcU16ThroughToFloat, &VertexDecoderJitCache::Jit_TcU16ThroughToFloat},
+
+	{&VertexDecoder::Step_NormalS8, &VertexDecoderJitCache::Jit_NormalS8},
+	{&VertexDecoder::Step_NormalS16, &VertexDecoderJitCache::Jit_NormalS16},
+	{&VertexDecoder::Step_NormalFloat, &VertexDecoderJitCache::Jit_NormalFloat},
+
+	{&VertexDecoder::Step_Color8888, &VertexDecoderJitCache::Jit_Color8888},
+	{&VertexDecoder::Step_Color4444, &VertexDecoderJitCache::Jit_Color4444},
+	{&VertexDecoder::Step_Color565, &VertexDecoderJitCache::Jit_Color565},
+	{&VertexDecoder::Step_Color5551, &VertexDecoderJitCache::Jit_Color5551},
+
+	{&VertexDecoder::Step_PosS8Through, &VertexDecoderJitCache::Jit_PosS8Through},
+	{&VertexDecoder::Step_PosS16Through, &VertexDecoderJitCache::Jit_PosS16Through},
+	{&VertexDecoder::Step_PosFloatThrough, &VertexDecoderJitCache::Jit_PosFloatThrough},
+
+	{&VertexDecoder::Step_PosS8, &VertexDecoderJitCache::Jit_PosS8},
+	{&VertexDecoder::Step_PosS16, &VertexDecoderJitCache::Jit_PosS16},
+	{&VertexDecoder::Step_PosFloat, &VertexDecoderJitCache::Jit_PosFloat},
+};
+
+// Takes the component at shift from the 16-bit color in tempReg1, expands it to 8 bits, and
+// places it in tempReg2 at outShift (replacing tempReg2 when outShift is 0.)
+static void ExpandColorBits(RiscVEmitter *emit, int shift, int bits, int outShift) {
+	RiscVReg src = tempReg1;
+	if (shift != 0) {
+		emit->SRLI(tempReg3, tempReg1, shift);
+		src = tempReg3;
+	}
+	emit->ANDI(tempReg3, src, (1 << bits) - 1);
+	emit->SLLI(scratchReg, tempReg3, 8 - bits);
+	emit->SRLI(tempReg3, tempReg3, bits - (8 - bits));
+	emit->OR(tempReg3, tempReg3, scratchReg);
+	if (outShift == 0) {
+		emit->MV(tempReg2, tempReg3);
+	} else {
+		emit->SLLI(tempReg3, tempReg3, outShift);
+		emit->OR(tempReg2, tempReg2, tempReg3);
+	}
+}
+
+JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int32_t *jittedSize) {
+	dec_ = &dec;
+
+	BeginWrite();
+	const u8 *start = AlignCode16();
+
+	bool prescaleStep = false;
+	// Look for prescaled texcoord steps
+	for (int i = 0; i < dec.numSteps_; i++) {
+		if (dec.steps_[i] == &VertexDecoder::Step_TcU8Prescale ||
+			dec.steps_[i] == &VertexDecoder::Step_TcU16Prescale ||
+			dec.steps_[i] == &VertexDecoder::Step_TcFloatPrescale) {
+			prescaleStep = true;
+		}
+	}
+
+	auto loadFloatConst = [&](RiscVReg fpReg, float value) {
+		LI(scratchReg, value);
+		FMV(FMv::W, FMv::X, fpReg, scratchReg);
+	};
+	loadFloatConst(fpBy128Reg, by128);
+	loadFloatConst(fpBy32768Reg, by32768);
+	FMV(FMv::W, FMv::X, fpZeroReg, R_ZERO);
+	loadFloatConst(fp65535Reg, const65535);
+
+	// Keep the scale/offset in a few fp registers if we need it.
+	if (prescaleStep) {
+		LI(tempReg1, &gstate_c.uv, scratchReg);
+		FLW(fpUScaleReg, tempReg1, offsetof(UVScale, uScale));
+		FLW(fpVScaleReg, tempReg1, offsetof(UVScale, vScale));
+		FLW(fpUOffsetReg, tempReg1, offsetof(UVScale, uOff));
+		FLW(fpVOffsetReg, tempReg1, offsetof(UVScale, vOff));
+		if ((dec.VertexType() & GE_VTYPE_TC_MASK) == GE_VTYPE_TC_8BIT) {
+			FMUL(32, fpUScaleReg, fpUScaleReg, fpBy128Reg);
+			FMUL(32, fpVScaleReg, fpVScaleReg, fpBy128Reg);
+		} else if ((dec.VertexType() & GE_VTYPE_TC_MASK) == GE_VTYPE_TC_16BIT) {
+			FMUL(32, fpUScaleReg, fpUScaleReg, fpBy32768Reg);
+			FMUL(32, fpVScaleReg, fpVScaleReg, fpBy32768Reg);
+		}
+	}
+
+	if (dec.col) {
+		LI(fullAlphaReg, 1);
+	}
+
+	if (dec.tc && dec.throughmode) {
+		// TODO: Smarter, only when doing bounds.
+		LI(scratchReg, &gstate_c.vertBounds, tempReg1);
+		LHU(boundsMinUReg, scratchReg, offsetof(KnownVertexBounds, minU));
+		LHU(boundsMaxUReg, scratchReg, offsetof(KnownVertexBounds, maxU));
+		LHU(boundsMinVReg, scratchReg, offsetof(KnownVertexBounds, minV));
+		LHU(boundsMaxVReg, scratchReg, offsetof(KnownVertexBounds, maxV));
+	}
+
+	const u8 *loopStart = GetCodePtr();
+	for (int i = 0; i < dec.numSteps_; i++) {
+		if (!CompileStep(dec, i)) {
+			EndWrite();
+			// Reset the code ptr (effectively undoing what we generated) and return zero to indicate that we failed.
+			ResetCodePtr(GetOffset(start));
+			char temp[1024] = {0};
+			dec.ToString(temp);
+			ERROR_LOG(G3D, "Could not compile vertex decoder, failed at step %d: %s", i, temp);
+			return nullptr;
+		}
+	}
+
+	auto addImm = [&](RiscVReg reg, int imm) {
+		if (imm >= -2048 && imm <= 2047) {
+			ADDI(reg, reg, imm);
+		} else {
+			LI(scratchReg, imm);
+			ADD(reg, reg, scratchReg);
+		}
+	};
+	addImm(srcReg, dec.VertexSize());
+	addImm(dstReg, dec.decFmt.stride);
+	ADDIW(counterReg, counterReg, -1);
+	if (BInRange(loopStart)) {
+		BNE(counterReg, R_ZERO, loopStart);
+	} else {
+		FixupBranch skip = BEQ(counterReg, R_ZERO);
+		J(loopStart);
+		SetJumpTarget(skip);
+	}
+
+	if (dec.col) {
+		FixupBranch skip = BNE(fullAlphaReg, R_ZERO);
+		LI(tempReg1, &gstate_c.vertexFullAlpha, scratchReg);
+		SB(R_ZERO, tempReg1, 0);
+		SetJumpTarget(skip);
+	}
+
+	if (dec.tc && dec.throughmode) {
+		// TODO: Smarter, only when doing bounds.
+		LI(scratchReg, &gstate_c.vertBounds, tempReg1);
+		SH(boundsMinUReg, scratchReg, offsetof(KnownVertexBounds, minU));
+		SH(boundsMaxUReg, scratchReg, offsetof(KnownVertexBounds, maxU));
+		SH(boundsMinVReg, scratchReg, offsetof(KnownVertexBounds, minV));
+		SH(boundsMaxVReg, scratchReg, offsetof(KnownVertexBounds, maxV));
+	}
+
+	RET();
+
+	FlushIcache();
+
+	*jittedSize = (int)(GetCodePtr() - start);
+	EndWrite();
+	return (JittedVertexDecoder)start;
+}
+
+bool VertexDecoderJitCache::CompileStep(const VertexDecoder &dec, int step) {
+	// See if we find a matching JIT function
+	for (size_t i = 0; i < ARRAY_SIZE(jitLookup); i++) {
+		if (dec.steps_[step] == jitLookup[i].func) {
+			((*this).*jitLookup[i].jitFunc)();
+			return true;
+		}
+	}
+	return false;
+}
+
+void VertexDecoderJitCache::Jit_WeightsU8() {
+	// Basic implementation - a byte at a time. TODO: Optimize
+	int j;
+	for (j = 0; j < dec_->nweights; j++) {
+		LBU(tempReg1, srcReg, dec_->weightoff + j);
+		SB(tempReg1, dstReg, dec_->decFmt.w0off + j);
+	}
+	while (j & 3) {
+		SB(R_ZERO, dstReg, dec_->decFmt.w0off + j);
+		j++;
+	}
+}
+
+void VertexDecoderJitCache::Jit_WeightsU16() {
+	// Basic implementation - a short at a time. TODO: Optimize
+	int j;
+	for (j = 0; j < dec_->nweights; j++) {
+		LHU(tempReg1, srcReg, dec_->weightoff + j * 2);
+		SH(tempReg1, dstReg, dec_->decFmt.w0off + j * 2);
+	}
+	while (j & 3) {
+		SH(R_ZERO, dstReg, dec_->decFmt.w0off + j * 2);
+		j++;
+	}
+}
+
+void VertexDecoderJitCache::Jit_WeightsFloat() {
+	int j;
+	for (j = 0; j < dec_->nweights; j++) {
+		LW(tempReg1, srcReg, dec_->weightoff + j * 4);
+		SW(tempReg1, dstReg, dec_->decFmt.w0off + j * 4);
+	}
+	while (j & 3) {  // Zero additional weights rounding up to 4.
+		SW(R_ZERO, dstReg, dec_->decFmt.w0off + j * 4);
+		j++;
+	}
+}
+
+void VertexDecoderJitCache::Jit_Color8888() {
+	LW(tempReg1, srcReg, dec_->coloff);
+	SW(tempReg1, dstReg, dec_->decFmt.c0off);
+
+	// Clear fullAlphaReg when alpha != 0xFF, without a branch.
+	SRLIW(tempReg2, tempReg1, 24);
+	ADDI(tempReg2, tempReg2, -0xFF);
+	SLTIU(tempReg2, tempReg2, 1);
+	AND(fullAlphaReg, fullAlphaReg, tempReg2);
+}
+
+void VertexDecoderJitCache::Jit_Color4444() {
+	LHU(tempReg1, srcReg, dec_->coloff);
+
+	// Spread out the components, one per byte.
+	ANDI(tempReg2, tempReg1, 0x000F);
+	for (int i = 1; i < 4; ++i) {
+		SRLI(tempReg3, tempReg1, i * 4);
+		if (i != 3)
+			ANDI(tempReg3, tempReg3, 0x000F);
+		SLLI(tempReg3, tempReg3, i * 8);
+		OR(tempReg2, tempReg2, tempReg3);
+	}
+
+	// And expand to 8 bits.
+	SLLI(tempReg3, tempReg2, 4);
+	OR(tempReg2, tempReg2, tempReg3);
+	SW(tempReg2, dstReg, dec_->decFmt.c0off);
+
+	// Clear fullAlphaReg when alpha != 0xF.
+	SRLI(tempReg3, tempReg1, 12);
+	ADDI(tempReg3, tempReg3, -0xF);
+	SLTIU(tempReg3, tempReg3, 1);
+	AND(fullAlphaReg, fullAlphaReg, tempReg3);
+}
+
+void VertexDecoderJitCache::Jit_Color565() {
+	LHU(tempReg1, srcReg, dec_->coloff);
+
+	ExpandColorBits(this, 0, 5, 0);
+	ExpandColorBits(this, 5, 6, 8);
+	ExpandColorBits(this, 11, 5, 16);
+
+	// Add in full alpha.  No need to update fullAlphaReg.
+	LI(tempReg3, (s32)0xFF000000);
+	OR(tempReg2, tempReg2, tempReg3);
+	SW(tempReg2, dstReg, dec_->decFmt.c0off);
+}
+
+void VertexDecoderJitCache::Jit_Color5551() {
+	LHU(tempReg1, srcReg, dec_->coloff);
+
+	ExpandColorBits(this, 0, 5, 0);
+	ExpandColorBits(this, 5, 5, 8);
+	ExpandColorBits(this, 10, 5, 16);
+
+	// Now alpha, which is also all we need to update fullAlphaReg.
+	SRLI(tempReg1, tempReg1, 15);
+	AND(fullAlphaReg, fullAlphaReg, tempReg1);
+	NEG(tempReg1, tempReg1);
+	SLLI(tempReg1, tempReg1, 24);
+	OR(tempReg2, tempReg2, tempReg1);
+	SW(tempReg2, dstReg, dec_->decFmt.c0off);
+}
+
+void VertexDecoderJitCache::Jit_TcU16ThroughToFloat() {
+	LHU(tempReg1, srcReg, dec_->tcoff);
+	LHU(tempReg2, srcReg, dec_->tcoff + 2);
+
+	FCVT(FConv::S, FConv::WU, fpScratchReg1, tempReg1);
+	FCVT(FConv::S, FConv::WU, fpScratchReg2, tempReg2);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.uvoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.uvoff + 4);
+
+	auto updateSide = [&](RiscVReg src, bool greater, RiscVReg dst) {
+		FixupBranch skip = greater ? BGEU(dst, src) : BGEU(src, dst);
+		MV(dst, src);
+		SetJumpTarget(skip);
+	};
+
+	updateSide(tempReg1, false, boundsMinUReg);
+	updateSide(tempReg1, true, boundsMaxUReg);
+	updateSide(tempReg2, false, boundsMinVReg);
+	updateSide(tempReg2, true, boundsMaxVReg);
+}
+
+void VertexDecoderJitCache::Jit_TcFloatThrough() {
+	LW(tempReg1, srcReg, dec_->tcoff);
+	LW(tempReg2, srcReg, dec_->tcoff + 4);
+	SW(tempReg1, dstReg, dec_->decFmt.uvoff);
+	SW(tempReg2, dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcFloat() {
+	LW(tempReg1, srcReg, dec_->tcoff);
+	LW(tempReg2, srcReg, dec_->tcoff + 4);
+	SW(tempReg1, dstReg, dec_->decFmt.uvoff);
+	SW(tempReg2, dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU8Prescale() {
+	LBU(tempReg1, srcReg, dec_->tcoff);
+	LBU(tempReg2, srcReg, dec_->tcoff + 1);
+	FCVT(FConv::S, FConv::WU, fpScratchReg1, tempReg1);
+	FCVT(FConv::S, FConv::WU, fpScratchReg2, tempReg2);
+	// Not FMADD, to round the same as the C version.
+	FMUL(32, fpScratchReg1, fpScratchReg1, fpUScaleReg);
+	FMUL(32, fpScratchReg2, fpScratchReg2, fpVScaleReg);
+	FADD(32, fpScratchReg1, fpScratchReg1, fpUOffsetReg);
+	FADD(32, fpScratchReg2, fpScratchReg2, fpVOffsetReg);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.uvoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU8ToFloat() {
+	LBU(tempReg1, srcReg, dec_->tcoff);
+	LBU(tempReg2, srcReg, dec_->tcoff + 1);
+	FCVT(FConv::S, FConv::WU, fpScratchReg1, tempReg1);
+	FCVT(FConv::S, FConv::WU, fpScratchReg2, tempReg2);
+	FMUL(32, fpScratchReg1, fpScratchReg1, fpBy128Reg);
+	FMUL(32, fpScratchReg2, fpScratchReg2, fpBy128Reg);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.uvoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU16Prescale() {
+	LHU(tempReg1, srcReg, dec_->tcoff);
+	LHU(tempReg2, srcReg, dec_->tcoff + 2);
+	FCVT(FConv::S, FConv::WU, fpScratchReg1, tempReg1);
+	FCVT(FConv::S, FConv::WU, fpScratchReg2, tempReg2);
+	FMUL(32, fpScratchReg1, fpScratchReg1, fpUScaleReg);
+	FMUL(32, fpScratchReg2, fpScratchReg2, fpVScaleReg);
+	FADD(32, fpScratchReg1, fpScratchReg1, fpUOffsetReg);
+	FADD(32, fpScratchReg2, fpScratchReg2, fpVOffsetReg);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.uvoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcU16ToFloat() {
+	LHU(tempReg1, srcReg, dec_->tcoff);
+	LHU(tempReg2, srcReg, dec_->tcoff + 2);
+	FCVT(FConv::S, FConv::WU, fpScratchReg1, tempReg1);
+	FCVT(FConv::S, FConv::WU, fpScratchReg2, tempReg2);
+	FMUL(32, fpScratchReg1, fpScratchReg1, fpBy32768Reg);
+	FMUL(32, fpScratchReg2, fpScratchReg2, fpBy32768Reg);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.uvoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_TcFloatPrescale() {
+	FLW(fpScratchReg1, srcReg, dec_->tcoff);
+	FLW(fpScratchReg2, srcReg, dec_->tcoff + 4);
+	FMUL(32, fpScratchReg1, fpScratchReg1, fpUScaleReg);
+	FMUL(32, fpScratchReg2, fpScratchReg2, fpVScaleReg);
+	FADD(32, fpScratchReg1, fpScratchReg1, fpUOffsetReg);
+	FADD(32, fpScratchReg2, fpScratchReg2, fpVOffsetReg);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.uvoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.uvoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_PosS8() {
+	Jit_AnyS8ToFloat(dec_->posoff);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.posoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.posoff + 4);
+	FSW(fpScratchReg3, dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosS16() {
+	Jit_AnyS16ToFloat(dec_->posoff);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.posoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.posoff + 4);
+	FSW(fpScratchReg3, dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosFloat() {
+	LW(tempReg1, srcReg, dec_->posoff);
+	LW(tempReg2, srcReg, dec_->posoff + 4);
+	LW(tempReg3, srcReg, dec_->posoff + 8);
+	SW(tempReg1, dstReg, dec_->decFmt.posoff);
+	SW(tempReg2, dstReg, dec_->decFmt.posoff + 4);
+	SW(tempReg3, dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosS8Through() {
+	// X and Y are signed, Z is unsigned.
+	LB(tempReg1, srcReg, dec_->posoff);
+	LB(tempReg2, srcReg, dec_->posoff + 1);
+	LBU(tempReg3, srcReg, dec_->posoff + 2);
+	FCVT(FConv::S, FConv::W, fpScratchReg1, tempReg1);
+	FCVT(FConv::S, FConv::W, fpScratchReg2, tempReg2);
+	FCVT(FConv::S, FConv::W, fpScratchReg3, tempReg3);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.posoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.posoff + 4);
+	FSW(fpScratchReg3, dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosS16Through() {
+	// X and Y are signed, Z is unsigned.
+	LH(tempReg1, srcReg, dec_->posoff);
+	LH(tempReg2, srcReg, dec_->posoff + 2);
+	LHU(tempReg3, srcReg, dec_->posoff + 4);
+	FCVT(FConv::S, FConv::W, fpScratchReg1, tempReg1);
+	FCVT(FConv::S, FConv::W, fpScratchReg2, tempReg2);
+	FCVT(FConv::S, FConv::W, fpScratchReg3, tempReg3);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.posoff);
+	FSW(fpScratchReg2, dstReg, dec_->decFmt.posoff + 4);
+	FSW(fpScratchReg3, dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_PosFloatThrough() {
+	// Instead of just copying 12 bytes, we copy 8 and clamp Z.
+	LW(tempReg1, srcReg, dec_->posoff);
+	LW(tempReg2, srcReg, dec_->posoff + 4);
+	SW(tempReg1, dstReg, dec_->decFmt.posoff);
+	SW(tempReg2, dstReg, dec_->decFmt.posoff + 4);
+
+	FLW(fpScratchReg1, srcReg, dec_->posoff + 8);
+	FMAX(32, fpScratchReg1, fpScratchReg1, fpZeroReg);
+	FMIN(32, fpScratchReg1, fpScratchReg1, fp65535Reg);
+	FSW(fpScratchReg1, dstReg, dec_->decFmt.posoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_NormalS8() {
+	// Byte loads, since this may not be aligned.
+	LBU(tempReg1, srcReg, dec_->nrmoff);
+	LBU(tempReg2, srcReg, dec_->nrmoff + 1);
+	LBU(tempReg3, srcReg, dec_->nrmoff + 2);
+	SLLI(tempReg2, tempReg2, 8);
+	SLLI(tempReg3, tempReg3, 16);
+	OR(tempReg1, tempReg1, tempReg2);
+	OR(tempReg1, tempReg1, tempReg3);
+	SW(tempReg1, dstReg, dec_->decFmt.nrmoff);
+}
+
+// Copy 6 bytes and then 2 zeroes.
+void VertexDecoderJitCache::Jit_NormalS16() {
+	LHU(tempReg1, srcReg, dec_->nrmoff);
+	LHU(tempReg2, srcReg, dec_->nrmoff + 2);
+	LHU(tempReg3, srcReg, dec_->nrmoff + 4);
+	SLLI(tempReg2, tempReg2, 16);
+	OR(tempReg1, tempReg1, tempReg2);
+	SW(tempReg1, dstReg, dec_->decFmt.nrmoff);
+	SW(tempReg3, dstReg, dec_->decFmt.nrmoff + 4);
+}
+
+void VertexDecoderJitCache::Jit_NormalFloat() {
+	LW(tempReg1, srcReg, dec_->nrmoff);
+	LW(tempReg2, srcReg, dec_->nrmoff + 4);
+	LW(tempReg3, srcReg, dec_->nrmoff + 8);
+	SW(tempReg1, dstReg, dec_->decFmt.nrmoff);
+	SW(tempReg2, dstReg, dec_->decFmt.nrmoff + 4);
+	SW(tempReg3, dstReg, dec_->decFmt.nrmoff + 8);
+}
+
+void VertexDecoderJitCache::Jit_AnyS8ToFloat(int srcoff) {
+	LB(tempReg1, srcReg, srcoff);
+	LB(tempReg2, srcReg, srcoff + 1);
+	LB(tempReg3, srcReg, srcoff + 2);
+	FCVT(FConv::S, FConv::W, fpScratchReg1, tempReg1);
+	FCVT(FConv::S, FConv::W, fpScratchReg2, tempReg2);
+	FCVT(FConv::S, FConv::W, fpScratchReg3, tempReg3);
+	FMUL(32, fpScratchReg1, fpScratchReg1, fpBy128Reg);
+	FMUL(32, fpScratchReg2, fpScratchReg2, fpBy128Reg);
+	FMUL(32, fpScratchReg3, fpScratchReg3, fpBy128Reg);
+}
+
+void VertexDecoderJitCache::Jit_AnyS16ToFloat(int srcoff) {
+	LH(tempReg1, srcReg, srcoff);
+	LH(tempReg2, srcReg, srcoff + 2);
+	LH(tempReg3, srcReg, srcoff + 4);
+	FCVT(FConv::S, FConv::W, fpScratchReg1, tempReg1);
+	FCVT(FConv::S, FConv::W, fpScratchReg2, tempReg2);
+	FCVT(FConv::S, FConv::W, fpScratchReg3, tempReg3);
+	FMUL(32, fpScratchReg1, fpScratchReg1, fpBy32768Reg);
+	FMUL(32, fpScratchReg2, fpScratchReg2, fpBy32768Reg);
+	FMUL(32, fpScratchReg3, fpScratchReg3, fpBy32768Reg);
+}
+
+#endif // PPSSPP_ARCH(RISCV64)
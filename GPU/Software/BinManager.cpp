@@ -19,6 +19,7 @@
 #include <condition_variable>
 #include <mutex>
 #include "Common/Profiler/Profiler.h"
+#include "Common/StringUtils.h"
 #include "Common/Thread/ThreadManager.h"
 #include "Common/TimeUtil.h"
 #include "Core/System.h"
@@ -90,12 +91,30 @@ static inline void DrawBinItem(const BinItem &item, const RasterizerState &state
 		DrawPoint(item.v0, item.range, state);
 		break;
 	}
+
+	u16 minZ = std::min(item.v0.screenpos.z, item.v1.screenpos.z);
+	u16 maxZ = std::max(item.v0.screenpos.z, item.v1.screenpos.z);
+	if (item.type == BinItemType::TRIANGLE) {
+		minZ = std::min(minZ, item.v2.screenpos.z);
+		maxZ = std::max(maxZ, item.v2.screenpos.z);
+	} else if (item.type == BinItemType::POINT) {
+		minZ = maxZ = item.v0.screenpos.z;
+	}
+	if (item.type == BinItemType::CLEAR_RECT) {
+		// This always writes exactly v1's depth to the whole range.
+		minZ = maxZ = item.v1.screenpos.z;
+	} else {
+		// Interpolation might round a bit past the vertex values.
+		minZ = minZ == 0 ? 0 : minZ - 1;
+		maxZ = maxZ == 0xFFFF ? 0xFFFF : maxZ + 1;
+	}
+	UpdateDepthTiles(item.range, minZ, maxZ, item.type == BinItemType::CLEAR_RECT, state);
 }
 
 class DrawBinItemsTask : public Task {
 public:
-	DrawBinItemsTask(BinWaitable *notify, BinManager::BinItemQueue &items, std::atomic<bool> &status, const BinManager::BinStateQueue &states)
-		: notify_(notify), items_(items), status_(status), states_(states) {
+	DrawBinItemsTask(BinWaitable *notify, BinManager *bins, int index)
+		: notify_(notify), bins_(bins), index_(index) {
 	}
 
 	TaskType Type() const override {
@@ -103,10 +122,12 @@ class DrawBinItemsTask : public Task {
 	}
 
 	void Run() override {
-		ProcessItems();
-		status_ = false;
+		ProcessItems(index_);
+		bins_->taskStatus_[index_] = false;
 		// In case of any atomic issues, do another pass.
-		ProcessItems();
+		ProcessItems(index_);
+		// Then help with any bins whose threads haven't gotten to them yet.
+		StealItems();
 		notify_->Drain();
 	}
 
@@ -115,18 +136,42 @@ class DrawBinItemsTask : public Task {
 	}
 
 private:
-	void ProcessItems() {
-		while (!items_.Empty()) {
-			const BinItem &item = items_.PeekNext();
-			DrawBinItem(item, states_[item.stateIndex]);
-			items_.SkipNext();
+	bool ProcessItems(int bin) {
+		BinManager::BinItemQueue &items = bins_->taskQueues_[bin];
+		std::atomic<bool> &claim = bins_->taskClaims_[bin];
+		const BinManager::BinStateQueue &states = bins_->states_;
+
+		bool processed = false;
+		// Whoever releases the claim last checks for more, so nothing queued gets stranded.
+		while (!items.Empty() && !claim.exchange(true)) {
+			double st = time_now_d();
+			while (!items.Empty()) {
+				const BinItem &item = items.PeekNext();
+				DrawBinItem(item, states[item.stateIndex]);
+				items.SkipNext();
+			}
+			claim = false;
+
+			int64_t nanos = (int64_t)((time_now_d() - st) * 1000000000.0);
+			bins_->taskBinCosts_[bin] += nanos;
+			bins_->taskBusyTimes_[index_] += nanos;
+			processed = true;
+		}
+		return processed;
+	}
+
+	void StealItems() {
+		const int count = bins_->initTasks_;
+		for (int i = 1; i < count; ++i) {
+			int bin = (index_ + i) % count;
+			if (ProcessItems(bin))
+				bins_->taskSteals_[index_]++;
 		}
 	}
 
 	BinWaitable *notify_;
-	BinManager::BinItemQueue &items_;
-	std::atomic<bool> &status_;
-	const BinManager::BinStateQueue &states_;
+	BinManager *bins_;
+	int index_;
 };
 
 constexpr int BinManager::MAX_POSSIBLE_TASKS;
@@ -138,14 +183,19 @@ BinManager::BinManager() {
 	queueRange_.y2 = 0;
 
 	waitable_ = new BinWaitable();
-	for (auto &s : taskStatus_)
-		s = false;
+	for (int i = 0; i < MAX_POSSIBLE_TASKS; ++i) {
+		taskStatus_[i] = false;
+		taskClaims_[i] = false;
+		taskBinCosts_[i] = 0;
+		taskBusyTimes_[i] = 0;
+		taskSteals_[i] = 0;
+	}
 
-	int maxInitTasks = std::min(g_threadManager.GetNumLooperThreads(), MAX_POSSIBLE_TASKS);
-	for (int i = 0; i < maxInitTasks; ++i) {
+	initTasks_ = std::min(g_threadManager.GetNumLooperThreads(), MAX_POSSIBLE_TASKS);
+	for (int i = 0; i < initTasks_; ++i) {
 		taskQueues_[i].Setup();
 		for (DrawBinItemsTask *&task : taskLists_[i].tasks)
-			task = new DrawBinItemsTask(waitable_, taskQueues_[i], taskStatus_[i], states_);
+			task = new DrawBinItemsTask(waitable_, this, i);
 	}
 	states_.Setup();
 	cluts_.Setup();
@@ -203,6 +253,14 @@ void BinManager::UpdateState() {
 		if (state.pixelID.depthWrite)
 			pendingWrites_[1].Expand(gstate.getDepthBufAddress() & mirrorMask, 2, gstate.DepthBufStride(), scissorTL, scissorBR);
 
+		// Depth tiles can't follow color writes to the depth buffer, or depth writes past its stride.
+		const uint32_t colorStart = (gstate.getFrameBufAddress() & mirrorMask) + (scissorTL.y * gstate.FrameBufStride() + scissorTL.x) * bpp;
+		const uint32_t colorEnd = (gstate.getFrameBufAddress() & mirrorMask) + (scissorBR.y * gstate.FrameBufStride() + scissorBR.x + 1) * bpp;
+		const uint32_t depthStart = gstate.getDepthBufAddress() & mirrorMask;
+		const uint32_t depthEnd = depthStart + 512 * gstate.DepthBufStride() * 2;
+		if ((colorStart < depthEnd && colorEnd > depthStart) || scissorBR.x >= gstate.DepthBufStride())
+			DisableDepthTiles();
+
 		ClearDirty(SoftDirty::BINNER_RANGE);
 	} else if (pendingOverlap_) {
 		if (HasTextureWrite(state))
@@ -400,28 +458,16 @@ void BinManager::Drain() {
 
 	// If the waitable has fully drained, we can update our binning decisions.
 	if (!tasksSplit_ || waitable_->Empty()) {
+		UpdateCostHistory();
+
 		int w2 = (queueRange_.x2 - queueRange_.x1 + (SCREEN_SCALE_FACTOR * 2 - 1)) / (SCREEN_SCALE_FACTOR * 2);
 		int h2 = (queueRange_.y2 - queueRange_.y1 + (SCREEN_SCALE_FACTOR * 2 - 1)) / (SCREEN_SCALE_FACTOR * 2);
 
-		// Always bin the entire possible range, but focus on the drawn area.
-		ScreenCoords tl(0, 0, 0);
-		ScreenCoords br(1024 * SCREEN_SCALE_FACTOR, 1024 * SCREEN_SCALE_FACTOR, 0);
-
 		taskRanges_.clear();
 		if (h2 >= 18 && w2 >= h2 * 4) {
-			int bin_w = std::max(4, (w2 + maxTasks_ - 1) / maxTasks_) * SCREEN_SCALE_FACTOR * 2;
-			taskRanges_.push_back(BinCoords{ tl.x, tl.y, queueRange_.x1 + bin_w - 1, br.y - 1 });
-			for (int x = queueRange_.x1 + bin_w; x <= queueRange_.x2; x += bin_w) {
-				int x2 = x + bin_w > queueRange_.x2 ? br.x : x + bin_w;
-				taskRanges_.push_back(BinCoords{ x, tl.y, x2 - 1, br.y - 1 });
-			}
+			SplitTaskRanges(true);
 		} else if (h2 >= 18 && w2 >= 18) {
-			int bin_h = std::max(4, (h2 + maxTasks_ - 1) / maxTasks_) * SCREEN_SCALE_FACTOR * 2;
-			taskRanges_.push_back(BinCoords{ tl.x, tl.y, br.x - 1, queueRange_.y1 + bin_h - 1 });
-			for (int y = queueRange_.y1 + bin_h; y <= queueRange_.y2; y += bin_h) {
-				int y2 = y + bin_h > queueRange_.y2 ? br.y : y + bin_h;
-				taskRanges_.push_back(BinCoords{ tl.x, y, br.x - 1, y2 - 1 });
-			}
+			SplitTaskRanges(false);
 		}
 
 		tasksSplit_ = true;
@@ -473,12 +519,87 @@ void BinManager::Drain() {
 	}
 }
 
+void BinManager::SplitTaskRanges(bool columns) {
+	// Always bin the entire possible range, but focus on the drawn area.
+	const int start = columns ? queueRange_.x1 : queueRange_.y1;
+	const int end = columns ? queueRange_.x2 : queueRange_.y2;
+	const int fullEnd = 1024 * SCREEN_SCALE_FACTOR;
+
+	// Each bin starts at one of these, except the first which starts at 0.
+	std::vector<int> cuts;
+	const float *costs = columns ? columnCosts_ : rowCosts_;
+	const int firstBucket = std::min(start / COST_BUCKET_SIZE, COST_BUCKETS - 1);
+	const int lastBucket = std::min(end / COST_BUCKET_SIZE, COST_BUCKETS - 1);
+	float total = 0.0f;
+	for (int b = firstBucket; b <= lastBucket; ++b)
+		total += costs[b];
+
+	if (total > 0.0f) {
+		// Give each bin about the same cost, based on how long each area took before.
+		// Areas with no history still get some weight, in case the drawing moved.
+		const float floor = total / (float)(lastBucket - firstBucket + 1) * 0.25f;
+		const float target = (total + floor * (lastBucket - firstBucket + 1)) / (float)maxTasks_;
+		float sum = 0.0f;
+		float next = target;
+		for (int b = firstBucket; b < lastBucket && (int)cuts.size() < maxTasks_ - 1; ++b) {
+			sum += costs[b] + floor;
+			if (sum >= next) {
+				cuts.push_back((b + 1) * COST_BUCKET_SIZE);
+				while (next <= sum)
+					next += target;
+			}
+		}
+	} else {
+		int size2 = (end - start + (SCREEN_SCALE_FACTOR * 2 - 1)) / (SCREEN_SCALE_FACTOR * 2);
+		int binSize = std::max(4, (size2 + maxTasks_ - 1) / maxTasks_) * SCREEN_SCALE_FACTOR * 2;
+		for (int pos = start + binSize; pos <= end; pos += binSize)
+			cuts.push_back(pos);
+	}
+
+	int binStart = 0;
+	for (size_t i = 0; i <= cuts.size(); ++i) {
+		int binEnd = i < cuts.size() ? cuts[i] : fullEnd;
+		if (columns)
+			taskRanges_.push_back(BinCoords{ binStart, 0, binEnd - 1, fullEnd - 1 });
+		else
+			taskRanges_.push_back(BinCoords{ 0, binStart, fullEnd - 1, binEnd - 1 });
+		binStart = binEnd;
+	}
+
+	splitColumns_ = columns;
+	splitRange_ = queueRange_;
+}
+
+void BinManager::UpdateCostHistory() {
+	// Only call when no tasks are running, the costs belong to the current split.
+	float *costs = splitColumns_ ? columnCosts_ : rowCosts_;
+	if (taskRanges_.size() > 1) {
+		for (int b = 0; b < COST_BUCKETS; ++b)
+			costs[b] *= 0.5f;
+	}
+
+	for (size_t i = 0; i < taskRanges_.size(); ++i) {
+		int64_t cost = taskBinCosts_[i].exchange(0);
+		const BinCoords range = taskRanges_[i].Intersect(splitRange_);
+		if (cost == 0 || taskRanges_.size() <= 1 || range.Invalid())
+			continue;
+
+		// Spread it over the part of the bin that actually had drawing.
+		int firstBucket = std::min((splitColumns_ ? range.x1 : range.y1) / COST_BUCKET_SIZE, COST_BUCKETS - 1);
+		int lastBucket = std::min((splitColumns_ ? range.x2 : range.y2) / COST_BUCKET_SIZE, COST_BUCKETS - 1);
+		float share = (float)cost / (float)(lastBucket - firstBucket + 1);
+		for (int b = firstBucket; b <= lastBucket; ++b)
+			costs[b] += share;
+	}
+}
+
 void BinManager::Flush(const char *reason) {
 	double st;
 	if (coreCollectDebugStats)
 		st = time_now_d();
 	Drain();
 	waitable_->Wait();
+	UpdateCostHistory();
 	taskRanges_.clear();
 	tasksSplit_ = false;
 
@@ -590,17 +711,32 @@ void BinManager::GetStats(char *buffer, size_t bufsize) {
 		recentTotal += it.second;
 	}
 
+	// Idle is measured against the busiest thread, since that's what everyone waits on.
+	int64_t mostBusy = 0;
+	int steals = 0;
+	for (int i = 0; i < initTasks_; ++i) {
+		mostBusy = std::max(mostBusy, (int64_t)taskBusyTimes_[i]);
+		steals += taskSteals_[i];
+	}
+	std::string busyIdle;
+	for (int i = 0; i < initTasks_; ++i) {
+		int64_t busy = taskBusyTimes_[i];
+		busyIdle += StringFromFormat("%s%0.2f/%0.2f", i == 0 ? "" : ", ", busy / 1000000.0, (mostBusy - busy) / 1000000.0);
+	}
+
 	snprintf(buffer, bufsize,
 		"Slowest individual flush: %s (%0.4f)\n"
 		"Slowest frame flush: %s (%0.4f)\n"
 		"Slowest recent flush: %s (%0.4f)\n"
 		"Total flush time: %0.4f (%05.2f%%, last 2: %05.2f%%)\n"
-		"Thread enqueues: %d, count %d",
+		"Thread enqueues: %d, count %d, steals %d\n"
+		"Thread busy/idle ms: %s",
 		slowestFlushReason_, slowestFlushTime_,
 		slowestTotalReason, slowestTotalTime,
 		slowestRecentReason, slowestRecentTime,
 		allTotal, allTotal * (6000.0 / 1.001), recentTotal * (3000.0 / 1.001),
-		enqueues_, mostThreads_);
+		enqueues_, mostThreads_, steals,
+		busyIdle.c_str());
 }
 
 void BinManager::ResetStats() {
@@ -610,6 +746,10 @@ void BinManager::ResetStats() {
 	slowestFlushTime_ = 0.0;
 	enqueues_ = 0;
 	mostThreads_ = 0;
+	for (int i = 0; i < initTasks_; ++i) {
+		taskBusyTimes_[i] = 0;
+		taskSteals_[i] = 0;
+	}
 }
 
 inline BinCoords BinCoords::Intersect(const BinCoords &range) const {
@@ -246,13 +246,29 @@ class BinManager {
 	SoftDirty dirty_ = SoftDirty::NONE;
 
 	int maxTasks_ = 1;
+	int initTasks_ = 0;
 	bool tasksSplit_ = false;
 	std::vector<BinCoords> taskRanges_;
 	BinItemQueue taskQueues_[MAX_POSSIBLE_TASKS];
 	BinTaskList taskLists_[MAX_POSSIBLE_TASKS];
 	std::atomic<bool> taskStatus_[MAX_POSSIBLE_TASKS];
+	// Held by whichever thread is drawing a bin, which may not be its own.
+	std::atomic<bool> taskClaims_[MAX_POSSIBLE_TASKS];
+	// Nanoseconds spent drawing each bin since it was last split.
+	std::atomic<int64_t> taskBinCosts_[MAX_POSSIBLE_TASKS];
+	// Per thread stats, including bins taken from other threads.
+	std::atomic<int64_t> taskBusyTimes_[MAX_POSSIBLE_TASKS];
+	std::atomic<int> taskSteals_[MAX_POSSIBLE_TASKS];
 	BinWaitable *waitable_ = nullptr;
 
+	// Decaying draw cost per 8 pixel column or row band, used to balance the next split.
+	static constexpr int COST_BUCKET_SIZE = 8 * SCREEN_SCALE_FACTOR;
+	static constexpr int COST_BUCKETS = 1024 / 8;
+	float columnCosts_[COST_BUCKETS]{};
+	float rowCosts_[COST_BUCKETS]{};
+	bool splitColumns_ = false;
+	BinCoords splitRange_{};
+
 	BinDirtyRange pendingWrites_[2]{};
 	std::unordered_map<uint32_t, BinDirtyRange> pendingReads_;
 
@@ -273,6 +289,8 @@ class BinManager {
 	BinCoords Range(const VertexData &v0, const VertexData &v1);
 	BinCoords Range(const VertexData &v0);
 	void Expand(const BinCoords &range);
+	void SplitTaskRanges(bool columns);
+	void UpdateCostHistory();
 
 	friend class DrawBinItemsTask;
 };
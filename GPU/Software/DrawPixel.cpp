@@ -17,6 +17,7 @@
 
 #include <mutex>
 #include "Common/Common.h"
+#include "Common/CPUDetect.h"
 #include "Common/Data/Convert/ColorConv.h"
 #include "Core/Config.h"
 #include "GPU/GPUState.h"
@@ -506,6 +507,10 @@ SingleFunc GetSingleFunc(const PixelFuncID &id) {
 	return jitCache->GenericSingle(id);
 }
 
+SpanFunc GetSpanFunc(const PixelFuncID &id) {
+	return jitCache->GetSpan(id);
+}
+
 SingleFunc PixelJitCache::GenericSingle(const PixelFuncID &id) {
 	if (id.clearMode) {
 		switch (id.fbFormat) {
@@ -540,12 +545,21 @@ PixelJitCache::PixelJitCache() : CodeBlock(1024 * 64 * 4) {
 void PixelJitCache::Clear() {
 	CodeBlock::Clear();
 	cache_.clear();
+	spanCache_.clear();
 	addresses_.clear();
 
 	constBlendHalf_11_4s_ = nullptr;
 	constBlendInvert_11_4s_ = nullptr;
 	const255_16s_ = nullptr;
 	constBy255i_ = nullptr;
+
+	constSpanBlendHalf_11_4s_ = nullptr;
+	constSpanBlendInvert_11_4s_ = nullptr;
+	constSpan255_16s_ = nullptr;
+	constSpanBy255i_ = nullptr;
+	constSpanMaskBits_ = nullptr;
+	constSpanFogShuffle_ = nullptr;
+	constSpanDitherShuffle_ = nullptr;
 }
 
 std::string PixelJitCache::DescribeCodePtr(const u8 *ptr) {
@@ -591,6 +605,31 @@ SingleFunc PixelJitCache::GetSingle(const PixelFuncID &id) {
 	return nullptr;
 }
 
+SpanFunc PixelJitCache::GetSpan(const PixelFuncID &id) {
+	std::lock_guard<std::mutex> guard(jitCacheLock);
+
+	auto it = spanCache_.find(id);
+	if (it != spanCache_.end()) {
+		return it->second;
+	}
+
+	// Unlike GetSingle(), don't clear here: the single func for this id may've just been compiled.
+	// Drawing per pixel is fine until GetSingle() next clears.
+	if (GetSpaceLeft() < 65536) {
+		return nullptr;
+	}
+
+#if PPSSPP_ARCH(AMD64) && !PPSSPP_PLATFORM(UWP)
+	if (g_Config.bSoftwareRenderingJit && cpu_info.bAVX2) {
+		// This caches nullptr too, for ids spans don't support.
+		SpanFunc func = CompileSpan(id);
+		spanCache_[id] = func;
+		return func;
+	}
+#endif
+	return nullptr;
+}
+
 void ComputePixelBlendState(PixelBlendState &state, const PixelFuncID &id) {
 	switch (id.AlphaBlendEq()) {
 	case GE_BLENDMODE_MUL_AND_ADD:
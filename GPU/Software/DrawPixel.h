@@ -38,6 +38,19 @@ namespace Rasterizer {
 typedef void (SOFTRAST_CALL *SingleFunc)(int x, int y, int z, int fog, Vec4IntArg color_in, const PixelFuncID &pixelID);
 SingleFunc GetSingleFunc(const PixelFuncID &id);
 
+// A horizontal run of up to 8 pixels, starting at x.  Colors are already clamped to RGBA8888.
+struct PixelSpan {
+	int z[8];
+	uint32_t color[8];
+	uint8_t fog[8];
+	// Bit i set means pixel x + i should be drawn.
+	uint32_t mask;
+};
+
+typedef void (SOFTRAST_CALL *SpanFunc)(int x, int y, const PixelSpan &span, const PixelFuncID &pixelID);
+// Returns nullptr if spans can't be drawn with this id, use GetSingleFunc() per pixel then.
+SpanFunc GetSpanFunc(const PixelFuncID &id);
+
 void Init();
 void Shutdown();
 
@@ -59,12 +72,15 @@ class PixelJitCache : public Rasterizer::CodeBlock {
 	// Returns a pointer to the code to run.
 	SingleFunc GetSingle(const PixelFuncID &id);
 	SingleFunc GenericSingle(const PixelFuncID &id);
+	// Returns nullptr if unsupported, which is common.
+	SpanFunc GetSpan(const PixelFuncID &id);
 	void Clear() override;
 
 	std::string DescribeCodePtr(const u8 *ptr) override;
 
 private:
 	SingleFunc CompileSingle(const PixelFuncID &id);
+	SpanFunc CompileSpan(const PixelFuncID &id);
 
 	RegCache::Reg GetPixelID();
 	void UnlockPixelID(RegCache::Reg &r);
@@ -99,7 +115,30 @@ class PixelJitCache : public Rasterizer::CodeBlock {
 	bool Jit_ConvertFrom5551(const PixelFuncID &id, RegCache::Reg colorReg, RegCache::Reg temp1Reg, RegCache::Reg temp2Reg, bool keepAlpha);
 	bool Jit_ConvertFrom4444(const PixelFuncID &id, RegCache::Reg colorReg, RegCache::Reg temp1Reg, RegCache::Reg temp2Reg, bool keepAlpha);
 
+	// Span versions, which work on 8 pixels at once using AVX2.
+	void WriteSpanConstantPool(const PixelFuncID &id);
+	RegCache::Reg GetSpanDest(const PixelFuncID &id);
+	void Jit_SpanBroadcast32(RegCache::Reg destReg, uint32_t value);
+	void Jit_SpanExpandColor();
+	void Jit_SpanPackColor();
+	bool Jit_SpanCompare(GEComparison func, RegCache::Reg valueReg, RegCache::Reg refReg);
+	bool Jit_SpanStore16(RegCache::Reg offReg, RegCache::Reg valueReg);
+	bool Jit_SpanDepthRange(const PixelFuncID &id);
+	bool Jit_SpanAlphaTest(const PixelFuncID &id);
+	bool Jit_SpanApplyFog(const PixelFuncID &id);
+	bool Jit_SpanColorTest(const PixelFuncID &id);
+	bool Jit_SpanDepthTest(const PixelFuncID &id);
+	bool Jit_SpanWriteDepth(const PixelFuncID &id);
+	bool Jit_SpanAlphaBlend(const PixelFuncID &id);
+	bool Jit_SpanBlendFactor(const PixelFuncID &id, RegCache::Reg factorReg, RegCache::Reg colorReg, RegCache::Reg dstReg, PixelBlendFactor factor);
+	bool Jit_SpanDstBlendFactor(const PixelFuncID &id, RegCache::Reg srcFactorReg, RegCache::Reg dstFactorReg, RegCache::Reg colorReg, RegCache::Reg dstReg);
+	bool Jit_SpanDither(const PixelFuncID &id);
+	bool Jit_SpanWriteColor(const PixelFuncID &id);
+	bool Jit_SpanConvertTo16(const PixelFuncID &id, RegCache::Reg colorReg);
+	bool Jit_SpanConvertFrom16(const PixelFuncID &id, RegCache::Reg colorReg);
+
 	std::unordered_map<PixelFuncID, SingleFunc> cache_;
+	std::unordered_map<PixelFuncID, SpanFunc> spanCache_;
 	std::unordered_map<PixelFuncID, const u8 *> addresses_;
 
 	const u8 *constBlendHalf_11_4s_ = nullptr;
@@ -107,6 +146,15 @@ class PixelJitCache : public Rasterizer::CodeBlock {
 	const u8 *const255_16s_ = nullptr;
 	const u8 *constBy255i_ = nullptr;
 
+	// These are all 256-bit, for spans.
+	const u8 *constSpanBlendHalf_11_4s_ = nullptr;
+	const u8 *constSpanBlendInvert_11_4s_ = nullptr;
+	const u8 *constSpan255_16s_ = nullptr;
+	const u8 *constSpanBy255i_ = nullptr;
+	const u8 *constSpanMaskBits_ = nullptr;
+	const u8 *constSpanFogShuffle_ = nullptr;
+	const u8 *constSpanDitherShuffle_ = nullptr;
+
 #if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
 	void Discard();
 	void Discard(Gen::CCFlags cc);
@@ -2006,7 +2006,7 @@ bool PixelJitCache::Jit_ApplyLogicOp(const PixelFuncID &id, RegCache::Reg colorR
 	skipStandardWrites_.push_back(J(true));
 
 	tableValues[GE_LOGIC_NAND] = GetCodePointer();
-	AND(bits, R(temp1Reg), MatR(colorOff));
+	AND(bits, R(colorReg), MatR(colorOff));
 	NOT(32, R(colorReg));
 	if (stencilReg != INVALID_REG) {
 		AND(bits, R(colorReg), notStencilMask);
@@ -2324,6 +2324,1102 @@ bool PixelJitCache::Jit_ConvertFrom4444(const PixelFuncID &id, RegCache::Reg col
 	return true;
 }
 
+SpanFunc PixelJitCache::CompileSpan(const PixelFuncID &id) {
+	// Stencil, logic ops, and clear mode are only handled a pixel at a time.
+	if (id.clearMode || id.stencilTest || id.applyLogicOp)
+		return nullptr;
+
+	// Setup the reg cache and disallow spill for arguments.
+	regCache_.SetupABI({
+		RegCache::GEN_ARG_X,
+		RegCache::GEN_ARG_Y,
+		RegCache::GEN_ARG_SPAN,
+		RegCache::GEN_ARG_ID,
+	});
+
+	BeginWrite();
+	Describe("InitSpan");
+	WriteSpanConstantPool(id);
+
+	const u8 *resetPos = AlignCode16();
+	bool success = true;
+
+#if PPSSPP_PLATFORM(WINDOWS)
+	// Only XMM0-XMM5 are volatile, and we'll want more.  Unused regs are dropped from the prolog.
+	WriteProlog(0, { XMM6, XMM7, XMM8, XMM9, XMM10, XMM11, XMM12, XMM13, XMM14, XMM15 }, { R12, R13, R14, R15 });
+#else
+	WriteProlog(0, {}, {});
+#endif
+	// All args fit in regs, so the id is never on the stack.
+	_assert_(regCache_.Has(RegCache::GEN_ARG_ID));
+	stackIDOffset_ = -1;
+
+	// Note: everything in here is VEX encoded, since we use all 256 bits.
+	Describe("SpanInit");
+	X64Reg zeroReg = regCache_.Alloc(RegCache::VEC_ZERO);
+	VPXOR(128, zeroReg, zeroReg, R(zeroReg));
+	regCache_.Unlock(zeroReg, RegCache::VEC_ZERO);
+	regCache_.ForceRetain(RegCache::VEC_ZERO);
+
+	// Expand the bit per pixel into a full lane per pixel.  Tests clear lanes as they fail.
+	X64Reg spanReg = regCache_.Find(RegCache::GEN_ARG_SPAN);
+	X64Reg maskReg = regCache_.Alloc(RegCache::VEC_ARG_MASK);
+	VPBROADCASTD(256, maskReg, MDisp(spanReg, offsetof(PixelSpan, mask)));
+	VPAND(256, maskReg, maskReg, M(constSpanMaskBits_));
+	VPCMPEQD(256, maskReg, maskReg, M(constSpanMaskBits_));
+	regCache_.Unlock(maskReg, RegCache::VEC_ARG_MASK);
+	regCache_.ForceRetain(RegCache::VEC_ARG_MASK);
+
+	X64Reg zReg = regCache_.Alloc(RegCache::VEC_ARG_Z);
+	VMOVDQU(256, zReg, MDisp(spanReg, offsetof(PixelSpan, z)));
+	regCache_.Unlock(zReg, RegCache::VEC_ARG_Z);
+	regCache_.ForceRetain(RegCache::VEC_ARG_Z);
+
+	// The span colors are already clamped, which is what the single func starts by doing.
+	X64Reg argColorReg = regCache_.Alloc(RegCache::VEC_ARG_COLOR);
+	VMOVDQU(256, argColorReg, MDisp(spanReg, offsetof(PixelSpan, color)));
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+	regCache_.ForceRetain(RegCache::VEC_ARG_COLOR);
+	regCache_.Unlock(spanReg, RegCache::GEN_ARG_SPAN);
+	colorIs16Bit_ = false;
+
+	success = success && Jit_SpanDepthRange(id);
+	success = success && Jit_SpanAlphaTest(id);
+	success = success && Jit_SpanApplyFog(id);
+	success = success && Jit_SpanColorTest(id);
+	success = success && Jit_SpanDepthTest(id);
+
+	// If every pixel failed, we can skip the rest.
+	Describe("SpanCheckMask");
+	maskReg = regCache_.Find(RegCache::VEC_ARG_MASK);
+	VPTEST(256, maskReg, R(maskReg));
+	regCache_.Unlock(maskReg, RegCache::VEC_ARG_MASK);
+	Discard(CC_Z);
+
+	success = success && Jit_SpanWriteDepth(id);
+	success = success && Jit_SpanAlphaBlend(id);
+	success = success && Jit_SpanDither(id);
+	success = success && Jit_SpanWriteColor(id);
+
+	for (auto &fixup : discards_) {
+		SetJumpTarget(fixup);
+	}
+	discards_.clear();
+
+	// Avoid SSE transition penalties in the caller, since we dirtied the upper halves.
+	VZEROUPPER();
+
+	if (regCache_.Has(RegCache::GEN_ARG_ID))
+		regCache_.ForceRelease(RegCache::GEN_ARG_ID);
+	regCache_.ForceRelease(RegCache::VEC_ARG_MASK);
+	regCache_.ForceRelease(RegCache::VEC_ZERO);
+
+	if (!success) {
+		ERROR_LOG_REPORT(G3D, "Could not compile pixel span func: %s", DescribePixelFuncID(id).c_str());
+
+		regCache_.Reset(false);
+		EndWrite();
+		ResetCodePtr(GetOffset(resetPos));
+		return nullptr;
+	}
+
+	const u8 *start = WriteFinalizedEpilog();
+	regCache_.Reset(true);
+	return (SpanFunc)start;
+}
+
+void PixelJitCache::WriteSpanConstantPool(const PixelFuncID &id) {
+	// Same as the single pixel constants, but 256-bit.
+	WriteSimpleConst16x16(constSpanBlendHalf_11_4s_, 1 << 3);
+	WriteSimpleConst16x16(constSpanBlendInvert_11_4s_, 0xFF << 4);
+	WriteSimpleConst16x16(constSpan255_16s_, 0xFF);
+	WriteSimpleConst16x16(constSpanBy255i_, 0x8081);
+
+	// The bit for each pixel in PixelSpan::mask, used to expand it.
+	if (constSpanMaskBits_ == nullptr) {
+		constSpanMaskBits_ = AlignCode16();
+		for (int i = 0; i < 8; ++i)
+			Write32(1 << i);
+	}
+
+	// Expanded colors are split into two halves, which hold pixels 0, 1 | 4, 5 and 2, 3 | 6, 7.
+	// These shuffle fog (8 bytes, broadcast to each 128-bit lane) into place, for each half.
+	if (constSpanFogShuffle_ == nullptr) {
+		constSpanFogShuffle_ = AlignCode16();
+		for (int half = 0; half < 2; ++half) {
+			for (int lane = 0; lane < 2; ++lane) {
+				for (int p = 0; p < 2; ++p) {
+					for (int c = 0; c < 4; ++c) {
+						Write8(lane * 4 + half * 2 + p);
+						Write8(0x80);
+					}
+				}
+			}
+		}
+	}
+
+	// First, indexes to add to (x & 3) to get each pixel's dither value from the matrix row.
+	// Then, like fog, shuffles to put the 16-bit dither values into RGB of each half (A gets zero.)
+	if (constSpanDitherShuffle_ == nullptr) {
+		constSpanDitherShuffle_ = AlignCode16();
+		for (int i = 0; i < 16; ++i)
+			Write8(i & 7);
+		for (int half = 0; half < 2; ++half) {
+			for (int lane = 0; lane < 2; ++lane) {
+				for (int p = 0; p < 2; ++p) {
+					int pixel = lane * 4 + half * 2 + p;
+					for (int c = 0; c < 3; ++c) {
+						Write8(pixel * 2);
+						Write8(pixel * 2 + 1);
+					}
+					Write8(0x80);
+					Write8(0x80);
+				}
+			}
+		}
+	}
+}
+
+RegCache::Reg PixelJitCache::GetSpanDest(const PixelFuncID &id) {
+	if (regCache_.Has(RegCache::VEC_DST))
+		return regCache_.Find(RegCache::VEC_DST);
+
+	// This is the dest color as is, in 32-bit lanes even for 16-bit formats.
+	X64Reg colorOffReg = GetColorOff(id);
+	Describe("GetSpanDest");
+	X64Reg dstReg = regCache_.Alloc(RegCache::VEC_DST);
+	if (id.FBFormat() == GE_FORMAT_8888)
+		VMOVDQU(256, dstReg, MatR(colorOffReg));
+	else
+		VPMOVZXWD(256, dstReg, MatR(colorOffReg));
+	regCache_.Unlock(colorOffReg, RegCache::GEN_COLOR_OFF);
+	// We may need this for both blending and the write mask.
+	regCache_.ForceRetain(RegCache::VEC_DST);
+
+	return dstReg;
+}
+
+void PixelJitCache::Jit_SpanBroadcast32(RegCache::Reg destReg, uint32_t value) {
+	X64Reg tempReg = regCache_.Alloc(RegCache::GEN_TEMP_HELPER);
+	MOV(32, R(tempReg), Imm32(value));
+	VMOVD(destReg, R(tempReg));
+	regCache_.Release(tempReg, RegCache::GEN_TEMP_HELPER);
+	VPBROADCASTD(256, destReg, R(destReg));
+}
+
+void PixelJitCache::Jit_SpanExpandColor() {
+	if (colorIs16Bit_)
+		return;
+
+	// This splits into pixels 0, 1 | 4, 5 in VEC_ARG_COLOR and 2, 3 | 6, 7 in VEC_COLOR_HI.
+	X64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	X64Reg zeroReg = regCache_.Find(RegCache::VEC_ZERO);
+	X64Reg colorHiReg = regCache_.Alloc(RegCache::VEC_COLOR_HI);
+	VPUNPCKHBW(256, colorHiReg, argColorReg, R(zeroReg));
+	VPUNPCKLBW(256, argColorReg, argColorReg, R(zeroReg));
+	regCache_.Unlock(colorHiReg, RegCache::VEC_COLOR_HI);
+	regCache_.ForceRetain(RegCache::VEC_COLOR_HI);
+	regCache_.Unlock(zeroReg, RegCache::VEC_ZERO);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+	colorIs16Bit_ = true;
+}
+
+void PixelJitCache::Jit_SpanPackColor() {
+	if (!colorIs16Bit_)
+		return;
+
+	// This also clamps, just like PACKUSWB in the single func.
+	X64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	X64Reg colorHiReg = regCache_.Find(RegCache::VEC_COLOR_HI);
+	VPACKUSWB(256, argColorReg, argColorReg, R(colorHiReg));
+	regCache_.Unlock(colorHiReg, RegCache::VEC_COLOR_HI);
+	regCache_.ForceRelease(RegCache::VEC_COLOR_HI);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+	colorIs16Bit_ = false;
+}
+
+bool PixelJitCache::Jit_SpanCompare(GEComparison func, RegCache::Reg valueReg, RegCache::Reg refReg) {
+	// Clear the mask for each lane where (value func ref) is false.  Values must fit in 31 bits.
+	X64Reg maskReg = regCache_.Find(RegCache::VEC_ARG_MASK);
+	X64Reg resultReg = regCache_.Alloc(RegCache::VEC_TEMP5);
+
+	switch (func) {
+	case GE_COMP_NEVER:
+		VPXOR(128, maskReg, maskReg, R(maskReg));
+		break;
+
+	case GE_COMP_ALWAYS:
+		break;
+
+	case GE_COMP_EQUAL:
+		VPCMPEQD(256, resultReg, valueReg, R(refReg));
+		VPAND(256, maskReg, maskReg, R(resultReg));
+		break;
+
+	case GE_COMP_NOTEQUAL:
+		VPCMPEQD(256, resultReg, valueReg, R(refReg));
+		VPANDN(256, maskReg, resultReg, R(maskReg));
+		break;
+
+	case GE_COMP_LESS:
+		VPCMPGTD(256, resultReg, refReg, R(valueReg));
+		VPAND(256, maskReg, maskReg, R(resultReg));
+		break;
+
+	case GE_COMP_LEQUAL:
+		VPCMPGTD(256, resultReg, valueReg, R(refReg));
+		VPANDN(256, maskReg, resultReg, R(maskReg));
+		break;
+
+	case GE_COMP_GREATER:
+		VPCMPGTD(256, resultReg, valueReg, R(refReg));
+		VPAND(256, maskReg, maskReg, R(resultReg));
+		break;
+
+	case GE_COMP_GEQUAL:
+		VPCMPGTD(256, resultReg, refReg, R(valueReg));
+		VPANDN(256, maskReg, resultReg, R(maskReg));
+		break;
+	}
+
+	regCache_.Release(resultReg, RegCache::VEC_TEMP5);
+	regCache_.Unlock(maskReg, RegCache::VEC_ARG_MASK);
+	return true;
+}
+
+bool PixelJitCache::Jit_SpanStore16(RegCache::Reg offReg, RegCache::Reg valueReg) {
+	// The 8 16-bit values are in the low 128 bits.  Spans are always inside the slice being drawn,
+	// so we can merge with the existing values for the pixels we're not drawing.
+	X64Reg maskReg = regCache_.Find(RegCache::VEC_ARG_MASK);
+	X64Reg mask16Reg = regCache_.Alloc(RegCache::VEC_TEMP5);
+	VPACKSSDW(256, mask16Reg, maskReg, R(maskReg));
+	VPERMQ(mask16Reg, R(mask16Reg), _MM_SHUFFLE(0, 0, 2, 0));
+	regCache_.Unlock(maskReg, RegCache::VEC_ARG_MASK);
+
+	VPAND(128, valueReg, valueReg, R(mask16Reg));
+	VPANDN(128, mask16Reg, mask16Reg, MatR(offReg));
+	VPOR(128, valueReg, valueReg, R(mask16Reg));
+	VMOVDQU(128, MatR(offReg), valueReg);
+	regCache_.Release(mask16Reg, RegCache::VEC_TEMP5);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_SpanDepthRange(const PixelFuncID &id) {
+	X64Reg zReg = regCache_.Find(RegCache::VEC_ARG_Z);
+	if (id.applyDepthRange) {
+		Describe("SpanDepthR");
+		X64Reg idReg = GetPixelID();
+		X64Reg maskReg = regCache_.Find(RegCache::VEC_ARG_MASK);
+		X64Reg tempReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+
+		// Like the single func, this compares all 32 bits of z.
+		VPBROADCASTD(256, tempReg, MDisp(idReg, offsetof(PixelFuncID, cached.minz)));
+		VPCMPGTD(256, tempReg, tempReg, R(zReg));
+		VPANDN(256, maskReg, tempReg, R(maskReg));
+
+		VPBROADCASTD(256, tempReg, MDisp(idReg, offsetof(PixelFuncID, cached.maxz)));
+		VPCMPGTD(256, tempReg, zReg, R(tempReg));
+		VPANDN(256, maskReg, tempReg, R(maskReg));
+
+		regCache_.Release(tempReg, RegCache::VEC_TEMP0);
+		regCache_.Unlock(maskReg, RegCache::VEC_ARG_MASK);
+		UnlockPixelID(idReg);
+	}
+
+	if (!id.depthWrite && id.DepthTestFunc() == GE_COMP_ALWAYS) {
+		regCache_.Unlock(zReg, RegCache::VEC_ARG_Z);
+		regCache_.ForceRelease(RegCache::VEC_ARG_Z);
+		return true;
+	}
+
+	// From here on, only the low 16 bits matter, so clear the rest.
+	X64Reg zeroReg = regCache_.Find(RegCache::VEC_ZERO);
+	VPBLENDW(256, zReg, zReg, R(zeroReg), 0xAA);
+	regCache_.Unlock(zeroReg, RegCache::VEC_ZERO);
+	regCache_.Unlock(zReg, RegCache::VEC_ARG_Z);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_SpanAlphaTest(const PixelFuncID &id) {
+	// Take care of ALWAYS/NEVER first.  ALWAYS is common, means disabled.
+	Describe("SpanAlphaTest");
+	switch (id.AlphaTestFunc()) {
+	case GE_COMP_NEVER:
+		Discard();
+		return true;
+
+	case GE_COMP_ALWAYS:
+		return true;
+
+	default:
+		break;
+	}
+
+	_assert_(!colorIs16Bit_);
+	X64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	X64Reg alphaReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+	VPSRLD(256, alphaReg, argColorReg, 24);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+
+	X64Reg refReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+	if (id.hasAlphaTestMask) {
+		X64Reg idReg = GetPixelID();
+		VPBROADCASTB(256, refReg, MDisp(idReg, offsetof(PixelFuncID, cached.alphaTestMask)));
+		UnlockPixelID(idReg);
+		VPAND(256, alphaReg, alphaReg, R(refReg));
+	}
+
+	// We hardcode the ref into this jit func.
+	Jit_SpanBroadcast32(refReg, id.alphaTestRef);
+	bool success = Jit_SpanCompare(id.AlphaTestFunc(), alphaReg, refReg);
+
+	regCache_.Release(alphaReg, RegCache::VEC_TEMP0);
+	regCache_.Release(refReg, RegCache::VEC_TEMP1);
+	return success;
+}
+
+bool PixelJitCache::Jit_SpanApplyFog(const PixelFuncID &id) {
+	if (!id.applyFog) {
+		// Fog is the last thing we need from the span.
+		regCache_.ForceRelease(RegCache::GEN_ARG_SPAN);
+		return true;
+	}
+
+	Describe("SpanApplyFog");
+	Jit_SpanExpandColor();
+
+	// Each 128-bit lane has two pixels at 16-bit, so we want the fog color twice.
+	X64Reg fogColorReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+	X64Reg idReg = GetPixelID();
+	VPBROADCASTD(256, fogColorReg, MDisp(idReg, offsetof(PixelFuncID, cached.fogColor)));
+	UnlockPixelID(idReg);
+	X64Reg zeroReg = regCache_.Find(RegCache::VEC_ZERO);
+	VPUNPCKLBW(256, fogColorReg, fogColorReg, R(zeroReg));
+	regCache_.Unlock(zeroReg, RegCache::VEC_ZERO);
+
+	// Grab all 8 fog values in each lane, we'll shuffle them into place for each half.
+	X64Reg fogReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+	X64Reg spanReg = regCache_.Find(RegCache::GEN_ARG_SPAN);
+	VPBROADCASTQ(256, fogReg, MDisp(spanReg, offsetof(PixelSpan, fog)));
+	regCache_.Unlock(spanReg, RegCache::GEN_ARG_SPAN);
+	regCache_.ForceRelease(RegCache::GEN_ARG_SPAN);
+
+	X64Reg fogMultReg = regCache_.Alloc(RegCache::VEC_TEMP2);
+	X64Reg invertReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+	X64Reg alphaReg = regCache_.Alloc(RegCache::VEC_TEMP4);
+	for (int half = 0; half < 2; ++half) {
+		RegCache::Purpose colorPurpose = half == 0 ? RegCache::VEC_ARG_COLOR : RegCache::VEC_COLOR_HI;
+		X64Reg colorReg = regCache_.Find(colorPurpose);
+		VPSHUFB(256, fogMultReg, fogReg, M(constSpanFogShuffle_ + half * 32));
+
+		// Save A so we can put it back, we don't "fog" A.
+		VMOVDQA(256, alphaReg, R(colorReg));
+
+		// Same math as the single func: multiply by fog, and fog color by the inverse, then sum.
+		VPMULLW(256, colorReg, colorReg, R(fogMultReg));
+		VMOVDQU(256, invertReg, M(constSpan255_16s_));
+		VPSUBUSW(256, invertReg, invertReg, R(fogMultReg));
+		VPMULLW(256, invertReg, invertReg, R(fogColorReg));
+		VPADDUSW(256, colorReg, colorReg, R(invertReg));
+
+		// Now divide by 255, using the multiply by 0x8081 and shift right by 16+7.
+		VPMULHUW(256, colorReg, colorReg, M(constSpanBy255i_));
+		VPSRLW(256, colorReg, colorReg, 7);
+
+		VPBLENDW(256, colorReg, colorReg, R(alphaReg), 0x88);
+		regCache_.Unlock(colorReg, colorPurpose);
+	}
+
+	regCache_.Release(fogColorReg, RegCache::VEC_TEMP0);
+	regCache_.Release(fogReg, RegCache::VEC_TEMP1);
+	regCache_.Release(fogMultReg, RegCache::VEC_TEMP2);
+	regCache_.Release(invertReg, RegCache::VEC_TEMP3);
+	regCache_.Release(alphaReg, RegCache::VEC_TEMP4);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_SpanColorTest(const PixelFuncID &id) {
+	if (!id.colorTest)
+		return true;
+
+	Describe("SpanColorTest");
+	// If it's expanded, we need to clamp anyway if it was fogged.
+	Jit_SpanPackColor();
+
+	X64Reg idReg = GetPixelID();
+	X64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+	X64Reg maskedReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+	X64Reg equalReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+	VPBROADCASTD(256, maskedReg, MDisp(idReg, offsetof(PixelFuncID, cached.colorTestMask)));
+	VPAND(256, maskedReg, maskedReg, R(argColorReg));
+	VPBROADCASTD(256, equalReg, MDisp(idReg, offsetof(PixelFuncID, cached.colorTestRef)));
+	VPCMPEQD(256, equalReg, equalReg, R(maskedReg));
+	regCache_.Release(maskedReg, RegCache::VEC_TEMP0);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+
+	// Now that we're setup, get the func and follow it.
+	X64Reg funcReg = regCache_.Alloc(RegCache::GEN_TEMP0);
+	MOVZX(32, 8, funcReg, MDisp(idReg, offsetof(PixelFuncID, cached.colorTestFunc)));
+	UnlockPixelID(idReg);
+
+	CMP(8, R(funcReg), Imm8(GE_COMP_ALWAYS));
+	// Discard for GE_COMP_NEVER...
+	Discard(CC_B);
+	FixupBranch skip = J_CC(CC_E);
+
+	CMP(8, R(funcReg), Imm8(GE_COMP_EQUAL));
+	FixupBranch doEqual = J_CC(CC_E);
+	regCache_.Release(funcReg, RegCache::GEN_TEMP0);
+
+	// The not equal path here... if they are equal, we drop the pixel.
+	X64Reg maskReg = regCache_.Find(RegCache::VEC_ARG_MASK);
+	VPANDN(256, maskReg, equalReg, R(maskReg));
+	FixupBranch skip2 = J();
+
+	SetJumpTarget(doEqual);
+	VPAND(256, maskReg, maskReg, R(equalReg));
+
+	SetJumpTarget(skip);
+	SetJumpTarget(skip2);
+	regCache_.Unlock(maskReg, RegCache::VEC_ARG_MASK);
+	regCache_.Release(equalReg, RegCache::VEC_TEMP1);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_SpanDepthTest(const PixelFuncID &id) {
+	if (id.DepthTestFunc() == GE_COMP_ALWAYS)
+		return true;
+
+	if (id.DepthTestFunc() == GE_COMP_NEVER) {
+		Discard();
+		// This should be uncommon, just keep going to have shared cleanup...
+	}
+
+	X64Reg depthOffReg = GetDepthOff(id);
+	Describe("SpanDepthTest");
+	X64Reg dstReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+	VPMOVZXWD(256, dstReg, MatR(depthOffReg));
+	regCache_.Unlock(depthOffReg, RegCache::GEN_DEPTH_OFF);
+
+	X64Reg zReg = regCache_.Find(RegCache::VEC_ARG_Z);
+	bool success = Jit_SpanCompare(id.DepthTestFunc(), zReg, dstReg);
+	regCache_.Unlock(zReg, RegCache::VEC_ARG_Z);
+	regCache_.Release(dstReg, RegCache::VEC_TEMP0);
+
+	// If we're not writing, we don't need Z anymore.  We'll free GEN_DEPTH_OFF in Jit_SpanWriteDepth().
+	if (!id.depthWrite)
+		regCache_.ForceRelease(RegCache::VEC_ARG_Z);
+
+	return success;
+}
+
+bool PixelJitCache::Jit_SpanWriteDepth(const PixelFuncID &id) {
+	bool success = true;
+	if (id.depthWrite) {
+		X64Reg depthOffReg = GetDepthOff(id);
+		Describe("SpanWriteDepth");
+		X64Reg zReg = regCache_.Find(RegCache::VEC_ARG_Z);
+		// We already cleared the high bits, so this just packs them into the low 128 bits.
+		VPACKUSDW(256, zReg, zReg, R(zReg));
+		VPERMQ(zReg, R(zReg), _MM_SHUFFLE(0, 0, 2, 0));
+		success = Jit_SpanStore16(depthOffReg, zReg);
+		regCache_.Unlock(depthOffReg, RegCache::GEN_DEPTH_OFF);
+		regCache_.Unlock(zReg, RegCache::VEC_ARG_Z);
+		regCache_.ForceRelease(RegCache::VEC_ARG_Z);
+	}
+
+	// We can free up this reg if we force locked it.
+	if (regCache_.Has(RegCache::GEN_DEPTH_OFF)) {
+		regCache_.ForceRelease(RegCache::GEN_DEPTH_OFF);
+	}
+
+	return success;
+}
+
+bool PixelJitCache::Jit_SpanAlphaBlend(const PixelFuncID &id) {
+	if (!id.alphaBlend)
+		return true;
+
+	// Check if we need to load and prep factors.
+	PixelBlendState blendState;
+	ComputePixelBlendState(blendState, id);
+
+	bool success = true;
+
+	// Step 1: Load and convert dest color to 8888.
+	X64Reg rawDstReg = GetSpanDest(id);
+	Describe("SpanAlphaBlend");
+	X64Reg dstReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+	VMOVDQA(256, dstReg, R(rawDstReg));
+	regCache_.Unlock(rawDstReg, RegCache::VEC_DST);
+	if (id.FBFormat() != GE_FORMAT_8888)
+		success = success && Jit_SpanConvertFrom16(id, dstReg);
+
+	// Step 2: Load and apply factors, a half at a time.
+	if (blendState.usesFactors) {
+		Jit_SpanExpandColor();
+
+		X64Reg dstHalfReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+		X64Reg srcFactorReg = regCache_.Alloc(RegCache::VEC_TEMP2);
+		X64Reg dstFactorReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+		X64Reg zeroReg = regCache_.Find(RegCache::VEC_ZERO);
+
+		// Skip multiplying by factors if we can.
+		bool multiplySrc = id.AlphaBlendSrc() != PixelBlendFactor::ZERO && id.AlphaBlendSrc() != PixelBlendFactor::ONE;
+		bool multiplyDst = id.AlphaBlendDst() != PixelBlendFactor::ZERO && id.AlphaBlendDst() != PixelBlendFactor::ONE;
+
+		X64Reg halfReg = INVALID_REG;
+		if (multiplySrc || multiplyDst) {
+			halfReg = regCache_.Alloc(RegCache::VEC_TEMP4);
+			VMOVDQU(256, halfReg, M(constSpanBlendHalf_11_4s_));
+		}
+
+		for (int half = 0; half < 2; ++half) {
+			RegCache::Purpose colorPurpose = half == 0 ? RegCache::VEC_ARG_COLOR : RegCache::VEC_COLOR_HI;
+			X64Reg colorReg = regCache_.Find(colorPurpose);
+			if (half == 0)
+				VPUNPCKLBW(256, dstHalfReg, dstReg, R(zeroReg));
+			else
+				VPUNPCKHBW(256, dstHalfReg, dstReg, R(zeroReg));
+
+			// Same as the single func: shift left by 4 so mulhi gives a free shift and room for the half bit.
+			if (multiplySrc || blendState.srcColorAsFactor)
+				VPSLLW(256, colorReg, colorReg, 4);
+			if (multiplyDst || blendState.dstColorAsFactor)
+				VPSLLW(256, dstHalfReg, dstHalfReg, 4);
+
+			if (id.AlphaBlendSrc() < PixelBlendFactor::ZERO)
+				success = success && Jit_SpanBlendFactor(id, srcFactorReg, colorReg, dstHalfReg, id.AlphaBlendSrc());
+			if (id.AlphaBlendDst() < PixelBlendFactor::ZERO)
+				success = success && Jit_SpanDstBlendFactor(id, srcFactorReg, dstFactorReg, colorReg, dstHalfReg);
+
+			if (multiplySrc) {
+				VPOR(256, srcFactorReg, srcFactorReg, R(halfReg));
+				VPOR(256, colorReg, colorReg, R(halfReg));
+				VPMULHUW(256, colorReg, colorReg, R(srcFactorReg));
+			} else if (id.AlphaBlendSrc() == PixelBlendFactor::ZERO) {
+				VPXOR(128, colorReg, colorReg, R(colorReg));
+			} else if (id.AlphaBlendSrc() == PixelBlendFactor::ONE) {
+				if (blendState.srcColorAsFactor)
+					VPSRLW(256, colorReg, colorReg, 4);
+			}
+
+			if (multiplyDst) {
+				VPOR(256, dstFactorReg, dstFactorReg, R(halfReg));
+				VPOR(256, dstHalfReg, dstHalfReg, R(halfReg));
+				VPMULHUW(256, dstHalfReg, dstHalfReg, R(dstFactorReg));
+			} else if (id.AlphaBlendDst() == PixelBlendFactor::ZERO) {
+				// No need to add or subtract zero, unless we're negating.
+				if (id.AlphaBlendEq() == GE_BLENDMODE_MUL_AND_SUBTRACT_REVERSE)
+					VPXOR(128, dstHalfReg, dstHalfReg, R(dstHalfReg));
+			} else if (id.AlphaBlendDst() == PixelBlendFactor::ONE) {
+				if (blendState.dstColorAsFactor)
+					VPSRLW(256, dstHalfReg, dstHalfReg, 4);
+			}
+
+			// Step 3: Apply equation.  As in the single func, we ignore what happens to alpha.
+			switch (id.AlphaBlendEq()) {
+			case GE_BLENDMODE_MUL_AND_ADD:
+				if (id.AlphaBlendDst() != PixelBlendFactor::ZERO)
+					VPADDUSW(256, colorReg, colorReg, R(dstHalfReg));
+				break;
+
+			case GE_BLENDMODE_MUL_AND_SUBTRACT:
+				if (id.AlphaBlendDst() != PixelBlendFactor::ZERO)
+					VPSUBUSW(256, colorReg, colorReg, R(dstHalfReg));
+				break;
+
+			case GE_BLENDMODE_MUL_AND_SUBTRACT_REVERSE:
+				VPSUBUSW(256, colorReg, dstHalfReg, R(colorReg));
+				break;
+
+			default:
+				_assert_(false);
+				break;
+			}
+
+			regCache_.Unlock(colorReg, colorPurpose);
+		}
+
+		regCache_.Unlock(zeroReg, RegCache::VEC_ZERO);
+		regCache_.Release(dstHalfReg, RegCache::VEC_TEMP1);
+		regCache_.Release(srcFactorReg, RegCache::VEC_TEMP2);
+		regCache_.Release(dstFactorReg, RegCache::VEC_TEMP3);
+		if (halfReg != INVALID_REG)
+			regCache_.Release(halfReg, RegCache::VEC_TEMP4);
+	} else {
+		// Shrink and clamp for our min/max/absdiff handling.
+		Jit_SpanPackColor();
+
+		X64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+		X64Reg tempReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+		switch (id.AlphaBlendEq()) {
+		case GE_BLENDMODE_MIN:
+			VPMINUB(256, argColorReg, argColorReg, R(dstReg));
+			break;
+
+		case GE_BLENDMODE_MAX:
+			VPMAXUB(256, argColorReg, argColorReg, R(dstReg));
+			break;
+
+		case GE_BLENDMODE_ABSDIFF:
+			// One of these will be zero, and the other is the result.
+			VPSUBUSB(256, tempReg, dstReg, R(argColorReg));
+			VPSUBUSB(256, argColorReg, argColorReg, R(dstReg));
+			VPOR(256, argColorReg, argColorReg, R(tempReg));
+			break;
+
+		default:
+			_assert_(false);
+			break;
+		}
+		regCache_.Release(tempReg, RegCache::VEC_TEMP1);
+		regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+	}
+
+	regCache_.Release(dstReg, RegCache::VEC_TEMP0);
+	return success;
+}
+
+bool PixelJitCache::Jit_SpanBlendFactor(const PixelFuncID &id, RegCache::Reg factorReg, RegCache::Reg colorReg, RegCache::Reg dstReg, PixelBlendFactor factor) {
+	X64Reg idReg = INVALID_REG;
+	X64Reg tempReg = INVALID_REG;
+
+	// Everything below expects an expanded 16-bit color.
+	_assert_(colorIs16Bit_);
+
+	// Load the invert constant first off, if needed.
+	switch (factor) {
+	case PixelBlendFactor::INVOTHERCOLOR:
+	case PixelBlendFactor::INVSRCALPHA:
+	case PixelBlendFactor::INVDSTALPHA:
+	case PixelBlendFactor::DOUBLEINVSRCALPHA:
+	case PixelBlendFactor::DOUBLEINVDSTALPHA:
+		VMOVDQU(256, factorReg, M(constSpanBlendInvert_11_4s_));
+		break;
+
+	default:
+		break;
+	}
+
+	// Each 64 bits is a pixel, so we broadcast alpha within each using both shuffles.
+	switch (factor) {
+	case PixelBlendFactor::OTHERCOLOR:
+		VMOVDQA(256, factorReg, R(dstReg));
+		break;
+
+	case PixelBlendFactor::INVOTHERCOLOR:
+		VPSUBUSW(256, factorReg, factorReg, R(dstReg));
+		break;
+
+	case PixelBlendFactor::SRCALPHA:
+		VPSHUFLW(256, factorReg, R(colorReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSHUFHW(256, factorReg, R(factorReg), _MM_SHUFFLE(3, 3, 3, 3));
+		break;
+
+	case PixelBlendFactor::INVSRCALPHA:
+		tempReg = regCache_.Alloc(RegCache::VEC_TEMP5);
+
+		VPSHUFLW(256, tempReg, R(colorReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSHUFHW(256, tempReg, R(tempReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSUBUSW(256, factorReg, factorReg, R(tempReg));
+		break;
+
+	case PixelBlendFactor::DSTALPHA:
+		VPSHUFLW(256, factorReg, R(dstReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSHUFHW(256, factorReg, R(factorReg), _MM_SHUFFLE(3, 3, 3, 3));
+		break;
+
+	case PixelBlendFactor::INVDSTALPHA:
+		tempReg = regCache_.Alloc(RegCache::VEC_TEMP5);
+
+		VPSHUFLW(256, tempReg, R(dstReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSHUFHW(256, tempReg, R(tempReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSUBUSW(256, factorReg, factorReg, R(tempReg));
+		break;
+
+	case PixelBlendFactor::DOUBLESRCALPHA:
+		VPSHUFLW(256, factorReg, R(colorReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSHUFHW(256, factorReg, R(factorReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSLLW(256, factorReg, factorReg, 1);
+		break;
+
+	case PixelBlendFactor::DOUBLEINVSRCALPHA:
+		tempReg = regCache_.Alloc(RegCache::VEC_TEMP5);
+
+		VPSHUFLW(256, tempReg, R(colorReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSHUFHW(256, tempReg, R(tempReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSLLW(256, tempReg, tempReg, 1);
+		VPSUBUSW(256, factorReg, factorReg, R(tempReg));
+		break;
+
+	case PixelBlendFactor::DOUBLEDSTALPHA:
+		VPSHUFLW(256, factorReg, R(dstReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSHUFHW(256, factorReg, R(factorReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSLLW(256, factorReg, factorReg, 1);
+		break;
+
+	case PixelBlendFactor::DOUBLEINVDSTALPHA:
+		tempReg = regCache_.Alloc(RegCache::VEC_TEMP5);
+
+		VPSHUFLW(256, tempReg, R(dstReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSHUFHW(256, tempReg, R(tempReg), _MM_SHUFFLE(3, 3, 3, 3));
+		VPSLLW(256, tempReg, tempReg, 1);
+		VPSUBUSW(256, factorReg, factorReg, R(tempReg));
+		break;
+
+	case PixelBlendFactor::ZERO:
+		// Special value meaning zero.
+		VPXOR(128, factorReg, factorReg, R(factorReg));
+		break;
+
+	case PixelBlendFactor::ONE:
+		// Special value meaning all 255s.
+		VPCMPEQD(256, factorReg, factorReg, R(factorReg));
+		VPSLLW(256, factorReg, factorReg, 8);
+		VPSRLW(256, factorReg, factorReg, 4);
+		break;
+
+	case PixelBlendFactor::FIX:
+	default:
+		idReg = GetPixelID();
+		tempReg = regCache_.Find(RegCache::VEC_ZERO);
+		VPBROADCASTD(256, factorReg, MDisp(idReg, offsetof(PixelFuncID, cached.alphaBlendSrc)));
+		VPUNPCKLBW(256, factorReg, factorReg, R(tempReg));
+		regCache_.Unlock(tempReg, RegCache::VEC_ZERO);
+		// Round it out by shifting into place.
+		VPSLLW(256, factorReg, factorReg, 4);
+		break;
+	}
+
+	if (idReg != INVALID_REG)
+		UnlockPixelID(idReg);
+	if (tempReg != INVALID_REG)
+		regCache_.Release(tempReg, RegCache::VEC_TEMP5);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_SpanDstBlendFactor(const PixelFuncID &id, RegCache::Reg srcFactorReg, RegCache::Reg dstFactorReg, RegCache::Reg colorReg, RegCache::Reg dstReg) {
+	bool success = true;
+	X64Reg idReg = INVALID_REG;
+	X64Reg zeroReg = INVALID_REG;
+
+	// Everything below expects an expanded 16-bit color.
+	_assert_(colorIs16Bit_);
+
+	PixelBlendState blendState;
+	ComputePixelBlendState(blendState, id);
+
+	// We might be able to reuse srcFactorReg for dst, in some cases.
+	switch (id.AlphaBlendDst()) {
+	case PixelBlendFactor::OTHERCOLOR:
+		VMOVDQA(256, dstFactorReg, R(colorReg));
+		break;
+
+	case PixelBlendFactor::INVOTHERCOLOR:
+		VMOVDQU(256, dstFactorReg, M(constSpanBlendInvert_11_4s_));
+		VPSUBUSW(256, dstFactorReg, dstFactorReg, R(colorReg));
+		break;
+
+	case PixelBlendFactor::SRCALPHA:
+	case PixelBlendFactor::INVSRCALPHA:
+	case PixelBlendFactor::DSTALPHA:
+	case PixelBlendFactor::INVDSTALPHA:
+	case PixelBlendFactor::DOUBLESRCALPHA:
+	case PixelBlendFactor::DOUBLEINVSRCALPHA:
+	case PixelBlendFactor::DOUBLEDSTALPHA:
+	case PixelBlendFactor::DOUBLEINVDSTALPHA:
+	case PixelBlendFactor::ZERO:
+	case PixelBlendFactor::ONE:
+		// These are all equivalent for src factor, so reuse that logic.
+		if (id.AlphaBlendSrc() == id.AlphaBlendDst()) {
+			VMOVDQA(256, dstFactorReg, R(srcFactorReg));
+		} else if (blendState.dstFactorIsInverse) {
+			VMOVDQU(256, dstFactorReg, M(constSpanBlendInvert_11_4s_));
+			VPSUBUSW(256, dstFactorReg, dstFactorReg, R(srcFactorReg));
+		} else {
+			success = success && Jit_SpanBlendFactor(id, dstFactorReg, colorReg, dstReg, id.AlphaBlendDst());
+		}
+		break;
+
+	case PixelBlendFactor::FIX:
+	default:
+		idReg = GetPixelID();
+		zeroReg = regCache_.Find(RegCache::VEC_ZERO);
+		VPBROADCASTD(256, dstFactorReg, MDisp(idReg, offsetof(PixelFuncID, cached.alphaBlendDst)));
+		VPUNPCKLBW(256, dstFactorReg, dstFactorReg, R(zeroReg));
+		regCache_.Unlock(zeroReg, RegCache::VEC_ZERO);
+		// Round it out by shifting into place.
+		VPSLLW(256, dstFactorReg, dstFactorReg, 4);
+		break;
+	}
+
+	if (idReg != INVALID_REG)
+		UnlockPixelID(idReg);
+
+	return success;
+}
+
+bool PixelJitCache::Jit_SpanDither(const PixelFuncID &id) {
+	if (!id.dithering)
+		return true;
+
+	Describe("SpanDither");
+	X64Reg valueReg = regCache_.Alloc(RegCache::GEN_TEMP0);
+
+	// Load the row of the dither matrix, we'll shuffle out each x.
+	X64Reg argYReg = regCache_.Find(RegCache::GEN_ARG_Y);
+	MOV(32, R(valueReg), R(argYReg));
+	AND(32, R(valueReg), Imm8(3));
+
+	// At this point, we're done with depth and y, so let's grab GEN_COLOR_OFF and retain it.
+	X64Reg colorOffReg = GetColorOff(id);
+	Describe("SpanDither");
+	regCache_.Unlock(colorOffReg, RegCache::GEN_COLOR_OFF);
+	regCache_.ForceRetain(RegCache::GEN_COLOR_OFF);
+	regCache_.Unlock(argYReg, RegCache::GEN_ARG_Y);
+	regCache_.ForceRelease(RegCache::GEN_ARG_Y);
+
+	X64Reg ditherReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+	X64Reg idReg = GetPixelID();
+	VPBROADCASTD(128, ditherReg, MComplex(idReg, valueReg, 4, offsetof(PixelFuncID, cached.ditherMatrix)));
+	UnlockPixelID(idReg);
+	regCache_.Release(valueReg, RegCache::GEN_TEMP0);
+
+	// Since the row repeats every 4 bytes, (x & 3) + i picks the value for pixel i.
+	X64Reg indexReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+	X64Reg argXReg = regCache_.Find(RegCache::GEN_ARG_X);
+	AND(32, R(argXReg), Imm8(3));
+	VMOVD(indexReg, R(argXReg));
+	regCache_.Unlock(argXReg, RegCache::GEN_ARG_X);
+	regCache_.ForceRelease(RegCache::GEN_ARG_X);
+	VPBROADCASTB(128, indexReg, R(indexReg));
+	VPADDB(128, indexReg, indexReg, M(constSpanDitherShuffle_));
+	VPSHUFB(128, ditherReg, ditherReg, R(indexReg));
+
+	// Now widen to signed 16-bit (we want a saturating signed add), and copy to both lanes.
+	VPMOVSXBW(128, ditherReg, R(ditherReg));
+	VPERMQ(ditherReg, R(ditherReg), _MM_SHUFFLE(1, 0, 1, 0));
+
+	Jit_SpanExpandColor();
+	for (int half = 0; half < 2; ++half) {
+		RegCache::Purpose colorPurpose = half == 0 ? RegCache::VEC_ARG_COLOR : RegCache::VEC_COLOR_HI;
+		X64Reg colorReg = regCache_.Find(colorPurpose);
+		// This puts each pixel's value in RGB, keeping A at zero.
+		VPSHUFB(256, indexReg, ditherReg, M(constSpanDitherShuffle_ + 16 + half * 32));
+		VPADDSW(256, colorReg, colorReg, R(indexReg));
+		regCache_.Unlock(colorReg, colorPurpose);
+	}
+
+	regCache_.Release(ditherReg, RegCache::VEC_TEMP0);
+	regCache_.Release(indexReg, RegCache::VEC_TEMP1);
+
+	return true;
+}
+
+bool PixelJitCache::Jit_SpanWriteColor(const PixelFuncID &id) {
+	X64Reg colorOffReg = GetColorOff(id);
+	Describe("SpanWriteColor");
+	if (regCache_.Has(RegCache::GEN_ARG_X)) {
+		// We normally toss x and y during dithering or useStandardStride with no dithering.
+		// Free up the regs now to get more reg space.
+		regCache_.ForceRelease(RegCache::GEN_ARG_X);
+		regCache_.ForceRelease(RegCache::GEN_ARG_Y);
+
+		// But make sure we don't lose GEN_COLOR_OFF, we'll be lost without that now.
+		regCache_.ForceRetain(RegCache::GEN_COLOR_OFF);
+	}
+
+	// Convert back to 8888 and clamp.
+	Jit_SpanPackColor();
+
+	bool success = true;
+	X64Reg argColorReg = regCache_.Find(RegCache::VEC_ARG_COLOR);
+
+	// Step 1: Convert to the framebuffer format.  Without stencil, we never write alpha bits.
+	uint32_t fixedKeepMask = 0x00000000;
+	switch (id.fbFormat) {
+	case GE_FORMAT_565:
+		success = success && Jit_SpanConvertTo16(id, argColorReg);
+		break;
+
+	case GE_FORMAT_5551:
+		success = success && Jit_SpanConvertTo16(id, argColorReg);
+		fixedKeepMask = 0x8000;
+		break;
+
+	case GE_FORMAT_4444:
+		success = success && Jit_SpanConvertTo16(id, argColorReg);
+		fixedKeepMask = 0xF000;
+		break;
+
+	case GE_FORMAT_8888:
+		fixedKeepMask = 0xFF000000;
+		break;
+	}
+
+	// Step 2: Keep the bits of the dest color from the write mask or alpha.
+	Describe("SpanWriteColor");
+	X64Reg keepReg = INVALID_REG;
+	if (id.applyColorWriteMask) {
+		// Load the pre-converted and combined write mask.
+		keepReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+		X64Reg idReg = GetPixelID();
+		VPBROADCASTD(256, keepReg, MDisp(idReg, offsetof(PixelFuncID, cached.colorWriteMask)));
+		UnlockPixelID(idReg);
+	} else if (fixedKeepMask != 0) {
+		keepReg = regCache_.Alloc(RegCache::VEC_TEMP0);
+		Jit_SpanBroadcast32(keepReg, fixedKeepMask);
+	}
+
+	if (keepReg != INVALID_REG) {
+		X64Reg dstReg = GetSpanDest(id);
+		X64Reg tempReg = regCache_.Alloc(RegCache::VEC_TEMP1);
+		VPAND(256, tempReg, dstReg, R(keepReg));
+		VPANDN(256, argColorReg, keepReg, R(argColorReg));
+		VPOR(256, argColorReg, argColorReg, R(tempReg));
+		regCache_.Release(tempReg, RegCache::VEC_TEMP1);
+		regCache_.Release(keepReg, RegCache::VEC_TEMP0);
+		regCache_.Unlock(dstReg, RegCache::VEC_DST);
+	}
+
+	// Step 3: Write only the pixels still in the mask.
+	if (id.FBFormat() == GE_FORMAT_8888) {
+		X64Reg maskReg = regCache_.Find(RegCache::VEC_ARG_MASK);
+		VPMASKMOVD(256, MatR(colorOffReg), argColorReg, maskReg);
+		regCache_.Unlock(maskReg, RegCache::VEC_ARG_MASK);
+	} else {
+		VPACKUSDW(256, argColorReg, argColorReg, R(argColorReg));
+		VPERMQ(argColorReg, R(argColorReg), _MM_SHUFFLE(0, 0, 2, 0));
+		success = success && Jit_SpanStore16(colorOffReg, argColorReg);
+	}
+
+	regCache_.Unlock(colorOffReg, RegCache::GEN_COLOR_OFF);
+	regCache_.ForceRelease(RegCache::GEN_COLOR_OFF);
+	regCache_.Unlock(argColorReg, RegCache::VEC_ARG_COLOR);
+	regCache_.ForceRelease(RegCache::VEC_ARG_COLOR);
+	if (regCache_.Has(RegCache::VEC_DST))
+		regCache_.ForceRelease(RegCache::VEC_DST);
+
+	return success;
+}
+
+bool PixelJitCache::Jit_SpanConvertTo16(const PixelFuncID &id, RegCache::Reg colorReg) {
+	// Each component is shifted down and masked, then all are combined.  Alpha is dropped.
+	struct Component {
+		uint8_t shift;
+		uint32_t mask;
+	};
+	static const Component to565[] = { { 3, 0x001F }, { 5, 0x07E0 }, { 8, 0xF800 } };
+	static const Component to5551[] = { { 3, 0x001F }, { 6, 0x03E0 }, { 9, 0x7C00 } };
+	static const Component to4444[] = { { 4, 0x000F }, { 8, 0x00F0 }, { 12, 0x0F00 } };
+
+	const Component *components = to565;
+	if (id.fbFormat == GE_FORMAT_5551)
+		components = to5551;
+	else if (id.fbFormat == GE_FORMAT_4444)
+		components = to4444;
+
+	Describe("SpanConvertTo16");
+	X64Reg resultReg = regCache_.Alloc(RegCache::VEC_TEMP2);
+	X64Reg tempReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+	X64Reg maskReg = regCache_.Alloc(RegCache::VEC_TEMP4);
+	for (int i = 0; i < 3; ++i) {
+		X64Reg partReg = i == 0 ? resultReg : tempReg;
+		VPSRLD(256, partReg, colorReg, components[i].shift);
+		Jit_SpanBroadcast32(maskReg, components[i].mask);
+		VPAND(256, partReg, partReg, R(maskReg));
+		if (i != 0)
+			VPOR(256, resultReg, resultReg, R(partReg));
+	}
+	VMOVDQA(256, colorReg, R(resultReg));
+
+	regCache_.Release(resultReg, RegCache::VEC_TEMP2);
+	regCache_.Release(tempReg, RegCache::VEC_TEMP3);
+	regCache_.Release(maskReg, RegCache::VEC_TEMP4);
+	return true;
+}
+
+bool PixelJitCache::Jit_SpanConvertFrom16(const PixelFuncID &id, RegCache::Reg colorReg) {
+	// First, mask each component and shift it to the top bits of its 8-bit lane.
+	struct Component {
+		uint8_t shift;
+		uint32_t mask;
+	};
+	static const Component from565[] = { { 3, 0x001F }, { 5, 0x07E0 }, { 8, 0xF800 } };
+	static const Component from5551[] = { { 3, 0x001F }, { 6, 0x03E0 }, { 9, 0x7C00 } };
+	static const Component from4444[] = { { 4, 0x000F }, { 8, 0x00F0 }, { 12, 0x0F00 }, { 16, 0xF000 } };
+
+	const Component *components = from565;
+	int count = 3;
+	if (id.fbFormat == GE_FORMAT_5551) {
+		components = from5551;
+	} else if (id.fbFormat == GE_FORMAT_4444) {
+		components = from4444;
+		count = 4;
+	}
+
+	Describe("SpanConvertFrom16");
+	X64Reg resultReg = regCache_.Alloc(RegCache::VEC_TEMP2);
+	X64Reg tempReg = regCache_.Alloc(RegCache::VEC_TEMP3);
+	X64Reg maskReg = regCache_.Alloc(RegCache::VEC_TEMP4);
+	for (int i = 0; i < count; ++i) {
+		X64Reg partReg = i == 0 ? resultReg : tempReg;
+		Jit_SpanBroadcast32(maskReg, components[i].mask);
+		VPAND(256, partReg, colorReg, R(maskReg));
+		VPSLLD(256, partReg, partReg, components[i].shift);
+		if (i != 0)
+			VPOR(256, resultReg, resultReg, R(partReg));
+	}
+
+	// Now fill in the low bits from the high bits, like Convert5To8() and friends.
+	switch (id.fbFormat) {
+	case GE_FORMAT_565:
+		VPSRLD(256, tempReg, resultReg, 5);
+		Jit_SpanBroadcast32(maskReg, 0x00070007);
+		VPAND(256, tempReg, tempReg, R(maskReg));
+		VPOR(256, tempReg, tempReg, R(resultReg));
+		// Green only has 6 bits, so it only needs its top 2.
+		VPSRLD(256, resultReg, resultReg, 6);
+		Jit_SpanBroadcast32(maskReg, 0x00000300);
+		VPAND(256, resultReg, resultReg, R(maskReg));
+		VPOR(256, resultReg, resultReg, R(tempReg));
+		break;
+
+	case GE_FORMAT_5551:
+		VPSRLD(256, tempReg, resultReg, 5);
+		Jit_SpanBroadcast32(maskReg, 0x00070707);
+		VPAND(256, tempReg, tempReg, R(maskReg));
+		VPOR(256, resultReg, resultReg, R(tempReg));
+		// Alpha is all or nothing, so spread the top bit of the 16 to all 8 bits of alpha.
+		VPSLLD(256, tempReg, colorReg, 16);
+		VPSRAD(256, tempReg, tempReg, 31);
+		VPSLLD(256, tempReg, tempReg, 24);
+		VPOR(256, resultReg, resultReg, R(tempReg));
+		break;
+
+	case GE_FORMAT_4444:
+		// Masking isn't necessary here since everything is 4 wide.
+		VPSRLD(256, tempReg, resultReg, 4);
+		VPOR(256, resultReg, resultReg, R(tempReg));
+		break;
+
+	case GE_FORMAT_8888:
+		break;
+	}
+	VMOVDQA(256, colorReg, R(resultReg));
+
+	regCache_.Release(resultReg, RegCache::VEC_TEMP2);
+	regCache_.Release(tempReg, RegCache::VEC_TEMP3);
+	regCache_.Release(maskReg, RegCache::VEC_TEMP4);
+	return true;
+}
+
 };
 
 #endif
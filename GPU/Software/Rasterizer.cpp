@@ -17,6 +17,7 @@
 
 #include "ppsspp_config.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
 #include "Common/Common.h"
@@ -101,9 +102,28 @@ static inline Vec4<float> Interpolate(const float &c0, const float &c1, const fl
 	return Interpolate(c0, c1, c2, w0.Cast<float>(), w1.Cast<float>(), w2.Cast<float>(), wsum_recip);
 }
 
+// Spans read and write several pixels at once, so they can't be used if color writes might hit depth.
+static bool ColorMayOverlapDepth(const PixelFuncID &pixelID) {
+	if (!pixelID.depthWrite && pixelID.DepthTestFunc() == GE_COMP_ALWAYS)
+		return false;
+
+	constexpr uint32_t mirrorMask = 0x0FFFFFFF & ~0x00600000;
+	const uint32_t bpp = pixelID.FBFormat() == GE_FORMAT_8888 ? 4 : 2;
+	const int x1 = gstate.getScissorX1();
+	const int y1 = gstate.getScissorY1();
+	const int x2 = gstate.getScissorX2();
+	const int y2 = gstate.getScissorY2();
+	const uint32_t colorStart = (gstate.getFrameBufAddress() & mirrorMask) + (y1 * gstate.FrameBufStride() + x1) * bpp;
+	const uint32_t colorEnd = (gstate.getFrameBufAddress() & mirrorMask) + (y2 * gstate.FrameBufStride() + x2 + 1) * bpp;
+	const uint32_t depthStart = (gstate.getDepthBufAddress() & mirrorMask) + (y1 * gstate.DepthBufStride() + x1) * 2;
+	const uint32_t depthEnd = (gstate.getDepthBufAddress() & mirrorMask) + (y2 * gstate.DepthBufStride() + x2 + 1) * 2;
+	return colorStart < depthEnd && colorEnd > depthStart;
+}
+
 void ComputeRasterizerState(RasterizerState *state) {
 	ComputePixelFuncID(&state->pixelID);
 	state->drawPixel = Rasterizer::GetSingleFunc(state->pixelID);
+	state->drawSpan = ColorMayOverlapDepth(state->pixelID) ? nullptr : Rasterizer::GetSpanFunc(state->pixelID);
 
 	state->enableTextures = gstate.isTextureMapEnabled() && !state->pixelID.clearMode;
 	if (state->enableTextures) {
@@ -679,6 +699,71 @@ static inline Vec4<float> EdgeRecip(const Vec4<int> &w0, const Vec4<int> &w1, co
 #endif
 }
 
+// Two rows of 8 pixels, collected from 4 quads.
+struct QuadSpans {
+	PixelSpan rows[2]{};
+	DrawingCoords p;
+	bool insideSlice = false;
+};
+
+// Adds quad (0-3) of the group, where each row of the quad is 2 pixels in a span.
+static inline void AddQuadToSpans(QuadSpans &spans, int quad, const Vec4<int> &mask, const Vec4<int> &z, const Vec4<int> &fog, const Vec4<int> colors[4]) {
+	const int j = quad * 2;
+#if defined(_M_SSE) && !PPSSPP_ARCH(X86)
+	// Lanes outside the mask are written too, they just don't get a mask bit.
+	const int drawn = ~_mm_movemask_ps(_mm_castsi128_ps(mask.ivec)) & 0xF;
+	_mm_storel_epi64((__m128i *)&spans.rows[0].z[j], z.ivec);
+	_mm_storel_epi64((__m128i *)&spans.rows[1].z[j], _mm_unpackhi_epi64(z.ivec, z.ivec));
+
+	// Same clamping as ToRGBA(), just all 4 at once.
+	const __m128i rgba = _mm_packus_epi16(_mm_packs_epi32(colors[0].ivec, colors[1].ivec), _mm_packs_epi32(colors[2].ivec, colors[3].ivec));
+	_mm_storel_epi64((__m128i *)&spans.rows[0].color[j], rgba);
+	_mm_storel_epi64((__m128i *)&spans.rows[1].color[j], _mm_unpackhi_epi64(rgba, rgba));
+
+	const __m128i fog16 = _mm_packs_epi32(fog.ivec, fog.ivec);
+	const uint32_t fog8 = _mm_cvtsi128_si32(_mm_packus_epi16(fog16, fog16));
+	spans.rows[0].fog[j] = (uint8_t)fog8;
+	spans.rows[0].fog[j + 1] = (uint8_t)(fog8 >> 8);
+	spans.rows[1].fog[j] = (uint8_t)(fog8 >> 16);
+	spans.rows[1].fog[j + 1] = (uint8_t)(fog8 >> 24);
+
+	spans.rows[0].mask |= (drawn & 3) << j;
+	spans.rows[1].mask |= (drawn >> 2) << j;
+#else
+	for (int i = 0; i < 4; ++i) {
+		if (mask[i] < 0)
+			continue;
+		PixelSpan &span = spans.rows[i / 2];
+		span.z[j + (i & 1)] = z[i];
+		span.fog[j + (i & 1)] = fog[i];
+		span.color[j + (i & 1)] = colors[i].ToRGBA();
+		span.mask |= 1 << (j + (i & 1));
+	}
+#endif
+}
+
+static inline void DrawQuadSpans(QuadSpans &spans, const RasterizerState &state) {
+	const DrawingCoords &p = spans.p;
+	for (int row = 0; row < 2; ++row) {
+		PixelSpan &span = spans.rows[row];
+		if (span.mask == 0)
+			continue;
+
+		// Spans may read and write (unchanged) pixels outside the mask, so they must all be ours.
+		if (spans.insideSlice && p.x + 7 <= 1023) {
+			state.drawSpan(p.x, p.y + row, span, state.pixelID);
+		} else {
+			for (int i = 0; i < 8; ++i) {
+				if ((span.mask & (1 << i)) == 0)
+					continue;
+				Vec4<int> color = Vec4<int>::FromRGBA(span.color[i]);
+				state.drawPixel((p.x + i) & 0x3FF, p.y + row, span.z[i], span.fog[i], ToVec4IntArg(color), state.pixelID);
+			}
+		}
+		span.mask = 0;
+	}
+}
+
 template <bool clearMode, bool useSSE4>
 void DrawTriangleSlice(
 	const VertexData& v0, const VertexData& v1, const VertexData& v2,
@@ -716,6 +801,14 @@ void DrawTriangleSlice(
 	std::string ztag = StringFromFormat("DisplayListTZ_%08x", state.listPC);
 #endif
 
+	// When we can, each row collects 4 quads at a time, and draws them as two 8 pixel spans.
+#if defined(SOFTGPU_MEMORY_TAGGING_DETAILED)
+	const bool useSpans = false;
+#else
+	const bool useSpans = !clearMode && state.drawSpan != nullptr;
+#endif
+	QuadSpans spans;
+
 	for (int64_t curY = minY; curY <= maxY; curY += SCREEN_SCALE_FACTOR * 2,
 										w0_base = e0.StepY(w0_base),
 										w1_base = e1.StepY(w1_base),
@@ -742,12 +835,18 @@ void DrawTriangleSlice(
 		Vec4<int> scissor_mask = Vec4<int>(0, rowMaxX - rowMinX - SCREEN_SCALE_FACTOR, scissorYPlus1, (rowMaxX - rowMinX - SCREEN_SCALE_FACTOR) | scissorYPlus1);
 		Vec4<int> scissor_step = Vec4<int>(0, -(SCREEN_SCALE_FACTOR * 2), 0, -(SCREEN_SCALE_FACTOR * 2));
 
+		int spanQuads = 0;
+
 		for (int64_t curX = rowMinX; curX <= rowMaxX; curX += SCREEN_SCALE_FACTOR * 2,
 			w0 = e0.StepX(w0),
 			w1 = e1.StepX(w1),
 			w2 = e2.StepX(w2),
 			scissor_mask = scissor_mask + scissor_step,
 			p.x = (p.x + 2) & 0x3FF) {
+			if (useSpans && spanQuads == 0) {
+				spans.p = p;
+				spans.insideSlice = curX + 7 * SCREEN_SCALE_FACTOR <= maxX;
+			}
 
 			// If p is on or inside all edges, render pixel
 			Vec4<int> mask = MakeMask(w0, w1, w2, bias0, bias1, bias2, scissor_mask);
@@ -826,27 +925,39 @@ void DrawTriangleSlice(
 				}
 
 				PROFILE_THIS_SCOPE("draw_tri_px");
-				DrawingCoords subp = p;
-				for (int i = 0; i < 4; ++i) {
-					if (mask[i] < 0) {
-						continue;
-					}
-					subp.x = p.x + (i & 1);
-					subp.y = p.y + (i / 2);
+				if (useSpans) {
+					AddQuadToSpans(spans, spanQuads, mask, z, fog, prim_color);
+				} else {
+					DrawingCoords subp = p;
+					for (int i = 0; i < 4; ++i) {
+						if (mask[i] < 0) {
+							continue;
+						}
+						subp.x = p.x + (i & 1);
+						subp.y = p.y + (i / 2);
 
-					state.drawPixel(subp.x, subp.y, z[i], fog[i], ToVec4IntArg(prim_color[i]), pixelID);
+						state.drawPixel(subp.x, subp.y, z[i], fog[i], ToVec4IntArg(prim_color[i]), pixelID);
 
 #if defined(SOFTGPU_MEMORY_TAGGING_DETAILED)
-					uint32_t row = gstate.getFrameBufAddress() + subp.y * pixelID.cached.framebufStride * bpp;
-					NotifyMemInfo(MemBlockFlags::WRITE, row + subp.x * bpp, bpp, tag.c_str(), tag.size());
-					if (pixelID.depthWrite) {
-						row = gstate.getDepthBufAddress() + subp.y * pixelID.cached.depthbufStride * 2;
-						NotifyMemInfo(MemBlockFlags::WRITE, row + subp.x * 2, 2, ztag.c_str(), ztag.size());
-					}
+						uint32_t row = gstate.getFrameBufAddress() + subp.y * pixelID.cached.framebufStride * bpp;
+						NotifyMemInfo(MemBlockFlags::WRITE, row + subp.x * bpp, bpp, tag.c_str(), tag.size());
+						if (pixelID.depthWrite) {
+							row = gstate.getDepthBufAddress() + subp.y * pixelID.cached.depthbufStride * 2;
+							NotifyMemInfo(MemBlockFlags::WRITE, row + subp.x * 2, 2, ztag.c_str(), ztag.size());
+						}
 #endif
+					}
 				}
 			}
+
+			if (useSpans && ++spanQuads == 4) {
+				DrawQuadSpans(spans, state);
+				spanQuads = 0;
+			}
 		}
+
+		if (useSpans && spanQuads != 0)
+			DrawQuadSpans(spans, state);
 	}
 
 #if !defined(SOFTGPU_MEMORY_TAGGING_DETAILED) && defined(SOFTGPU_MEMORY_TAGGING_BASIC)
@@ -864,6 +975,138 @@ void DrawTriangleSlice(
 #endif
 }
 
+// In screen coordinates, so 8x8 pixels.
+static constexpr int DEPTH_TILE_SIZE = 8 * SCREEN_SCALE_FACTOR;
+static constexpr int DEPTH_TILES_PER_ROW = 1024 / 8;
+// Only the first 512 rows, so framebuffers just past the depth buffer don't overlap.
+static constexpr int DEPTH_TILE_ROWS = 512 / 8;
+// The low 16 bits are the lowest depth in the tile, and the high 16 bits the highest.
+// These may be wider than the actual depth values, but never narrower.
+static constexpr uint32_t DEPTH_TILE_UNKNOWN = 0xFFFF0000;
+static constexpr uint32_t DEPTH_TILE_MIRROR_MASK = 0x0FFFFFFF & ~0x00600000;
+
+static std::atomic<uint32_t> depthTiles[DEPTH_TILES_PER_ROW * DEPTH_TILE_ROWS];
+static std::atomic<uint32_t> depthTilesAddr;
+static std::atomic<int> depthTilesStride;
+static std::atomic<bool> depthTilesEnabled;
+
+void SetDepthTilesTarget(uint32_t depthAddr, int depthStride) {
+	depthAddr &= DEPTH_TILE_MIRROR_MASK;
+	if (depthTilesEnabled && depthTilesAddr == depthAddr && depthTilesStride == depthStride)
+		return;
+
+	for (auto &tile : depthTiles)
+		tile.store(DEPTH_TILE_UNKNOWN, std::memory_order_relaxed);
+	depthTilesAddr = depthAddr;
+	depthTilesStride = depthStride;
+	depthTilesEnabled = depthStride != 0;
+}
+
+void DisableDepthTiles() {
+	depthTilesEnabled = false;
+}
+
+void InvalidateDepthTiles(uint32_t addr, int size) {
+	if (!depthTilesEnabled)
+		return;
+
+	int firstRow = 0;
+	int lastRow = DEPTH_TILE_ROWS * 8 - 1;
+	if (size >= 0) {
+		if (!Memory::IsVRAMAddress(addr))
+			return;
+		const int64_t rowBytes = depthTilesStride * 2;
+		const int64_t start = (int64_t)(addr & DEPTH_TILE_MIRROR_MASK) - (int64_t)depthTilesAddr;
+		const int64_t end = start + size;
+		if (end <= 0 || start >= rowBytes * (lastRow + 1))
+			return;
+
+		// Writes past the stride land in the next row, so whole rows is simplest.
+		firstRow = start < 0 ? 0 : (int)(start / rowBytes);
+		lastRow = std::min(lastRow, (int)((end - 1) / rowBytes));
+	}
+
+	for (int ty = firstRow / 8; ty <= lastRow / 8; ++ty) {
+		for (int tx = 0; tx < DEPTH_TILES_PER_ROW; ++tx)
+			depthTiles[ty * DEPTH_TILES_PER_ROW + tx].store(DEPTH_TILE_UNKNOWN, std::memory_order_relaxed);
+	}
+}
+
+void UpdateDepthTiles(const BinCoords &range, u16 minZ, u16 maxZ, bool exactClear, const RasterizerState &state) {
+	const PixelFuncID &pixelID = state.pixelID;
+	if (!depthTilesEnabled || !(pixelID.clearMode ? pixelID.DepthClear() : pixelID.depthWrite))
+		return;
+
+	// A pixel is only written after passing the test, so it can't move the tile range past what the test allows.
+	bool keepMin = false, keepMax = false;
+	if (!pixelID.clearMode) {
+		switch (pixelID.DepthTestFunc()) {
+		case GE_COMP_NEVER:
+		case GE_COMP_EQUAL:
+			return;
+		case GE_COMP_LESS:
+		case GE_COMP_LEQUAL:
+			keepMax = true;
+			break;
+		case GE_COMP_GREATER:
+		case GE_COMP_GEQUAL:
+			keepMin = true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	const int lastY = std::min(range.y2, DEPTH_TILE_ROWS * DEPTH_TILE_SIZE - 1);
+	for (int y = range.y1 & ~(DEPTH_TILE_SIZE - 1); y <= lastY; y += DEPTH_TILE_SIZE) {
+		const bool fullY = y >= range.y1 && y + DEPTH_TILE_SIZE - 1 <= range.y2;
+		for (int x = range.x1 & ~(DEPTH_TILE_SIZE - 1); x <= range.x2; x += DEPTH_TILE_SIZE) {
+			std::atomic<uint32_t> &tile = depthTiles[(y / DEPTH_TILE_SIZE) * DEPTH_TILES_PER_ROW + x / DEPTH_TILE_SIZE];
+			// A clear covering the entire tile tells us exactly what's in it.
+			if (exactClear && fullY && x >= range.x1 && x + DEPTH_TILE_SIZE - 1 <= range.x2) {
+				tile.store(minZ | (minZ << 16), std::memory_order_relaxed);
+				continue;
+			}
+
+			// Other bins may share this tile, so widen atomically.
+			uint32_t old = tile.load(std::memory_order_relaxed);
+			uint32_t wider;
+			do {
+				uint32_t tileMin = keepMin ? old & 0xFFFF : std::min(old & 0xFFFF, (uint32_t)minZ);
+				uint32_t tileMax = keepMax ? old >> 16 : std::max(old >> 16, (uint32_t)maxZ);
+				wider = tileMin | (tileMax << 16);
+			} while (wider != old && !tile.compare_exchange_weak(old, wider, std::memory_order_relaxed));
+		}
+	}
+}
+
+// Can every pixel drawn in this area fail the depth test, so nothing would be written?
+static bool DepthTilesReject(int x1, int y1, int x2, int y2, GEComparison func, int minZ, int maxZ) {
+	if (y2 >= DEPTH_TILE_ROWS * DEPTH_TILE_SIZE)
+		return false;
+	for (int y = y1 & ~(DEPTH_TILE_SIZE - 1); y <= y2; y += DEPTH_TILE_SIZE) {
+		for (int x = x1 & ~(DEPTH_TILE_SIZE - 1); x <= x2; x += DEPTH_TILE_SIZE) {
+			uint32_t tile = depthTiles[(y / DEPTH_TILE_SIZE) * DEPTH_TILES_PER_ROW + x / DEPTH_TILE_SIZE].load(std::memory_order_relaxed);
+			int tileMin = tile & 0xFFFF;
+			int tileMax = tile >> 16;
+
+			bool reject = false;
+			switch (func) {
+			case GE_COMP_NEVER: reject = true; break;
+			case GE_COMP_EQUAL: reject = maxZ < tileMin || minZ > tileMax; break;
+			case GE_COMP_LESS: reject = minZ >= tileMax; break;
+			case GE_COMP_LEQUAL: reject = minZ > tileMax; break;
+			case GE_COMP_GREATER: reject = maxZ <= tileMin; break;
+			case GE_COMP_GEQUAL: reject = maxZ < tileMin; break;
+			default: break;
+			}
+			if (!reject)
+				return false;
+		}
+	}
+	return true;
+}
+
 // Draws triangle, vertices specified in counter-clockwise direction
 void DrawTriangle(const VertexData &v0, const VertexData &v1, const VertexData &v2, const BinCoords &range, const RasterizerState &state) {
 	PROFILE_THIS_SCOPE("draw_tri");
@@ -872,7 +1115,51 @@ void DrawTriangle(const VertexData &v0, const VertexData &v1, const VertexData &
 		(state.pixelID.clearMode ? &DrawTriangleSlice<true, true> : &DrawTriangleSlice<false, true>) :
 		(state.pixelID.clearMode ? &DrawTriangleSlice<true, false> : &DrawTriangleSlice<false, false>);
 
-	drawSlice(v0, v1, v2, range.x1, range.y1, range.x2, range.y2, state);
+	// If failing the depth test would still change stencil, we have to run every pixel.
+	const PixelFuncID &pixelID = state.pixelID;
+	const GEComparison depthFunc = pixelID.DepthTestFunc();
+	if (!depthTilesEnabled || pixelID.clearMode || pixelID.stencilTest || depthFunc == GE_COMP_ALWAYS || depthFunc == GE_COMP_NOTEQUAL) {
+		drawSlice(v0, v1, v2, range.x1, range.y1, range.x2, range.y2, state);
+		return;
+	}
+
+	// Interpolation might round a bit past the vertex values.
+	const int minZ = std::min(std::min(v0.screenpos.z, v1.screenpos.z), v2.screenpos.z) - 1;
+	const int maxZ = std::max(std::max(v0.screenpos.z, v1.screenpos.z), v2.screenpos.z) + 1;
+
+	// Walk in 8x8 steps from the start of the range, to keep the same 2x2 pixel groups.
+	// These may straddle tiles, in which case all of them need to reject.
+	bool rejects[DEPTH_TILES_PER_ROW + 1];
+	int pendingY = range.y1;
+	for (int y = range.y1; y <= range.y2; y += DEPTH_TILE_SIZE) {
+		const int y2 = std::min(y + DEPTH_TILE_SIZE - 1, range.y2);
+		bool anyReject = false;
+		for (int x = range.x1, i = 0; x <= range.x2; x += DEPTH_TILE_SIZE, ++i) {
+			rejects[i] = DepthTilesReject(x, y, std::min(x + DEPTH_TILE_SIZE - 1, range.x2), y2, depthFunc, minZ, maxZ);
+			anyReject = anyReject || rejects[i];
+		}
+		if (!anyReject)
+			continue;
+
+		// Draw any rows above in one go, then the parts of this one we can't skip.
+		if (pendingY < y)
+			drawSlice(v0, v1, v2, range.x1, pendingY, range.x2, y - 1, state);
+		pendingY = y2 + 1;
+
+		int runX = range.x1;
+		for (int x = range.x1, i = 0; x <= range.x2; x += DEPTH_TILE_SIZE, ++i) {
+			if (!rejects[i])
+				continue;
+			if (runX < x)
+				drawSlice(v0, v1, v2, runX, y, x - 1, y2, state);
+			runX = x + DEPTH_TILE_SIZE;
+		}
+		if (runX <= range.x2)
+			drawSlice(v0, v1, v2, runX, y, range.x2, y2, state);
+	}
+
+	if (pendingY <= range.y2)
+		drawSlice(v0, v1, v2, range.x1, pendingY, range.x2, range.y2, state);
 }
 
 void DrawRectangle(const VertexData &v0, const VertexData &v1, const BinCoords &range, const RasterizerState &state) {
@@ -36,6 +36,8 @@ struct RasterizerState {
 	PixelFuncID pixelID;
 	SamplerID samplerID;
 	SingleFunc drawPixel;
+	// May be nullptr, in which case pixels are drawn one at a time.
+	SpanFunc drawSpan;
 	Sampler::LinearFunc linear;
 	Sampler::NearestFunc nearest;
 	uint32_t texaddr[8]{};
@@ -76,6 +78,16 @@ void DrawPoint(const VertexData &v0, const BinCoords &range, const RasterizerSta
 void DrawLine(const VertexData &v0, const VertexData &v1, const BinCoords &range, const RasterizerState &state);
 void ClearRectangle(const VertexData &v0, const VertexData &v1, const BinCoords &range, const RasterizerState &state);
 
+// Coarse depth range per 8x8 tile of the depth buffer, so hidden parts of triangles can be skipped.
+// Only call this when nothing is drawing, i.e. after a flush.
+void SetDepthTilesTarget(uint32_t depthAddr, int depthStride);
+// Until the next SetDepthTilesTarget(), e.g. when the framebuffer overlaps the depth buffer.
+void DisableDepthTiles();
+// For any depth buffer writes other than drawing.  A negative size means everything.
+void InvalidateDepthTiles(uint32_t addr, int size);
+// Call after drawing within range, with the lowest and highest depth it might have written.
+void UpdateDepthTiles(const BinCoords &range, u16 minZ, u16 maxZ, bool exactClear, const RasterizerState &state);
+
 bool GetCurrentTexture(GPUDebugBuffer &buffer, int level);
 
 // Shared functions with RasterizerRectangle.cpp
@@ -99,6 +99,202 @@ static inline bool AlphaTestIsNeedless(const PixelFuncID &pixelID) {
 	return false;
 }
 
+// Texels decoded at a time when drawing sprites by rows.
+static constexpr int SPRITE_ROW_CHUNK = 256;
+
+// How each texel of a sprite row ends up in the framebuffer.
+enum class SpriteRun {
+	SKIP,
+	COPY,
+	PIXEL,
+};
+
+struct SpriteRowState {
+	// Texels with zero alpha never change the framebuffer.
+	bool skipZeroAlpha;
+	// Only opaque and fully transparent texels can be copied or skipped.
+	bool blend;
+	// Replaces the texture alpha, if not using it.
+	int primAlpha;
+	const u32 *palette;
+};
+
+// Can we draw this sprite a row of texels at a time?  The result must exactly match the pixel func.
+static bool UseSpriteRows(const RasterizerState &state, bool isWhite, int ds) {
+	const PixelFuncID &pixelID = state.pixelID;
+	const SamplerID &samplerID = state.samplerID;
+	if (pixelID.stencilTest || pixelID.DepthTestFunc() != GE_COMP_ALWAYS || pixelID.applyDepthRange)
+		return false;
+	if (pixelID.applyLogicOp || pixelID.colorTest || pixelID.dithering || pixelID.applyColorWriteMask || pixelID.applyFog)
+		return false;
+	if (ds != 1 || samplerID.useColorDoubling)
+		return false;
+	if (samplerID.TexFunc() != GE_TEXFUNC_REPLACE && (samplerID.TexFunc() != GE_TEXFUNC_MODULATE || !isWhite))
+		return false;
+
+	switch (pixelID.AlphaTestFunc()) {
+	case GE_COMP_ALWAYS:
+		break;
+	case GE_COMP_GREATER:
+	case GE_COMP_NOTEQUAL:
+		if (pixelID.alphaTestRef != 0 || pixelID.hasAlphaTestMask)
+			return false;
+		break;
+	default:
+		return false;
+	}
+
+	// The common "over" blend is exact for opaque and transparent texels, so only edges need the pixel func.
+	if (pixelID.alphaBlend) {
+		if (pixelID.AlphaBlendEq() != GE_BLENDMODE_MUL_AND_ADD)
+			return false;
+		if (pixelID.AlphaBlendSrc() != PixelBlendFactor::SRCALPHA || pixelID.AlphaBlendDst() != PixelBlendFactor::INVSRCALPHA)
+			return false;
+	}
+	return true;
+}
+
+static inline SpriteRun ClassifySpriteTexel(u32 c, const SpriteRowState &rowState) {
+	const u32 a = c >> 24;
+	if (a == 0 && rowState.skipZeroAlpha)
+		return SpriteRun::SKIP;
+	if (rowState.blend && a != 255)
+		return SpriteRun::PIXEL;
+	return SpriteRun::COPY;
+}
+
+// Decodes count texels at s, t as RGBA8888 with the texture function applied, which is only a copy here.
+static void DecodeSpriteRow(u32 *dest, int s, int t, int count, const RasterizerState &state, Sampler::FetchFunc fetchFunc, const SpriteRowState &rowState) {
+	const SamplerID &samplerID = state.samplerID;
+	const u8 *texptr = state.texptr[0];
+	const int texbufw = state.texbufw[0];
+
+	bool decoded = false;
+	if (!samplerID.swizzle && texptr) {
+		switch (samplerID.TexFmt()) {
+		case GE_TFMT_8888:
+			memcpy(dest, texptr + (t * texbufw + s) * 4, count * 4);
+			decoded = true;
+			break;
+
+		case GE_TFMT_5551:
+			ConvertRGBA5551ToRGBA8888(dest, (const u16 *)(texptr + (t * texbufw + s) * 2), count);
+			decoded = true;
+			break;
+
+		case GE_TFMT_CLUT8:
+			if (rowState.palette) {
+				const u8 *src = texptr + t * texbufw + s;
+				for (int i = 0; i < count; ++i)
+					dest[i] = rowState.palette[src[i]];
+				decoded = true;
+			}
+			break;
+
+		case GE_TFMT_CLUT4:
+			if (rowState.palette) {
+				const u8 *src = texptr + (t * texbufw + s) / 2;
+				int i = 0;
+				if (s & 1)
+					dest[i++] = rowState.palette[*src++ >> 4];
+				for (; i + 1 < count; i += 2) {
+					dest[i] = rowState.palette[*src & 0xF];
+					dest[i + 1] = rowState.palette[*src++ >> 4];
+				}
+				if (i < count)
+					dest[i] = rowState.palette[*src & 0xF];
+				decoded = true;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (!decoded) {
+		for (int i = 0; i < count; ++i)
+			dest[i] = Vec4<int>(fetchFunc(s + i, t, texptr, texbufw, 0, samplerID)).ToRGBA();
+	}
+
+	if (!samplerID.useTextureAlpha) {
+		const u32 alpha = rowState.primAlpha << 24;
+		for (int i = 0; i < count; ++i)
+			dest[i] = (dest[i] & 0x00FFFFFF) | alpha;
+	}
+}
+
+// Writes colors to the framebuffer, keeping the stencil bits already there like the pixel func would.
+static void WriteSpriteRun(int x, int y, int z, const u32 *colors, int count, const PixelFuncID &pixelID) {
+	const int stride = pixelID.cached.framebufStride;
+	int i = 0;
+	switch (pixelID.FBFormat()) {
+	case GE_FORMAT_8888:
+	{
+		u32 *dest = fb.Get32Ptr(x, y, stride);
+#if defined(_M_SSE)
+		const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+		for (; i + 4 <= count; i += 4) {
+			const __m128i c = _mm_and_si128(_mm_loadu_si128((const __m128i *)&colors[i]), colorMask);
+			const __m128i old = _mm_andnot_si128(colorMask, _mm_loadu_si128((const __m128i *)&dest[i]));
+			_mm_storeu_si128((__m128i *)&dest[i], _mm_or_si128(c, old));
+		}
+#endif
+		for (; i < count; ++i)
+			dest[i] = (colors[i] & 0x00FFFFFF) | (dest[i] & 0xFF000000);
+		break;
+	}
+
+	case GE_FORMAT_5551:
+	{
+		u16 *dest = fb.Get16Ptr(x, y, stride);
+#if defined(_M_SSE)
+		const __m128i mask5 = _mm_set1_epi32(0x1F);
+		const __m128i stencilMask = _mm_set1_epi16((short)0x8000);
+		auto to555 = [&](__m128i c) {
+			__m128i r = _mm_and_si128(_mm_srli_epi32(c, 3), mask5);
+			__m128i g = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(c, 11), mask5), 5);
+			__m128i b = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(c, 19), mask5), 10);
+			return _mm_or_si128(_mm_or_si128(r, g), b);
+		};
+		for (; i + 8 <= count; i += 8) {
+			// These never use the top bit, so a signed pack is fine.
+			const __m128i c = _mm_packs_epi32(to555(_mm_loadu_si128((const __m128i *)&colors[i])), to555(_mm_loadu_si128((const __m128i *)&colors[i + 4])));
+			const __m128i old = _mm_and_si128(_mm_loadu_si128((const __m128i *)&dest[i]), stencilMask);
+			_mm_storeu_si128((__m128i *)&dest[i], _mm_or_si128(c, old));
+		}
+#endif
+		for (; i < count; ++i)
+			dest[i] = (RGBA8888ToRGBA5551(colors[i]) & 0x7FFF) | (dest[i] & 0x8000);
+		break;
+	}
+
+	case GE_FORMAT_4444:
+	{
+		u16 *dest = fb.Get16Ptr(x, y, stride);
+		for (; i < count; ++i)
+			dest[i] = (RGBA8888ToRGBA4444(colors[i]) & 0x0FFF) | (dest[i] & 0xF000);
+		break;
+	}
+
+	case GE_FORMAT_565:
+	{
+		u16 *dest = fb.Get16Ptr(x, y, stride);
+		for (; i < count; ++i)
+			dest[i] = RGBA8888ToRGB565(colors[i]);
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	if (pixelID.depthWrite) {
+		u16 *depth = depthbuf.Get16Ptr(x, y, pixelID.cached.depthbufStride);
+		std::fill(depth, depth + count, (u16)z);
+	}
+}
+
 void DrawSprite(const VertexData &v0, const VertexData &v1, const BinCoords &range, const RasterizerState &state) {
 	const u8 *texptr = state.texptr[0];
 
@@ -148,8 +344,51 @@ void DrawSprite(const VertexData &v0, const VertexData &v1, const BinCoords &ran
 			pos0.y = scissorTL.y;
 		}
 
-		if (!pixelID.stencilTest &&
+		if (UseSpriteRows(state, isWhite, ds)) {
+			SpriteRowState rowState;
+			// Blending with zero alpha keeps the color, but depth would still be written.
+			rowState.skipZeroAlpha = pixelID.AlphaTestFunc() != GE_COMP_ALWAYS || (pixelID.alphaBlend && !pixelID.depthWrite);
+			rowState.blend = pixelID.alphaBlend;
+			rowState.primAlpha = v1.color0.a();
+			rowState.palette = nullptr;
+
+			// Decoding the palette up front only pays off with enough texels.
+			alignas(16) u32 palette[256];
+			const int paletteSize = texfmt == GE_TFMT_CLUT8 ? 256 : 16;
+			if ((texfmt == GE_TFMT_CLUT8 || texfmt == GE_TFMT_CLUT4) && (pos1.x - pos0.x) * (pos1.y - pos0.y) >= paletteSize) {
+				Sampler::DecodeClut(palette, paletteSize, samplerID);
+				rowState.palette = palette;
+			}
+
+			alignas(16) u32 row[SPRITE_ROW_CHUNK];
+			int t = t_start;
+			for (int y = pos0.y; y < pos1.y; y++) {
+				for (int x = pos0.x; x < pos1.x; x += SPRITE_ROW_CHUNK) {
+					const int count = std::min(SPRITE_ROW_CHUNK, pos1.x - x);
+					DecodeSpriteRow(row, s_start + x - pos0.x, t, count, state, fetchFunc, rowState);
+
+					// Find runs of texels we can copy or skip, and use the pixel func for the rest.
+					int i = 0;
+					while (i < count) {
+						const SpriteRun run = ClassifySpriteTexel(row[i], rowState);
+						int end = i + 1;
+						while (end < count && ClassifySpriteTexel(row[end], rowState) == run)
+							end++;
+
+						if (run == SpriteRun::COPY) {
+							WriteSpriteRun(x + i, y, z, row + i, end - i, pixelID);
+						} else if (run == SpriteRun::PIXEL) {
+							for (int j = i; j < end; ++j)
+								state.drawPixel(x + j, y, z, 255, ToVec4IntArg(Vec4<int>::FromRGBA(row[j])), pixelID);
+						}
+						i = end;
+					}
+				}
+				t += dt;
+			}
+		} else if (!pixelID.stencilTest &&
 			pixelID.DepthTestFunc() == GE_COMP_ALWAYS &&
+			!pixelID.depthWrite &&
 			!pixelID.applyLogicOp &&
 			!pixelID.colorTest &&
 			!pixelID.dithering &&
@@ -220,6 +459,7 @@ void DrawSprite(const VertexData &v0, const VertexData &v1, const BinCoords &ran
 		if (pos0.y < scissorTL.y) pos0.y = scissorTL.y;
 		if (!pixelID.stencilTest &&
 			pixelID.DepthTestFunc() == GE_COMP_ALWAYS &&
+			!pixelID.depthWrite &&
 			!pixelID.applyLogicOp &&
 			!pixelID.colorTest &&
 			!pixelID.dithering &&
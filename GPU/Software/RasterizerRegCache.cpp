@@ -590,6 +590,16 @@ void CodeBlock::WriteSimpleConst4x32(const u8 *&ptr, uint32_t value) {
 		WriteDynamicConst4x32(ptr, value);
 }
 
+void CodeBlock::WriteSimpleConst16x16(const u8 *&ptr, uint16_t value) {
+	if (ptr == nullptr)
+		WriteDynamicConst16x16(ptr, value);
+}
+
+void CodeBlock::WriteSimpleConst8x32(const u8 *&ptr, uint32_t value) {
+	if (ptr == nullptr)
+		WriteDynamicConst8x32(ptr, value);
+}
+
 void CodeBlock::WriteDynamicConst16x8(const u8 *&ptr, uint8_t value) {
 #if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
 	ptr = AlignCode16();
@@ -620,4 +630,24 @@ void CodeBlock::WriteDynamicConst4x32(const u8 *&ptr, uint32_t value) {
 #endif
 }
 
+void CodeBlock::WriteDynamicConst16x16(const u8 *&ptr, uint16_t value) {
+#if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+	ptr = AlignCode16();
+	for (int i = 0; i < 16; ++i)
+		Write16(value);
+#else
+	_assert_msg_(false, "Not yet implemented");
+#endif
+}
+
+void CodeBlock::WriteDynamicConst8x32(const u8 *&ptr, uint32_t value) {
+#if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+	ptr = AlignCode16();
+	for (int i = 0; i < 8; ++i)
+		Write32(value);
+#else
+	_assert_msg_(false, "Not yet implemented");
+#endif
+}
+
 };
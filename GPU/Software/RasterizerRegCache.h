@@ -108,6 +108,8 @@ struct RegCache {
 		VEC_V1 = 0x0004,
 		VEC_INDEX = 0x0005,
 		VEC_INDEX1 = 0x0006,
+		VEC_COLOR_HI = 0x0007,
+		VEC_DST = 0x0008,
 
 		GEN_SRC_ALPHA = 0x0100,
 		GEN_ID = 0x0101,
@@ -130,6 +132,7 @@ struct RegCache {
 		GEN_ARG_TEXPTR_PTR = 0x018A,
 		GEN_ARG_BUFW_PTR = 0x018B,
 		GEN_ARG_LEVELFRAC = 0x018C,
+		GEN_ARG_SPAN = 0x018D,
 		VEC_ARG_COLOR = 0x0080,
 		VEC_ARG_MASK = 0x0081,
 		VEC_ARG_U = 0x0082,
@@ -137,6 +140,7 @@ struct RegCache {
 		VEC_ARG_S = 0x0084,
 		VEC_ARG_T = 0x0085,
 		VEC_FRAC = 0x0086,
+		VEC_ARG_Z = 0x0087,
 
 		VEC_TEMP0 = 0x1000,
 		VEC_TEMP1 = 0x1001,
@@ -238,9 +242,14 @@ class CodeBlock : public BaseCodeBlock {
 	void WriteSimpleConst16x8(const u8 *&ptr, uint8_t value);
 	void WriteSimpleConst8x16(const u8 *&ptr, uint16_t value);
 	void WriteSimpleConst4x32(const u8 *&ptr, uint32_t value);
+	// These are 256-bit, for AVX2.
+	void WriteSimpleConst16x16(const u8 *&ptr, uint16_t value);
+	void WriteSimpleConst8x32(const u8 *&ptr, uint32_t value);
 	void WriteDynamicConst16x8(const u8 *&ptr, uint8_t value);
 	void WriteDynamicConst8x16(const u8 *&ptr, uint16_t value);
 	void WriteDynamicConst4x32(const u8 *&ptr, uint32_t value);
+	void WriteDynamicConst16x16(const u8 *&ptr, uint16_t value);
+	void WriteDynamicConst8x32(const u8 *&ptr, uint32_t value);
 
 #if PPSSPP_ARCH(ARM64_NEON)
 	Arm64Gen::ARM64FloatEmitter fp;
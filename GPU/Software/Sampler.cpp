@@ -272,6 +272,11 @@ uint32_t TransformClutIndex(uint32_t index, const SamplerID &samplerID) {
 	return index & 0xFF;
 }
 
+void DecodeClut(u32 *dest, int count, const SamplerID &samplerID) {
+	for (int i = 0; i < count; ++i)
+		dest[i] = LookupColor(TransformClutIndex(i, samplerID), 0, samplerID);
+}
+
 struct Nearest4 {
 	alignas(16) u32 v[4];
 
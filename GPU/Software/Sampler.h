@@ -42,6 +42,9 @@ NearestFunc GetNearestFunc(SamplerID id);
 typedef Rasterizer::Vec4IntResult (SOFTRAST_CALL *LinearFunc)(float s, float t, int x, int y, Rasterizer::Vec4IntArg prim_color, const u8 *const *tptr, const int *bufw, int level, int levelFrac, const SamplerID &samplerID);
 LinearFunc GetLinearFunc(SamplerID id);
 
+// Decodes the level 0 palette entries for indexes 0 to count - 1, as RGBA8888.
+void DecodeClut(u32 *dest, int count, const SamplerID &samplerID);
+
 void Init();
 void Shutdown();
 
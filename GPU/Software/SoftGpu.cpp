@@ -24,6 +24,7 @@
 #include "GPU/Common/TextureDecoder.h"
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/GraphicsContext.h"
+#include "Common/Serialize/Serializer.h"
 #include "Core/Config.h"
 #include "Core/ConfigValues.h"
 #include "Core/Core.h"
@@ -397,6 +398,7 @@ SoftGPU::SoftGPU(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 {
 	fb.data = Memory::GetPointerWrite(0x44000000); // TODO: correct default address?
 	depthbuf.data = Memory::GetPointerWrite(0x44000000); // TODO: correct default address?
+	Rasterizer::SetDepthTilesTarget(0x44000000, gstate.DepthBufStride());
 
 	memset(softgpuCmdInfo, 0, sizeof(softgpuCmdInfo));
 
@@ -821,8 +823,9 @@ void SoftGPU::Execute_BlockTransferStart(u32 op, u32 diff) {
 	// TODO: Correct timing appears to be 1.9, but erring a bit low since some of our other timing is inaccurate.
 	cyclesExecuted += ((height * width * bpp) * 16) / 10;
 
-	// Could theoretically dirty the framebuffer.
+	// Could theoretically dirty the framebuffer, or overwrite depth.
 	MarkDirty(dst, dstSize, SoftGPUVRAMDirty::DIRTY | SoftGPUVRAMDirty::REALLY_DIRTY);
+	Rasterizer::InvalidateDepthTiles(dst, dstSize);
 }
 
 void SoftGPU::Execute_Prim(u32 op, u32 diff) {
@@ -1006,6 +1009,8 @@ void SoftGPU::Execute_FramebufPtr(u32 op, u32 diff) {
 	// We assume fb.data won't change while we're drawing.
 	drawEngine_->transformUnit.Flush("framebuf");
 	fb.data = Memory::GetPointerWrite(gstate.getFrameBufAddress());
+	// If the last framebuffer overlapped depth, this gets the depth tiles going again.
+	Rasterizer::SetDepthTilesTarget(gstate.getDepthBufAddress(), gstate.DepthBufStride());
 }
 
 void SoftGPU::Execute_FramebufFormat(u32 op, u32 diff) {
@@ -1017,6 +1022,7 @@ void SoftGPU::Execute_ZbufPtr(u32 op, u32 diff) {
 	// We assume depthbuf.data won't change while we're drawing.
 	drawEngine_->transformUnit.Flush("depthbuf");
 	depthbuf.data = Memory::GetPointerWrite(gstate.getDepthBufAddress());
+	Rasterizer::SetDepthTilesTarget(gstate.getDepthBufAddress(), gstate.DepthBufStride());
 }
 
 void SoftGPU::Execute_VertexType(u32 op, u32 diff) {
@@ -1143,7 +1149,14 @@ void SoftGPU::GetStats(char *buffer, size_t bufsize) {
 
 void SoftGPU::InvalidateCache(u32 addr, int size, GPUInvalidationType type)
 {
-	// Nothing to invalidate.
+	// The only thing cached is the depth range of each depth buffer tile.
+	Rasterizer::InvalidateDepthTiles(addr, type == GPU_INVALIDATE_ALL ? -1 : size);
+}
+
+void SoftGPU::DoState(PointerWrap &p) {
+	GPUCommon::DoState(p);
+	if (p.mode == p.MODE_READ)
+		Rasterizer::InvalidateDepthTiles(0, -1);
 }
 
 void SoftGPU::NotifyVideoUpload(u32 addr, int size, int width, int format)
@@ -23,6 +23,7 @@
 #include "Common/Math/math_util.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
 #include "GPU/GPUState.h"
 #include "GPU/Common/DrawEngineCommon.h"
@@ -47,6 +48,7 @@ TransformUnit::TransformUnit() {
 
 TransformUnit::~TransformUnit() {
 	FreeMemoryPages(decoded_, TRANSFORM_BUF_SIZE);
+	FreeAlignedMemory(transformed_);
 	delete binner_;
 }
 
@@ -438,6 +440,33 @@ VertexData TransformUnit::ReadVertex(VertexReader &vreader, const TransformState
 	return vertex;
 }
 
+bool TransformUnit::TransformVertices(const DecVtxFormat &vtxfmt, u32 vertex_type, int count, const TransformState &state) {
+	if (count < PARALLEL_TRANSFORM_MIN_VERTS || !g_threadManager.IsInitialized() || g_threadManager.GetNumLooperThreads() <= 1)
+		return false;
+
+	PROFILE_THIS_SCOPE("transform_verts");
+	if (transformedCapacity_ < count) {
+		// The old contents don't matter, they're all written below.
+		FreeAlignedMemory(transformed_);
+		transformed_ = (VertexData *)AllocateAlignedMemory(sizeof(VertexData) * count, 16);
+		transformedCapacity_ = count;
+		transformedOutside_.resize(count);
+	}
+
+	// Each vertex is read and transformed just like ReadVertex() would one at a time, and only
+	// reads the state, so the ranges don't affect each other.
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		VertexReader vreader(decoded_, vtxfmt, vertex_type);
+		for (int i = l; i < h; ++i) {
+			bool outside = false;
+			vreader.Goto(i);
+			transformed_[i] = ReadVertex(vreader, state, outside);
+			transformedOutside_[i] = outside ? 1 : 0;
+		}
+	}, 0, count, PARALLEL_TRANSFORM_MIN_VERTS / 2);
+	return true;
+}
+
 void TransformUnit::SetDirty(SoftDirty flags) {
 	binner_->SetDirty(flags);
 }
@@ -501,9 +530,6 @@ void TransformUnit::SubmitPrimitive(const void* vertices, const void* indices, G
 	default: vtcs_per_prim = 0; break;
 	}
 
-	// TODO: Do this in two passes - first process the vertices (before indexing/stripping),
-	// then resolve the indices. This lets us avoid transforming shared vertices twice.
-
 	binner_->UpdateState();
 
 	static TransformState transformState;
@@ -512,23 +538,35 @@ void TransformUnit::SubmitPrimitive(const void* vertices, const void* indices, G
 		binner_->ClearDirty(SoftDirty::LIGHT_ALL | SoftDirty::TRANSFORM_ALL);
 	}
 
+	// Large draws process the vertices first (before indexing/stripping), spread across threads.
+	// This also avoids transforming shared vertices twice.  Prims are still assembled and
+	// binned in order below.
+	int decodedCount = index_upper_bound - index_lower_bound + 1;
+	bool pretransformed = decodedCount <= vertex_count && TransformVertices(vtxfmt, vertex_type, decodedCount, transformState);
+
+	bool outside_range_flag = false;
+	// Like ReadVertex(), this only ever sets outside_range_flag, the prim loops reset it.
+	auto readVertex = [&](int vtx) -> VertexData {
+		int index = indices ? ConvertIndex(vtx) - index_lower_bound : vtx;
+		if (pretransformed) {
+			if (transformedOutside_[index])
+				outside_range_flag = true;
+			return transformed_[index];
+		}
+		vreader.Goto(index);
+		return ReadVertex(vreader, transformState, outside_range_flag);
+	};
+
 	bool skipCull = !gstate.isCullEnabled() || gstate.isModeClear();
 	const CullType cullType = skipCull ? CullType::OFF : (gstate.getCullMode() ? CullType::CCW : CullType::CW);
 
-	bool outside_range_flag = false;
 	switch (prim_type) {
 	case GE_PRIM_POINTS:
 	case GE_PRIM_LINES:
 	case GE_PRIM_TRIANGLES:
 		{
 			for (int vtx = 0; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
-				data[data_index++] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[data_index++] = readVertex(vtx);
 				if (data_index < vtcs_per_prim) {
 					// Keep reading.  Note: an incomplete prim will stay read for GE_PRIM_KEEP_PREVIOUS.
 					continue;
@@ -573,13 +611,7 @@ void TransformUnit::SubmitPrimitive(const void* vertices, const void* indices, G
 
 	case GE_PRIM_RECTANGLES:
 		for (int vtx = 0; vtx < vertex_count; ++vtx) {
-			if (indices) {
-				vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-			} else {
-				vreader.Goto(vtx);
-			}
-
-			data[data_index++] = ReadVertex(vreader, transformState, outside_range_flag);
+			data[data_index++] = readVertex(vtx);
 			if (outside_range_flag) {
 				outside_range_flag = false;
 				// Note: this is the post increment index.  If odd, we set the first vert.
@@ -619,13 +651,7 @@ void TransformUnit::SubmitPrimitive(const void* vertices, const void* indices, G
 			// If data_index is 1 or 2, etc., it means we're continuing a line strip.
 			int skip_count = data_index == 0 ? 1 : 0;
 			for (int vtx = 0; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
-				data[(data_index++) & 1] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[(data_index++) & 1] = readVertex(vtx);
 				if (outside_range_flag) {
 					// Drop all primitives containing the current vertex
 					skip_count = 2;
@@ -652,13 +678,7 @@ void TransformUnit::SubmitPrimitive(const void* vertices, const void* indices, G
 			// This is for Darkstalkers (and should speed up many 2D games).
 			if (data_index == 0 && vertex_count == 4 && cullType == CullType::OFF) {
 				for (int vtx = 0; vtx < 4; ++vtx) {
-					if (indices) {
-						vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-					}
-					else {
-						vreader.Goto(vtx);
-					}
-					data[vtx] = ReadVertex(vreader, transformState, outside_range_flag);
+					data[vtx] = readVertex(vtx);
 				}
 
 				// If a strip is effectively a rectangle, draw it as such!
@@ -671,14 +691,8 @@ void TransformUnit::SubmitPrimitive(const void* vertices, const void* indices, G
 
 			outside_range_flag = false;
 			for (int vtx = 0; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
 				int provoking_index = (data_index++) % 3;
-				data[provoking_index] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[provoking_index] = readVertex(vtx);
 				if (outside_range_flag) {
 					// Drop all primitives containing the current vertex
 					skip_count = 2;
@@ -714,12 +728,7 @@ void TransformUnit::SubmitPrimitive(const void* vertices, const void* indices, G
 
 			// Only read the central vertex if we're not continuing.
 			if (data_index == 0) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(0) - index_lower_bound);
-				} else {
-					vreader.Goto(0);
-				}
-				data[0] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[0] = readVertex(0);
 				data_index++;
 				start_vtx = 1;
 
@@ -730,12 +739,7 @@ void TransformUnit::SubmitPrimitive(const void* vertices, const void* indices, G
 
 			if (data_index == 1 && vertex_count == 4 && cullType == CullType::OFF) {
 				for (int vtx = start_vtx; vtx < vertex_count; ++vtx) {
-					if (indices) {
-						vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-					} else {
-						vreader.Goto(vtx);
-					}
-					data[vtx] = ReadVertex(vreader, transformState, outside_range_flag);
+					data[vtx] = readVertex(vtx);
 				}
 
 				int tl = -1, br = -1;
@@ -747,14 +751,8 @@ void TransformUnit::SubmitPrimitive(const void* vertices, const void* indices, G
 
 			outside_range_flag = false;
 			for (int vtx = start_vtx; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
 				int provoking_index = 2 - ((data_index++) % 2);
-				data[provoking_index] = ReadVertex(vreader, transformState, outside_range_flag);
+				data[provoking_index] = readVertex(vtx);
 				if (outside_range_flag) {
 					// Drop all primitives containing the current vertex
 					skip_count = 2;
@@ -133,9 +133,19 @@ class TransformUnit {
 
 private:
 	VertexData ReadVertex(VertexReader &vreader, const TransformState &lstate, bool &outside_range_flag);
+	// Transforms all the decoded vertices into transformed_ using worker threads.  Returns false
+	// without doing anything if the draw is too small to be worth it.
+	bool TransformVertices(const DecVtxFormat &vtxfmt, u32 vertex_type, int count, const TransformState &state);
+
+	// Below this many vertices, handing out the work costs more than it saves.
+	static constexpr int PARALLEL_TRANSFORM_MIN_VERTS = 512;
 
 	u8 *decoded_ = nullptr;
 	BinManager *binner_ = nullptr;
+	// Allocated aligned, since VertexData may contain SSE types.
+	VertexData *transformed_ = nullptr;
+	int transformedCapacity_ = 0;
+	std::vector<u8> transformedOutside_;
 };
 
 class SoftwareDrawEngine : public DrawEngineCommon {
@@ -1005,6 +1005,9 @@ UI::EventReturn JitCompareScreen::OnShowStats(UI::EventParams &e) {
 		}
 		ctr++;
 	}
+	for (auto iter : bcStats.passRemoved) {
+		NOTICE_LOG(JIT, "%s: removed %d instructions", iter.first.c_str(), iter.second);
+	}
 	return UI::EVENT_DONE;
 }
 
@@ -657,6 +657,10 @@ void NativeInit(int argc, const char *argv[], const char *savegame_dir, const ch
 				g_Config.iCpuCore = (int)CPUCore::IR_JIT;
 				g_Config.bSaveSettings = false;
 				break;
+			case 'J':
+				g_Config.iCpuCore = (int)CPUCore::JIT_IR;
+				g_Config.bSaveSettings = false;
+				break;
 			case '-':
 				if (!strncmp(argv[i], "--loglevel=", strlen("--loglevel=")) && strlen(argv[i]) > strlen("--loglevel="))
 					setLogLevel(static_cast<LogTypes::LOG_LEVELS>(std::atoi(argv[i] + strlen("--loglevel="))));
@@ -765,7 +769,7 @@ void NativeInit(int argc, const char *argv[], const char *savegame_dir, const ch
 		}
 	}
 
-	if (System_GetPropertyBool(SYSPROP_CAN_JIT) == false && g_Config.iCpuCore == (int)CPUCore::JIT) {
+	if (System_GetPropertyBool(SYSPROP_CAN_JIT) == false && (g_Config.iCpuCore == (int)CPUCore::JIT || g_Config.iCpuCore == (int)CPUCore::JIT_IR)) {
 		// Just gonna force it to the IR interpreter on startup.
 		// We don't hide the option, but we make sure it's off on bootup. In case someone wants
 		// to experiment in future iOS versions or something...
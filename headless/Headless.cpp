@@ -33,6 +33,8 @@
 #include "Core/CoreTiming.h"
 #include "Core/System.h"
 #include "Core/WebServer.h"
+#include "Core/HLE/HLEProfiler.h"
+#include "Core/HLE/ReplaceTables.h"
 #include "Core/HLE/sceUtility.h"
 #include "Core/Host.h"
 #include "Core/SaveState.h"
@@ -141,6 +143,11 @@ int printUsage(const char *progname, const char *reason)
 	fprintf(stderr, "  -i                    use the interpreter\n");
 	fprintf(stderr, "  --ir                  use ir interpreter\n");
 	fprintf(stderr, "  -j                    use jit (default)\n");
+	fprintf(stderr, "  --irjit               use jit via ir (native ir backend where available)\n");
+	fprintf(stderr, "  --bench               print the run time of each test\n");
+	fprintf(stderr, "  --hle-profile=FILE    write HLE call counts and timings to FILE as JSON\n");
+	fprintf(stderr, "  --unreplaced-profile=FILE\n");
+	fprintf(stderr, "                        write calls to known funcs without replacements to FILE\n");
 	fprintf(stderr, "  -c, --compare         compare with output in file.expected\n");
 	fprintf(stderr, "\nSee headless.txt for details.\n");
 
@@ -266,7 +273,10 @@ int main(int argc, const char* argv[])
 	bool fullLog = false;
 	bool autoCompare = false;
 	bool verbose = false;
+	bool bench = false;
 	const char *stateToLoad = 0;
+	const char *hleProfileFilename = nullptr;
+	const char *unreplacedProfileFilename = nullptr;
 	GPUCore gpuCore = GPUCORE_SOFTWARE;
 	CPUCore cpuCore = CPUCore::JIT;
 	int debuggerPort = -1;
@@ -299,6 +309,10 @@ int main(int argc, const char* argv[])
 			cpuCore = CPUCore::JIT;
 		else if (!strcmp(argv[i], "--ir"))
 			cpuCore = CPUCore::IR_JIT;
+		else if (!strcmp(argv[i], "--irjit"))
+			cpuCore = CPUCore::JIT_IR;
+		else if (!strcmp(argv[i], "--bench"))
+			bench = true;
 		else if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "--compare"))
 			autoCompare = true;
 		else if (!strcmp(argv[i], "-v") || !strcmp(argv[i], "--verbose"))
@@ -337,6 +351,10 @@ int main(int argc, const char* argv[])
 			teamCityMode = true;
 		else if (!strncmp(argv[i], "--state=", strlen("--state=")) && strlen(argv[i]) > strlen("--state="))
 			stateToLoad = argv[i] + strlen("--state=");
+		else if (!strncmp(argv[i], "--hle-profile=", strlen("--hle-profile=")) && strlen(argv[i]) > strlen("--hle-profile="))
+			hleProfileFilename = argv[i] + strlen("--hle-profile=");
+		else if (!strncmp(argv[i], "--unreplaced-profile=", strlen("--unreplaced-profile=")) && strlen(argv[i]) > strlen("--unreplaced-profile="))
+			unreplacedProfileFilename = argv[i] + strlen("--unreplaced-profile=");
 		else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h"))
 			return printUsage(argv[0], NULL);
 		else
@@ -403,6 +421,7 @@ int main(int argc, const char* argv[])
 	// Never report from tests.
 	g_Config.sReportHost = "";
 	g_Config.bAutoSaveSymbolMap = false;
+	g_Config.bIRBlockCache = false;
 	g_Config.iRenderingMode = FB_BUFFERED_MODE;
 	g_Config.bHardwareTransform = true;
 	g_Config.iAnisotropyLevel = 0;  // When testing mipmapping we really don't want this.
@@ -482,14 +501,26 @@ int main(int argc, const char* argv[])
 	if (stateToLoad != NULL)
 		SaveState::Load(Path(stateToLoad), -1);
 
+	if (hleProfileFilename)
+		HLEProfiler_Enable(true);
+	if (unreplacedProfileFilename)
+		ReplacementProfiler_Enable(true);
+
 	std::vector<std::string> failedTests;
 	std::vector<std::string> passedTests;
+	double benchTotal = 0.0;
 	for (size_t i = 0; i < testFilenames.size(); ++i)
 	{
 		coreParameter.fileToStart = Path(testFilenames[i]);
 		if (autoCompare)
 			printf("%s:\n", coreParameter.fileToStart.c_str());
+		double startTime = time_now_d();
 		bool passed = RunAutoTest(headlessHost, coreParameter, autoCompare, verbose, timeout);
+		if (bench) {
+			double elapsed = time_now_d() - startTime;
+			benchTotal += elapsed;
+			printf("  %s - %0.2f ms\n", GetTestName(coreParameter.fileToStart).c_str(), elapsed * 1000.0);
+		}
 		if (autoCompare)
 		{
 			std::string testName = GetTestName(coreParameter.fileToStart);
@@ -515,6 +546,20 @@ int main(int argc, const char* argv[])
 		}
 	}
 
+	if (bench)
+		printf("%d tests ran in %0.2f ms.\n", (int)testFilenames.size(), benchTotal * 1000.0);
+
+	if (hleProfileFilename) {
+		HLEProfiler_Enable(false);
+		if (!HLEProfiler_DumpJson(Path(std::string(hleProfileFilename))))
+			fprintf(stderr, "Failed to write HLE profile to %s\n", hleProfileFilename);
+	}
+	if (unreplacedProfileFilename) {
+		ReplacementProfiler_Enable(false);
+		if (!ReplacementProfiler_DumpJson(Path(std::string(unreplacedProfileFilename))))
+			fprintf(stderr, "Failed to write unreplaced function profile to %s\n", unreplacedProfileFilename);
+	}
+
 	if (debuggerPort > 0) {
 		ShutdownWebServer();
 	}
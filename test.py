@@ -469,6 +469,25 @@ tests_next = [
 ]
 
 
+# These cover the syscalls marked HLE_JIT_INLINE, which the jits call without ending the block.
+# Run with -s to check them on each jit core.
+tests_inline_syscalls = [
+  "ctrl/ctrl",
+  "ctrl/sampling/sampling",
+  "ctrl/sampling2/sampling2",
+  "ctrl/vblank",
+  "intr/intr",
+  "intr/enablesub",
+  "intr/suspended",
+  "intr/vblank/vblank",
+  "misc/libc",
+  "rtc/rtc",
+  "threads/alarm/alarm",
+  "threads/threads/threads",
+  "threads/vtimers/vtimer",
+  "threads/vtimers/interrupt",
+]
+
 # These are the tests we ignore (not important, or impossible to run)
 tests_ignored = [
   "kirk/kirk",
@@ -520,7 +539,7 @@ def run_tests(test_list, args):
   if len(test_filenames):
     # TODO: Maybe --compare should detect --graphics?
     cmdline = [PPSSPP_EXE, '--root', TEST_ROOT + '../', '--compare', '--timeout=' + str(TIMEOUT), '@-']
-    cmdline.extend([i for i in args if i not in ['-g', '-m', '-b']])
+    cmdline.extend([i for i in args if i not in ['-g', '-m', '-b', '-p', '-s']])
 
     c = Command(cmdline, '\n'.join(test_filenames))
     returncode = c.run(TIMEOUT * len(test_filenames))
@@ -544,7 +563,11 @@ def main():
       tests.append(arg)
 
   if not tests:
-    if '-g' in args:
+    if '-s' in args:
+      tests = tests_inline_syscalls
+    elif '-p' in args:
+      tests = [i for i in tests_good if i.startswith('cpu/')]
+    elif '-g' in args:
       tests = tests_good
     elif '-b' in args:
       tests = tests_next
@@ -557,6 +580,22 @@ def main():
   elif '-m' in args:
     tests = [i for i in tests_next + tests_good if i.startswith(tests[0])]
 
+  if '-p' in args:
+    # Benchmark on each jit core, by default using the cpu tests.
+    returncode = 0
+    for core in ['-j', '--irjit']:
+      core_args = [i for i in args if i not in ['-i', '-j', '--ir', '--irjit']] + [core, '--bench']
+      returncode = run_tests(tests, core_args) or returncode
+    return returncode
+
+  if '-s' in args:
+    # The inline syscall paths differ per jit core, so run each.
+    returncode = 0
+    for core in ['-j', '--irjit']:
+      core_args = [i for i in args if i not in ['-i', '-j', '--ir', '--irjit']] + [core]
+      returncode = run_tests(tests, core_args) or returncode
+    return returncode
+
   returncode = run_tests(tests, args)
   if teamcity:
     return 0
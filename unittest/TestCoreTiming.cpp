@@ -0,0 +1,195 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Common/Serialize/Serializer.h"
+#include "Core/CoreTiming.h"
+#include "Core/MIPS/MIPS.h"
+#include "unittest/UnitTest.h"
+
+static int recordEvent = -1;
+static std::vector<u64> fired;
+
+static void RecordCallback(u64 userdata, int cyclesLate) {
+	fired.push_back(userdata);
+}
+
+// Pretends the CPU ran each whole slice, until the expected number of events fired.
+static void RunUntilFired(size_t count) {
+	for (int i = 0; i < 100000 && fired.size() < count; ++i) {
+		currentMIPS->downcount = 0;
+		CoreTiming::Advance();
+	}
+}
+
+static u32 Random(u32 &seed) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+static bool TestFiringOrder() {
+	struct Expected {
+		s64 time;
+		u64 userdata;
+	};
+	std::vector<Expected> expected;
+	std::vector<CoreTiming::EventHandle> handles;
+
+	u32 seed = 1;
+	fired.clear();
+	const s64 now = (s64)CoreTiming::GetTicks();
+	for (u64 i = 0; i < 1000; ++i) {
+		// Plenty of ties, which must fire in the order they were scheduled.
+		s64 cycles = 1 + Random(seed) % 200 * 50;
+		handles.push_back(CoreTiming::ScheduleEvent(cycles, recordEvent, i));
+		expected.push_back({ now + cycles, i });
+	}
+
+	// Cancel some by handle, and some by userdata.
+	for (u64 i = 0; i < 1000; i += 7) {
+		EXPECT_TRUE(CoreTiming::IsHandleScheduled(handles[i]));
+		EXPECT_EQ_INT(CoreTiming::UnscheduleEventByHandle(handles[i]), expected[i].time - now);
+		EXPECT_FALSE(CoreTiming::IsHandleScheduled(handles[i]));
+		EXPECT_EQ_INT(CoreTiming::UnscheduleEventByHandle(handles[i]), 0);
+	}
+	for (u64 i = 3; i < 1000; i += 7) {
+		EXPECT_EQ_INT(CoreTiming::UnscheduleEvent(recordEvent, i), expected[i].time - now);
+	}
+	expected.erase(std::remove_if(expected.begin(), expected.end(), [](const Expected &e) {
+		return e.userdata % 7 == 0 || e.userdata % 7 == 3;
+	}), expected.end());
+	std::stable_sort(expected.begin(), expected.end(), [](const Expected &a, const Expected &b) {
+		return a.time < b.time;
+	});
+
+	RunUntilFired(expected.size());
+	EXPECT_EQ_INT(fired.size(), expected.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		EXPECT_EQ_INT(fired[i], expected[i].userdata);
+	}
+	EXPECT_FALSE(CoreTiming::IsScheduled(recordEvent));
+	// Handles of fired events are stale, even once their slots get reused.
+	CoreTiming::ScheduleEvent(10, recordEvent, 0);
+	EXPECT_FALSE(CoreTiming::IsHandleScheduled(handles[1]));
+	EXPECT_EQ_INT(CoreTiming::UnscheduleEventByHandle(handles[1]), 0);
+	CoreTiming::RemoveEvent(recordEvent);
+	EXPECT_FALSE(CoreTiming::IsScheduled(recordEvent));
+	return true;
+}
+
+// Like the HLE modules do, the event types have to be restored after any DoState.
+static void DoState(PointerWrap &p) {
+	CoreTiming::DoState(p);
+	CoreTiming::RestoreRegisterEvent(recordEvent, "RecordEvent", &RecordCallback);
+}
+
+static std::vector<u8> SaveState() {
+	u8 *ptr = nullptr;
+	PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+	DoState(measure);
+
+	std::vector<u8> data((size_t)(uintptr_t)ptr);
+	ptr = data.data();
+	PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+	DoState(p);
+	return data;
+}
+
+static bool TestSaveState() {
+	u32 seed = 2;
+	fired.clear();
+	for (u64 i = 0; i < 100; ++i) {
+		CoreTiming::ScheduleEvent(1 + Random(seed) % 20 * 100, recordEvent, i);
+	}
+	const std::string summary = CoreTiming::GetScheduledEventsSummary();
+	std::vector<u8> state = SaveState();
+
+	CoreTiming::ClearPendingEvents();
+	u8 *ptr = state.data();
+	PointerWrap p(&ptr, PointerWrap::MODE_READ);
+	DoState(p);
+	EXPECT_EQ_INT(p.error, PointerWrap::ERROR_NONE);
+
+	EXPECT_EQ_STR(CoreTiming::GetScheduledEventsSummary(), summary);
+	EXPECT_TRUE(SaveState() == state);
+
+	RunUntilFired(100);
+	EXPECT_EQ_INT(fired.size(), 100);
+	return true;
+}
+
+// Several threads hammer ScheduleEvent_Threadsafe, enough to overflow the ring, while this
+// thread keeps advancing like the CPU thread would.
+static bool TestThreadsafeStress() {
+	const int THREADS = 4;
+	const u32 PER_THREAD = 50000;
+	const size_t total = THREADS * PER_THREAD;
+
+	fired.clear();
+	std::atomic<int> finished(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < THREADS; ++t) {
+		threads.push_back(std::thread([t, &finished] {
+			for (u32 i = 0; i < PER_THREAD; ++i) {
+				CoreTiming::ScheduleEvent_Threadsafe(i & 7, recordEvent, ((u64)t << 32) | i);
+			}
+			finished++;
+		}));
+	}
+
+	while (finished < THREADS) {
+		currentMIPS->downcount = 0;
+		CoreTiming::Advance();
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	RunUntilFired(total);
+
+	EXPECT_EQ_INT(fired.size(), total);
+	std::vector<u8> seen(total);
+	for (u64 userdata : fired) {
+		size_t index = (size_t)(userdata >> 32) * PER_THREAD + (u32)userdata;
+		EXPECT_TRUE(index < total && !seen[index]);
+		seen[index] = 1;
+	}
+
+	// Cancelling only affects events that haven't been moved to the main queue yet.
+	fired.clear();
+	CoreTiming::ScheduleEvent_Threadsafe(100, recordEvent, 1);
+	CoreTiming::ScheduleEvent_Threadsafe(200, recordEvent, 2);
+	EXPECT_EQ_INT(CoreTiming::UnscheduleThreadsafeEvent(recordEvent, 1), 100);
+	RunUntilFired(1);
+	EXPECT_EQ_INT(fired.size(), 1);
+	EXPECT_EQ_INT(fired[0], 2);
+	return true;
+}
+
+bool TestCoreTiming() {
+	CoreTiming::Init();
+	recordEvent = CoreTiming::RegisterEvent("RecordEvent", &RecordCallback);
+
+	bool success = TestFiringOrder() && TestSaveState() && TestThreadsafeStress();
+
+	CoreTiming::Shutdown();
+	return success;
+}
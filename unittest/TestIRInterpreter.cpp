@@ -0,0 +1,155 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRInterpreter.h"
+#include "Core/MIPS/IR/IRPassSimplify.h"
+#include "unittest/UnitTest.h"
+
+static void InitState(MIPSState &mips) {
+	for (int i = 0; i < 32; ++i) {
+		mips.r[i] = i == 0 ? 0 : 0x01010101 * i;
+		mips.f[i] = (float)i * 0.5f;
+	}
+	mips.lo = 0;
+	mips.hi = 0;
+	mips.pc = 0x08804000;
+	mips.downcount = 1000;
+}
+
+static bool StatesMatch(const MIPSState &a, const MIPSState &b) {
+	return memcmp(a.r, b.r, sizeof(a.r)) == 0 && memcmp(a.fi, b.fi, sizeof(a.fi)) == 0 &&
+		a.lo == b.lo && a.hi == b.hi && a.pc == b.pc && a.downcount == b.downcount;
+}
+
+static bool TestThreadedMatches() {
+	const std::vector<IRInst> insts = {
+		{ IROp::Add, { MIPS_REG_V0 }, MIPS_REG_A0, MIPS_REG_A1 },
+		{ IROp::SubConst, { MIPS_REG_V1 }, MIPS_REG_V0, 0, 0x1234 },
+		{ IROp::ShlImm, { MIPS_REG_T0 }, MIPS_REG_V1, 5 },
+		{ IROp::SarImm, { MIPS_REG_T1 }, MIPS_REG_T0, 3 },
+		{ IROp::SltU, { MIPS_REG_T2 }, MIPS_REG_T1, MIPS_REG_T0 },
+		{ IROp::Mult, { 0 }, MIPS_REG_T0, MIPS_REG_T1 },
+		{ IROp::MfHi, { MIPS_REG_T3 }, 0, 0 },
+		// No threaded handler for these, so they use the fallback.
+		{ IROp::Clz, { MIPS_REG_T4 }, MIPS_REG_T3, 0 },
+		{ IROp::FSqrt, { 2 }, 3, 0 },
+		{ IROp::FMul, { 4 }, 2, 5 },
+		{ IROp::FMovToGPR, { MIPS_REG_T5 }, 4, 0 },
+		{ IROp::Downcount, { 0 }, 0, 0, 12 },
+		{ IROp::ExitToConstIfEq, { 0 }, MIPS_REG_T2, MIPS_REG_ZERO, 0x08808000 },
+		{ IROp::SetPCConst, { 0 }, 0, 0, 0x0880C000 },
+		{ IROp::ExitToPC, { 0 }, 0, 0, 0 },
+	};
+
+	static MIPSState ref, mips;
+	InitState(ref);
+	InitState(mips);
+
+	std::vector<IRThreadedInst> threaded;
+	IRBuildThreaded(&mips, insts.data(), (int)insts.size(), threaded);
+	u32 refPC = IRInterpret(&ref, insts.data(), (int)insts.size());
+	u32 pc = IRInterpretThreaded(&mips, threaded.data());
+	EXPECT_EQ_HEX(pc, refPC);
+	EXPECT_TRUE(StatesMatch(mips, ref));
+	return true;
+}
+
+static bool TestVec4Dot() {
+	// Should match the scalar ops exactly, including the order of the adds.
+	const std::vector<IRInst> scalar = {
+		{ IROp::FMul, { IRVTEMP_0 }, 32, 36 },
+		{ IROp::FMul, { IRVTEMP_0 + 1 }, 33, 37 },
+		{ IROp::FAdd, { IRVTEMP_0 }, IRVTEMP_0, IRVTEMP_0 + 1 },
+		{ IROp::FMul, { IRVTEMP_0 + 1 }, 34, 38 },
+		{ IROp::FAdd, { IRVTEMP_0 }, IRVTEMP_0, IRVTEMP_0 + 1 },
+		{ IROp::FMul, { IRVTEMP_0 + 1 }, 35, 39 },
+		{ IROp::FAdd, { 40 }, IRVTEMP_0, IRVTEMP_0 + 1 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+	};
+	const std::vector<IRInst> vec4 = {
+		{ IROp::Vec4Dot, { 40 }, 32, 36 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+	};
+	// Values where the order of the adds matters.
+	static const float values[8] = { 1.0e8f, 1.0f, -1.0e8f, 3.0f, 1.0f, 0.5f, 1.0f, 0.25f };
+
+	static MIPSState ref, mips;
+	InitState(ref);
+	memcpy(ref.v, values, sizeof(values));
+	InitState(mips);
+	memcpy(mips.v, values, sizeof(values));
+
+	IRInterpret(&ref, scalar.data(), (int)scalar.size());
+	IRInterpret(&mips, vec4.data(), (int)vec4.size());
+	EXPECT_EQ_FLOAT(mips.f[40], ref.f[40]);
+	return true;
+}
+
+static bool TestCombinedLanesMatch() {
+	// Combining lanes into Vec4 ops must not change any bits, even for inf * 0.
+	const std::vector<IRInst> insts = {
+		{ IROp::FMul, { 40 }, 32, 36 },
+		{ IROp::FMul, { 41 }, 33, 37 },
+		{ IROp::FMul, { 42 }, 34, 38 },
+		{ IROp::FMul, { 43 }, 35, 39 },
+		{ IROp::FAdd, { 44 }, 32, 36 },
+		{ IROp::FAdd, { 45 }, 33, 37 },
+		{ IROp::FAdd, { 46 }, 34, 38 },
+		{ IROp::FAdd, { 47 }, 35, 39 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+	};
+	const float inf = std::numeric_limits<float>::infinity();
+	static const float values[8] = { inf, 0.0f, -inf, 2.0f, 0.0f, inf, -0.0f, 0.5f };
+
+	IRWriter in, out;
+	for (const IRInst &inst : insts)
+		in.Write(inst);
+	const IRPassFunc pass = &CombineVec4Lanes;
+	IROptions opts{};
+	IRApplyPasses(&pass, 1, in, out, opts);
+	const std::vector<IRInst> &combined = out.GetInstructions();
+
+	static MIPSState ref, mips;
+	InitState(ref);
+	memcpy(ref.v, values, sizeof(values));
+	InitState(mips);
+	memcpy(mips.v, values, sizeof(values));
+
+	IRInterpret(&ref, insts.data(), (int)insts.size());
+	IRInterpret(&mips, combined.data(), (int)combined.size());
+	for (int i = 0; i < 8; ++i)
+		EXPECT_EQ_HEX(mips.vi[8 + i], ref.vi[8 + i]);
+	return true;
+}
+
+bool TestIRInterpreter() {
+	InitIR();
+
+	if (!TestThreadedMatches())
+		return false;
+	if (!TestVec4Dot())
+		return false;
+	if (!TestCombinedLanesMatch())
+		return false;
+	return true;
+}
@@ -19,6 +19,7 @@
 #include <cstring>
 #include "Core/MIPS/IR/IRInst.h"
 #include "Core/MIPS/IR/IRPassSimplify.h"
+#include "unittest/UnitTest.h"
 
 struct IRVerification {
 	const char *name;
@@ -166,8 +167,201 @@ static const IRVerification tests[] = {
 		},
 		{ &PropagateConstants },
 	},
+	{
+		"CombineVec4Lanes",
+		{
+			{ IROp::FAdd, { 32 }, 36, 40 },
+			{ IROp::FAdd, { 33 }, 37, 41 },
+			{ IROp::FAdd, { 34 }, 38, 42 },
+			{ IROp::FAdd, { 35 }, 39, 43 },
+			{ IROp::FSub, { 44 }, 36, 48 },
+			{ IROp::FSub, { 45 }, 37, 49 },
+			{ IROp::FSub, { 46 }, 38, 50 },
+			{ IROp::FSub, { 47 }, 39, 51 },
+			{ IROp::FNeg, { 36 }, 36 },
+			{ IROp::FNeg, { 37 }, 37 },
+			{ IROp::FNeg, { 38 }, 38 },
+			{ IROp::FNeg, { 39 }, 39 },
+		},
+		{
+			{ IROp::Vec4Add, { 32 }, 36, 40 },
+			{ IROp::Vec4Sub, { 44 }, 36, 48 },
+			{ IROp::Vec4Neg, { 36 }, 36 },
+		},
+		{ &CombineVec4Lanes },
+	},
+	{
+		"CombineVec4LanesUnsafe",
+		{
+			// Not aligned.
+			{ IROp::FAdd, { 33 }, 37, 41 },
+			{ IROp::FAdd, { 34 }, 38, 42 },
+			{ IROp::FAdd, { 35 }, 39, 43 },
+			{ IROp::FAdd, { 36 }, 40, 44 },
+			// FMul gives the PSP's NaN for inf * 0, which the Vec4 ops don't.
+			{ IROp::FMul, { 44 }, 36, 48 },
+			{ IROp::FMul, { 45 }, 37, 49 },
+			{ IROp::FMul, { 46 }, 38, 50 },
+			{ IROp::FMul, { 47 }, 39, 51 },
+			// Past v[] are t[] and vfpuCtrl, which aren't vectors.
+			{ IROp::FSub, { 160 }, 36, 40 },
+			{ IROp::FSub, { 161 }, 37, 41 },
+			{ IROp::FSub, { 162 }, 38, 42 },
+			{ IROp::FSub, { 163 }, 39, 43 },
+			{ IROp::FSub, { 36 }, 188, 40 },
+			{ IROp::FSub, { 37 }, 189, 41 },
+			{ IROp::FSub, { 38 }, 190, 42 },
+			{ IROp::FSub, { 39 }, 191, 43 },
+		},
+		{
+			{ IROp::FAdd, { 33 }, 37, 41 },
+			{ IROp::FAdd, { 34 }, 38, 42 },
+			{ IROp::FAdd, { 35 }, 39, 43 },
+			{ IROp::FAdd, { 36 }, 40, 44 },
+			{ IROp::FMul, { 44 }, 36, 48 },
+			{ IROp::FMul, { 45 }, 37, 49 },
+			{ IROp::FMul, { 46 }, 38, 50 },
+			{ IROp::FMul, { 47 }, 39, 51 },
+			{ IROp::FSub, { 160 }, 36, 40 },
+			{ IROp::FSub, { 161 }, 37, 41 },
+			{ IROp::FSub, { 162 }, 38, 42 },
+			{ IROp::FSub, { 163 }, 39, 43 },
+			{ IROp::FSub, { 36 }, 188, 40 },
+			{ IROp::FSub, { 37 }, 189, 41 },
+			{ IROp::FSub, { 38 }, 190, 42 },
+			{ IROp::FSub, { 39 }, 191, 43 },
+		},
+		{ &CombineVec4Lanes },
+	},
+	{
+		"RemoveDeadWrites",
+		{
+			{ IROp::Add, { MIPS_REG_V0 }, MIPS_REG_A0, MIPS_REG_A1 },
+			{ IROp::FAdd, { 0 }, 1, 2 },
+			{ IROp::Add, { MIPS_REG_V1 }, MIPS_REG_V0, MIPS_REG_A1 },
+			{ IROp::SetConst, { MIPS_REG_V0 }, 0, 0, 0x1234 },
+			// GPR 32 is f[0], so this overwrites the FAdd.
+			{ IROp::Mov, { 32 }, MIPS_REG_A2 },
+			{ IROp::Load32, { MIPS_REG_A0 }, MIPS_REG_A1, 0, 0 },
+			{ IROp::Load32, { MIPS_REG_A0 }, MIPS_REG_A1, 0, 4 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{
+			{ IROp::Add, { MIPS_REG_V0 }, MIPS_REG_A0, MIPS_REG_A1 },
+			{ IROp::Add, { MIPS_REG_V1 }, MIPS_REG_V0, MIPS_REG_A1 },
+			{ IROp::SetConst, { MIPS_REG_V0 }, 0, 0, 0x1234 },
+			{ IROp::Mov, { 32 }, MIPS_REG_A2 },
+			{ IROp::Load32, { MIPS_REG_A0 }, MIPS_REG_A1, 0, 0 },
+			{ IROp::Load32, { MIPS_REG_A0 }, MIPS_REG_A1, 0, 4 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{ &RemoveDeadWrites },
+	},
+	{
+		"RemoveDeadWritesBarrier",
+		{
+			{ IROp::SetConst, { MIPS_REG_V0 }, 0, 0, 0x1234 },
+			{ IROp::ExitToConstIfEq, { 0 }, MIPS_REG_A0, MIPS_REG_A1, 0x08808000 },
+			{ IROp::SetConst, { MIPS_REG_V0 }, 0, 0, 0x5678 },
+			{ IROp::Interpret, { 0 }, 0, 0, 0 },
+			{ IROp::SetConst, { MIPS_REG_V0 }, 0, 0, 0x9ABC },
+			{ IROp::MovZ, { MIPS_REG_V0 }, MIPS_REG_A0, MIPS_REG_A1 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{
+			{ IROp::SetConst, { MIPS_REG_V0 }, 0, 0, 0x1234 },
+			{ IROp::ExitToConstIfEq, { 0 }, MIPS_REG_A0, MIPS_REG_A1, 0x08808000 },
+			{ IROp::SetConst, { MIPS_REG_V0 }, 0, 0, 0x5678 },
+			{ IROp::Interpret, { 0 }, 0, 0, 0 },
+			{ IROp::SetConst, { MIPS_REG_V0 }, 0, 0, 0x9ABC },
+			{ IROp::MovZ, { MIPS_REG_V0 }, MIPS_REG_A0, MIPS_REG_A1 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{ &RemoveDeadWrites },
+	},
+	{
+		"RemoveDeadWritesPack",
+		{
+			// The pack only writes one lane, so the write to the next lane stays live.
+			{ IROp::FMovFromGPR, { 33 }, MIPS_REG_A0 },
+			{ IROp::Vec2Pack32To16, { 32 }, 36 },
+			{ IROp::StoreFloat, { 33 }, MIPS_REG_A1, 0, 0 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{
+			{ IROp::FMovFromGPR, { 33 }, MIPS_REG_A0 },
+			{ IROp::Vec2Pack32To16, { 32 }, 36 },
+			{ IROp::StoreFloat, { 33 }, MIPS_REG_A1, 0, 0 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{ &RemoveDeadWrites },
+	},
+	{
+		"RemoveRedundantStores",
+		{
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_SP, 0, 0x10 },
+			{ IROp::Store16, { MIPS_REG_A1 }, MIPS_REG_SP, 0, 0x12 },
+			{ IROp::Store32, { MIPS_REG_A2 }, MIPS_REG_SP, 0, 0x10 },
+			// The load keeps the first of these.
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_SP, 0, 0x20 },
+			{ IROp::Load32, { MIPS_REG_V0 }, MIPS_REG_A3, 0, 0 },
+			{ IROp::Store32, { MIPS_REG_A1 }, MIPS_REG_SP, 0, 0x20 },
+			// And changing the base keeps the first of these.
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_T0, 0, 0 },
+			{ IROp::AddConst, { MIPS_REG_T0 }, MIPS_REG_T0, 0, 4 },
+			{ IROp::Store32, { MIPS_REG_A1 }, MIPS_REG_T0, 0, 0 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{
+			{ IROp::Store32, { MIPS_REG_A2 }, MIPS_REG_SP, 0, 0x10 },
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_SP, 0, 0x20 },
+			{ IROp::Load32, { MIPS_REG_V0 }, MIPS_REG_A3, 0, 0 },
+			{ IROp::Store32, { MIPS_REG_A1 }, MIPS_REG_SP, 0, 0x20 },
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_T0, 0, 0 },
+			{ IROp::AddConst, { MIPS_REG_T0 }, MIPS_REG_T0, 0, 4 },
+			{ IROp::Store32, { MIPS_REG_A1 }, MIPS_REG_T0, 0, 0 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{ &RemoveRedundantStores },
+	},
+	{
+		"RemoveRedundantStoresNegativeOffset",
+		{
+			// -4 + 4 must not wrap around to cover offset 0.
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_SP, 0, (u32)-4 },
+			{ IROp::Store32, { MIPS_REG_A1 }, MIPS_REG_SP, 0, 0 },
+			{ IROp::Store16, { MIPS_REG_A2 }, MIPS_REG_SP, 0, (u32)-8 },
+			{ IROp::Store32, { MIPS_REG_A3 }, MIPS_REG_SP, 0, (u32)-8 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_SP, 0, (u32)-4 },
+			{ IROp::Store32, { MIPS_REG_A1 }, MIPS_REG_SP, 0, 0 },
+			{ IROp::Store32, { MIPS_REG_A3 }, MIPS_REG_SP, 0, (u32)-8 },
+			{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+		},
+		{ &RemoveRedundantStores },
+	},
 };
 
+static bool TestPassStats() {
+	IRWriter in, out;
+	IROptions opts{};
+	in.Write({ IROp::Add, { MIPS_REG_V0 }, MIPS_REG_A0, MIPS_REG_A1 });
+	in.Write({ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_SP, 0, 0x10 });
+	in.Write({ IROp::SetConst, { MIPS_REG_V0 }, 0, 0, 0x1234 });
+	in.Write({ IROp::Store32, { MIPS_REG_A1 }, MIPS_REG_SP, 0, 0x10 });
+	in.Write({ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 });
+
+	static const IRPassFunc passes[] = { &RemoveDeadWrites, &RemoveRedundantStores };
+	IRPassStats stats;
+	IRApplyPasses(passes, 2, in, out, opts, &stats);
+	EXPECT_EQ_INT(stats["RemoveDeadWrites"], 1);
+	EXPECT_EQ_INT(stats["RemoveRedundantStores"], 1);
+	EXPECT_EQ_INT((int)out.GetInstructions().size(), 3);
+	return true;
+}
+
 bool TestIRPassSimplify() {
 	InitIR();
 
@@ -175,6 +369,8 @@ bool TestIRPassSimplify() {
 		if (!VerifyPass(test))
 			return false;
 	}
+	if (!TestPassStats())
+		return false;
 
 	return true;
 }
@@ -0,0 +1,145 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <vector>
+#include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRRegAlloc.h"
+#include "unittest/UnitTest.h"
+
+static int CountActions(const IRRegAllocator &alloc, int i, IRRegAllocActionType type) {
+	int count = 0;
+	for (auto action = alloc.ActionsBegin(i); action != alloc.ActionsEnd(i); ++action) {
+		if (action->type == type)
+			count++;
+	}
+	return count;
+}
+
+static bool TestSimpleBlock() {
+	const std::vector<IRInst> insts = {
+		{ IROp::Add, { MIPS_REG_V0 }, MIPS_REG_A0, MIPS_REG_A1 },
+		{ IROp::Add, { MIPS_REG_V0 }, MIPS_REG_V0, MIPS_REG_A1 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+	};
+
+	IRRegAllocConfig config;
+	config.numGPRs = 4;
+	IRRegAllocator alloc;
+	alloc.Allocate(insts.data(), (int)insts.size(), config);
+
+	// a0, a1 loaded, v0 isn't (written first), and v0 stored before the exit.
+	EXPECT_EQ_INT(CountActions(alloc, 0, IRRegAllocActionType::LOAD), 2);
+	EXPECT_EQ_INT(CountActions(alloc, 1, IRRegAllocActionType::LOAD), 0);
+	EXPECT_EQ_INT(CountActions(alloc, 2, IRRegAllocActionType::STORE), 1);
+	EXPECT_EQ_INT(alloc.GetStats().spilled, 0);
+	EXPECT_TRUE(alloc.DestReg(0) != IRRegAllocator::NO_REG);
+	EXPECT_EQ_INT(alloc.DestReg(0), alloc.DestReg(1));
+	EXPECT_EQ_INT(alloc.DestReg(1), alloc.Src1Reg(1));
+	EXPECT_EQ_INT(alloc.Src2Reg(0), alloc.Src2Reg(1));
+	return true;
+}
+
+static bool TestSpill() {
+	// Five values live at once with only two host registers.
+	const std::vector<IRInst> insts = {
+		{ IROp::Add, { MIPS_REG_T0 }, MIPS_REG_A0, MIPS_REG_A1 },
+		{ IROp::Add, { MIPS_REG_T1 }, MIPS_REG_A2, MIPS_REG_A3 },
+		{ IROp::Add, { MIPS_REG_T0 }, MIPS_REG_T0, MIPS_REG_T1 },
+		{ IROp::Add, { MIPS_REG_V0 }, MIPS_REG_T0, MIPS_REG_A0 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+	};
+
+	IRRegAllocConfig config;
+	config.numGPRs = 2;
+	IRRegAllocator alloc;
+	alloc.Allocate(insts.data(), (int)insts.size(), config);
+
+	const IRRegAllocStats &stats = alloc.GetStats();
+	EXPECT_EQ_INT(stats.intervals, 7);
+	EXPECT_TRUE(stats.spilled > 0);
+	EXPECT_TRUE(stats.allocated <= stats.intervals);
+	// Only two host registers exist, anything else must use MIPSState directly.
+	int mapped = 0;
+	for (int i = 0; i < (int)insts.size(); ++i) {
+		for (int reg : { alloc.DestReg(i), alloc.Src1Reg(i), alloc.Src2Reg(i) }) {
+			EXPECT_TRUE(reg == IRRegAllocator::NO_REG || (reg >= 0 && reg < 2));
+			if (reg != IRRegAllocator::NO_REG)
+				mapped++;
+		}
+	}
+	EXPECT_TRUE(mapped > 0);
+	return true;
+}
+
+static bool TestConditionalDest() {
+	const std::vector<IRInst> insts = {
+		// Only writes v0 if the condition holds, so the old value must be loaded.
+		{ IROp::FCmovVfpuCC, { 32 }, 33, 0, 0 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08804000 },
+	};
+
+	IRRegAllocConfig config;
+	config.numFPRs = 4;
+	IRRegAllocator alloc;
+	alloc.Allocate(insts.data(), (int)insts.size(), config);
+
+	EXPECT_EQ_INT(CountActions(alloc, 0, IRRegAllocActionType::LOAD), 2);
+	EXPECT_TRUE(alloc.DestReg(0) >= 0 && alloc.DestReg(0) < 4);
+	EXPECT_EQ_INT(CountActions(alloc, 1, IRRegAllocActionType::STORE), 1);
+	return true;
+}
+
+static bool TestBarrier() {
+	const std::vector<IRInst> insts = {
+		{ IROp::AddConst, { MIPS_REG_A0 }, MIPS_REG_A0, 0, 4 },
+		{ IROp::Interpret, { 0 }, 0, 0, 0 },
+		{ IROp::AddConst, { MIPS_REG_A0 }, MIPS_REG_A0, 0, 4 },
+		{ IROp::ExitToConstIfEq, { 0 }, MIPS_REG_A0, MIPS_REG_ZERO, 0x08804000 },
+		{ IROp::AddConst, { MIPS_REG_A0 }, MIPS_REG_A0, 0, 4 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08808000 },
+	};
+
+	IRRegAllocConfig config;
+	config.numGPRs = 4;
+	IRRegAllocator alloc;
+	alloc.Allocate(insts.data(), (int)insts.size(), config);
+
+	// a0 is written back before the interpreter runs, and reloaded after.
+	EXPECT_EQ_INT(CountActions(alloc, 1, IRRegAllocActionType::STORE), 1);
+	EXPECT_EQ_INT(CountActions(alloc, 2, IRRegAllocActionType::LOAD), 1);
+	// And before each exit, but stays mapped across the conditional one.
+	EXPECT_EQ_INT(CountActions(alloc, 3, IRRegAllocActionType::STORE), 1);
+	EXPECT_EQ_INT(CountActions(alloc, 4, IRRegAllocActionType::LOAD), 0);
+	EXPECT_EQ_INT(CountActions(alloc, 5, IRRegAllocActionType::STORE), 1);
+	EXPECT_EQ_INT(alloc.DestReg(1), IRRegAllocator::NO_REG);
+	return true;
+}
+
+bool TestIRRegAlloc() {
+	InitIR();
+
+	if (!TestSimpleBlock())
+		return false;
+	if (!TestSpill())
+		return false;
+	if (!TestBarrier())
+		return false;
+	if (!TestConditionalDest())
+		return false;
+	return true;
+}
@@ -0,0 +1,179 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(RISCV64)
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Core/MemMap.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/RiscV/IRToRiscV.h"
+#include "unittest/UnitTest.h"
+
+static void InitState(MIPSState &mips) {
+	for (int i = 0; i < 32; ++i) {
+		mips.r[i] = i == 0 ? 0 : (0x01234567 * i) ^ ((i & 1) ? 0x80000000 : 0);
+		mips.f[i] = (float)i * 0.5f - 3.0f;
+	}
+	for (int i = 0; i < 128; ++i)
+		mips.v[i] = (float)i * 0.25f - 8.0f;
+	mips.r[MIPS_REG_A2] = 3;
+	mips.r[MIPS_REG_A3] = 0x08800010;
+	mips.lo = 0x11111111;
+	mips.hi = 0x22222222;
+	mips.pc = 0x08804000;
+	mips.downcount = 1000;
+}
+
+static bool StatesMatch(const MIPSState &a, const MIPSState &b) {
+	bool match = true;
+	for (int i = 0; i < 32; ++i) {
+		if (a.r[i] != b.r[i]) {
+			printf("r%d: %08x vs %08x\n", i, a.r[i], b.r[i]);
+			match = false;
+		}
+		if (a.fi[i] != b.fi[i]) {
+			printf("f%d: %08x vs %08x\n", i, a.fi[i], b.fi[i]);
+			match = false;
+		}
+	}
+	if (memcmp(a.v, b.v, sizeof(a.v)) != 0) {
+		printf("VFPU regs differ\n");
+		match = false;
+	}
+	if (a.lo != b.lo || a.hi != b.hi || a.downcount != b.downcount) {
+		printf("lo/hi/downcount differ\n");
+		match = false;
+	}
+	return match;
+}
+
+// Runs the block natively and in the interpreter, and compares the results.
+static bool CheckBlock(MIPSComp::IRToRiscV &converter, MIPSComp::IRToRiscV::EnterBlockFunc enterBlock, RiscVGen::RiscVCodeBlock &code, const std::vector<IRInst> &insts) {
+	static u8 memory[0x10000];
+	u8 *oldBase = Memory::base;
+	Memory::base = memory - 0x08800000;
+
+	static MIPSState ref, mips;
+	memset(memory, 0x5A, sizeof(memory));
+	InitState(ref);
+	u32 refPC = IRInterpret(&ref, insts.data(), (int)insts.size());
+	u32 refWord = *(u32 *)(memory + 0x10);
+
+	memset(memory, 0x5A, sizeof(memory));
+	InitState(mips);
+	code.BeginWrite();
+	const u8 *block = converter.ConvertIRToNative(insts.data(), (int)insts.size());
+	code.EndWrite();
+	u32 pc = enterBlock(&mips, block);
+	u32 word = *(u32 *)(memory + 0x10);
+
+	Memory::base = oldBase;
+	EXPECT_EQ_HEX(pc, refPC);
+	EXPECT_EQ_HEX(word, refWord);
+	EXPECT_TRUE(StatesMatch(mips, ref));
+	return true;
+}
+
+bool TestIRToRiscV() {
+	InitIR();
+
+	RiscVGen::RiscVCodeBlock code;
+	code.AllocCodeSpace(1024 * 1024);
+	MIPSComp::IRToRiscV converter;
+	converter.SetCodeBlock(&code);
+	code.BeginWrite();
+	MIPSComp::IRToRiscV::EnterBlockFunc enterBlock = converter.GenerateFixedCode();
+	code.EndWrite();
+
+	const std::vector<IRInst> alu = {
+		{ IROp::Add, { MIPS_REG_V0 }, MIPS_REG_A0, MIPS_REG_A1 },
+		{ IROp::Sub, { MIPS_REG_V1 }, MIPS_REG_T0, MIPS_REG_T1 },
+		{ IROp::AddConst, { MIPS_REG_T2 }, MIPS_REG_A0, 0, 0x12345 },
+		{ IROp::XorConst, { MIPS_REG_T3 }, MIPS_REG_A1, 0, 0x5555 },
+		{ IROp::Slt, { MIPS_REG_T4 }, MIPS_REG_A0, MIPS_REG_A1 },
+		{ IROp::SltU, { MIPS_REG_T5 }, MIPS_REG_A0, MIPS_REG_A1 },
+		{ IROp::SltConst, { MIPS_REG_T6 }, MIPS_REG_T0, 0, (u32)-5 },
+		{ IROp::Shl, { MIPS_REG_T7 }, MIPS_REG_S0, MIPS_REG_A2 },
+		{ IROp::Ror, { MIPS_REG_S1 }, MIPS_REG_S0, MIPS_REG_A2 },
+		{ IROp::SarImm, { MIPS_REG_S2 }, MIPS_REG_A1, 7 },
+		{ IROp::RorImm, { MIPS_REG_S3 }, MIPS_REG_A1, 13 },
+		{ IROp::Ext8to32, { MIPS_REG_S4 }, MIPS_REG_S0, 0 },
+		{ IROp::MovZ, { MIPS_REG_S5 }, MIPS_REG_ZERO, MIPS_REG_T9 },
+		{ IROp::Max, { MIPS_REG_S6 }, MIPS_REG_A0, MIPS_REG_A1 },
+		{ IROp::Min, { MIPS_REG_S7 }, MIPS_REG_A0, MIPS_REG_A1 },
+		// No native version, so these use the interpreter fallback.
+		{ IROp::Clz, { MIPS_REG_T8 }, MIPS_REG_A2, 0 },
+		{ IROp::BSwap32, { MIPS_REG_T9 }, MIPS_REG_S0, 0 },
+		{ IROp::Downcount, { 0 }, 0, 0, 12 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08808000 },
+	};
+	if (!CheckBlock(converter, enterBlock, code, alu))
+		return false;
+
+	const std::vector<IRInst> mult = {
+		{ IROp::Mult, { 0 }, MIPS_REG_A0, MIPS_REG_A1 },
+		{ IROp::Madd, { 0 }, MIPS_REG_T0, MIPS_REG_T1 },
+		{ IROp::MfHi, { MIPS_REG_V0 }, 0, 0 },
+		{ IROp::MultU, { 0 }, MIPS_REG_A0, MIPS_REG_A1 },
+		{ IROp::Msub, { 0 }, MIPS_REG_T2, MIPS_REG_T3 },
+		{ IROp::MfLo, { MIPS_REG_V1 }, 0, 0 },
+		{ IROp::ExitToReg, { 0 }, MIPS_REG_A3, 0 },
+	};
+	if (!CheckBlock(converter, enterBlock, code, mult))
+		return false;
+
+	const std::vector<IRInst> loadStore = {
+		{ IROp::Store32, { MIPS_REG_S0 }, MIPS_REG_A3, 0, 0 },
+		{ IROp::Load16Ext, { MIPS_REG_V0 }, MIPS_REG_A3, 0, 2 },
+		{ IROp::Load8, { MIPS_REG_V1 }, MIPS_REG_A3, 0, 3 },
+		{ IROp::Store8, { MIPS_REG_A2 }, MIPS_REG_A3, 0, 1 },
+		{ IROp::Load32, { MIPS_REG_T0 }, MIPS_REG_A3, 0, 0 },
+		{ IROp::LoadFloat, { 4 }, MIPS_REG_A3, 0, 0 },
+		{ IROp::StoreFloat, { 5 }, MIPS_REG_A3, 0, 0x20 },
+		{ IROp::ExitToConstIfNeq, { 0 }, MIPS_REG_T0, MIPS_REG_S0, 0x08808000 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x0880C000 },
+	};
+	if (!CheckBlock(converter, enterBlock, code, loadStore))
+		return false;
+
+	// Avoids Vec4Dot, since the compiler may fuse the interpreter's multiply-adds.
+	const std::vector<IRInst> fpu = {
+		{ IROp::FAdd, { 10 }, 1, 2 },
+		{ IROp::FSub, { 11 }, 3, 4 },
+		{ IROp::FMul, { 12 }, 5, 6 },
+		{ IROp::FDiv, { 13 }, 7, 8 },
+		{ IROp::FNeg, { 14 }, 9, 0 },
+		{ IROp::FAbs, { 15 }, 1, 0 },
+		{ IROp::FMin, { 16 }, 1, 2 },
+		{ IROp::FMovToGPR, { MIPS_REG_V0 }, 12, 0 },
+		{ IROp::Vec4Add, { 64 }, 32, 36 },
+		{ IROp::Vec4Scale, { 68 }, 40, 1 },
+		{ IROp::Vec4ClampToZero, { 72 }, 44, 0 },
+		{ IROp::Vec4Mov, { 76 }, 32, 0 },
+		{ IROp::ExitToPC, { 0 }, 0, 0 },
+	};
+	if (!CheckBlock(converter, enterBlock, code, fpu))
+		return false;
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,81 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <vector>
+#include "Core/HLE/KernelWaitHelpers.h"
+#include "unittest/UnitTest.h"
+
+// Like an event flag's waiting threads, each waiting for some bits.
+struct FakeWaiter {
+	SceUID threadID;
+	u32 bits;
+};
+
+static std::vector<FakeWaiter> MakeWaiters(int count) {
+	std::vector<FakeWaiter> waiters;
+	for (int i = 0; i < count; ++i)
+		waiters.push_back({ 100 + i, 1U << (i & 31) });
+	return waiters;
+}
+
+// Wakes waiters whose bits are all set, optionally clearing them like PSP_EVENT_WAITCLEAR.
+static bool TryWake(u32 &pattern, const FakeWaiter &w, std::vector<SceUID> &woken, bool clear) {
+	if ((pattern & w.bits) != w.bits)
+		return false;
+	if (clear)
+		pattern &= ~w.bits;
+	woken.push_back(w.threadID);
+	return true;
+}
+
+// The way sceKernelSetEventFlag used to do it.
+static void EraseAsWeGo(std::vector<FakeWaiter> &waiters, u32 &pattern, std::vector<SceUID> &woken, bool clear) {
+	for (size_t i = 0; i < waiters.size(); ++i) {
+		if (TryWake(pattern, waiters[i], woken, clear)) {
+			waiters.erase(waiters.begin() + i);
+			--i;
+		}
+	}
+}
+
+static bool TestSameResult() {
+	std::vector<FakeWaiter> expected = MakeWaiters(300);
+	std::vector<FakeWaiter> actual = expected;
+
+	const u32 patterns[] = { 0x00000001, 0x0000FFFF, 0x80000000, 0xFFFFFFFF, 0x12345678, 0xFFFFFFFF };
+	for (u32 setBits : patterns) {
+		u32 expectedPattern = setBits, actualPattern = setBits;
+		std::vector<SceUID> expectedWoken, actualWoken;
+		EraseAsWeGo(expected, expectedPattern, expectedWoken, true);
+		HLEKernel::RemoveWaitingThreadsIf(actual, [&](const FakeWaiter &w) {
+			return TryWake(actualPattern, w, actualWoken, true);
+		});
+
+		EXPECT_EQ_INT(actualPattern, expectedPattern);
+		EXPECT_TRUE(actualWoken == expectedWoken);
+		EXPECT_EQ_INT(actual.size(), expected.size());
+		for (size_t i = 0; i < expected.size(); ++i) {
+			EXPECT_EQ_INT(actual[i].threadID, expected[i].threadID);
+		}
+	}
+	return true;
+}
+
+bool TestKernelWaitHelpers() {
+	return TestSameResult();
+}
@@ -15,9 +15,11 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include "Common/CPUDetect.h"
 #include "Common/Data/Random/Rng.h"
 #include "Common/StringUtils.h"
 #include "Core/Config.h"
+#include "GPU/GPUState.h"
 #include "GPU/Software/DrawPixel.h"
 #include "GPU/Software/Sampler.h"
 #include "GPU/Software/SoftGpu.h"
@@ -158,6 +160,168 @@ static bool TestPixelJit() {
 	return successes == count && !HitAnyAsserts();
 }
 
+// Any faster path through the pixel funcs must stay bit-exact with DrawSinglePixel().
+static bool TestPixelJitMatchesGeneric() {
+	using namespace Rasterizer;
+	PixelJitCache *cache = new PixelJitCache();
+
+	GMRng rng;
+	int mismatches = 0;
+	int count = 1000;
+	// Enough rows to cover the 4x4 dither pattern at either stride.
+	const int bufSize = 512 * 4;
+
+	u32 *fbJit = new u32[bufSize];
+	u32 *fbGeneric = new u32[bufSize];
+	u16 *zbJit = new u16[bufSize];
+	u16 *zbGeneric = new u16[bufSize];
+
+	const GPUgstate savedState = gstate;
+	for (int i = 0; i < count; ++i) {
+		// Let ComputePixelFuncID() pick the ID, so it's always one the rasterizer could use.
+		for (int cmd = 0; cmd < 256; ++cmd)
+			gstate.cmdmem[cmd] = (cmd << 24) | (rng.R32() & 0x00FFFFFF);
+		const u32 stride = (rng.R32() & 1) ? 512 : 256;
+		gstate.fbwidth = (GE_CMD_FRAMEBUFWIDTH << 24) | stride;
+		gstate.zbwidth = (GE_CMD_ZBUFWIDTH << 24) | stride;
+
+		PixelFuncID id{};
+		ComputePixelFuncID(&id);
+
+		SingleFunc func = cache->GetSingle(id);
+		SingleFunc genericFunc = cache->GenericSingle(id);
+		if (!func)
+			continue;
+
+		for (int j = 0; j < bufSize; ++j) {
+			fbJit[j] = fbGeneric[j] = rng.R32();
+			zbJit[j] = zbGeneric[j] = (u16)rng.R32();
+		}
+
+		for (int y = 0; y < 4; ++y) {
+			for (int x = 0; x < 4; ++x) {
+				int z = rng.R32() & 0xFFFF;
+				int fog = rng.R32() & 0xFF;
+				// Colors can go past 255 after adding the secondary color.
+				Math3D::Vec4<int> color(rng.R32() % 320, rng.R32() % 320, rng.R32() % 320, rng.R32() % 320);
+
+				fb.as32 = fbJit;
+				depthbuf.as16 = zbJit;
+				func(x, y, z, fog, ToVec4IntArg(color), id);
+
+				fb.as32 = fbGeneric;
+				depthbuf.as16 = zbGeneric;
+				genericFunc(x, y, z, fog, ToVec4IntArg(color), id);
+			}
+		}
+
+		if (memcmp(fbJit, fbGeneric, sizeof(u32) * bufSize) != 0 || memcmp(zbJit, zbGeneric, sizeof(u16) * bufSize) != 0) {
+			if (mismatches == 0)
+				printf("Pixel funcs not matching generic:\n");
+			printf(" * %s\n", DescribePixelFuncID(id).c_str());
+			mismatches++;
+		}
+	}
+	gstate = savedState;
+
+	if (mismatches != 0)
+		printf("PixelFunc mismatches: %d / %d\n", mismatches, count);
+
+	delete [] fbJit;
+	delete [] fbGeneric;
+	delete [] zbJit;
+	delete [] zbGeneric;
+	delete cache;
+	return mismatches == 0 && !HitAnyAsserts();
+}
+
+// Spans must draw exactly what DrawSinglePixel() would for each pixel in the mask, and nothing else.
+static bool TestPixelJitSpansMatchGeneric() {
+	using namespace Rasterizer;
+	PixelJitCache *cache = new PixelJitCache();
+
+	GMRng rng;
+	int mismatches = 0;
+	int compiled = 0;
+	int count = 1000;
+	const int bufSize = 512 * 4;
+
+	u32 *fbJit = new u32[bufSize];
+	u32 *fbGeneric = new u32[bufSize];
+	u16 *zbJit = new u16[bufSize];
+	u16 *zbGeneric = new u16[bufSize];
+
+	const GPUgstate savedState = gstate;
+	for (int i = 0; i < count; ++i) {
+		for (int cmd = 0; cmd < 256; ++cmd)
+			gstate.cmdmem[cmd] = (cmd << 24) | (rng.R32() & 0x00FFFFFF);
+		// Spans never handle these, so make sure most IDs can use them.
+		gstate.clearmode &= ~1;
+		gstate.stencilTestEnable &= ~1;
+		gstate.logicOpEnable &= ~1;
+		const u32 stride = (rng.R32() & 1) ? 512 : 256;
+		gstate.fbwidth = (GE_CMD_FRAMEBUFWIDTH << 24) | stride;
+		gstate.zbwidth = (GE_CMD_ZBUFWIDTH << 24) | stride;
+
+		PixelFuncID id{};
+		ComputePixelFuncID(&id);
+
+		SpanFunc spanFunc = cache->GetSpan(id);
+		SingleFunc genericFunc = cache->GenericSingle(id);
+		if (!spanFunc)
+			continue;
+		compiled++;
+
+		for (int j = 0; j < bufSize; ++j) {
+			fbJit[j] = fbGeneric[j] = rng.R32();
+			zbJit[j] = zbGeneric[j] = (u16)rng.R32();
+		}
+
+		for (int y = 0; y < 4; ++y) {
+			PixelSpan span;
+			const int x = rng.R32() % (stride - 7);
+			span.mask = rng.R32() & 0xFF;
+			for (int j = 0; j < 8; ++j) {
+				span.z[j] = rng.R32() & 0xFFFF;
+				span.fog[j] = (u8)rng.R32();
+				span.color[j] = rng.R32();
+			}
+
+			fb.as32 = fbJit;
+			depthbuf.as16 = zbJit;
+			spanFunc(x, y, span, id);
+
+			fb.as32 = fbGeneric;
+			depthbuf.as16 = zbGeneric;
+			for (int j = 0; j < 8; ++j) {
+				if (span.mask & (1 << j))
+					genericFunc(x + j, y, span.z[j], span.fog[j], ToVec4IntArg(Math3D::Vec4<int>::FromRGBA(span.color[j])), id);
+			}
+		}
+
+		if (memcmp(fbJit, fbGeneric, sizeof(u32) * bufSize) != 0 || memcmp(zbJit, zbGeneric, sizeof(u16) * bufSize) != 0) {
+			if (mismatches == 0)
+				printf("Span funcs not matching generic:\n");
+			printf(" * %s\n", DescribePixelFuncID(id).c_str());
+			mismatches++;
+		}
+	}
+	gstate = savedState;
+
+	if (mismatches != 0)
+		printf("SpanFunc mismatches: %d / %d\n", mismatches, compiled);
+	// Spans are only compiled where AVX2 is available.
+	if (cpu_info.bAVX2 && compiled == 0)
+		printf("SpanFunc: none compiled\n");
+
+	delete [] fbJit;
+	delete [] fbGeneric;
+	delete [] zbJit;
+	delete [] zbGeneric;
+	delete cache;
+	return mismatches == 0 && (compiled != 0 || !cpu_info.bAVX2) && !HitAnyAsserts();
+}
+
 bool TestSoftwareGPUJit() {
 	g_Config.bSoftwareRenderingJit = true;
 	ResetHitAnyAsserts();
@@ -170,5 +334,13 @@ bool TestSoftwareGPUJit() {
 		return false;
 	}
 
+	if (!TestPixelJitMatchesGeneric()) {
+		return false;
+	}
+
+	if (!TestPixelJitSpansMatchGeneric()) {
+		return false;
+	}
+
 	return true;
 }
@@ -0,0 +1,212 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Common/Data/Random/Rng.h"
+#include "GPU/GPUState.h"
+#include "GPU/Software/BinManager.h"
+#include "GPU/Software/Rasterizer.h"
+#include "GPU/Software/RasterizerRectangle.h"
+#include "GPU/Software/Sampler.h"
+#include "GPU/Software/SoftGpu.h"
+#include "unittest/UnitTest.h"
+
+static const int FB_STRIDE = 512;
+static const int FB_HEIGHT = 272;
+static const int TEX_SIZE = 256;
+
+static void SetCmd(int cmd, u32 value) {
+	gstate.cmdmem[cmd] = (cmd << 24) | (value & 0x00FFFFFF);
+}
+
+// A texture and palette that mix opaque, transparent, and translucent runs like typical sprites.
+struct SpriteTexture {
+	std::vector<u8> data;
+	u8 clutData[1024];
+
+	SpriteTexture(GMRng &rng) : data(TEX_SIZE * TEX_SIZE * 4) {
+		for (size_t i = 0; i < data.size(); i += 4) {
+			u32 c = rng.R32();
+			switch ((i / 64) % 4) {
+			case 0: c |= 0xFF008000; break;
+			case 1: c &= 0x00FF7FFF; break;
+			default: break;
+			}
+			memcpy(&data[i], &c, 4);
+		}
+		for (int i = 0; i < 256; ++i) {
+			u32 c = rng.R32();
+			if (i & 1)
+				c |= 0xFF008000;
+			else if (i & 2)
+				c &= 0x00FF7FFF;
+			memcpy(&clutData[i * 4], &c, 4);
+		}
+	}
+};
+
+struct SpriteConfig {
+	GETextureFormat texfmt;
+	GEBufferFormat fbfmt;
+	bool swizzle;
+	bool blend;
+	bool alphaTest;
+	bool depthWrite;
+	GETexFunc texfunc;
+	bool textureAlpha;
+	u32 primColor;
+};
+
+static void SetupState(const SpriteConfig &config, const SpriteTexture &tex, Rasterizer::RasterizerState *state) {
+	memset(&gstate, 0, sizeof(gstate));
+	for (int i = 0; i < 256; ++i)
+		SetCmd(i, 0);
+	SetCmd(GE_CMD_VERTEXTYPE, GE_VTYPE_THROUGH);
+	SetCmd(GE_CMD_FRAMEBUFWIDTH, FB_STRIDE);
+	SetCmd(GE_CMD_ZBUFWIDTH, FB_STRIDE);
+	SetCmd(GE_CMD_FRAMEBUFPIXFORMAT, config.fbfmt);
+	SetCmd(GE_CMD_TEXTUREMAPENABLE, 1);
+	SetCmd(GE_CMD_TEXFORMAT, config.texfmt);
+	SetCmd(GE_CMD_TEXMODE, config.swizzle ? 1 : 0);
+	SetCmd(GE_CMD_TEXSIZE0, 8 | (8 << 8));
+	SetCmd(GE_CMD_TEXBUFWIDTH0, TEX_SIZE);
+	SetCmd(GE_CMD_CLUTFORMAT, GE_CMODE_32BIT_ABGR8888 | (0xFF << 8));
+	SetCmd(GE_CMD_TEXFUNC, config.texfunc | (config.textureAlpha ? 0x100 : 0));
+	SetCmd(GE_CMD_ALPHABLENDENABLE, config.blend ? 1 : 0);
+	SetCmd(GE_CMD_BLENDMODE, GE_SRCBLEND_SRCALPHA | (GE_DSTBLEND_INVSRCALPHA << 4) | (GE_BLENDMODE_MUL_AND_ADD << 8));
+	SetCmd(GE_CMD_ALPHATESTENABLE, config.alphaTest ? 1 : 0);
+	SetCmd(GE_CMD_ALPHATEST, GE_COMP_GREATER | (0xFF << 16));
+	SetCmd(GE_CMD_ZTESTENABLE, config.depthWrite ? 1 : 0);
+	SetCmd(GE_CMD_ZTEST, GE_COMP_ALWAYS);
+
+	Rasterizer::ComputeRasterizerState(state);
+	// There's no PSP memory here, so point the sampler at our own texture instead.
+	state->samplerID.hasInvalidPtr = false;
+	state->samplerID.cached.clut = tex.clutData;
+	state->nearest = Sampler::GetNearestFunc(state->samplerID);
+	state->linear = Sampler::GetLinearFunc(state->samplerID);
+	state->texptr[0] = tex.data.data();
+	state->texbufw[0] = TEX_SIZE;
+}
+
+static VertexData MakeVertex(int x, int y, int u, int v, u32 primColor) {
+	VertexData vert{};
+	vert.screenpos = ScreenCoords(x * SCREEN_SCALE_FACTOR, y * SCREEN_SCALE_FACTOR, 0x1234);
+	vert.texturecoords = Vec2f((float)u, (float)v);
+	vert.color0 = Vec4<int>::FromRGBA(primColor);
+	vert.fogdepth = 1.0f;
+	return vert;
+}
+
+// Like the binner, clip to the sprite itself.
+static BinCoords SpriteRange(const VertexData &v0, const VertexData &v1) {
+	BinCoords range;
+	range.x1 = v0.screenpos.x;
+	range.y1 = v0.screenpos.y;
+	range.x2 = v1.screenpos.x - 1;
+	range.y2 = v1.screenpos.y - 1;
+	return range;
+}
+
+// The per pixel loop DrawSprite uses for states without a faster path.
+static void DrawSpriteReference(const VertexData &v0, const VertexData &v1, const Rasterizer::RasterizerState &state) {
+	const u8 *texptr = state.texptr[0];
+	int texbufw = state.texbufw[0];
+	const float invWidth = 1.0f / (float)(1 << state.samplerID.width0Shift);
+	const float invHeight = 1.0f / (float)(1 << state.samplerID.height0Shift);
+
+	const int x1 = v0.screenpos.x / SCREEN_SCALE_FACTOR, y1 = v0.screenpos.y / SCREEN_SCALE_FACTOR;
+	const int x2 = v1.screenpos.x / SCREEN_SCALE_FACTOR, y2 = v1.screenpos.y / SCREEN_SCALE_FACTOR;
+	for (int y = y1; y < y2; ++y) {
+		for (int x = x1; x < x2; ++x) {
+			float s = (v0.texturecoords.x + (x - x1)) * invWidth;
+			float t = (v0.texturecoords.y + (y - y1)) * invHeight;
+			Vec4<int> color = state.nearest(s, t, 0, 0, Rasterizer::ToVec4IntArg(v1.color0), &texptr, &texbufw, 0, 0, state.samplerID);
+			state.drawPixel(x, y, v1.screenpos.z, 255, Rasterizer::ToVec4IntArg(color), state.pixelID);
+		}
+	}
+}
+
+static bool TestSpriteMatchesReference() {
+	static u32 fbData[2][FB_STRIDE * FB_HEIGHT];
+	static u16 depthData[2][FB_STRIDE * FB_HEIGHT];
+	const FormatBuffer oldFb = fb, oldDepth = depthbuf;
+	const GPUgstate oldState = gstate;
+
+	GMRng rng;
+	SpriteTexture tex(rng);
+	const GETextureFormat texfmts[] = { GE_TFMT_CLUT4, GE_TFMT_CLUT8, GE_TFMT_5551, GE_TFMT_8888, GE_TFMT_4444 };
+	const GEBufferFormat fbfmts[] = { GE_FORMAT_8888, GE_FORMAT_5551, GE_FORMAT_565, GE_FORMAT_4444 };
+	const u32 primColors[] = { 0xFFFFFFFF, 0x80FFFFFF, 0xFF8040C0 };
+
+	int mismatches = 0;
+	for (int i = 0; i < 2000; ++i) {
+		SpriteConfig config;
+		config.texfmt = texfmts[rng.R32() % ARRAY_SIZE(texfmts)];
+		config.fbfmt = fbfmts[rng.R32() % ARRAY_SIZE(fbfmts)];
+		config.swizzle = (rng.R32() & 3) == 0;
+		config.blend = (rng.R32() & 1) != 0;
+		config.alphaTest = (rng.R32() & 1) != 0;
+		config.depthWrite = (rng.R32() & 3) == 0;
+		config.texfunc = (rng.R32() & 1) ? GE_TEXFUNC_REPLACE : GE_TEXFUNC_MODULATE;
+		config.textureAlpha = (rng.R32() & 3) != 0;
+		config.primColor = primColors[rng.R32() % ARRAY_SIZE(primColors)];
+
+		Rasterizer::RasterizerState state;
+		SetupState(config, tex, &state);
+
+		int w = 1 + rng.R32() % TEX_SIZE, h = 1 + rng.R32() % 64;
+		int x = rng.R32() % (480 - w + 1), y = rng.R32() % (FB_HEIGHT - h + 1);
+		int u = rng.R32() % (TEX_SIZE - w + 1), v = rng.R32() % (TEX_SIZE - h + 1);
+		const VertexData v0 = MakeVertex(x, y, u, v, config.primColor);
+		const VertexData v1 = MakeVertex(x + w, y + h, u + w, v + h, config.primColor);
+
+		for (int j = 0; j < FB_STRIDE * FB_HEIGHT; ++j) {
+			fbData[0][j] = rng.R32();
+			depthData[0][j] = (u16)rng.R32();
+		}
+		memcpy(fbData[1], fbData[0], sizeof(fbData[0]));
+		memcpy(depthData[1], depthData[0], sizeof(depthData[0]));
+
+		for (int j = 0; j < 2; ++j) {
+			fb.as32 = fbData[j];
+			depthbuf.as16 = depthData[j];
+			if (j == 0)
+				DrawSpriteReference(v0, v1, state);
+			else
+				Rasterizer::DrawSprite(v0, v1, SpriteRange(v0, v1), state);
+		}
+
+		if (memcmp(fbData[0], fbData[1], sizeof(fbData[0])) != 0 || memcmp(depthData[0], depthData[1], sizeof(depthData[0])) != 0) {
+			if (mismatches < 10)
+				printf("Sprite mismatch: texfmt=%d fbfmt=%d swizzle=%d blend=%d atest=%d zwrite=%d func=%d rgba=%d prim=%08x\n", config.texfmt, config.fbfmt, config.swizzle, config.blend, config.alphaTest, config.depthWrite, config.texfunc, config.textureAlpha, config.primColor);
+			mismatches++;
+		}
+	}
+
+	fb = oldFb;
+	depthbuf = oldDepth;
+	gstate = oldState;
+	EXPECT_EQ_INT(mismatches, 0);
+	return true;
+}
+
+bool TestSoftwareGPUSprite() {
+	return TestSpriteMatchesReference();
+}
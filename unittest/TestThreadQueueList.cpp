@@ -0,0 +1,122 @@
+// Copyright (c) 2022- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <deque>
+#include "Core/HLE/ThreadQueueList.h"
+#include "unittest/UnitTest.h"
+
+static const int NUM_QUEUES = ThreadQueueList::NUM_QUEUES;
+
+// The thread at the front of the best priority better than limit, or 0.
+static SceUID FirstBetter(const std::deque<SceUID> *ref, int limit) {
+	for (int p = 0; p < limit; ++p) {
+		if (!ref[p].empty())
+			return ref[p].front();
+	}
+	return 0;
+}
+
+static SceUID PopFirstBetter(std::deque<SceUID> *ref, int limit) {
+	for (int p = 0; p < limit; ++p) {
+		if (!ref[p].empty()) {
+			SceUID threadID = ref[p].front();
+			ref[p].pop_front();
+			return threadID;
+		}
+	}
+	return 0;
+}
+
+static bool TestRandomOps() {
+	static ThreadQueueList queue;
+	static std::deque<SceUID> ref[NUM_QUEUES];
+	queue.clear();
+	for (int p = 0; p < NUM_QUEUES; ++p) {
+		ref[p].clear();
+		queue.prepare(p);
+	}
+
+	// A fixed seed, so any failure is repeatable.
+	u32 seed = 1;
+	auto nextRandom = [&]() {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	};
+
+	SceUID nextID = 1;
+	for (int i = 0; i < 200000; ++i) {
+		int priority = nextRandom() % NUM_QUEUES;
+		switch (nextRandom() % 6) {
+		case 0:
+			queue.push_back(priority, nextID);
+			ref[priority].push_back(nextID++);
+			break;
+
+		case 1:
+			queue.push_front(priority, nextID);
+			ref[priority].push_front(nextID++);
+			break;
+
+		case 2:
+		{
+			// Like a reschedule, only threads better than the current one.
+			SceUID expected = PopFirstBetter(ref, priority);
+			SceUID actual = queue.pop_first_better(priority);
+			EXPECT_EQ_INT(actual, expected);
+			break;
+		}
+
+		case 3:
+			if (!ref[priority].empty()) {
+				auto it = ref[priority].begin() + nextRandom() % ref[priority].size();
+				queue.remove(priority, *it);
+				ref[priority].erase(it);
+			}
+			break;
+
+		case 4:
+			queue.rotate(priority);
+			if (ref[priority].size() > 1) {
+				ref[priority].push_back(ref[priority].front());
+				ref[priority].pop_front();
+			}
+			break;
+
+		case 5:
+			// This one asserts when there's nothing to pop.
+			if (FirstBetter(ref, NUM_QUEUES) != 0) {
+				SceUID expected = PopFirstBetter(ref, NUM_QUEUES);
+				SceUID actual = queue.pop_first();
+				EXPECT_EQ_INT(actual, expected);
+			}
+			break;
+		}
+
+		EXPECT_EQ_INT(queue.peek_first(), FirstBetter(ref, NUM_QUEUES));
+		EXPECT_EQ_INT(queue.empty(priority), ref[priority].empty());
+	}
+
+	queue.clear();
+	return true;
+}
+
+bool TestThreadQueueList() {
+	if (!TestRandomOps())
+		return false;
+	return true;
+}
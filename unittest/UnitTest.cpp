@@ -796,7 +796,16 @@ bool TestX64Emitter();
 bool TestRiscVEmitter();
 bool TestShaderGenerators();
 bool TestSoftwareGPUJit();
+bool TestSoftwareGPUSprite();
 bool TestIRPassSimplify();
+bool TestIRInterpreter();
+bool TestIRRegAlloc();
+bool TestCoreTiming();
+bool TestKernelWaitHelpers();
+bool TestThreadQueueList();
+#if PPSSPP_ARCH(RISCV64)
+bool TestIRToRiscV();
+#endif
 bool TestThreadManager();
 
 TestItem availableTests[] = {
@@ -819,6 +828,14 @@ TestItem availableTests[] = {
 	TEST_ITEM(MathUtil),
 	TEST_ITEM(Parsers),
 	TEST_ITEM(IRPassSimplify),
+	TEST_ITEM(IRInterpreter),
+	TEST_ITEM(IRRegAlloc),
+	TEST_ITEM(CoreTiming),
+	TEST_ITEM(KernelWaitHelpers),
+	TEST_ITEM(ThreadQueueList),
+#if PPSSPP_ARCH(RISCV64)
+	TEST_ITEM(IRToRiscV),
+#endif
 	TEST_ITEM(Jit),
 	TEST_ITEM(MatrixTranspose),
 	TEST_ITEM(ParseLBN),
@@ -827,6 +844,7 @@ TestItem availableTests[] = {
 	TEST_ITEM(MemMap),
 	TEST_ITEM(ShaderGenerators),
 	TEST_ITEM(SoftwareGPUJit),
+	TEST_ITEM(SoftwareGPUSprite),
 	TEST_ITEM(Path),
 	TEST_ITEM(AndroidContentURI),
 	TEST_ITEM(ThreadManager),